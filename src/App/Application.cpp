@@ -75,6 +75,8 @@
 #include <Base/PlacementPy.h>
 #include <Base/RotationPy.h>
 #include <Base/Sequencer.h>
+#include <Base/Stream.h>
+#include <Base/TimeInfo.h>
 #include <Base/Tools.h>
 #include <Base/Translate.h>
 #include <Base/UnitsApi.h>
@@ -1269,6 +1271,23 @@ void Application::changeImportModule(const char* Type, const char* OldModuleName
     }
 }
 
+/// In lazy init mode a file type is registered only after the Init.py of its module
+/// is run. Run all deferred Init.py once the first time a lookup fails.
+static bool loadDeferredModules()
+{
+    static bool loaded = false;
+    if (loaded || Application::Config()["LazyInit"] != "1")
+        return false;
+    loaded = true;
+    try {
+        Base::Interpreter().runString("import FreeCAD\nFreeCAD.loadDeferredModules()");
+    }
+    catch (const Base::Exception& e) {
+        e.ReportException();
+    }
+    return true;
+}
+
 std::vector<std::string> Application::getImportModules(const char* Type) const
 {
     std::vector<std::string> modules;
@@ -1284,6 +1303,8 @@ std::vector<std::string> Application::getImportModules(const char* Type) const
         }
     }
 
+    if (modules.empty() && loadDeferredModules())
+        return getImportModules(Type);
     return modules;
 }
 
@@ -1407,6 +1428,8 @@ std::vector<std::string> Application::getExportModules(const char* Type) const
         }
     }
 
+    if (modules.empty() && loadDeferredModules())
+        return getExportModules(Type);
     return modules;
 }
 
@@ -1779,8 +1802,77 @@ void my_se_translator_filter(unsigned int code, EXCEPTION_POINTERS* pExp)
 }
 #endif
 
+namespace {
+struct StartupStage {
+    std::string name;
+    double start;
+    double duration;
+};
+std::vector<StartupStage> _StartupStages;
+bool _StartupTraceWritten;
+
+// reference point of all recorded start-up stages
+const Base::TimeInfo &startupTime() {
+    static Base::TimeInfo t;
+    return t;
+}
+
+std::string escapeJson(const std::string &s) {
+    std::ostringstream str;
+    for (char c : s) {
+        if (c == '"' || c == '\\')
+            str << '\\' << c;
+        else if ((unsigned char)c < 0x20)
+            str << "\\u00" << "0123456789abcdef"[(c>>4)&0xf] << "0123456789abcdef"[c&0xf];
+        else
+            str << c;
+    }
+    return str.str();
+}
+} // anonymous namespace
+
+void Application::addStartupTime(const std::string &stage, double seconds)
+{
+    StartupStage info;
+    info.name = stage;
+    info.duration = seconds;
+    info.start = std::max(0.0, Base::TimeInfo::diffTimeF(startupTime()) - seconds);
+    _StartupStages.push_back(info);
+}
+
+void Application::writeStartupTrace(void)
+{
+    auto it = mConfig.find("StartupTrace");
+    if (_StartupTraceWritten || it == mConfig.end() || it->second.empty())
+        return;
+    _StartupTraceWritten = true;
+
+    Base::FileInfo fi(it->second);
+    Base::ofstream str(fi);
+    if (!str) {
+        Console().Warning("Cannot write start-up trace to %s\n", fi.filePath().c_str());
+        return;
+    }
+    str.setf(std::ios::fixed, std::ios::floatfield);
+    str.precision(6);
+    str << "{\n"
+        << "  \"total\": " << Base::TimeInfo::diffTimeF(startupTime()) << ",\n"
+        << "  \"lazyInit\": " << (mConfig["LazyInit"] == "1" ? "true" : "false") << ",\n"
+        << "  \"stages\": [";
+    for (std::size_t i=0; i<_StartupStages.size(); ++i) {
+        const auto &stage = _StartupStages[i];
+        str << (i ? ",\n" : "\n")
+            << "    {\"name\": \"" << escapeJson(stage.name)
+            << "\", \"start\": " << stage.start
+            << ", \"duration\": " << stage.duration << "}";
+    }
+    str << "\n  ]\n}\n";
+    Console().Log("Start-up trace written to %s\n", fi.filePath().c_str());
+}
+
 void Application::init(int argc, char ** argv)
 {
+    startupTime();
     try {
         // install our own new handler
 #ifdef _MSC_VER // Microsoft compiler
@@ -1802,14 +1894,20 @@ void Application::init(int argc, char ** argv)
 #if defined(FC_SE_TRANSLATOR)
         _set_se_translator(my_se_translator_filter);
 #endif
+        Base::TimeInfo t;
         initTypes();
+        addStartupTime("initTypes", Base::TimeInfo::diffTimeF(t));
 
 #if (BOOST_FILESYSTEM_VERSION == 2)
         boost::filesystem::path::default_name_check(boost::filesystem::no_check);
 #endif
 
+        t.setCurrent();
         initConfig(argc,argv);
+        addStartupTime("initConfig", Base::TimeInfo::diffTimeF(t));
+        t.setCurrent();
         initApplication();
+        addStartupTime("initApplication", Base::TimeInfo::diffTimeF(t));
     }
     catch (...) {
         // force the log to flush
@@ -2088,7 +2186,9 @@ void Application::initConfig(int argc, char ** argv)
     PyImport_AppendInittab ("FreeCAD", init_freecad_module);
     PyImport_AppendInittab ("__FreeCADBase__", init_freecad_base_module);
 #endif
+    Base::TimeInfo t;
     const char* pythonpath = Interpreter().init(argc,argv);
+    addStartupTime("Python init", Base::TimeInfo::diffTimeF(t));
     if (pythonpath)
         mConfig["PythonSearchPath"] = pythonpath;
     else
@@ -2132,7 +2232,9 @@ void Application::initConfig(int argc, char ** argv)
                               mConfig["BuildVersionMinor"].c_str(),
                               mConfig["BuildRevision"].c_str());
     }
+    t.setCurrent();
     LoadParameters();
+    addStartupTime("LoadParameters", Base::TimeInfo::diffTimeF(t));
 
     auto loglevelParam = _pcUserParamMngr->GetGroup("BaseApp/LogLevels");
     const auto &loglevels = loglevelParam->GetIntMap();
@@ -2238,7 +2340,9 @@ void Application::initApplication(void)
     Console().Log("Run App init script\n");
     try {
         Interpreter().runString(Base::ScriptFactory().ProduceScript("CMakeVariables"));
+        Base::TimeInfo t;
         Interpreter().runString(Base::ScriptFactory().ProduceScript("FreeCADInit"));
+        addStartupTime("FreeCADInit", Base::TimeInfo::diffTimeF(t));
     }
     catch (const Base::Exception& e) {
         e.ReportException();
@@ -2383,6 +2487,8 @@ void Application::processCmdLineFiles(void)
 
 void Application::runApplication()
 {
+    writeStartupTrace();
+
     // process all files given through command line interface
     processCmdLineFiles();
 
@@ -2601,6 +2707,8 @@ void Application::ParseOptions(int ac, char ** av)
     ("module-path,M", value< vector<string> >()->composing(),"Additional module paths")
     ("python-path,P", value< vector<string> >()->composing(),"Additional python paths")
     ("single-instance", "Allow to run a single instance of the application")
+    ("startup-trace", value<string>(), "Write the time spent in the start-up stages to a JSON file")
+    ("lazy-init", "Run the Init.py of a module only when the module is first used")
     ;
 
 
@@ -2824,6 +2932,14 @@ void Application::ParseOptions(int ac, char ** av)
         mConfig["SingleInstance"] = "1";
     }
 
+    if (vm.count("startup-trace")) {
+        mConfig["StartupTrace"] = vm["startup-trace"].as<string>();
+    }
+
+    if (vm.count("lazy-init")) {
+        mConfig["LazyInit"] = "1";
+    }
+
     if (vm.count("dump-config")) {
         std::stringstream str;
         for (std::map<std::string,std::string>::iterator it=mConfig.begin(); it != mConfig.end(); ++it) {
@@ -394,6 +394,16 @@ public:
     static char** GetARGV(void){return _argv;}
     //@}
 
+    /** @name Start-up profiling */
+    //@{
+    /// Record the time in seconds spent in a start-up stage that has just finished
+    static void addStartupTime(const std::string &stage, double seconds);
+    /** Write the recorded start-up stages as JSON to the file given with
+     * --startup-trace. Does nothing if no file is given or the trace is already written.
+     */
+    static void writeStartupTrace(void);
+    //@}
+
     /** @name Application directories */
     //@{
     const char* getHomePath(void) const;
@@ -547,6 +557,8 @@ private:
     static PyObject *sDumpSWIG(PyObject *self,PyObject *args);
 
     static PyObject *sCheckAbort(PyObject *self,PyObject *args);
+
+    static PyObject *sAddStartupTime(PyObject *self,PyObject *args);
     static PyMethodDef    Methods[];
 
     friend class ApplicationObserver;
@@ -187,6 +187,9 @@ PyMethodDef Application::Methods[] = {
      "There is an active sequencer during document restore and recomputation. User may\n"
      "abort the operation by pressing the ESC key. Once detected, this function will\n"
      "trigger a BaseExceptionFreeCADAbort exception."},
+    {"addStartupTime", (PyCFunction) Application::sAddStartupTime, METH_VARARGS,
+     "addStartupTime(stage, seconds) -- record the time spent in a start-up stage\n\n"
+     "The recorded stages are written to the file given with --startup-trace."},
     {NULL, NULL, 0, NULL}		/* Sentinel */
 };
 
@@ -968,6 +971,19 @@ PyObject *Application::sCheckAbort(PyObject * /*self*/, PyObject *args)
     }PY_CATCH
 }
 
+PyObject *Application::sAddStartupTime(PyObject * /*self*/, PyObject *args)
+{
+    char *stage;
+    double seconds;
+    if (!PyArg_ParseTuple(args, "sd", &stage, &seconds))
+        return 0;
+
+    PY_TRY {
+        addStartupTime(stage, seconds);
+        Py_Return;
+    }PY_CATCH
+}
+
 PyObject *Application::sDumpSWIG(PyObject * /*self*/, PyObject *args)
 {
     if (!PyArg_ParseTuple(args, ""))
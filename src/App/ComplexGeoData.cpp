@@ -25,12 +25,19 @@
 
 #ifndef _PreComp_
 # include <cstdlib>
+# include <cstring>
+# include <algorithm>
+# include <deque>
 #endif
 
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+
 #include <boost/algorithm/string/predicate.hpp>
-#include <boost/bimap.hpp>
-#include <boost/bimap/multiset_of.hpp>
-#include <boost/bimap/unordered_set_of.hpp>
+#include <boost/functional/hash.hpp>
+#include <boost/unordered_map.hpp>
 #include <Base/Writer.h>
 #include <Base/Reader.h>
 
@@ -43,11 +50,710 @@ FC_LOG_LEVEL_INIT("ComplexGeoData", true,true);
 using namespace Data;
 
 namespace Data {
-typedef boost::bimap<
-            boost::bimaps::set_of<std::string>,
-            boost::bimaps::multiset_of<std::string>,
-            boost::bimaps::with_info<std::vector<App::StringIDRef> > > ElementMapBase;
-class ElementMap: public ElementMapBase {};
+
+/** Global table of indexed element types
+ *
+ * Indexed names (e.g. Face1, Edge2) are stored inside the element map as a
+ * pair of type and integer index. This table owns the type text, and lazily
+ * produces the full indexed name for the API that needs to return a persistent
+ * <tt>const char *</tt>. The generated names are shared by all element maps.
+ *
+ * Looking up a generated name is lock free, so that it does not serialize
+ * threads that are naming elements concurrently.
+ */
+class IndexedNameTable {
+public:
+    enum {
+        BlockSize = 1024,
+        MaxBlocks = 4096,
+    };
+
+    struct Type {
+        std::string name;
+        /// Generated names of index below BlockSize*MaxBlocks
+        mutable std::atomic<std::atomic<const char*>*> blocks[MaxBlocks];
+        /// Generated names of larger index, protected by the table mutex
+        mutable std::unordered_map<int, std::string> names;
+
+        Type() {
+            for(auto &block : blocks)
+                block.store(nullptr, std::memory_order_relaxed);
+        }
+    };
+
+    static IndexedNameTable &instance() {
+        // Never destroyed, because element maps may outlive static destruction
+        static IndexedNameTable *inst = new IndexedNameTable;
+        return *inst;
+    }
+
+    const Type *getType(const char *name, size_t len) {
+        std::lock_guard<std::mutex> lock(mutex);
+        for(auto &type : types) {
+            if(type->name.size()==len && std::strncmp(type->name.c_str(),name,len)==0)
+                return type.get();
+        }
+        types.emplace_back(new Type);
+        types.back()->name.assign(name,len);
+        return types.back().get();
+    }
+
+    const char *getName(const Type *type, int index) {
+        if(index < 0)
+            return type->name.c_str();
+
+        std::size_t i = (std::size_t)index / BlockSize;
+        if(i >= MaxBlocks) {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto res = type->names.emplace(index, std::string());
+            if(res.second)
+                res.first->second = makeName(type,index);
+            return res.first->second.c_str();
+        }
+
+        auto &block = type->blocks[i];
+        auto entries = block.load(std::memory_order_acquire);
+        if(!entries) {
+            auto newEntries = new std::atomic<const char*>[BlockSize];
+            for(int j=0; j<BlockSize; ++j)
+                newEntries[j].store(nullptr, std::memory_order_relaxed);
+            if(block.compare_exchange_strong(entries, newEntries, std::memory_order_acq_rel))
+                entries = newEntries;
+            else
+                delete [] newEntries;
+        }
+
+        auto &entry = entries[(std::size_t)index % BlockSize];
+        const char *name = entry.load(std::memory_order_acquire);
+        if(!name) {
+            std::string text = makeName(type,index);
+            char *newName = new char[text.size()+1];
+            std::memcpy(newName, text.c_str(), text.size()+1);
+            if(entry.compare_exchange_strong(name, newName, std::memory_order_acq_rel))
+                name = newName;
+            else
+                delete [] newName;
+        }
+        return name;
+    }
+
+private:
+    static std::string makeName(const Type *type, int index) {
+        std::string res = type->name;
+        res += std::to_string(index);
+        return res;
+    }
+
+private:
+    std::vector<std::unique_ptr<Type> > types;
+    std::mutex mutex;
+};
+
+/** Indexed element name stored as type plus index
+ *
+ * The index is -1 if the element name does not end with a plain integer (or
+ * has leading zeros), in which case the whole name is stored as the type.
+ */
+struct IndexedName {
+    const IndexedNameTable::Type *type = nullptr;
+    int index = -1;
+
+    bool operator==(const IndexedName &other) const {
+        return type == other.type && index == other.index;
+    }
+
+    const char *c_str() const {
+        return IndexedNameTable::instance().getName(type,index);
+    }
+
+    std::string toString() const {
+        if(index < 0)
+            return type->name;
+        return type->name + std::to_string(index);
+    }
+
+    /// Split the name into type and index, return the length of the type part
+    static size_t split(const char *name, int &index) {
+        size_t len = std::strlen(name);
+        size_t pos = len;
+        while(pos && std::isdigit((unsigned char)name[pos-1]))
+            --pos;
+        index = -1;
+        // Reject name without digits, with leading zeros, or with an index
+        // too large to fit in int.
+        if(pos==len || len-pos>9 || (name[pos]=='0' && len-pos>1))
+            return len;
+        index = std::atoi(name+pos);
+        return pos;
+    }
+};
+
+/** Global pool of mapped element names
+ *
+ * Mapped names are interned, so that a name used by more than one element map
+ * (e.g. the maps of the same shape kept by a feature, its copies and the undo
+ * transactions) is stored only once. The names are also prefix compressed. A
+ * name is split at its last elementMapPrefix() into an interned parent and a
+ * tail, so that the names along the modelling history, which are built by
+ * appending postfixes to the names of the input shapes, share their common
+ * prefixes.
+ *
+ * The full text of a name is only built when requested through c_str(), and
+ * is released together with the name.
+ */
+class MappedNameTable {
+public:
+    struct Node {
+        std::atomic<int> refs;
+        Node *parent;
+        std::string tail;
+        /// hash of the full text
+        std::size_t hash;
+        /// length of the full text
+        std::size_t length;
+        std::atomic<char*> text;
+
+        Node() : refs(1), parent(nullptr), hash(0), length(0), text(nullptr) {}
+        ~Node() { delete [] text.load(); }
+
+        bool equals(const char *name, std::size_t len) const {
+            if(length != len)
+                return false;
+            for(const Node *node=this; node; node=node->parent) {
+                std::size_t size = node->tail.size();
+                if(std::memcmp(name+len-size, node->tail.c_str(), size)!=0)
+                    return false;
+                len -= size;
+            }
+            return true;
+        }
+
+        const char *c_str() {
+            if(!parent)
+                return tail.c_str();
+            char *res = text.load(std::memory_order_acquire);
+            if(!res) {
+                char *newText = new char[length+1];
+                newText[length] = 0;
+                std::size_t end = length;
+                for(const Node *node=this; node; node=node->parent) {
+                    end -= node->tail.size();
+                    std::memcpy(newText+end, node->tail.c_str(), node->tail.size());
+                }
+                if(text.compare_exchange_strong(res, newText, std::memory_order_acq_rel))
+                    res = newText;
+                else
+                    delete [] newText;
+            }
+            return res;
+        }
+
+        void appendTo(std::string &res) const {
+            if(parent)
+                parent->appendTo(res);
+            res += tail;
+        }
+    };
+
+    static MappedNameTable &instance() {
+        // Never destroyed, because element maps may outlive static destruction
+        static MappedNameTable *inst = new MappedNameTable;
+        return *inst;
+    }
+
+    static std::size_t hash(const char *name, std::size_t len) {
+        return boost::hash_range(name, name+len);
+    }
+
+    /// Return the interned name with one reference owned by the caller
+    Node *intern(const char *name, std::size_t len) {
+        std::size_t h = hash(name,len);
+
+        // Intern the parent before locking, as it may belong to the same shard
+        Node *parent = nullptr;
+        std::size_t pos = len;
+        char sep = ComplexGeoData::elementMapPrefix()[0];
+        while(--pos) {
+            if(name[pos] == sep) {
+                parent = intern(name,pos);
+                break;
+            }
+        }
+
+        auto &shard = shards[h % NumShards];
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            auto range = shard.nodes.equal_range(h);
+            for(auto it=range.first; it!=range.second; ++it) {
+                Node *node = it->second;
+                if(node->equals(name,len)) {
+                    node->refs.fetch_add(1, std::memory_order_relaxed);
+                    release(parent);
+                    return node;
+                }
+            }
+            Node *node = new Node;
+            node->parent = parent;
+            node->tail.assign(name+pos, len-pos);
+            node->hash = h;
+            node->length = len;
+            shard.nodes.emplace(h, node);
+            return node;
+        }
+    }
+
+    void release(Node *node) {
+        while(node) {
+            // Drop a reference that is not the last one without locking
+            int refs = node->refs.load(std::memory_order_relaxed);
+            while(refs > 1) {
+                if(node->refs.compare_exchange_weak(refs, refs-1, std::memory_order_acq_rel))
+                    return;
+            }
+
+            // The last reference must be dropped while locking, or else a
+            // concurrent intern() may pick up the node being deleted.
+            Node *parent;
+            {
+                auto &shard = shards[node->hash % NumShards];
+                std::lock_guard<std::mutex> lock(shard.mutex);
+                if(node->refs.fetch_sub(1, std::memory_order_acq_rel) != 1)
+                    return;
+                auto range = shard.nodes.equal_range(node->hash);
+                for(auto it=range.first; it!=range.second; ++it) {
+                    if(it->second == node) {
+                        shard.nodes.erase(it);
+                        break;
+                    }
+                }
+                parent = node->parent;
+            }
+            delete node;
+            node = parent;
+        }
+    }
+
+private:
+    enum {
+        NumShards = 64,
+    };
+    struct Shard {
+        std::mutex mutex;
+        std::unordered_multimap<std::size_t, Node*> nodes;
+    };
+    Shard shards[NumShards];
+};
+
+/// Reference counted handle of an interned mapped name
+class MappedName {
+public:
+    typedef MappedNameTable::Node Node;
+
+    MappedName(const char *name, std::size_t len)
+        :node(MappedNameTable::instance().intern(name,len))
+    {}
+
+    MappedName(const MappedName &other)
+        :node(other.node)
+    {
+        node->refs.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    MappedName(MappedName &&other)
+        :node(other.node)
+    {
+        other.node = nullptr;
+    }
+
+    ~MappedName() {
+        if(node)
+            MappedNameTable::instance().release(node);
+    }
+
+    MappedName &operator=(const MappedName &) = delete;
+
+    bool operator==(const MappedName &other) const {
+        // interned names are equal if and only if they are the same node
+        return node == other.node;
+    }
+
+    bool equals(const char *name, std::size_t len) const {
+        return node->equals(name,len);
+    }
+
+    std::size_t hash() const {
+        return node->hash;
+    }
+
+    std::size_t size() const {
+        return node->length;
+    }
+
+    /// Return the full text, which is built once and kept with the name
+    const char *c_str() const {
+        return node->c_str();
+    }
+
+    /// Return the full text if it does not need to be built, or else nullptr
+    const char *data() const {
+        return node->parent ? nullptr : node->tail.c_str();
+    }
+
+    void appendTo(std::string &res) const {
+        res.reserve(res.size() + node->length);
+        node->appendTo(res);
+    }
+
+    std::string toString() const {
+        std::string res;
+        appendTo(res);
+        return res;
+    }
+
+    /// Compare the text of two names without building it
+    int compare(const MappedName &other) const {
+        if(node == other.node)
+            return 0;
+        return TextCursor(node).compare(TextCursor(other.node));
+    }
+
+    int compare(const char *name) const {
+        return TextCursor(node).compare(TextCursor(name));
+    }
+
+    friend std::ostream &operator<<(std::ostream &s, const MappedName &name) {
+        write(s, name.node);
+        return s;
+    }
+
+private:
+    static void write(std::ostream &s, const Node *node) {
+        if(node->parent)
+            write(s, node->parent);
+        s << node->tail;
+    }
+
+    /// Iterate the text of a name as a sequence of segments
+    struct TextCursor {
+        enum {
+            MaxDepth = 32,
+        };
+        const char *segments[MaxDepth];
+        std::size_t lengths[MaxDepth];
+        int count = 0;
+        int pos = 0;
+        std::size_t offset = 0;
+
+        TextCursor(const char *text) {
+            segments[0] = text;
+            lengths[0] = std::strlen(text);
+            count = 1;
+        }
+
+        TextCursor(Node *node) {
+            int depth = 0;
+            for(const Node *n=node; n; n=n->parent)
+                ++depth;
+            if(depth > MaxDepth) {
+                segments[0] = node->c_str();
+                lengths[0] = node->length;
+                count = 1;
+                return;
+            }
+            count = depth;
+            for(const Node *n=node; n; n=n->parent) {
+                --depth;
+                segments[depth] = n->tail.c_str();
+                lengths[depth] = n->tail.size();
+            }
+        }
+
+        int compare(TextCursor &&other) {
+            for(;;) {
+                if(pos == count)
+                    return other.pos == other.count ? 0 : -1;
+                if(other.pos == other.count)
+                    return 1;
+                std::size_t n = std::min(lengths[pos]-offset, other.lengths[other.pos]-other.offset);
+                int res = std::memcmp(segments[pos]+offset, other.segments[other.pos]+other.offset, n);
+                if(res)
+                    return res;
+                advance(n);
+                other.advance(n);
+            }
+        }
+
+        void advance(std::size_t n) {
+            offset += n;
+            if(offset == lengths[pos]) {
+                ++pos;
+                offset = 0;
+            }
+        }
+    };
+
+private:
+    Node *node;
+};
+
+/// Hash of mapped names that can be used with both MappedName and char range
+struct MappedNameHash {
+    std::size_t operator()(const MappedName &s) const {
+        return s.hash();
+    }
+    std::size_t operator()(const std::pair<const char*, size_t> &s) const {
+        return MappedNameTable::hash(s.first, s.second);
+    }
+};
+
+struct MappedNameEqual {
+    bool operator()(const MappedName &a, const MappedName &b) const {
+        return a == b;
+    }
+    bool operator()(const std::pair<const char*, size_t> &a, const MappedName &b) const {
+        return b.equals(a.first, a.second);
+    }
+    bool operator()(const MappedName &a, const std::pair<const char*, size_t> &b) const {
+        return a.equals(b.first, b.second);
+    }
+};
+
+/** Compact bidirectional map between mapped and indexed element names
+ *
+ * Each mapped name is stored as an interned MappedName, while the indexed
+ * names are stored as integers. Reverse lookup is done through a per-type
+ * array indexed by the element index, with multiple mapped names of the same
+ * element chained in insertion order. Indices far beyond the number of names
+ * of a type (e.g. from a malformed name) go into a sparse map instead, so that
+ * the array stays proportional to the number of names.
+ */
+class ElementMap {
+public:
+    struct MappedEntry;
+    typedef boost::unordered_map<MappedName, MappedEntry, MappedNameHash, MappedNameEqual> MappedMap;
+    typedef MappedMap::value_type MappedValue;
+
+    struct MappedEntry {
+        IndexedName indexed;
+        std::vector<App::StringIDRef> sids;
+        /// next mapped name of the same indexed element
+        MappedValue *next = nullptr;
+    };
+
+    std::size_t size() const {
+        return mappedNames.size();
+    }
+
+    bool empty() const {
+        return mappedNames.empty();
+    }
+
+    const MappedValue *find(const char *name, size_t len) const {
+        auto it = mappedNames.find(std::make_pair(name,len), MappedNameHash(), MappedNameEqual());
+        if(it == mappedNames.end())
+            return nullptr;
+        return &(*it);
+    }
+
+    /// Return the first mapped name of the given indexed element name
+    const MappedValue *findIndexed(const char *element) const {
+        int index;
+        auto slot = findTypeSlot(element, index);
+        if(!slot)
+            return nullptr;
+        auto head = slot->findHead((size_t)(index+1));
+        return head ? *head : nullptr;
+    }
+
+    /// Obtain the indexed name of an element, and register its type if not exist
+    IndexedName getIndexed(const char *element) {
+        IndexedName indexed;
+        auto slot = findTypeSlot(element, indexed.index);
+        if(!slot) {
+            typeSlots.emplace_back();
+            slot = &typeSlots.back();
+            slot->type = IndexedNameTable::instance().getType(
+                    element, IndexedName::split(element,indexed.index));
+        }
+        indexed.type = slot->type;
+        return indexed;
+    }
+
+    /** Insert a new mapped name
+     *
+     * @return Returns the entry of the given mapped name. If the name already
+     * exists, the existing entry is returned and \c inserted is set to false.
+     */
+    MappedValue &insert(const char *name, const IndexedName &indexed,
+            const std::vector<App::StringIDRef> &sids, bool &inserted)
+    {
+        std::size_t len = std::strlen(name);
+        auto it = mappedNames.find(std::make_pair(name,len), MappedNameHash(), MappedNameEqual());
+        inserted = it == mappedNames.end();
+        if(!inserted)
+            return *it;
+
+        sorted.clear();
+        auto &v = *mappedNames.emplace(MappedName(name,len), MappedEntry()).first;
+        v.second.indexed = indexed;
+        v.second.sids = sids;
+        auto &slot = *findSlot(indexed.type);
+        MappedValue **link = &slot.getHead((size_t)(indexed.index+1));
+        while(*link)
+            link = &(*link)->second.next;
+        *link = &v;
+        return v;
+    }
+
+    void erase(const MappedValue &v) {
+        const auto &indexed = v.second.indexed;
+        auto &slot = *findSlot(indexed.type);
+        MappedValue **link = slot.findHead((size_t)(indexed.index+1));
+        while(link && *link && *link != &v)
+            link = &(*link)->second.next;
+        if(link && *link)
+            *link = v.second.next;
+        sorted.clear();
+        mappedNames.erase(mappedNames.find(v.first));
+    }
+
+    void eraseIndexed(const char *element) {
+        int index;
+        auto slot = findTypeSlot(element, index);
+        if(!slot)
+            return;
+        MappedValue **head = slot->findHead((size_t)(index+1));
+        if(!head)
+            return;
+        MappedValue *v = *head;
+        *head = nullptr;
+        if(v)
+            sorted.clear();
+        while(v) {
+            MappedValue *next = v->second.next;
+            mappedNames.erase(mappedNames.find(v->first));
+            v = next;
+        }
+    }
+
+    /// Iterate all entries ordered by their indexed names
+    template<class F>
+    void forEachIndexed(F f) const {
+        std::vector<const TypeSlot*> slots;
+        slots.reserve(typeSlots.size());
+        for(auto &slot : typeSlots)
+            slots.push_back(&slot);
+        std::sort(slots.begin(), slots.end(), [](const TypeSlot *a, const TypeSlot *b) {
+            return a->type->name < b->type->name;
+        });
+        for(auto slot : slots) {
+            for(auto v : slot->heads) {
+                for(;v;v=v->second.next)
+                    f(*v);
+            }
+            // all sparse indices are beyond the dense array
+            for(auto &sparse : slot->sparseHeads) {
+                for(auto v=sparse.second;v;v=v->second.next)
+                    f(*v);
+            }
+        }
+    }
+
+    /// Return all entries ordered by their mapped names
+    const std::vector<const MappedValue*> &getSortedNames() const {
+        std::lock_guard<std::mutex> lock(sortedMutex);
+        if(sorted.size() != mappedNames.size()) {
+            sorted.clear();
+            sorted.reserve(mappedNames.size());
+            for(auto &v : mappedNames)
+                sorted.push_back(&v);
+            std::sort(sorted.begin(), sorted.end(), [](const MappedValue *a, const MappedValue *b) {
+                return a->first.compare(b->first) < 0;
+            });
+        }
+        return sorted;
+    }
+
+private:
+    struct TypeSlot {
+        const IndexedNameTable::Type *type;
+        /// first mapped name of each element, indexed by element index + 1
+        std::vector<MappedValue*> heads;
+        /// first mapped name of elements with index beyond the dense array
+        std::map<size_t, MappedValue*> sparseHeads;
+        /// number of names inserted, used to bound the dense array
+        size_t count = 0;
+
+        MappedValue **findHead(size_t idx) {
+            if(idx < heads.size())
+                return &heads[idx];
+            auto it = sparseHeads.find(idx);
+            if(it == sparseHeads.end())
+                return nullptr;
+            return &it->second;
+        }
+
+        MappedValue *const *findHead(size_t idx) const {
+            return const_cast<TypeSlot*>(this)->findHead(idx);
+        }
+
+        MappedValue *&getHead(size_t idx) {
+            ++count;
+            if(idx < heads.size())
+                return heads[idx];
+            if(idx > 2*count + 1024)
+                return sparseHeads[idx];
+
+            heads.resize(std::max(idx+1, heads.size()*3/2), nullptr);
+            // move the sparse entries now covered by the dense array
+            auto end = sparseHeads.lower_bound(heads.size());
+            for(auto it=sparseHeads.begin(); it!=end; ++it)
+                heads[it->first] = it->second;
+            sparseHeads.erase(sparseHeads.begin(), end);
+            return heads[idx];
+        }
+    };
+
+    TypeSlot *findSlot(const IndexedNameTable::Type *type) {
+        for(auto &slot : typeSlots) {
+            if(slot.type == type)
+                return &slot;
+        }
+        return nullptr;
+    }
+
+    TypeSlot *findTypeSlot(const char *element, int &index) const {
+        size_t len = IndexedName::split(element, index);
+        for(auto &slot : typeSlots) {
+            const auto &name = slot.type->name;
+            if(name.size()==len && std::strncmp(name.c_str(),element,len)==0)
+                return const_cast<TypeSlot*>(&slot);
+        }
+        return nullptr;
+    }
+
+private:
+    MappedMap mappedNames;
+    std::deque<TypeSlot> typeSlots;
+    mutable std::vector<const MappedValue*> sorted;
+    mutable std::mutex sortedMutex;
+};
+
+/** Return the text of a stored mapped name from setElementName()
+ *
+ * The full text of a prefix compressed name is copied into a thread local
+ * buffer instead of being built and kept with the name, because most callers
+ * ignore it.
+ */
+static const char *returnedName(const MappedName &name) {
+    if(auto text = name.data())
+        return text;
+    static thread_local std::string buffer;
+    buffer.clear();
+    name.appendTo(buffer);
+    return buffer.c_str();
+}
+
 }
 
 TYPESYSTEM_SOURCE_ABSTRACT(Data::Segment , Base::BaseClass)
@@ -269,11 +975,11 @@ const char *ComplexGeoData::getElementName(const char *name, int direction,
     }
 
     if(direction == MapToNamed) {
-        auto it = _ElementMap->right.find(name);
-        if(it == _ElementMap->right.end())
+        auto v = _ElementMap->findIndexed(name);
+        if(!v)
             return name;
-        if(sid) sid->insert(sid->end(),it->info.begin(),it->info.end());
-        return it->second.c_str();
+        if(sid) sid->insert(sid->end(),v->second.sids.begin(),v->second.sids.end());
+        return v->first.c_str();
     }
     const char *txt = isMappedElement(name);
     if(!txt) {
@@ -281,32 +987,27 @@ const char *ComplexGeoData::getElementName(const char *name, int direction,
             return name;
         txt = name;
     }
-    std::string _txt;
     // Strip out the trailing '.XXXX' if any
     const char *dot = strchr(txt,'.');
-    if(dot) {
-        _txt = std::string(txt,dot-txt);
-        txt = _txt.c_str();
-    }
-    auto it = _ElementMap->left.find(txt);
-    if(it == _ElementMap->left.end())
+    auto v = _ElementMap->find(txt, dot?dot-txt:std::strlen(txt));
+    if(!v)
         return name;
-    if(sid) sid->insert(sid->end(),it->info.begin(),it->info.end());
-    return it->second.c_str();
+    if(sid) sid->insert(sid->end(),v->second.sids.begin(),v->second.sids.end());
+    return v->second.indexed.c_str();
 }
 
 std::vector<std::pair<std::string, std::vector<App::StringIDRef> > >
 ComplexGeoData::getElementMappedNames(const char *element, bool needUnmapped) const {
     std::vector<std::pair<std::string, std::vector<App::StringIDRef> > > names;
     if(_ElementMap) {
-        auto ret = _ElementMap->right.equal_range(element);
-        size_t count=0;
-        for(auto it=ret.first;it!=ret.second;++it)
-            ++count;
-        if(count) {
+        auto first = _ElementMap->findIndexed(element);
+        if(first) {
+            size_t count=0;
+            for(auto v=first;v;v=v->second.next)
+                ++count;
             names.reserve(count);
-            for(auto it=ret.first;it!=ret.second;++it)
-                names.emplace_back(it->second,it->info);
+            for(auto v=first;v;v=v->second.next)
+                names.emplace_back(v->first.toString(),v->second.sids);
             return names;
         }
     }
@@ -323,9 +1024,16 @@ ComplexGeoData::getElementNamesWithPrefix(const char *prefix) const {
     const auto &p = elementMapPrefix();
     if(boost::starts_with(prefix,p))
         prefix += p.size();
-    for(auto it=_ElementMap->left.lower_bound(prefix);it!=_ElementMap->left.end();++it) {
-        if(boost::starts_with(it->first,prefix))
-            names.emplace_back(it->first,it->second);
+    const auto &sorted = _ElementMap->getSortedNames();
+    auto it = std::lower_bound(sorted.begin(), sorted.end(), prefix,
+        [](const ElementMap::MappedValue *v, const char *prefix) {
+            return v->first.compare(prefix) < 0;
+        });
+    for(;it!=sorted.end();++it) {
+        std::string name = (*it)->first.toString();
+        if(!boost::starts_with(name,prefix))
+            break;
+        names.emplace_back(std::move(name),(*it)->second.indexed.toString());
     }
     return names;
 }
@@ -333,8 +1041,8 @@ ComplexGeoData::getElementNamesWithPrefix(const char *prefix) const {
 std::map<std::string, std::string> ComplexGeoData::getElementMap() const {
     std::map<std::string, std::string> ret;
     if(!_ElementMap) return ret;
-    for(auto &v : _ElementMap->left)
-        ret.emplace_hint(ret.cend(),v.first,v.second);
+    for(auto v : _ElementMap->getSortedNames())
+        ret.emplace_hint(ret.cend(),v->first.toString(),v->second.indexed.toString());
     return ret;
 }
 
@@ -355,18 +1063,26 @@ void ComplexGeoData::copyElementMap(const ComplexGeoData &data, const char *post
     if(!Hasher)
         Hasher = data.Hasher;
 
-    for(const auto &v : data._ElementMap->left) {
-        auto name = v.first.c_str();
+    std::string buffer;
+    for(auto v : data._ElementMap->getSortedNames()) {
+        // Avoid building and keeping the full text in the source map
+        auto name = v->first.data();
+        if(!name) {
+            buffer.clear();
+            v->first.appendTo(buffer);
+            name = buffer.c_str();
+        }
+        auto element = v->second.indexed.c_str();
         if(Hasher==data.Hasher || !data.Hasher) {
-            setElementName(v.second.c_str(), name, postfix, &v.info);
+            setElementName(element, name, postfix, &v->second.sids);
             continue;
         }
         if(postfix)
-            setElementName(v.second.c_str(),name,postfix);
+            setElementName(element,name,postfix);
         else {
             // In case we have different hasher, but no additional postfix. 
             // Copy the element name as it is without hashing.
-            setElementName(v.second.c_str(),name,0,false,true);
+            setElementName(element,name,0,false,true);
         }
     }
 }
@@ -442,7 +1158,7 @@ const char *ComplexGeoData::setElementName(const char *element, const char *name
         throw Base::ValueError("Invalid input");
     if(!name || !name[0])  {
         if(_ElementMap)
-            _ElementMap->right.erase(element);
+            _ElementMap->eraseIndexed(element);
         return element;
     }
 
@@ -474,24 +1190,25 @@ const char *ComplexGeoData::setElementName(const char *element, const char *name
     }
     int retry=1;
     mapped = name;
-    std::ostringstream ss;
     std::string retry_name;
+    auto indexed = _ElementMap->getIndexed(element);
     while(1) {
-        auto ret = _ElementMap->left.insert(ElementMap::left_map::value_type(mapped,element,*sid));
-        if(ret.second || ret.first->second==element) {
+        bool inserted;
+        auto &v = _ElementMap->insert(mapped,indexed,*sid,inserted);
+        if(inserted || v.second.indexed==indexed) {
             FC_TRACE(element << " -> " << name);
-            return ret.first->first.c_str();
+            return returnedName(v.first);
         }
         if(overwrite) {
             overwrite = false;
-            _ElementMap->left.erase(ret.first);
+            _ElementMap->erase(v);
             continue;
         }
         if(sid!=&_sid)
             _sid.insert(_sid.end(),sid->begin(),sid->end());
-        retry_name = renameDuplicateElement(retry++,element,ret.first->second.c_str(),name,_sid);
+        retry_name = renameDuplicateElement(retry++,element,v.second.indexed.c_str(),name,_sid);
         if(retry_name.empty())
-            return ret.first->first.c_str();
+            return returnedName(v.first);
         mapped = retry_name.c_str();
         sid = &_sid;
     }
@@ -701,19 +1418,20 @@ void ComplexGeoData::Save(Base::Writer &writer) const {
             << "\"/>\n";
         return;
     }
-    writer.Stream() << " count=\"" << _ElementMap->left.size() << "\">\n";
+    writer.Stream() << " count=\"" << _ElementMap->size() << "\">\n";
     if(writer.getFileVersion() > 1) {
         saveStream(writer.beginCharStream(false) << '\n');
         writer.endCharStream() << '\n';
     } else {
-        for(auto &v : _ElementMap->left) {
+        for(auto v : _ElementMap->getSortedNames()) {
+            const auto &sids = v->second.sids;
             // We are omitting indentation here to save some space in case of long list of elements
-            writer.Stream() << "<Element key=\"" << encodeAttribute(v.first) 
-                            << "\" value=\"" << encodeAttribute(v.second);
-            if(v.info.size()) {
-                writer.Stream() << "\" sid=\"" << v.info.front()->value();
-                for(size_t i=1;i<v.info.size();++i)
-                    writer.Stream() << '.' << v.info[i]->value();
+            writer.Stream() << "<Element key=\"" << encodeAttribute(v->first.toString()) 
+                            << "\" value=\"" << encodeAttribute(v->second.indexed.toString());
+            if(sids.size()) {
+                writer.Stream() << "\" sid=\"" << sids.front()->value();
+                for(size_t i=1;i<sids.size();++i)
+                    writer.Stream() << '.' << sids[i]->value();
             }
             writer.Stream() << "\"/>\n";
         }
@@ -722,12 +1440,12 @@ void ComplexGeoData::Save(Base::Writer &writer) const {
 }
 
 void ComplexGeoData::saveStream(std::ostream &s)  const {
-    for(auto &v : _ElementMap->right) {
-        s << v.first << '\t' << v.second << ' ' << v.info.size();
-        for(auto &sid : v.info)
+    _ElementMap->forEachIndexed([&s](const ElementMap::MappedValue &v) {
+        s << v.second.indexed.toString() << '\t' << v.first << ' ' << v.second.sids.size();
+        for(auto &sid : v.second.sids)
             s << ' ' << sid->value();
         s << '\n';
-    }
+    });
 }
 
 void ComplexGeoData::Restore(Base::XMLReader &reader) {
@@ -820,7 +1538,7 @@ void ComplexGeoData::restoreStream(std::istream &s, std::size_t count) {
 }
 
 void ComplexGeoData::SaveDocFile(Base::Writer &writer) const {
-    writer.Stream() << _ElementMap->left.size() << '\n';
+    writer.Stream() << _ElementMap->size() << '\n';
     saveStream(writer.Stream());
 }
 
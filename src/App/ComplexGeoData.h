@@ -263,7 +263,9 @@ public:
      * @param overwrite: if true, it will overwrite existing names
      *
      * @return Returns the stored mapped element name. Note that if hasher is
-     * provided the stored name will be different from the input name.
+     * provided the stored name will be different from the input name. The
+     * returned pointer may only be valid until the next call of this function
+     * in the same thread.
      *
      * An element can have multiple mapped names. However, a name can only be
      * mapped to one element
@@ -315,6 +317,11 @@ public:
         return elementMap;
     }
 
+    /// Check if the element map is shared with another data
+    bool isSameElementMap(const ComplexGeoData &other) const {
+        return _ElementMap == other._ElementMap;
+    }
+
     /// Get the entire element map
     std::map<std::string, std::string> getElementMap() const;
 
@@ -170,6 +170,239 @@ typedef boost::bimap<StringHasherRef,int> HasherMap;
 
 static bool _IsRestoring;
 
+// Dependency graph of the objects of a document and of the external objects
+// they link to. Unlike _buildDependencyList(), which visits the out list of
+// every object on each call, the graph is kept between queries. Objects
+// whose out list changed since the last query are re-visited, and the
+// topological order is only recomputed if a changed link breaks it.
+class DependencyGraph
+{
+public:
+    DependencyGraph(const std::vector<DocumentObject*> &objectArray)
+        :objectArray(objectArray)
+    {
+        graphs().insert(this);
+    }
+
+    ~DependencyGraph() {
+        graphs().erase(this);
+    }
+
+    static std::unordered_set<DependencyGraph*> &graphs() {
+        // Intentionally leaked, because objects may still be destroyed
+        // during static destruction
+        static auto _graphs = new std::unordered_set<DependencyGraph*>;
+        return *_graphs;
+    }
+
+    void changed(const DocumentObject *obj, bool destroyed) {
+        if(!valid)
+            return;
+        auto it = index.find(obj);
+        if(it == index.end())
+            return;
+        int i = it->second;
+        if(destroyed) {
+            index.erase(it);
+            nodes[i].obj = 0;
+            nodes[i].outs.clear();
+            ++dead;
+            unsorted = true;
+        } else
+            queue(i);
+    }
+
+    // Returns false if the query cannot be answered from the graph, i.e. on
+    // dependency cycles when sorting is requested
+    bool getDependencyList(const std::vector<DocumentObject*> &objs,
+                           int options, std::vector<DocumentObject*> &res)
+    {
+        if(!valid || dead > std::max<std::size_t>(64, nodes.size()/2))
+            rebuild();
+
+        for(auto obj : objs) {
+            if(obj && obj->getNameInDocument() && !index.count(obj))
+                addNode(obj, ++maxPos);
+        }
+        update();
+
+        bool sort = !!(options & (Document::DepSort | Document::DepNoCycle));
+        if(sort && hasCycle)
+            return false;
+
+        // Same visiting order as _buildDependencyList()
+        bool noXLinked = !!(options & Document::DepNoXLinked);
+        std::vector<int> visited;
+        std::vector<int> pending;
+        if(++stamp == 0) {
+            for(auto &node : nodes)
+                node.stamp = 0;
+            stamp = 1;
+        }
+        for(auto obj : objs) {
+            auto it = index.find(obj);
+            if(it == index.end())
+                continue;
+            pending.assign(1, it->second);
+            for(std::size_t k=0; k<pending.size(); ++k) {
+                auto &node = nodes[pending[k]];
+                if(node.stamp == stamp || !node.obj || !node.obj->getNameInDocument())
+                    continue;
+                if(!node.expanded) {
+                    // should not happen, but play safe
+                    valid = false;
+                    return false;
+                }
+                node.stamp = stamp;
+                visited.push_back(pending[k]);
+                for(int j : node.outs) {
+                    auto &out = nodes[j];
+                    if(out.stamp == stamp || !out.obj)
+                        continue;
+                    if(noXLinked && out.obj->getDocument() != node.obj->getDocument())
+                        continue;
+                    pending.push_back(j);
+                }
+            }
+        }
+
+        if(sort) {
+            std::sort(visited.begin(), visited.end(), [this](int a, int b) {
+                return nodes[a].pos < nodes[b].pos;
+            });
+        }
+        res.reserve(res.size() + visited.size());
+        for(int i : visited)
+            res.push_back(nodes[i].obj);
+        return true;
+    }
+
+private:
+    int addNode(DocumentObject *obj, long pos) {
+        int i = (int)nodes.size();
+        nodes.emplace_back();
+        nodes[i].obj = obj;
+        nodes[i].pos = pos;
+        index[obj] = i;
+        queue(i);
+        return i;
+    }
+
+    void queue(int i) {
+        if(!nodes[i].queued) {
+            nodes[i].queued = true;
+            dirty.push_back(i);
+        }
+    }
+
+    void rebuild() {
+        index.clear();
+        nodes.clear();
+        dirty.clear();
+        dead = 0;
+        stamp = 0;
+        minPos = maxPos = 0;
+        valid = true;
+        unsorted = true;
+        for(auto obj : objectArray) {
+            if(obj && obj->getNameInDocument() && !index.count(obj))
+                addNode(obj, ++maxPos);
+        }
+    }
+
+    void update() {
+        while(dirty.size()) {
+            int i = dirty.back();
+            dirty.pop_back();
+            nodes[i].queued = false;
+            auto obj = nodes[i].obj;
+            if(!obj || !obj->getNameInDocument()) {
+                // will be queued again once attached
+                nodes[i].expanded = false;
+                continue;
+            }
+            // the node may be reallocated by addNode()
+            std::vector<int> outs;
+            for(auto o : obj->getOutList()) {
+                if(!o)
+                    continue;
+                auto it = index.find(o);
+                int j = it == index.end() ? addNode(o, --minPos) : it->second;
+                outs.push_back(j);
+                if(nodes[j].pos >= nodes[i].pos)
+                    unsorted = true;
+            }
+            // A removed link may have broken the cycle, so sort again to
+            // find out
+            if(hasCycle && nodes[i].outs != outs)
+                unsorted = true;
+            nodes[i].outs = std::move(outs);
+            nodes[i].expanded = true;
+        }
+        if(unsorted)
+            topologicalSort();
+    }
+
+    // Depth first post order so that dependencies come first. Detached
+    // objects are not traversed, same as in _buildDependencyList().
+    void topologicalSort() {
+        unsorted = false;
+        hasCycle = false;
+        std::vector<char> state(nodes.size(), 0);
+        std::vector<std::pair<int, std::size_t> > stack;
+        long pos = 0;
+        for(int root=0; root<(int)nodes.size(); ++root) {
+            if(state[root] || !nodes[root].obj)
+                continue;
+            state[root] = 1;
+            stack.emplace_back(root, 0);
+            while(stack.size()) {
+                auto &top = stack.back();
+                auto &node = nodes[top.first];
+                if(node.obj->getNameInDocument() && top.second < node.outs.size()) {
+                    int j = node.outs[top.second++];
+                    if(!nodes[j].obj)
+                        continue;
+                    if(state[j] == 1)
+                        hasCycle = true;
+                    else if(!state[j]) {
+                        state[j] = 1;
+                        stack.emplace_back(j, 0);
+                    }
+                    continue;
+                }
+                state[top.first] = 2;
+                node.pos = pos++;
+                stack.pop_back();
+            }
+        }
+        minPos = 0;
+        maxPos = pos;
+    }
+
+private:
+    struct Node {
+        DocumentObject *obj = 0;
+        std::vector<int> outs;
+        long pos = 0;
+        unsigned stamp = 0;
+        bool expanded = false;
+        bool queued = false;
+    };
+
+    const std::vector<DocumentObject*> &objectArray;
+    std::unordered_map<const DocumentObject*, int> index;
+    std::vector<Node> nodes;
+    std::vector<int> dirty;
+    std::size_t dead = 0;
+    unsigned stamp = 0;
+    long minPos = 0;
+    long maxPos = 0;
+    bool valid = false;
+    bool unsorted = false;
+    bool hasCycle = false;
+};
+
 // Pimpl class
 struct DocumentP
 {
@@ -202,11 +435,14 @@ struct DocumentP
 #endif //USE_OLD_DAG
     std::multimap<const App::DocumentObject*,
         std::unique_ptr<App::DocumentObjectExecReturn> > _RecomputeLog;
+    DependencyGraph depGraph;
 
     // restored files
     std::set<std::string> files;
 
-    DocumentP() {
+    DocumentP()
+        :depGraph(objectArray)
+    {
         static std::random_device _RD;
         static std::mt19937 _RGEN(_RD());
         static std::uniform_int_distribution<> _RDIST(0,5000);
@@ -3394,10 +3630,33 @@ static void _buildDependencyList(const std::vector<App::DocumentObject*> &object
     }
 }
 
+void Document::_dependencyChanged(const DocumentObject *obj, bool destroyed)
+{
+    for(auto graph : DependencyGraph::graphs())
+        graph->changed(obj, destroyed);
+}
+
 std::vector<App::DocumentObject*> Document::getDependencyList(
     const std::vector<App::DocumentObject*>& objectArray, int options)
 {
     std::vector<App::DocumentObject*> ret;
+
+    // Use the cached graph of the document if all objects belong to it
+    Document *doc = 0;
+    for(auto obj : objectArray) {
+        if(!obj)
+            continue;
+        if(!doc)
+            doc = obj->getDocument();
+        if(!doc || obj->getDocument() != doc) {
+            doc = 0;
+            break;
+        }
+    }
+    if(doc && doc->d->depGraph.getDependencyList(objectArray,options,ret))
+        return ret;
+    ret.clear();
+
     if(!(options & (DepSort | DepNoCycle))) {
         _buildDependencyList(objectArray,options,&ret,0,0);
         return ret;
@@ -4194,6 +4453,7 @@ DocumentObject * Document::addObject(const char* sType, const char* pObjectName,
     d->objectIdMap[pcObject->_Id] = pcObject;
     // cache the pointer to the name string in the Object (for performance of DocumentObject::getNameInDocument())
     pcObject->pcNameInDocument = &(d->objectMap.find(ObjectName)->first);
+    _dependencyChanged(pcObject);
     // insert in the vector
     d->objectArray.push_back(pcObject);
     // insert in the adjacence list and reference through the ConectionMap
@@ -4296,6 +4556,7 @@ std::vector<DocumentObject *> Document::addObjects(const char* sType, const std:
         d->objectIdMap[pcObject->_Id] = pcObject;
         // cache the pointer to the name string in the Object (for performance of DocumentObject::getNameInDocument())
         pcObject->pcNameInDocument = &(d->objectMap.find(ObjectName)->first);
+        _dependencyChanged(pcObject);
         // insert in the vector
         d->objectArray.push_back(pcObject);
 
@@ -4361,6 +4622,7 @@ void Document::addObject(DocumentObject* pcObject, const char* pObjectName, bool
     d->objectIdMap[pcObject->_Id] = pcObject;
     // cache the pointer to the name string in the Object (for performance of DocumentObject::getNameInDocument())
     pcObject->pcNameInDocument = &(d->objectMap.find(ObjectName)->first);
+    _dependencyChanged(pcObject);
     // insert in the vector
     d->objectArray.push_back(pcObject);
 
@@ -4392,6 +4654,7 @@ void Document::_addObject(DocumentObject* pcObject, const char* pObjectName)
     d->objectArray.push_back(pcObject);
     // cache the pointer to the name string in the Object (for performance of DocumentObject::getNameInDocument())
     pcObject->pcNameInDocument = &(d->objectMap.find(ObjectName)->first);
+    _dependencyChanged(pcObject);
 
     // do no transactions if we do a rollback!
     if (!d->rollback) {
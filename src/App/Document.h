@@ -606,6 +606,10 @@ protected:
     /// refresh the internal dependency graph
     void _rebuildDependencyList(
         const std::vector<App::DocumentObject*> &objs = std::vector<App::DocumentObject*>());
+    /** Notify the cached dependency graphs of all documents that the out
+     * list of \a obj may have changed, or that it is being destroyed
+     */
+    static void _dependencyChanged(const DocumentObject *obj, bool destroyed=false);
 
     std::string getTransientDirectoryName(const std::string& uuid, const std::string& filename) const;
 
@@ -100,6 +100,7 @@ DocumentObject::~DocumentObject(void)
         // Call before decrementing the reference counter, otherwise a heap error can occur
         obj->setInvalid();
     }
+    Document::_dependencyChanged(this, true);
 }
 
 App::DocumentObjectExecReturn *DocumentObject::recompute(void)
@@ -814,6 +815,7 @@ void DocumentObject::clearOutListCache() const {
     _outList.clear();
     _outListMap.clear();
     _outListCached = false;
+    Document::_dependencyChanged(this);
 }
 
 PyObject *DocumentObject::getPyObject(void)
@@ -76,6 +76,8 @@ public:
     FC_DOCUMENT_PARAM(OptimizeRecompute, bool, Bool, true) \
     FC_DOCUMENT_PARAM(CanAbortRecompute, bool, Bool, true) \
     FC_DOCUMENT_PARAM(UseHasher, bool, Bool, true) \
+    FC_DOCUMENT_PARAM(StringHasherBinary, bool, Bool, false) \
+    FC_DOCUMENT_PARAM(StringHasherCompression, int, Int, 0) \
     FC_DOCUMENT_PARAM(ViewObjectTransaction, bool, Bool, false) \
     FC_DOCUMENT_PARAM(WarnRecomputeOnRestore, bool, Bool, true) \
     FC_DOCUMENT_PARAM(NoPartialLoading, bool, Bool, false) \
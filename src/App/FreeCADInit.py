@@ -82,6 +82,55 @@ def setupSearchPaths(PathExtension):
 FreeCAD._importFromFreeCAD = removeFromPath
 
 
+def RunInitFile(Dir):
+	"""Run the Init.py of a module directory and record its start-up time"""
+	import time
+	InstallFile = os.path.join(Dir,"Init.py")
+	if (os.path.exists(InstallFile)):
+		start = time.time()
+		try:
+			# XXX: This looks scary securitywise...
+			if sys.version_info.major < 3:
+				with open(InstallFile) as f:
+					exec(f.read())
+			else:
+				with open(file=InstallFile, encoding="utf-8") as f:
+					exec(f.read())
+		except Exception as inst:
+			Log('Init:      Initializing ' + Dir + '... failed\n')
+			Log('-'*100+'\n')
+			Log(traceback.format_exc())
+			Log('-'*100+'\n')
+			Err('During initialization the error "' + str(inst) + '" occurred in ' + InstallFile + '\n')
+			Err('Please look into the log file for further information\n')
+		else:
+			Log('Init:      Initializing ' + Dir + '... done\n')
+		FreeCAD.addStartupTime('Init.py ' + Dir, time.time() - start)
+	else:
+		Log('Init:      Initializing ' + Dir + '(Init.py not found)... ignore\n')
+
+# module directories whose Init.py is run on first import in lazy init mode
+DeferredInitDirs = {}
+
+class DeferredInitFinder(object):
+	"""Import hook that runs the deferred Init.py of a module before the module
+	itself (or its C++ library, e.g. when a document needs one of its types) is
+	imported. It never loads anything itself."""
+	def find_module(self, fullname, path=None):
+		if path is None and DeferredInitDirs:
+			Dir = DeferredInitDirs.pop(fullname.lstrip('_').lower(), None)
+			if Dir:
+				RunInitFile(Dir)
+		return None
+
+	def find_spec(self, fullname, path, target=None):
+		return self.find_module(fullname, path)
+
+def LoadDeferredModules():
+	"""Run the Init.py of all modules that were deferred in lazy init mode"""
+	while DeferredInitDirs:
+		RunInitFile(DeferredInitDirs.popitem()[1])
+
 def InitApplications():
 	# Checking on FreeCAD module path ++++++++++++++++++++++++++++++++++++++++++
 	ModDir = FreeCAD.getHomePath()+'Mod'
@@ -164,31 +213,20 @@ def InitApplications():
 	# proper python modules this can eventuelly be removed.
 	sys.path = [ModDir] + libpaths + [ExtDir] + sys.path
 
+	# In lazy init mode the Init.py of a module is only run once the module is
+	# imported or FreeCAD.loadDeferredModules() is called.
+	LazyInit = FreeCAD.ConfigGet("LazyInit") == "1"
 	for Dir in ModDict.values():
 		if ((Dir != '') & (Dir != 'CVS') & (Dir != '__init__.py')):
 			sys.path.insert(0,Dir)
 			PathExtension.append(Dir)
-			InstallFile = os.path.join(Dir,"Init.py")
-			if (os.path.exists(InstallFile)):
-				try:
-					# XXX: This looks scary securitywise...
-					if sys.version_info.major < 3:
-						with open(InstallFile) as f:
-							exec(f.read())
-					else:
-						with open(file=InstallFile, encoding="utf-8") as f:
-							exec(f.read())
-				except Exception as inst:
-					Log('Init:      Initializing ' + Dir + '... failed\n')
-					Log('-'*100+'\n')
-					Log(traceback.format_exc())
-					Log('-'*100+'\n')
-					Err('During initialization the error "' + str(inst) + '" occurred in ' + InstallFile + '\n')
-					Err('Please look into the log file for further information\n')
-				else:
-					Log('Init:      Initializing ' + Dir + '... done\n')
+			if LazyInit and os.path.exists(os.path.join(Dir,"Init.py")):
+				Log('Init:      Deferring ' + Dir + '\n')
+				DeferredInitDirs[os.path.basename(os.path.normpath(Dir)).lower()] = Dir
 			else:
-				Log('Init:      Initializing ' + Dir + '(Init.py not found)... ignore\n')
+				RunInitFile(Dir)
+	if DeferredInitDirs:
+		sys.meta_path.insert(0, DeferredInitFinder())
 
 	extension_modules = []
 
@@ -632,6 +670,7 @@ class FCADLogger(object):
                         FreeCADGui.getMainWindow(),self.title,str(e))
 
 FreeCAD.Logger = FCADLogger
+FreeCAD.loadDeferredModules = LoadDeferredModules
 
 # init every application by importing Init.py
 try:
@@ -24,12 +24,14 @@
 #include "PreCompiled.h"
 
 #ifndef _PreComp_
+# include <algorithm>
+# include <cstring>
 #endif
 
+#include <array>
+#include <atomic>
+#include <mutex>
 #include <boost/algorithm/string/predicate.hpp>
-#include <boost/bimap.hpp>
-#include <boost/bimap/unordered_set_of.hpp>
-#include <boost/bimap/set_of.hpp>
 #include <QHash>
 #include <QCryptographicHash>
 #include <Base/Console.h>
@@ -37,6 +39,7 @@
 #include <Base/Writer.h>
 #include <Base/Reader.h>
 #include <App/StringHasher.h>
+#include <App/DocumentParams.h>
 #include <App/StringHasherPy.h>
 #include <App/StringIDPy.h>
 
@@ -85,26 +88,445 @@ std::string StringID::dataToText() const {
 }
 
 ///////////////////////////////////////////////////////////
-//
-namespace boost {
-template<>
-struct hash<QByteArray> {
-    size_t operator()(const QByteArray &data) const {
+
+namespace {
+
+/** 128 bit fingerprint of a string
+ *
+ * The fingerprint is used as an in-memory index of the strings that are
+ * stored as SHA1 hash, so that repeated lookup of the same long string does
+ * not need to compute the (much slower) cryptographic hash. The fingerprint
+ * is never saved.
+ */
+struct Fingerprint {
+    uint64_t h1 = 0;
+    uint64_t h2 = 0;
+
+    bool operator==(const Fingerprint &other) const {
+        return h1 == other.h1 && h2 == other.h2;
+    }
+};
+
+struct FingerprintHasher {
+    std::size_t operator()(const Fingerprint &fp) const {
+        return (std::size_t)fp.h1;
+    }
+};
+
+struct ByteArrayHasher {
+    std::size_t operator()(const QByteArray &data) const {
         return qHash(data);
     }
 };
+
+inline uint64_t rotl64(uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+inline uint64_t fmix64(uint64_t k) {
+    k ^= k >> 33;
+    k *= 0xff51afd7ed558ccdULL;
+    k ^= k >> 33;
+    k *= 0xc4ceb9fe1a85ec53ULL;
+    k ^= k >> 33;
+    return k;
+}
+
+// MurmurHash3 x64 128 bit variant, written by Austin Appleby and placed in
+// the public domain.
+Fingerprint fingerprint(const char *data, int len) {
+    const uint64_t c1 = 0x87c37b91114253d5ULL;
+    const uint64_t c2 = 0x4cf5ad432745937fULL;
+    const int nblocks = len / 16;
+    uint64_t h1 = 0;
+    uint64_t h2 = 0;
+
+    for(int i=0; i<nblocks; ++i) {
+        uint64_t k1, k2;
+        std::memcpy(&k1, data + i*16, 8);
+        std::memcpy(&k2, data + i*16 + 8, 8);
+
+        k1 *= c1; k1 = rotl64(k1,31); k1 *= c2; h1 ^= k1;
+        h1 = rotl64(h1,27); h1 += h2; h1 = h1*5+0x52dce729;
+        k2 *= c2; k2 = rotl64(k2,33); k2 *= c1; h2 ^= k2;
+        h2 = rotl64(h2,31); h2 += h1; h2 = h2*5+0x38495ab5;
+    }
+
+    const unsigned char *tail = (const unsigned char*)(data + nblocks*16);
+    uint64_t k1 = 0;
+    uint64_t k2 = 0;
+    switch(len & 15) {
+    case 15: k2 ^= ((uint64_t)tail[14]) << 48; // fall through
+    case 14: k2 ^= ((uint64_t)tail[13]) << 40; // fall through
+    case 13: k2 ^= ((uint64_t)tail[12]) << 32; // fall through
+    case 12: k2 ^= ((uint64_t)tail[11]) << 24; // fall through
+    case 11: k2 ^= ((uint64_t)tail[10]) << 16; // fall through
+    case 10: k2 ^= ((uint64_t)tail[ 9]) << 8;  // fall through
+    case  9: k2 ^= ((uint64_t)tail[ 8]) << 0;
+             k2 *= c2; k2 = rotl64(k2,33); k2 *= c1; h2 ^= k2;
+             // fall through
+    case  8: k1 ^= ((uint64_t)tail[ 7]) << 56; // fall through
+    case  7: k1 ^= ((uint64_t)tail[ 6]) << 48; // fall through
+    case  6: k1 ^= ((uint64_t)tail[ 5]) << 40; // fall through
+    case  5: k1 ^= ((uint64_t)tail[ 4]) << 32; // fall through
+    case  4: k1 ^= ((uint64_t)tail[ 3]) << 24; // fall through
+    case  3: k1 ^= ((uint64_t)tail[ 2]) << 16; // fall through
+    case  2: k1 ^= ((uint64_t)tail[ 1]) << 8;  // fall through
+    case  1: k1 ^= ((uint64_t)tail[ 0]) << 0;
+             k1 *= c1; k1 = rotl64(k1,31); k1 *= c2; h1 ^= k1;
+    }
+
+    h1 ^= (uint64_t)len; h2 ^= (uint64_t)len;
+    h1 += h2; h2 += h1;
+    h1 = fmix64(h1); h2 = fmix64(h2);
+    h1 += h2; h2 += h1;
+
+    Fingerprint fp;
+    fp.h1 = h1;
+    fp.h2 = h2;
+    return fp;
 }
 
-typedef boost::bimap<
-    boost::bimaps::unordered_set_of<QByteArray>,
-    boost::bimaps::set_of<long>, 
-    boost::bimaps::with_info<StringIDRef> > HashMapBase;
+/** Append only table of StringID indexed by its integer ID
+ *
+ * The table is stored in fixed size chunks, so that existing entries are
+ * never moved. Lookup is lock free. Insertion is serialized by a mutex, and
+ * the chunk directory is replaced (not reallocated in place) when it grows.
+ * The retired directories are kept till clear() to let any concurrent reader
+ * finish.
+ */
+class IDTable {
+public:
+    /** Largest accepted ID
+     *
+     * IDs are assigned in ascending order, so a valid table is far below this
+     * limit. The chunk directory is indexed by the ID, so the limit also caps
+     * its size in case of a corrupted file.
+     */
+    static const long MaxID = 0x7fffffff;
+
+    ~IDTable() {
+        clear();
+    }
+
+    /// Check an ID read from a file, throw Base::BadFormatError if invalid
+    static void checkID(long id) {
+        if(id <= 0 || id > MaxID)
+            FC_THROWM(Base::BadFormatError, "Invalid string id " << id);
+    }
+
+    StringID *get(long id) const {
+        if(id <= 0)
+            return nullptr;
+        std::size_t index = (std::size_t)id;
+        auto dir = directory.load(std::memory_order_acquire);
+        if(!dir || (index >> ChunkBits) >= dir->size)
+            return nullptr;
+        auto chunk = dir->chunks[index >> ChunkBits].load(std::memory_order_acquire);
+        if(!chunk)
+            return nullptr;
+        return chunk->items[index & ChunkMask].load(std::memory_order_acquire);
+    }
 
-class StringHasher::HashMap: public HashMapBase 
+    /// Insert a new entry, return false if the ID is already taken
+    bool insert(StringID *sid) {
+        std::size_t index = (std::size_t)sid->value();
+        std::lock_guard<std::mutex> lock(mutex);
+        auto &item = getChunk(index >> ChunkBits)->items[index & ChunkMask];
+        if(item.load(std::memory_order_relaxed))
+            return false;
+        sid->ref();
+        item.store(sid, std::memory_order_release);
+        ++count;
+        return true;
+    }
+
+    /// Iterate all entries in ascending order of their ID
+    template<class F>
+    void forEach(F f) const {
+        std::lock_guard<std::mutex> lock(mutex);
+        for(auto &chunk : chunks) {
+            for(auto &item : chunk->items) {
+                auto sid = item.load(std::memory_order_relaxed);
+                if(sid)
+                    f(sid);
+            }
+        }
+    }
+
+    std::size_t size() const {
+        return count;
+    }
+
+    /// Clear the table. Must not be called concurrently with any other access
+    void clear() {
+        std::lock_guard<std::mutex> lock(mutex);
+        for(auto &chunk : chunks) {
+            for(auto &item : chunk->items) {
+                auto sid = item.load(std::memory_order_relaxed);
+                if(sid)
+                    sid->unref();
+            }
+        }
+        chunks.clear();
+        directories.clear();
+        directory.store(nullptr, std::memory_order_release);
+        count = 0;
+    }
+
+private:
+    enum {
+        ChunkBits = 10,
+        ChunkSize = 1 << ChunkBits,
+        ChunkMask = ChunkSize - 1,
+    };
+
+    struct Chunk {
+        Chunk() {
+            for(auto &item : items)
+                item.store(nullptr, std::memory_order_relaxed);
+        }
+        std::array<std::atomic<StringID*>, ChunkSize> items;
+    };
+
+    struct Directory {
+        Directory(std::size_t size)
+            :size(size), chunks(new std::atomic<Chunk*>[size])
+        {
+            for(std::size_t i=0; i<size; ++i)
+                chunks[i].store(nullptr, std::memory_order_relaxed);
+        }
+        std::size_t size;
+        std::unique_ptr<std::atomic<Chunk*>[]> chunks;
+    };
+
+    Chunk *getChunk(std::size_t index) {
+        auto dir = directory.load(std::memory_order_relaxed);
+        if(!dir || index >= dir->size) {
+            std::size_t size = dir ? dir->size : 16;
+            while(size <= index)
+                size *= 2;
+            directories.emplace_back(new Directory(size));
+            auto newDir = directories.back().get();
+            if(dir) {
+                for(std::size_t i=0; i<dir->size; ++i)
+                    newDir->chunks[i].store(dir->chunks[i].load(std::memory_order_relaxed),
+                                            std::memory_order_relaxed);
+            }
+            directory.store(newDir, std::memory_order_release);
+            dir = newDir;
+        }
+        auto chunk = dir->chunks[index].load(std::memory_order_relaxed);
+        if(!chunk) {
+            // Chunks are kept in ascending order of their index for iteration
+            std::unique_ptr<Chunk> newChunk(new Chunk);
+            chunk = newChunk.get();
+            auto it = std::upper_bound(chunkIndices.begin(), chunkIndices.end(), index);
+            chunks.insert(chunks.begin() + (it - chunkIndices.begin()), std::move(newChunk));
+            chunkIndices.insert(it, index);
+            dir->chunks[index].store(chunk, std::memory_order_release);
+        }
+        return chunk;
+    }
+
+private:
+    std::atomic<Directory*> directory {nullptr};
+    std::vector<std::unique_ptr<Directory> > directories;
+    std::vector<std::unique_ptr<Chunk> > chunks;
+    std::vector<std::size_t> chunkIndices;
+    std::atomic<std::size_t> count {0};
+    mutable std::mutex mutex;
+};
+
+/// Header of the binary string table
+const char BinaryMagic[4] = {'F','C','S','H'};
+const uint8_t BinaryVersion = 1;
+const uint8_t BinaryCompressed = 1;
+
+void writeVarInt(QByteArray &buffer, uint64_t value) {
+    do {
+        uint8_t byte = value & 0x7f;
+        value >>= 7;
+        if(value)
+            byte |= 0x80;
+        buffer.append((char)byte);
+    } while(value);
+}
+
+bool readVarInt(const char *&p, const char *end, uint64_t &value) {
+    value = 0;
+    for(int shift=0; p<end && shift<64; shift+=7) {
+        uint8_t byte = (uint8_t)*p++;
+        value |= (uint64_t)(byte & 0x7f) << shift;
+        if(!(byte & 0x80))
+            return true;
+    }
+    return false;
+}
+
+} // anonymous namespace
+
+/** Concurrent string table
+ *
+ * The strings are stored in a number of shards selected by the string hash,
+ * each guarded by its own mutex, so that threads looking up different
+ * strings rarely contend with each other. The reverse lookup by ID is lock
+ * free.
+ *
+ * When restored from the binary format, the StringID objects are not created
+ * up front. The shards index the entries directly inside the restored buffer,
+ * and the StringID is only created on first access.
+ */
+class StringHasher::HashMap
 {
 public:
+    enum {
+        ShardCount = 32,
+    };
+
+    struct Shard {
+        std::mutex mutex;
+        /// stored data (SHA1 hash for hashed strings) to string ID
+        std::unordered_map<QByteArray, long, ByteArrayHasher> data;
+        /// fingerprint of the original data of the hashed strings
+        std::unordered_map<Fingerprint, long, FingerprintHasher> fingerprints;
+    };
+
+    /// Restored entry that has not been materialized yet
+    struct PendingEntry {
+        long id;
+        uint32_t offset;
+        uint32_t size;
+        uint8_t flags;
+
+        bool operator<(long other) const {
+            return id < other;
+        }
+    };
+
+    Shard &getShard(std::size_t hash) {
+        return shards[(hash ^ (hash >> 16)) % ShardCount];
+    }
+
+    void updateLastID(long value) {
+        long id = lastID;
+        while(id < value && !lastID.compare_exchange_weak(id, value));
+    }
+
+    /// Insert a restored entry
+    void insert(StringID *sid) {
+        IDTable::checkID(sid->value());
+        if(!ids.insert(sid)) {
+            FC_WARN("duplicate string id " << sid->value());
+            return;
+        }
+        auto &shard = getShard(qHash(sid->data()));
+        shard.data.emplace(sid->data(), sid->value());
+        updateLastID(sid->value());
+    }
+
+    /// Insert a restored entry that is not materialized
+    void insertPending(long id, uint32_t offset, uint32_t size, uint8_t flags) {
+        IDTable::checkID(id);
+        PendingEntry entry;
+        entry.id = id;
+        entry.offset = offset;
+        entry.size = size;
+        entry.flags = flags;
+        pending.push_back(entry);
+        ++pendingCount;
+        auto data = QByteArray::fromRawData(buffer.constData()+offset, size);
+        getShard(qHash(data)).data.emplace(data, id);
+        updateLastID(id);
+    }
+
+    StringID *get(long id) {
+        auto sid = ids.get(id);
+        if(sid || !pendingCount)
+            return sid;
+        return materialize(id);
+    }
+
+    StringID *materialize(long id) {
+        std::lock_guard<std::mutex> lock(pendingMutex);
+        auto sid = ids.get(id);
+        if(sid)
+            return sid;
+        auto it = std::lower_bound(pending.begin(), pending.end(), id);
+        if(it == pending.end() || it->id != id)
+            return nullptr;
+        return materialize(*it);
+    }
+
+    /// Materialize all pending entries, e.g. before iterating the whole table
+    void materializeAll() {
+        if(!pendingCount)
+            return;
+        std::lock_guard<std::mutex> lock(pendingMutex);
+        // materialize() releases the pending entries after the last one
+        for(std::size_t i=0; pendingCount && i<pending.size(); ++i) {
+            if(!ids.get(pending[i].id))
+                materialize(pending[i]);
+        }
+    }
+
+    std::size_t size() const {
+        return ids.size() + pendingCount;
+    }
+
+    void clear() {
+        std::lock_guard<std::mutex> lock(pendingMutex);
+        for(auto &shard : shards) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            shard.data.clear();
+            shard.fingerprints.clear();
+        }
+        ids.clear();
+        lastID = 0;
+        releasePending();
+    }
+
+private:
+    /// Must be called with pendingMutex locked
+    StringID *materialize(const PendingEntry &entry) {
+        StringIDRef sid(new StringID(entry.id,
+                    QByteArray(buffer.constData()+entry.offset, entry.size), entry.flags));
+        ids.insert(sid);
+
+        // The shard key is still referring to the restored buffer. Replace it
+        // with the data of the StringID so that the buffer can be released
+        // once all entries are materialized.
+        auto &shard = getShard(qHash(sid->data()));
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            shard.data.erase(sid->data());
+            shard.data.emplace(sid->data(), entry.id);
+        }
+        if(--pendingCount == 0)
+            releasePending();
+        return sid;
+    }
+
+    void releasePending() {
+        pendingCount = 0;
+        pending.clear();
+        pending.shrink_to_fit();
+        buffer.clear();
+    }
+
+public:
+    std::array<Shard, ShardCount> shards;
+    IDTable ids;
+    std::atomic<long> lastID {0};
     bool SaveAll = false;
     int Threshold = 0;
+
+    /// Buffer holding the restored binary table
+    QByteArray buffer;
+    /// Restored entries that are not materialized yet, sorted by ID
+    std::vector<PendingEntry> pending;
+    std::atomic<std::size_t> pendingCount {0};
+    std::mutex pendingMutex;
 };
 
 ///////////////////////////////////////////////////////////
@@ -135,11 +557,7 @@ int StringHasher::getThreshold() const {
 }
 
 long StringHasher::lastID() const {
-    if(_hashes->right.empty())
-        return 0;
-    auto it = _hashes->right.end();
-    --it;
-    return it->first;
+    return _hashes->lastID;
 }
 
 StringIDRef StringHasher::getID(const char *text, int len, bool hashable) {
@@ -148,43 +566,73 @@ StringIDRef StringHasher::getID(const char *text, int len, bool hashable) {
 }
 
 StringIDRef StringHasher::getID(QByteArray data, bool binary, bool hashable) {
-    QByteArray hash;
-
     bool hashed = hashable && _hashes->Threshold>0 
                            && (int)data.size()>_hashes->Threshold;
 
+    Fingerprint fp;
+    if(hashed) {
+        // Try the fast in-memory index first to avoid SHA1 hashing
+        fp = fingerprint(data.constData(),data.size());
+        auto &shard = _hashes->getShard((std::size_t)fp.h2);
+        long id = 0;
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            auto it = shard.fingerprints.find(fp);
+            if(it != shard.fingerprints.end())
+                id = it->second;
+        }
+        if(id) {
+            StringIDRef sid(_hashes->get(id));
+            if(sid)
+                return sid;
+        }
+    }
+
+    QByteArray key;
     if(hashed) {
         QCryptographicHash hasher(QCryptographicHash::Sha1);
         hasher.addData(data);
-        hash = hasher.result();
+        key = hasher.result();
     }else
-        hash = data;
-
-    auto it = _hashes->left.find(hash);
-    if(it!=_hashes->left.end())
-        return it->info;
+        key = data;
 
     StringIDRef sid;
+    long id = 0;
+    {
+        auto &shard = _hashes->getShard(qHash(key));
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.data.find(key);
+        if(it != shard.data.end())
+            id = it->second;
+        else {
+            // if hashed, the original data is discarded. If not hashed, make
+            // a deep copy of the data
+            if(!hashed)
+                key = QByteArray(data.constData(),data.size());
+            sid = new StringID(++_hashes->lastID,key,binary,hashed);
+            id = sid->value();
+            _hashes->ids.insert(sid);
+            shard.data.emplace(key,id);
+        }
+    }
+
+    // Must not hold the shard lock here, because the entry may need to be
+    // materialized, which modifies the shard.
+    if(!sid)
+        sid = _hashes->get(id);
+
     if(hashed) {
-        // if hashed, discard the original data
-        data = hash;
-    }else{
-        // if not hashed, make a deep copy of the data
-        data = QByteArray(data.constData(),data.size());
-        hash = data;
-    }
-    sid = new StringID(lastID()+1,data,binary,hashed);
-    _hashes->right.insert(_hashes->right.end(),HashMap::right_map::value_type(sid->value(),hash,sid));
+        auto &shard = _hashes->getShard((std::size_t)fp.h2);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.fingerprints.emplace(fp,id);
+    }
     return sid;
 }
 
 StringIDRef StringHasher::getID(long id) const {
     if(id<=0)
         return _StringIDNull;
-    auto it = _hashes->right.find(id);
-    if(it == _hashes->right.end())
-        return StringIDRef();
-    return it->info;
+    return _hashes->get(id);
 }
 
 void StringHasher::setPersistenceFileName(const char *filename) const {
@@ -197,7 +645,15 @@ const std::string &StringHasher::getPersistenceFileName() const {
     return _filename;
 }
 
+static bool useBinaryFormat(const Base::Writer &writer) {
+    return writer.getFileVersion() > 1 && DocumentParams::StringHasherBinary();
+}
+
 void StringHasher::Save(Base::Writer &writer) const {
+    // The writers below only iterate materialized entries, so the saved count
+    // must not include pending ones
+    if(_hashes->SaveAll)
+        _hashes->materializeAll();
     size_t count = _hashes->SaveAll?this->size():this->count();
     writer.Stream() << writer.ind() << "<StringHasher saveall=\"" 
         << _hashes->SaveAll << "\" threshold=\"" << _hashes->Threshold;
@@ -209,61 +665,168 @@ void StringHasher::Save(Base::Writer &writer) const {
 
     if(_filename.size()) {
         writer.Stream() << "\" file=\"" 
-            << writer.addFile(_filename+".txt",this)
+            << writer.addFile(_filename+(useBinaryFormat(writer)?".bin":".txt"),this)
             << "\"/>\n";
         return;
     }
 
+    if(useBinaryFormat(writer)) {
+        writer.Stream() << "\" count=\"" << count << "\" binary=\"1\">\n";
+        this->saveBinary(writer.beginCharStream(true));
+        writer.endCharStream() << '\n';
+        writer.Stream() << writer.ind() << "</StringHasher>\n";
+        return;
+    }
+
     writer.Stream() << "\" count=\"" << count << "\">\n";
     if(writer.getFileVersion() > 1) {
         saveStream(writer.beginCharStream(false) << '\n');
         writer.endCharStream() << '\n';
     } else {
-        for(auto &v : _hashes->right) {
-            if(_hashes->SaveAll || v.info.getRefCount()>1) {
+        _hashes->ids.forEach([&](const StringID *sid) {
+            if(_hashes->SaveAll || sid->getRefCount()>1) {
                 // We are omitting the indentation to save some space in case of long list of hashes
-                if(v.info->isHashed()) 
-                    writer.Stream() <<"<Item hash=\""<< v.second.toBase64().constData();
-                else if(v.info->isBinary())
-                    writer.Stream() <<"<Item data=\""<< v.second.toBase64().constData();
+                if(sid->isHashed()) 
+                    writer.Stream() <<"<Item hash=\""<< sid->data().toBase64().constData();
+                else if(sid->isBinary())
+                    writer.Stream() <<"<Item data=\""<< sid->data().toBase64().constData();
                 else
-                    writer.Stream() <<"<Item text=\""<< encodeAttribute(v.second.constData());
-                writer.Stream() << "\" id=\""<<v.first<<"\"/>\n";
+                    writer.Stream() <<"<Item text=\""<< encodeAttribute(sid->data().constData());
+                writer.Stream() << "\" id=\""<<sid->value()<<"\"/>\n";
             }
-        }
+        });
     }
     writer.Stream() << writer.ind() << "</StringHasher>\n";
 }
 
 void StringHasher::SaveDocFile (Base::Writer &writer) const {
+    if(useBinaryFormat(writer)) {
+        this->saveBinary(writer.Stream());
+        return;
+    }
+    if(_hashes->SaveAll)
+        _hashes->materializeAll();
     std::size_t count = _hashes->SaveAll?this->size():this->count();
     writer.Stream() << count << '\n';
     saveStream(writer.Stream());
 }
 
 void StringHasher::saveStream(std::ostream &s) const {
+    if(_hashes->SaveAll)
+        _hashes->materializeAll();
     Base::OutputStream str(s,false);
-    for(auto &v : _hashes->right) {
-        if(_hashes->SaveAll || v.info.getRefCount()>1) {
+    _hashes->ids.forEach([&](const StringID *sid) {
+        if(_hashes->SaveAll || sid->getRefCount()>1) {
             // We do not use OutputStream to save the id and flags because
             // we don't want to use '\n' as delimiter. It makes no difference
             // to restoring.
-            s << v.first << ' ' << v.info->_flags.to_ulong() << ' ';
+            s << sid->value() << ' ' << sid->_flags.to_ulong() << ' ';
 
             // We DO rely on OutputStream to save the string which may
             // contain multiple lines.
-            str << v.info->dataToText();
+            str << sid->dataToText();
         }
+    });
+}
+
+void StringHasher::saveBinary(std::ostream &s) const {
+    if(_hashes->SaveAll)
+        _hashes->materializeAll();
+
+    QByteArray payload;
+    uint32_t count = 0;
+    long lastID = 0;
+    _hashes->ids.forEach([&](const StringID *sid) {
+        if(_hashes->SaveAll || sid->getRefCount()>1) {
+            // The IDs are strictly increasing, store the difference only
+            writeVarInt(payload, sid->value() - lastID);
+            payload.append((char)sid->_flags.to_ulong());
+            writeVarInt(payload, sid->data().size());
+            payload.append(sid->data());
+            lastID = sid->value();
+            ++count;
+        }
+    });
+
+    uint8_t flags = 0;
+    uint32_t size = payload.size();
+    int level = DocumentParams::StringHasherCompression();
+    if(level > 0) {
+        payload = qCompress(payload, std::min(level, 9));
+        flags |= BinaryCompressed;
+    }
+
+    s.write(BinaryMagic, sizeof(BinaryMagic));
+    Base::OutputStream str(s);
+    str << BinaryVersion << flags << count << size << (uint32_t)payload.size();
+    s.write(payload.constData(), payload.size());
+}
+
+void StringHasher::restoreBinary(std::istream &s) {
+    FC_TIME_INIT(t);
+
+    char magic[sizeof(BinaryMagic)];
+    if(!s.read(magic, sizeof(magic)) || std::memcmp(magic, BinaryMagic, sizeof(magic))!=0)
+        FC_THROWM(Base::RuntimeError, "Invalid string table");
+
+    Base::InputStream str(s);
+    uint8_t version = 0, flags = 0;
+    uint32_t count = 0, size = 0, stored = 0;
+    str >> version >> flags >> count >> size >> stored;
+    if(!s || version > BinaryVersion)
+        FC_THROWM(Base::RuntimeError, "Unsupported string table version " << (int)version);
+
+    QByteArray buffer(stored, Qt::Uninitialized);
+    if(!s.read(buffer.data(), stored))
+        FC_THROWM(Base::RuntimeError, "Truncated string table");
+    if(flags & BinaryCompressed)
+        buffer = qUncompress(buffer);
+    if((uint32_t)buffer.size() != size)
+        FC_THROWM(Base::RuntimeError, "Corrupted string table");
+
+    // Each entry takes at least three bytes
+    if((uint64_t)count*3 > size)
+        FC_THROWM(Base::BadFormatError, "Corrupted string table");
+
+    _hashes->clear();
+    _hashes->buffer = buffer;
+    _hashes->pending.reserve(count);
+
+    // Only index the entries here. The StringID objects are created on
+    // first access.
+    const char *begin = _hashes->buffer.constData();
+    const char *end = begin + size;
+    const char *p = begin;
+    long id = 0;
+    for(uint32_t i=0; i<count; ++i) {
+        uint64_t delta, len;
+        if(!readVarInt(p, end, delta) || !delta || p == end)
+            FC_THROWM(Base::RuntimeError, "Corrupted string table");
+        uint8_t type = (uint8_t)*p++;
+        if(!readVarInt(p, end, len) || len > (uint64_t)(end - p))
+            FC_THROWM(Base::RuntimeError, "Corrupted string table");
+        if(delta > (uint64_t)(IDTable::MaxID - id))
+            FC_THROWM(Base::BadFormatError, "Invalid string id in string table");
+        id += (long)delta;
+        _hashes->insertPending(id, (uint32_t)(p - begin), (uint32_t)len, type);
+        p += len;
     }
+
+    FC_TIME_LOG(t, "restore " << count << " string(s)");
 }
 
 void StringHasher::RestoreDocFile (Base::Reader &reader) {
+    if(!boost::ends_with(reader.getFileName(),".txt")) {
+        restoreBinary(reader);
+        return;
+    }
     std::size_t count;
     reader >> count;
     restoreStream(reader,count);
 }
 
 void StringHasher::restoreStream(std::istream &s, std::size_t count) {
+    FC_TIME_INIT(t);
     Base::InputStream str(s,false);
     _hashes->clear();
     std::string content;
@@ -276,9 +839,9 @@ void StringHasher::restoreStream(std::istream &s, std::size_t count) {
             sid->_data = QByteArray::fromBase64(content.c_str());
         } else
             sid->_data = QByteArray(content.c_str());
-        _hashes->right.insert(_hashes->right.end(),
-                HashMap::right_map::value_type(sid->value(),sid->_data,sid));
+        _hashes->insert(sid);
     }
+    FC_TIME_LOG(t, "restore " << count << " string(s)");
 }
 
 void StringHasher::clear() {
@@ -291,9 +854,10 @@ size_t StringHasher::size() const {
 
 size_t StringHasher::count() const {
     size_t count = 0;
-    for(auto &v : _hashes->right) 
-        if(v.info.getRefCount()>1)
+    _hashes->ids.forEach([&count](const StringID *sid) {
+        if(sid->getRefCount()>1)
             ++count;
+    });
     return count;
 }
 
@@ -311,7 +875,9 @@ void StringHasher::Restore(Base::XMLReader &reader) {
     }
 
     std::size_t count = reader.getAttributeAsUnsigned("count");
-    if(reader.FileVersion > 1) {
+    if(reader.getAttributeAsInteger("binary","0")) {
+        restoreBinary(reader.beginCharStream(true));
+    } else if(reader.FileVersion > 1) {
         restoreStream(reader.beginCharStream(false),count);
     } else {
         for(std::size_t i=0;i<count;++i) {
@@ -328,7 +894,7 @@ void StringHasher::Restore(Base::XMLReader &reader) {
                 data = QByteArray(reader.getAttribute("text"));
                 sid = new StringID(id,data,false,false);
             }
-            _hashes->right.insert(_hashes->right.end(),HashMap::right_map::value_type(sid->value(),data,sid));
+            _hashes->insert(sid);
         }
     }
     reader.readEndElement("StringHasher");
@@ -343,8 +909,10 @@ PyObject *StringHasher::getPyObject() {
 }
 
 std::map<long,StringIDRef> StringHasher::getIDMap() const {
+    _hashes->materializeAll();
     std::map<long,StringIDRef> ret;
-    for(auto &v : _hashes->right)
-        ret.emplace_hint(ret.end(),v.first,v.info);
+    _hashes->ids.forEach([&ret](StringID *sid) {
+        ret.emplace_hint(ret.end(),sid->value(),sid);
+    });
     return ret;
 }
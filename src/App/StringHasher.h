@@ -147,6 +147,8 @@ private:
     long lastID() const;
     void saveStream(std::ostream &s) const;
     void restoreStream(std::istream &s, std::size_t count);
+    void saveBinary(std::ostream &s) const;
+    void restoreBinary(std::istream &s);
 
 private:
     std::unique_ptr<HashMap> _hashes;
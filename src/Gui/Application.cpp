@@ -62,6 +62,7 @@
 #include <Base/Exception.h>
 #include <Base/Factory.h>
 #include <Base/FileInfo.h>
+#include <Base/TimeInfo.h>
 #include <Base/Tools.h>
 #include <Base/UnitsApi.h>
 #include <App/Document.h>
@@ -2341,7 +2342,9 @@ void Application::runApplication(void)
     // running the GUI init script
     try {
         Base::Console().Log("Run Gui init script\n");
+        Base::TimeInfo t;
         runInitGuiScript();
+        App::Application::addStartupTime("FreeCADGuiInit", Base::TimeInfo::diffTimeF(t));
     }
     catch (const Base::Exception& e) {
         Base::Console().Error("Error in FreeCADGuiInit.py: %s\n", e.what());
@@ -2382,7 +2385,9 @@ void Application::runApplication(void)
     // Call this before showing the main window because otherwise:
     // 1. it shows a white window for a few seconds which doesn't look nice
     // 2. the layout of the toolbars is completely broken
+    Base::TimeInfo t;
     app.activateWorkbench(start.c_str());
+    App::Application::addStartupTime("activateWorkbench " + start, Base::TimeInfo::diffTimeF(t));
 
     // show the main window
     if (!hidden) {
@@ -2421,6 +2426,8 @@ void Application::runApplication(void)
     // gets called once we start the event loop
     QTimer::singleShot(0, &mw, SLOT(delayedStartup()));
 
+    App::Application::writeStartupTrace();
+
     // run the Application event loop
     Base::Console().Log("Init: Entering event loop\n");
 
@@ -39,6 +39,12 @@
 #endif
 
 #include <Base/Console.h>
+#include <Base/TimeInfo.h>
+#include <App/StringHasher.h>
+#include <App/Document.h>
+#include <App/GeoFeature.h>
+#include <App/ComplexGeoData.h>
+#include "Selection.h"
 #include "Application.h"
 #include "MainWindow.h"
 #include "MDIView.h"
@@ -806,6 +812,195 @@ void CmdTestConsoleOutput::activated(int iMsg)
 }
 
 
+DEF_STD_CMD(CmdTestStringHasher)
+
+CmdTestStringHasher::CmdTestStringHasher()
+  : Command("Std_TestStringHasher")
+{
+    sGroup      = QT_TR_NOOP("Standard-Test");
+    sMenuText   = QT_TR_NOOP("Test string hasher");
+    sToolTipText= QT_TR_NOOP("Measure string hasher throughput under concurrent access");
+    sStatusTip  = QT_TR_NOOP("Measure string hasher throughput under concurrent access");
+}
+
+namespace Gui {
+class StringHasherTask : public QRunnable
+{
+public:
+    StringHasherTask(App::StringHasher *hasher, const std::vector<QByteArray> &strings,
+                     int seed, int count)
+        : hasher(hasher), strings(strings), seed(seed), count(count), mismatch(0)
+    {
+        setAutoDelete(false);
+    }
+    void run()
+    {
+        // Each task visits the strings in a different order so that
+        // threads race on creating the same entries.
+        std::size_t n = strings.size();
+        for (int i=0; i<count; i++) {
+            const QByteArray &data = strings[(std::size_t(i) * 7919 + seed) % n];
+            App::StringIDRef sid = hasher->getID(data, false);
+            if (!sid || hasher->getID(sid->value()) != sid)
+                ++mismatch;
+        }
+    }
+
+    App::StringHasher *hasher;
+    const std::vector<QByteArray> &strings;
+    int seed;
+    int count;
+    int mismatch;
+};
+}
+
+void CmdTestStringHasher::activated(int iMsg)
+{
+    Q_UNUSED(iMsg);
+
+    const int stringCount = 20000;
+    const int opCount = 200000;
+
+    // Mix short element names with long ones that exceed the hash threshold
+    std::vector<QByteArray> strings;
+    strings.reserve(stringCount);
+    for (int i=0; i<stringCount; i++) {
+        QByteArray data = QByteArray("Face") + QByteArray::number(i);
+        if (i % 4 == 0)
+            data += QByteArray(200, 'x') + QByteArray::number(i);
+        strings.push_back(data);
+    }
+
+    int maxThreads = std::max(1, QThread::idealThreadCount());
+    for (int threads=1; ; threads*=2) {
+        threads = std::min(threads, maxThreads);
+
+        Base::Reference<App::StringHasher> hasher(new App::StringHasher);
+        hasher->setThreshold(100);
+
+        std::vector<std::unique_ptr<StringHasherTask> > tasks;
+        for (int i=0; i<threads; i++)
+            tasks.emplace_back(new StringHasherTask(hasher, strings, i*131, opCount));
+
+        QThreadPool pool;
+        pool.setMaxThreadCount(threads);
+        Base::TimeInfo start;
+        for (auto &task : tasks)
+            pool.start(task.get());
+        pool.waitForDone();
+        float seconds = Base::TimeInfo::diffTimeF(start, Base::TimeInfo());
+
+        int mismatch = 0;
+        for (auto &task : tasks)
+            mismatch += task->mismatch;
+        if (mismatch || hasher->size() != strings.size())
+            Base::Console().Error("Race condition in StringHasher: %d mismatches, %d entries\n",
+                    mismatch, (int)hasher->size());
+
+        // Same string must map to the same ID regardless of the thread that created it
+        for (auto &data : strings) {
+            if (hasher->getID(data, false) != hasher->getID(data, false)) {
+                Base::Console().Error("StringHasher returned different IDs for the same string\n");
+                break;
+            }
+        }
+
+        double ops = double(threads) * opCount;
+        Base::Console().Message("StringHasher: %d thread(s), %.0f lookups in %.3f s, %.0f lookups/s\n",
+                threads, ops, seconds, seconds > 0 ? ops/seconds : 0.0);
+
+        if (threads == maxThreads)
+            break;
+    }
+}
+
+//===========================================================================
+// Std_TestSelection
+//===========================================================================
+
+DEF_STD_CMD_A(CmdTestSelection)
+
+CmdTestSelection::CmdTestSelection()
+  : Command("Std_TestSelection")
+{
+    sGroup      = QT_TR_NOOP("Standard-Test");
+    sMenuText   = QT_TR_NOOP("Test selection");
+    sToolTipText= QT_TR_NOOP("Measure select all and box selection performance of the active document");
+    sStatusTip  = QT_TR_NOOP("Measure select all and box selection performance of the active document");
+}
+
+static float testSelection(const char *title,
+                           const std::vector<App::SubObjectT> &objs,
+                           bool bulk)
+{
+    Gui::Selection().clearCompleteSelection();
+    Base::TimeInfo start;
+    if (bulk)
+        Gui::Selection().addSelections(objs, false);
+    else {
+        for (auto &objT : objs)
+            Gui::Selection().addSelection(objT, false);
+    }
+    float seconds = Base::TimeInfo::diffTimeF(start, Base::TimeInfo());
+
+    start = Base::TimeInfo();
+    std::size_t found = 0;
+    for (auto &objT : objs) {
+        if (Gui::Selection().isSelected(objT.getDocumentName().c_str(),
+                                        objT.getObjectName().c_str(),
+                                        objT.getSubName().c_str(), 0))
+            ++found;
+    }
+    float lookup = Base::TimeInfo::diffTimeF(start, Base::TimeInfo());
+
+    start = Base::TimeInfo();
+    Gui::Selection().clearCompleteSelection();
+    float clear = Base::TimeInfo::diffTimeF(start, Base::TimeInfo());
+
+    Base::Console().Message("%s (%s): %d selected in %.3f s, lookup %.3f s, clear %.3f s\n",
+            title, bulk ? "bulk" : "single", (int)found, seconds, lookup, clear);
+    return seconds;
+}
+
+void CmdTestSelection::activated(int iMsg)
+{
+    Q_UNUSED(iMsg);
+
+    App::Document *doc = App::GetApplication().getActiveDocument();
+    if (!doc)
+        return;
+
+    // Select all: every object of the document
+    std::vector<App::SubObjectT> objs;
+    // Box selection: every face of every geometry object
+    std::vector<App::SubObjectT> elements;
+    for (auto obj : doc->getObjects()) {
+        objs.emplace_back(obj, "");
+        auto geo = Base::freecad_dynamic_cast<App::GeoFeature>(obj);
+        if (!geo || !geo->getPropertyOfGeometry())
+            continue;
+        auto data = geo->getPropertyOfGeometry()->getComplexData();
+        if (!data)
+            continue;
+        unsigned long count = data->countSubElements("Face");
+        for (unsigned long i=1; i<=count; ++i)
+            elements.emplace_back(obj, (std::string("Face") + std::to_string(i)).c_str());
+    }
+
+    testSelection("Select all", objs, false);
+    testSelection("Select all", objs, true);
+    if (elements.size()) {
+        testSelection("Box select", elements, false);
+        testSelection("Box select", elements, true);
+    }
+}
+
+bool CmdTestSelection::isActive(void)
+{
+    return App::GetApplication().getActiveDocument() != 0;
+}
+
+
 namespace Gui {
 
 void CreateTestCommands(void)
@@ -830,6 +1025,8 @@ void CreateTestCommands(void)
     rcCmdMgr.addCommand(new CmdTestMDI2());
     rcCmdMgr.addCommand(new CmdTestMDI3());
     rcCmdMgr.addCommand(new CmdTestConsoleOutput());
+    rcCmdMgr.addCommand(new CmdTestStringHasher());
+    rcCmdMgr.addCommand(new CmdTestSelection());
 }
 
 } // namespace Gui
@@ -2781,12 +2781,11 @@ static void selectionCallback(void * ud, SoEventCallback * cb)
 
         auto picked = view->getPickedList(points, center, selectElement, backFaceCull,
                                         currentSelection, unselect, false);
-        for (auto &objT : picked) {
-            if (unselect)
+        if (unselect) {
+            for (auto &objT : picked)
                 Selection().rmvSelection(objT);
-            else
-                Selection().addSelection(objT);
-        }
+        } else
+            Selection().addSelections(picked);
     }
 
     if (singleSelect) {
@@ -75,6 +75,7 @@ DlgPropertyLink::DlgPropertyLink(QWidget* parent, int flags)
   , ui(new Ui_DlgPropertyLink)
   , flags(flags)
 {
+    setPerElementNotification();
     ui->setupUi(this);
 
     ui->typeTree->hide();
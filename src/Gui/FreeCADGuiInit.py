@@ -105,7 +105,7 @@ class NoneWorkbench ( Workbench ):
         return "Gui::NoneWorkbench"
 
 def InitApplications():
-    import sys,os,traceback
+    import sys,os,traceback,time
     try:
         # Python3
         import io as cStringIO
@@ -116,12 +116,15 @@ def InitApplications():
     # (additional module paths are already cached)
     ModDirs = FreeCAD.__ModDirs__
     #print ModDirs
+    # InitGui.py relies on Init.py, so nothing can be deferred with a GUI
+    FreeCAD.loadDeferredModules()
     Log('Init:   Searching modules...\n')
     for Dir in ModDirs:
         if ((Dir != '') & (Dir != 'CVS') & (Dir != '__init__.py')):
             InstallFile = os.path.join(Dir,"InitGui.py")
             if (os.path.exists(InstallFile)):
                 Gui._setExecFile(InstallFile)
+                start = time.time()
                 try:
                     # XXX: This looks scary securitywise...
                     if sys.version_info.major < 3:
@@ -139,6 +142,7 @@ def InitApplications():
                     Err('Please look into the log file for further information\n')
                 else:
                     Log('Init:      Initializing ' + Dir + '... done\n')
+                FreeCAD.addStartupTime('InitGui.py ' + Dir, time.time() - start)
                 Gui._setExecFile()
             else:
                 Log('Init:      Initializing ' + Dir + '(InitGui.py not found)... ignore\n')
@@ -89,14 +89,14 @@ bool SelectionGateFilterExternal::allow(App::Document *doc ,App::DocumentObject
 //////////////////////////////////////////////////////////////////////////////////////////
 
 SelectionObserver::SelectionObserver(bool attach,int resolve)
-    :resolve(resolve),blockSelection(false)
+    :resolve(resolve),blockSelection(false),perElement(false)
 {
     if(attach)
         attachSelection();
 }
 
 SelectionObserver::SelectionObserver(const ViewProviderDocumentObject *vp,bool attach,int resolve)
-    :resolve(resolve),blockSelection(false)
+    :resolve(resolve),blockSelection(false),perElement(false)
 {
     if(vp && vp->getObject() && vp->getObject()->getDocument()) {
         filterDocName = vp->getObject()->getDocument()->getName();
@@ -132,6 +132,16 @@ bool SelectionObserver::isConnectionAttached() const
     return connectSelection.connected();
 }
 
+void SelectionObserver::setPerElementNotification(bool enable)
+{
+    perElement = enable;
+}
+
+bool SelectionObserver::isPerElementNotification() const
+{
+    return perElement;
+}
+
 void SelectionObserver::attachSelection()
 {
     if (!connectSelection.connected()) {
@@ -152,7 +162,37 @@ void SelectionObserver::_onSelectionChanged(const SelectionChanges& msg) {
     try {
         if (blockSelection)
             return;
-        onSelectionChanged(msg);
+        if (!perElement
+                || msg.Type != SelectionChanges::SetSelection
+                || msg.SubObjects.empty())
+        {
+            onSelectionChanged(msg);
+            return;
+        }
+        for (auto &objT : msg.SubObjects) {
+            auto pObject = objT.getObject();
+            if (!pObject)
+                continue;
+            SelectionChanges Chng(SelectionChanges::AddSelection,
+                    objT.getDocumentName(), objT.getObjectName(),
+                    objT.getSubName(), pObject->getTypeId().getName());
+            if (!resolve || objT.getSubName().empty()) {
+                onSelectionChanged(Chng);
+                continue;
+            }
+            // Resolve the same way as SelectionSingleton::slotSelectionChanged()
+            std::pair<std::string,std::string> elementName;
+            auto pResolved = App::GeoFeature::resolveElement(pObject,Chng.pSubName,elementName);
+            if (!pResolved)
+                continue;
+            const std::string &element = (resolve > 1 && elementName.first.size()) ?
+                elementName.first : elementName.second;
+            SelectionChanges Chng2(SelectionChanges::AddSelection,
+                    pResolved->getDocument()->getName(), pResolved->getNameInDocument(),
+                    element, pResolved->getTypeId().getName());
+            Chng2.pOriginalMsg = &Chng;
+            onSelectionChanged(Chng2);
+        }
     } catch (Base::Exception &e) {
         e.ReportException();
         FC_ERR("Unhandled Base::Exception caught in selection observer");
@@ -187,6 +227,11 @@ SelectionObserverPython::SelectionObserverPython(const Py::Object& obj, int reso
 #undef FC_PY_ELEMENT
 #define FC_PY_ELEMENT(_name) FC_PY_GetCallable(obj.ptr(),#_name,py_##_name);
     FC_PY_SEL_OBSERVER
+
+    // Observers without setSelection() expect one addSelection() call per
+    // element on bulk selection
+    if(py_setSelection.isNone() && !py_addSelection.isNone())
+        setPerElementNotification();
 }
 
 SelectionObserverPython::~SelectionObserverPython()
@@ -547,6 +592,63 @@ std::vector<SelectionObject> SelectionSingleton::getObjectList(const char* pDocN
             return temp;
     }
 
+    if(&objList == &_SelList) {
+        // Visit the selection grouped by the reported object through the
+        // index. Each group gives one SelectionObject, which are then
+        // ordered by their first selected entry, same as below.
+        std::vector<std::pair<unsigned long, SelectionObject> > results;
+        std::vector<const SelIndexEntry*> entries;
+        auto addGroup = [&](const SelIndexMap &group) -> bool {
+            entries.clear();
+            for(auto &v : group)
+                entries.push_back(&v.second);
+            std::sort(entries.begin(), entries.end(),
+                [](const SelIndexEntry *a, const SelIndexEntry *b) {
+                    return a->seq < b->seq;
+                });
+            SelectionObject *selObj = 0;
+            for(auto entry : entries) {
+                auto &sel = *entry->it;
+                if(!sel.pDoc) continue;
+                const char *subelement = 0;
+                auto obj = getObjectOfType(sel,typeId,resolve,&subelement);
+                if(!obj || (pcDoc && sel.pObject->getDocument()!=pcDoc))
+                    continue;
+                if(!selObj) {
+                    results.emplace_back(entry->seq, SelectionObject(obj));
+                    selObj = &results.back().second;
+                }
+                if (subelement && *subelement) {
+                    if(resolve && !selObj->_SubNameSet.insert(subelement).second)
+                        continue;
+                    selObj->SubNames.push_back(subelement);
+                    selObj->SelPoses.emplace_back(sel.x,sel.y,sel.z);
+                }
+            }
+            return !single || results.size() <= 1;
+        };
+        if(resolve) {
+            for(auto &v : _SelResolvedIndex) {
+                if(!addGroup(v.second))
+                    return temp;
+            }
+        } else {
+            for(auto &v : _SelIndex) {
+                if(!addGroup(v.second))
+                    return temp;
+            }
+        }
+        std::sort(results.begin(), results.end(),
+            [](const std::pair<unsigned long, SelectionObject> &a,
+               const std::pair<unsigned long, SelectionObject> &b) {
+                return a.first < b.first;
+            });
+        temp.reserve(results.size());
+        for(auto &v : results)
+            temp.push_back(std::move(v.second));
+        return temp;
+    }
+
     for (auto &sel : objList) {
         if(!sel.pDoc) continue;
         const char *subelement = 0;
@@ -1145,7 +1247,7 @@ bool SelectionSingleton::addSelection(const char* pDocName, const char* pObjectN
     if(!logDisabled)
         temp.log(false,clearPreselect);
 
-    _SelList.push_back(temp);
+    selListAppend(_SelObj(temp));
     _SelStackForward.clear();
 
     if(clearPreselect)
@@ -1307,7 +1409,7 @@ bool SelectionSingleton::addSelections(const char* pDocName, const char* pObject
         temp.y        = 0;
         temp.z        = 0;
 
-        _SelList.push_back(temp);
+        selListAppend(_SelObj(temp));
         _SelStackForward.clear();
 
         SelectionChanges Chng(SelectionChanges::AddSelection,
@@ -1324,6 +1426,68 @@ bool SelectionSingleton::addSelections(const char* pDocName, const char* pObject
     return true;
 }
 
+bool SelectionSingleton::addSelections(const std::vector<App::SubObjectT> &objs, bool clearPreselect)
+{
+    if(_PickedList.size()) {
+        _PickedList.clear();
+        notify(SelectionChanges(SelectionChanges::PickedListChanged));
+    }
+
+    // One SetSelection message per document, carrying the added entries
+    std::vector<SelectionChanges> changes;
+    for(auto &objT : objs) {
+        _SelObj temp;
+        int ret = checkSelection(objT.getDocumentName().c_str(),
+                                 objT.getObjectName().c_str(),
+                                 objT.getSubName().c_str(),0,temp);
+        if(ret!=0)
+            continue;
+
+        if (ActiveGate) {
+            const char *subelement = 0;
+            auto pObject = getObjectOfType(temp,App::DocumentObject::getClassTypeId(),gateResolve,&subelement);
+            if (!ActiveGate->allow(pObject?pObject->getDocument():temp.pDoc,pObject,subelement)) {
+                ActiveGate->notAllowedReason.clear();
+                continue;
+            }
+        }
+
+        if(!logDisabled)
+            temp.log(false,clearPreselect);
+
+        FC_LOG("Add Selection "<<temp.DocName<<'#'<<temp.FeatName<<'.'<<temp.SubName);
+
+        SelectionChanges *Chng = 0;
+        for(auto &change : changes) {
+            if(change.Object.getDocumentName() == temp.DocName) {
+                Chng = &change;
+                break;
+            }
+        }
+        if(!Chng) {
+            changes.emplace_back(SelectionChanges::SetSelection,temp.DocName.c_str());
+            Chng = &changes.back();
+        }
+        Chng->SubObjects.emplace_back(temp.pObject,temp.SubName.c_str());
+
+        selListAppend(std::move(temp));
+    }
+
+    if(changes.empty())
+        return false;
+
+    _SelStackForward.clear();
+
+    if(clearPreselect)
+        rmvPreselect();
+
+    for(auto &Chng : changes)
+        notify(std::move(Chng));
+
+    getMainWindow()->updateActions();
+    return true;
+}
+
 bool SelectionSingleton::updateSelection(bool show, const char* pDocName, 
                             const char* pObjectName, const char* pSubName)
 {
@@ -1413,26 +1577,40 @@ void SelectionSingleton::rmvSelection(const char* pDocName, const char* pObjectN
     if(ret<0)
         return;
 
-    std::vector<SelectionChanges> changes;
-    for(auto It=_SelList.begin(),ItNext=It;It!=_SelList.end();It=ItNext) {
-        ++ItNext;
-        if(It->DocName!=temp.DocName || It->FeatName!=temp.FeatName) 
+    auto iter = _SelIndex.find(selIndexKey(temp.DocName,temp.FeatName));
+    if(iter == _SelIndex.end())
+        return;
+
+    // Collect the matches first, because erasing modifies the index
+    std::vector<SelIndexEntry> matches;
+    auto &subs = iter->second;
+    // if no subname is specified, remove all subobjects of the matching object,
+    // otherwise, match subojects with common prefix, separated by '.'
+    for(auto it=subs.lower_bound(temp.SubName);it!=subs.end();++it) {
+        const std::string &subname = it->first;
+        if(!boost::starts_with(subname,temp.SubName))
+            break;
+        if(temp.SubName.size() && subname.length()!=temp.SubName.length()
+                && subname[temp.SubName.length()-1]!='.')
             continue;
-        // if no subname is specified, remove all subobjects of the matching object
-        if(temp.SubName.size()) {
-            // otherwise, match subojects with common prefix, separated by '.'
-            if(!boost::starts_with(It->SubName,temp.SubName) ||
-               (It->SubName.length()!=temp.SubName.length() && It->SubName[temp.SubName.length()-1]!='.'))
-                continue;
-        }
+        matches.push_back(it->second);
+    }
+    // report in selection order
+    std::sort(matches.begin(),matches.end(),
+        [](const SelIndexEntry &a, const SelIndexEntry &b) {
+            return a.seq < b.seq;
+        });
 
+    std::vector<SelectionChanges> changes;
+    for(auto &entry : matches) {
+        auto It = entry.it;
         It->log(true);
 
         changes.emplace_back(SelectionChanges::RmvSelection,
                 It->DocName,It->FeatName,It->SubName,It->TypeName);
 
         // destroy the _SelObj item
-        _SelList.erase(It);
+        selListErase(It);
     }
 
     // NOTE: It can happen that there are nested calls of rmvSelection()
@@ -1577,7 +1755,7 @@ void SelectionSingleton::setSelection(const char* pDocName, const std::vector<Ap
         if(ret!=0)
             continue;
         touched = true;
-        _SelList.push_back(temp);
+        selListAppend(std::move(temp));
     }
 
     if(touched) {
@@ -1613,7 +1791,7 @@ void SelectionSingleton::clearSelection(const char* pDocName, bool clearPreSelec
         for (auto it=_SelList.begin();it!=_SelList.end();) {
             if (it->DocName == docName) {
                 touched = true;
-                it = _SelList.erase(it);
+                it = selListErase(it);
             }
             else {
                 ++it;
@@ -1656,7 +1834,7 @@ void SelectionSingleton::clearCompleteSelection(bool clearPreSelect)
                 clearPreSelect?"Gui.Selection.clearSelection()"
                               :"Gui.Selection.clearSelection(False)");
 
-    _SelList.clear();
+    selListClear();
 
     SelectionChanges Chng(SelectionChanges::ClrSelection);
 
@@ -1682,6 +1860,53 @@ bool SelectionSingleton::isSelected(App::DocumentObject* pObject, const char* pS
             pObject->getNameInDocument(),pSubName,resolve,sel,&_SelList)>0;
 }
 
+SelectionSingleton::SelIterator SelectionSingleton::selListAppend(_SelObj &&sel)
+{
+    _SelList.push_back(std::move(sel));
+    auto it = _SelList.end();
+    --it;
+    SelIndexEntry entry{_SelSeq++, it};
+    _SelIndex[selIndexKey(it->DocName,it->FeatName)].emplace(it->SubName, entry);
+    if(it->pResolvedObject)
+        _SelResolvedIndex[it->pResolvedObject].emplace(resolvedIndexKey(*it), entry);
+    return it;
+}
+
+void SelectionSingleton::eraseIndexEntry(SelIndexMap &map, const std::string &key, SelIterator it)
+{
+    auto range = map.equal_range(key);
+    for(auto i=range.first;i!=range.second;++i) {
+        if(i->second.it == it) {
+            map.erase(i);
+            break;
+        }
+    }
+}
+
+SelectionSingleton::SelIterator SelectionSingleton::selListErase(SelIterator it)
+{
+    auto iter = _SelIndex.find(selIndexKey(it->DocName,it->FeatName));
+    if(iter != _SelIndex.end()) {
+        eraseIndexEntry(iter->second, it->SubName, it);
+        if(iter->second.empty())
+            _SelIndex.erase(iter);
+    }
+    auto iter2 = _SelResolvedIndex.find(it->pResolvedObject);
+    if(iter2 != _SelResolvedIndex.end()) {
+        eraseIndexEntry(iter2->second, resolvedIndexKey(*it), it);
+        if(iter2->second.empty())
+            _SelResolvedIndex.erase(iter2);
+    }
+    return _SelList.erase(it);
+}
+
+void SelectionSingleton::selListClear()
+{
+    _SelList.clear();
+    _SelIndex.clear();
+    _SelResolvedIndex.clear();
+}
+
 void SelectionSingleton::checkTopParent(App::DocumentObject *&obj, std::string &subname) {
     TreeWidget::checkTopParent(obj,subname);
 }
@@ -1743,15 +1968,40 @@ int SelectionSingleton::checkSelection(const char *pDocName, const char *pObject
     if(!pSubName)
         pSubName = "";
 
-    for (auto &s : *selList) {
-        if (s.DocName==pDocName && s.FeatName==sel.FeatName) {
-            if(s.SubName==pSubName)
-                return 1;
-            if(resolve>1 && boost::starts_with(s.SubName,prefix))
+    if(selList == &_SelList) {
+        auto it = _SelIndex.find(selIndexKey(sel.DocName,sel.FeatName));
+        if(it != _SelIndex.end()) {
+            auto &subs = it->second;
+            if(subs.count(pSubName))
                 return 1;
+            if(resolve>1) {
+                auto iter = subs.lower_bound(prefix);
+                if(iter!=subs.end() && boost::starts_with(iter->first,prefix))
+                    return 1;
+            }
+        }
+    } else {
+        for (auto &s : *selList) {
+            if (s.DocName==pDocName && s.FeatName==sel.FeatName) {
+                if(s.SubName==pSubName)
+                    return 1;
+                if(resolve>1 && boost::starts_with(s.SubName,prefix))
+                    return 1;
+            }
         }
     }
-    if(resolve==1) {
+    if(resolve==1 && selList == &_SelList) {
+        auto it = _SelResolvedIndex.find(sel.pResolvedObject);
+        if(it != _SelResolvedIndex.end()) {
+            auto &elements = it->second;
+            if(!pSubName[0])
+                return 1;
+            if(sel.elementName.first.size() && elements.count("N" + sel.elementName.first))
+                return 1;
+            if(elements.count("S" + sel.elementName.second))
+                return 1;
+        }
+    } else if(resolve==1) {
         for(auto &s : *selList) {
             if(s.pResolvedObject != sel.pResolvedObject)
                 continue;
@@ -1807,7 +2057,7 @@ void SelectionSingleton::slotDeletedObject(const App::DocumentObject& Obj)
         if(it->pResolvedObject == &Obj || it->pObject==&Obj) {
             changes.emplace_back(SelectionChanges::RmvSelection,
                     it->DocName,it->FeatName,it->SubName,it->TypeName);
-            _SelList.erase(it);
+            selListErase(it);
         }
     }
     if(changes.size()) {
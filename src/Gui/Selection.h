@@ -31,6 +31,7 @@
 #include <vector>
 #include <list>
 #include <map>
+#include <unordered_map>
 #include <deque>
 #include <boost_signals2.hpp>
 #include <CXX/Objects.hxx>
@@ -128,6 +129,7 @@ public:
         pSubName = Object.getSubName().c_str();
         pTypeName = TypeName.c_str();
         pOriginalMsg = other.pOriginalMsg;
+        SubObjects = other.SubObjects;
         return *this;
     }
 
@@ -148,6 +150,7 @@ public:
         pSubName = Object.getSubName().c_str();
         pTypeName = TypeName.c_str();
         pOriginalMsg = other.pOriginalMsg;
+        SubObjects = std::move(other.SubObjects);
         return *this;
     }
 
@@ -167,6 +170,9 @@ public:
 
     // Original selection message in case resolve!=0
     const SelectionChanges *pOriginalMsg = 0;
+
+    /// Entries added by SelectionSingleton::addSelections() in a SetSelection message
+    std::vector<App::SubObjectT> SubObjects;
 };
 
 } //namespace Gui
@@ -240,6 +246,16 @@ public:
     /** Detaches from the selection. */
     void detachSelection();
 
+    /** Enables per element notification of bulk selection
+     *
+     * SelectionSingleton::addSelections() notifies with a single SetSelection
+     * message carrying the added entries in SelectionChanges::SubObjects.
+     * When enabled, this message is passed to onSelectionChanged() as one
+     * AddSelection message per entry instead.
+     */
+    void setPerElementNotification(bool enable=true);
+    bool isPerElementNotification() const;
+
 private:
     virtual void onSelectionChanged(const SelectionChanges& msg) = 0;
     void _onSelectionChanged(const SelectionChanges& msg);
@@ -251,6 +267,7 @@ private:
     std::string filterObjName;
     int resolve;
     bool blockSelection;
+    bool perElement;
 };
 
 /**
@@ -382,6 +399,19 @@ public:
     bool addSelection(const SelectionObject&, bool clearPreSelect=true);
     /// Add to selection with several sub-elements
     bool addSelections(const char* pDocName, const char* pObjectName, const std::vector<std::string>& pSubNames);
+    /** Add to selection with several (sub)objects at once
+     *
+     * All objects are added to the selection first, and then observers are
+     * notified with one SelectionChanges::SetSelection message per document,
+     * with the added objects listed in SelectionChanges::SubObjects in the
+     * given order. Observers needing one AddSelection message per object can
+     * ask for it with SelectionObserver::setPerElementNotification(). Intended
+     * for operations that select many objects/elements at once, such as box
+     * selection.
+     *
+     * @return Returns true if any object was added to the selection.
+     */
+    bool addSelections(const std::vector<App::SubObjectT> &objs, bool clearPreselect=true);
     /// Update a selection
     bool updateSelection(bool show, const char* pDocName, const char* pObjectName=0, const char* pSubName=0);
     /// Remove from selection
@@ -743,6 +773,35 @@ protected:
     };
     mutable std::list<_SelObj> _SelList;
 
+    typedef std::list<_SelObj>::iterator SelIterator;
+    struct SelIndexEntry {
+        unsigned long seq; // insertion order, to report changes in list order
+        SelIterator it;
+    };
+    typedef std::multimap<std::string, SelIndexEntry> SelIndexMap;
+    /// Index of _SelList by 'DocName#FeatName', then by SubName
+    std::unordered_map<std::string, SelIndexMap> _SelIndex;
+    /// Index of _SelList by the resolved object, then by resolvedIndexKey()
+    std::unordered_map<const App::DocumentObject*, SelIndexMap> _SelResolvedIndex;
+    unsigned long _SelSeq = 0;
+
+    static std::string selIndexKey(const std::string &docName, const std::string &featName) {
+        return docName + '#' + featName;
+    }
+    /// Element key used by checkSelection() to match resolved selections
+    static std::string resolvedIndexKey(const _SelObj &sel) {
+        if(sel.elementName.first.size())
+            return "N" + sel.elementName.first;
+        return "S" + sel.SubName;
+    }
+    static void eraseIndexEntry(SelIndexMap &map, const std::string &key, SelIterator it);
+    /// Append to _SelList and update the index
+    SelIterator selListAppend(_SelObj &&sel);
+    /// Erase from _SelList and the index
+    SelIterator selListErase(SelIterator it);
+    /// Clear _SelList and the index
+    void selListClear();
+
     mutable std::list<_SelObj> _PickedList;
     bool _needPickedList;
 
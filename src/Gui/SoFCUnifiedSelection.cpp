@@ -586,22 +586,19 @@ void SoFCUnifiedSelection::doAction(SoAction *action)
 
     if (action->getTypeId() == SoFCSelectionAction::getClassTypeId()) {
         SoFCSelectionAction *selaction = static_cast<SoFCSelectionAction*>(action);
-        if(selectionMode.getValue() == ON
-            && (selaction->SelChange.Type == SelectionChanges::AddSelection
-                || selaction->SelChange.Type == SelectionChanges::RmvSelection))
-        {
+        auto applySelection = [&](const char *pObjectName, const char *pSubName, bool add) {
             // selection changes inside the 3d view are handled in handleEvent()
             App::Document* doc = App::GetApplication().getDocument(selaction->SelChange.pDocName);
-            App::DocumentObject* obj = doc->getObject(selaction->SelChange.pObjectName);
+            App::DocumentObject* obj = doc->getObject(pObjectName);
             ViewProvider*vp = Application::Instance->getViewProvider(obj);
             if (vp && (useNewSelection.getValue()||vp->useNewSelectionModel()) && vp->isSelectable()) {
                 SoDetail *detail = nullptr;
                 detailPath->truncate(0);
-                if(!selaction->SelChange.pSubName || !selaction->SelChange.pSubName[0] ||
-                    vp->getDetailPath(selaction->SelChange.pSubName,detailPath,true,detail))
+                if(!pSubName || !pSubName[0] ||
+                    vp->getDetailPath(pSubName,detailPath,true,detail))
                 {
                     SoSelectionElementAction::Type type = SoSelectionElementAction::None;
-                    if (selaction->SelChange.Type == SelectionChanges::AddSelection) {
+                    if (add) {
                         if (detail)
                             type = SoSelectionElementAction::Append;
                         else
@@ -625,6 +622,20 @@ void SoFCUnifiedSelection::doAction(SoAction *action)
                 detailPath->truncate(0);
                 delete detail;
             }
+        };
+        if(selectionMode.getValue() == ON
+            && (selaction->SelChange.Type == SelectionChanges::AddSelection
+                || selaction->SelChange.Type == SelectionChanges::RmvSelection))
+        {
+            applySelection(selaction->SelChange.pObjectName, selaction->SelChange.pSubName,
+                    selaction->SelChange.Type == SelectionChanges::AddSelection);
+        }
+        else if(selectionMode.getValue() == ON
+                    && selaction->SelChange.Type == SelectionChanges::SetSelection
+                    && selaction->SelChange.SubObjects.size()) {
+            // Entries added by Selection().addSelections()
+            for(auto &objT : selaction->SelChange.SubObjects)
+                applySelection(objT.getObjectName().c_str(), objT.getSubName().c_str(), true);
         }
         else if (selaction->SelChange.Type == SelectionChanges::ClrSelection) {
             SoSelectionElementAction selectionAction(SoSelectionElementAction::None);
@@ -427,6 +427,7 @@ public:
 ElementColors::ElementColors(ViewProviderDocumentObject* vp, bool noHide)
     :d(new Private(vp))
 {
+    setPerElementNotification();
     d->ui->setupUi(this);
     d->ui->objectLabel->setText(QString::fromUtf8(vp->getObject()->Label.getValue()));
     d->ui->elementList->setMouseTracking(true); // needed for itemEntered() to work
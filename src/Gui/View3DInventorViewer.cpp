@@ -1075,6 +1075,14 @@ void View3DInventorViewer::checkGroupOnTop(const SelectionChanges &Reason, bool
 
     switch(Reason.Type) {
     case SelectionChanges::SetSelection:
+        if(Reason.SubObjects.size()) {
+            // Entries added by Selection().addSelections()
+            for(auto &objT : Reason.SubObjects) {
+                checkGroupOnTop(SelectionChanges(SelectionChanges::AddSelection,
+                            objT.getDocumentName(),objT.getObjectName(),objT.getSubName()));
+            }
+            return;
+        }
         clearGroupOnTop();
         if(!guiDocument)
             return;
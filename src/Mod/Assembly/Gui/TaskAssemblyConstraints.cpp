@@ -51,6 +51,7 @@ extern Assembly::Item* ActiveAsmObject;
 TaskAssemblyConstraints::TaskAssemblyConstraints(ViewProviderConstraint* vp)
     : TaskBox(Gui::BitmapFactory().pixmap("document-new"),tr("Constraints"),true, 0), view(vp)
 {
+    setPerElementNotification();
     // we need a separate container widget to add all controls to
     proxy = new QWidget(this);
     ui = new Ui::TaskAssemblyConstraints();
@@ -67,6 +67,7 @@ TaskCreateNodeSet::TaskCreateNodeSet(Fem::FemSetNodesObject *pcObject,QWidget *p
       pcObject(pcObject),
       selectionMode(none)
 {
+    setPerElementNotification();
     // we need a separate container widget to add all controls to
     proxy = new QWidget(this);
     ui = new Ui_TaskCreateNodeSet();
@@ -78,6 +78,7 @@ TaskFemConstraint::TaskFemConstraint(ViewProviderFemConstraint *ConstraintView,Q
     , okButton(nullptr)
     , cancelButton(nullptr)
 {
+    setPerElementNotification();
     selectionMode = selref;
 
     // Setup the dialog inside the Shaft Wizard dialog
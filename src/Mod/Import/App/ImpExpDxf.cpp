@@ -52,6 +52,7 @@
 #include <TopoDS_Compound.hxx>
 #include <TopoDS_Shape.hxx>
 #include <TopExp_Explorer.hxx>
+#include <TopoDS_Iterator.hxx>
 #include <TopoDS_Edge.hxx>
 #include <TColgp_Array1OfPnt.hxx>
 
@@ -106,7 +107,7 @@ void ImpExpDxfRead::OnReadLine(const double* s, const double* e, bool /*hidden*/
         return;
     BRepBuilderAPI_MakeEdge makeEdge(p0, p1);
     TopoDS_Edge edge = makeEdge.Edge();
-    AddObject(new Part::TopoShape(edge));
+    AddObject(edge);
 }
 
 
@@ -114,7 +115,7 @@ void ImpExpDxfRead::OnReadPoint(const double* s)
 {
     BRepBuilderAPI_MakeVertex makeVertex(makePoint(s));
     TopoDS_Vertex vertex = makeVertex.Vertex();
-    AddObject(new Part::TopoShape(vertex));
+    AddObject(vertex);
 }
 
 
@@ -130,7 +131,7 @@ void ImpExpDxfRead::OnReadArc(const double* s, const double* e, const double* c,
     if (circle.Radius() > 0) {
         BRepBuilderAPI_MakeEdge makeEdge(circle, p0, p1);
         TopoDS_Edge edge = makeEdge.Edge();
-        AddObject(new Part::TopoShape(edge));
+        AddObject(edge);
     }
     else {
         Base::Console().Warning("ImpExpDxf - ignore degenerate arc of circle\n");
@@ -149,7 +150,7 @@ void ImpExpDxfRead::OnReadCircle(const double* s, const double* c, bool dir, boo
     if (circle.Radius() > 0) {
         BRepBuilderAPI_MakeEdge makeEdge(circle);
         TopoDS_Edge edge = makeEdge.Edge();
-        AddObject(new Part::TopoShape(edge));
+        AddObject(edge);
     }
     else {
         Base::Console().Warning("ImpExpDxf - ignore degenerate circle\n");
@@ -174,7 +175,7 @@ void ImpExpDxfRead::OnReadEllipse(const double* c, double major_radius, double m
     if (ellipse.MinorRadius() > 0) {
         BRepBuilderAPI_MakeEdge makeEdge(ellipse);
         TopoDS_Edge edge = makeEdge.Edge();
-        AddObject(new Part::TopoShape(edge));
+        AddObject(edge);
     }
     else {
         Base::Console().Warning("ImpExpDxf - ignore degenerate ellipse\n");
@@ -202,29 +203,23 @@ void ImpExpDxfRead::OnReadInsert(const double* point, const double* scale, const
     std::string prefix = "BLOCKS ";
     prefix += name;
     prefix += " ";
-    for(std::map<std::string,std::vector<Part::TopoShape*> > ::const_iterator i = layers.begin(); i != layers.end(); ++i) {
-        std::string k = i->first;
-        if(k.substr(0, prefix.size()) == prefix) {
-            BRep_Builder builder;
-            TopoDS_Compound comp;
-            builder.MakeCompound(comp);
-            std::vector<Part::TopoShape*> v = i->second;
-            for(std::vector<Part::TopoShape*>::const_iterator j = v.begin(); j != v.end(); ++j) { 
-                const TopoDS_Shape& sh = (*j)->getShape();
-                if (!sh.IsNull())
-                    builder.Add(comp, sh);
-            }
-            if (!comp.IsNull()) {
-                Part::TopoShape* pcomp = new Part::TopoShape(comp);
-                Base::Matrix4D mat;
-                mat.scale(scale[0],scale[1],scale[2]);
-                mat.rotZ(rotation);
-                mat.move(point[0]*optionScaling,point[1]*optionScaling,point[2]*optionScaling);
-                pcomp->transformShape(mat,true);
-                AddObject(pcomp);
-            }
-        }
-    } 
+    // the block layers are sorted by name, so they follow each other in the map
+    for(std::map<std::string,TopoDS_Compound>::const_iterator i = layers.lower_bound(prefix); i != layers.end(); ++i) {
+        const std::string& k = i->first;
+        if(k.compare(0, prefix.size(), prefix) != 0)
+            break;
+        TopoDS_Compound comp;
+        builder.MakeCompound(comp);
+        for (TopoDS_Iterator it(i->second); it.More(); it.Next())
+            builder.Add(comp, it.Value());
+        Part::TopoShape pcomp(comp);
+        Base::Matrix4D mat;
+        mat.scale(scale[0],scale[1],scale[2]);
+        mat.rotZ(rotation);
+        mat.move(point[0]*optionScaling,point[1]*optionScaling,point[2]*optionScaling);
+        pcomp.transformShape(mat,true);
+        AddObject(pcomp.getShape());
+    }
 }
 
 
@@ -240,18 +235,24 @@ void ImpExpDxfRead::OnReadDimension(const double* s, const double* e, const doub
 }
 
 
-void ImpExpDxfRead::AddObject(Part::TopoShape *shape)
+void ImpExpDxfRead::AddObject(const TopoDS_Shape& shape)
 {
+    if (shape.IsNull())
+        return;
     //std::cout << "layer:" << LayerName() << std::endl;
-    std::vector <Part::TopoShape*> vec;
-    if (layers.count(LayerName()))
-        vec = layers[LayerName()];
-    vec.push_back(shape);
-    layers[LayerName()] = vec;
+    std::string layer = LayerName();
+    // the shapes are collected in one compound per layer instead of one
+    // TopoShape per entity
+    std::map<std::string,TopoDS_Compound>::iterator it = layers.find(layer);
+    if (it == layers.end()) {
+        it = layers.insert(std::make_pair(layer, TopoDS_Compound())).first;
+        builder.MakeCompound(it->second);
+    }
+    builder.Add(it->second, shape);
     if (!optionGroupLayers) {
-        if(LayerName().substr(0, 6) != "BLOCKS") {
+        if(layer.compare(0, 6, "BLOCKS") != 0) {
             Part::Feature *pcFeature = (Part::Feature *)document->addObject("Part::Feature", "Shape");
-            pcFeature->Shape.setValue(shape->getShape());
+            pcFeature->Shape.setValue(shape);
         }
     }
 }
@@ -299,24 +300,13 @@ std::string ImpExpDxfRead::Deformat(const char* text)
 void ImpExpDxfRead::AddGraphics() const
 {
     if (optionGroupLayers) {
-        for(std::map<std::string,std::vector<Part::TopoShape*> > ::const_iterator i = layers.begin(); i != layers.end(); ++i) {
-            BRep_Builder builder;
-            TopoDS_Compound comp;
-            builder.MakeCompound(comp);
+        for(std::map<std::string,TopoDS_Compound>::const_iterator i = layers.begin(); i != layers.end(); ++i) {
             std::string k = i->first;
             if (k == "0") // FreeCAD doesn't like an object name being '0'...
                 k = "LAYER_0";
-            std::vector<Part::TopoShape*> v = i->second;
             if(k.substr(0, 6) != "BLOCKS") {
-                for(std::vector<Part::TopoShape*>::const_iterator j = v.begin(); j != v.end(); ++j) { 
-                    const TopoDS_Shape& sh = (*j)->getShape();
-                    if (!sh.IsNull())
-                        builder.Add(comp, sh);
-                }
-                if (!comp.IsNull()) {
-                    Part::Feature *pcFeature = (Part::Feature *)document->addObject("Part::Feature", k.c_str());
-                    pcFeature->Shape.setValue(comp);
-                } 
+                Part::Feature *pcFeature = (Part::Feature *)document->addObject("Part::Feature", k.c_str());
+                pcFeature->Shape.setValue(i->second);
             }
         }
     }
@@ -26,6 +26,8 @@
 #include "dxf.h"
 #include <Mod/Part/App/TopoShape.h>
 #include <App/Document.h>
+#include <BRep_Builder.hxx>
+#include <TopoDS_Compound.hxx>
 #include <gp_Pnt.hxx>
 
 class BRepAdaptor_Curve;
@@ -50,7 +52,7 @@ namespace Import
         void AddGraphics() const;
     
         // FreeCAD-specific functions
-        void AddObject(Part::TopoShape *shape); //Called by OnRead functions to add Part objects
+        void AddObject(const TopoDS_Shape& shape); //Called by OnRead functions to add Part objects
         std::string Deformat(const char* text); // Removes DXF formatting from texts
 
         std::string getOptionSource() { return m_optionSource; }
@@ -65,7 +67,8 @@ namespace Import
         bool optionGroupLayers;
         bool optionImportAnnotations;
         double optionScaling;
-        std::map <std::string, std::vector <Part::TopoShape*> > layers;
+        std::map <std::string, TopoDS_Compound> layers; // the shapes of each layer and block
+        BRep_Builder builder;
         std::string m_optionSource;
     };
 
@@ -48,6 +48,8 @@
 
 #include <XCAFDoc_ShapeMapTool.hxx>
 
+#include <QtConcurrentMap>
+
 #include <boost/regex.hpp>
 #include <boost/algorithm/string.hpp>
 #include <Base/Parameter.h>
@@ -157,6 +159,7 @@ ImportOCAF2::ImportOCAF2(Handle(TDocStd_Document) h, App::Document* d, const std
     reduceObjects = hGrp->GetBool("ReduceObjects",true);
     showProgress = hGrp->GetBool("ShowProgress",true);
     expandCompound = hGrp->GetBool("ExpandCompound",false);
+    parallel = hGrp->GetBool("ParallelImport",true);
 
     if(d->isSaved()) {
         Base::FileInfo fi(d->FileName.getValue());
@@ -275,6 +278,14 @@ struct ImportOCAF2::ColorInfo {
     bool hasEdgeColor = false;
 };
 
+// Find the indices of the faces or edges of a sub-shape
+static void findSubShapes(const Part::TopoShape &tshape, const TopoDS_Shape &subShape,
+        TopAbs_ShapeEnum type, std::vector<int> &indices)
+{
+    for(TopExp_Explorer exp(subShape,type);exp.More();exp.Next())
+        indices.push_back(tshape.findShape(exp.Current())-1);
+}
+
 // Check for uniform color
 static void mergeColor(bool &hasColors, App::Color &color, std::vector<App::Color> &colors) {
     if(colors.empty())
@@ -404,11 +415,21 @@ bool ImportOCAF2::createObject(App::Document *doc, TDF_Label label,
     bool hasFaceColors = false;
     bool hasEdgeColors = false;
 
-    Part::TopoShape tshape(shape);
+    Part::TopoShape tshape;
+    const PreparedShape *prepared = 0;
+    auto itPrepared = myPreparedShapes.find(shape);
+    if(itPrepared != myPreparedShapes.end()) {
+        prepared = &itPrepared->second;
+        tshape = prepared->shape;
+    } else
+        tshape.setShape(shape);
     ColorInfo colors;
 
     TDF_LabelSequence seq;
     if(!label.IsNull() && aShapeTool->GetSubShapes(label,seq)) {
+        // use the sub-shape indices found by prepareShapes() if they are of this label
+        if(prepared && (prepared->label!=label || (int)prepared->subFaces.size()!=seq.Length()))
+            prepared = 0;
         colors.faceColors.assign(tshape.countSubShapes(TopAbs_FACE),info.faceColor);
         colors.edgeColors.assign(tshape.countSubShapes(TopAbs_EDGE),info.edgeColor);
         // Two passes to get sub shape colors. First pass, look for solid, and
@@ -448,8 +469,10 @@ bool ImportOCAF2::createObject(App::Document *doc, TDF_Label label,
                 }
 
                 if(checkSubFaceColor) {
-                    for(TopExp_Explorer exp(subShape,TopAbs_FACE);exp.More();exp.Next()) {
-                        int idx = tshape.findShape(exp.Current())-1;
+                    std::vector<int> indices;
+                    if(!prepared)
+                        findSubShapes(tshape,subShape,TopAbs_FACE,indices);
+                    for(int idx : prepared?prepared->subFaces[i-1]:indices) {
                         if(idx>=0 && idx<(int)colors.faceColors.size()) {
                             colors.faceColors[idx] = faceColor;
                             hasFaceColors = true;
@@ -458,8 +481,10 @@ bool ImportOCAF2::createObject(App::Document *doc, TDF_Label label,
                     }
                 }
                 if(checkSubEdgeColor) {
-                    for(TopExp_Explorer exp(subShape,TopAbs_EDGE);exp.More();exp.Next()) {
-                        int idx = tshape.findShape(exp.Current())-1;
+                    std::vector<int> indices;
+                    if(!prepared)
+                        findSubShapes(tshape,subShape,TopAbs_EDGE,indices);
+                    for(int idx : prepared?prepared->subEdges[i-1]:indices) {
                         if(idx>=0 && idx<(int)colors.edgeColors.size()) {
                             colors.edgeColors[idx] = edgeColor;
                             hasEdgeColors = true;
@@ -484,16 +509,14 @@ bool ImportOCAF2::createObject(App::Document *doc, TDF_Label label,
     colors.hasFaceColor = info.hasFaceColor;
     colors.hasEdgeColor = info.hasEdgeColor;
 
-    if(expandCompound && !merge &&
-       (tshape.countSubShapes(TopAbs_SOLID)>1 || 
-        (!tshape.countSubShapes(TopAbs_SOLID) && tshape.countSubShapes(TopAbs_SHELL)>1)))
-    {
+    if(canExpand(tshape)) {
         feature = expandShape(doc,label,shape,colors);
         if(!feature)
             return false;
     } else {
         feature = static_cast<Part::Feature*>(doc->addObject("Part::Feature",tshape.shapeName().c_str()));
-        feature->Shape.setValue(shape);
+        // pass the TopoShape to keep its sub-shape cache
+        feature->Shape.setValue(tshape);
         // feature->Visibility.setValue(false);
     }
     applyFaceColors(feature,{info.faceColor});
@@ -508,6 +531,109 @@ bool ImportOCAF2::createObject(App::Document *doc, TDF_Label label,
     return true;
 }
 
+bool ImportOCAF2::canExpand(const Part::TopoShape &tshape) const {
+    return expandCompound && !merge &&
+        (tshape.countSubShapes(TopAbs_SOLID)>1 || 
+         (!tshape.countSubShapes(TopAbs_SOLID) && tshape.countSubShapes(TopAbs_SHELL)>1));
+}
+
+/// Collect the shapes that createObject() will be called with, in the same way
+/// as loadShape() and createAssembly() traverse the shapes. Shared instances are
+/// only collected once.
+void ImportOCAF2::collectShapes(const TopoDS_Shape &shape, std::vector<TopoDS_Shape> &shapes,
+        std::unordered_set<TopoDS_Shape, ShapeHasher> &visited)
+{
+    if(shape.IsNull())
+        return;
+    auto baseShape = shape.Located(TopLoc_Location());
+    if(!visited.insert(baseShape).second)
+        return;
+    auto baseLabel = aShapeTool->FindShape(baseShape);
+    if(baseLabel.IsNull() || !aShapeTool->IsAssembly(baseLabel)) {
+        shapes.push_back(baseShape);
+        return;
+    }
+    for(TopoDS_Iterator it(baseShape,0,0);it.More();it.Next())
+        collectShapes(it.Value(),shapes,visited);
+}
+
+/// Build the sub-shape index maps of a shape, and find the faces and edges of
+/// its colored sub-shapes. Runs in a worker thread and does not touch the OCAF
+/// document.
+void ImportOCAF2::prepareShape(PreparedShape &prepared)
+{
+    try {
+        for(auto type : {TopAbs_SOLID, TopAbs_SHELL, TopAbs_FACE, TopAbs_EDGE, TopAbs_VERTEX})
+            prepared.shape.countSubShapes(type);
+        prepared.subFaces.resize(prepared.subShapes.size());
+        prepared.subEdges.resize(prepared.subShapes.size());
+        for(std::size_t i=0;i<prepared.subShapes.size();++i) {
+            const auto &subShape = prepared.subShapes[i];
+            if(subShape.IsNull())
+                continue;
+            findSubShapes(prepared.shape,subShape,TopAbs_FACE,prepared.subFaces[i]);
+            findSubShapes(prepared.shape,subShape,TopAbs_EDGE,prepared.subEdges[i]);
+        }
+    } catch (...) {
+        // createObject() will try again on the main thread
+        prepared.subFaces.clear();
+        prepared.subEdges.clear();
+    }
+}
+
+/// Prepare the TopoShapes of the given shapes and of the sub-shapes expandShape()
+/// creates objects for in worker threads, including the sub-shape lookup for the
+/// color mapping. The labels and colors are read from the OCAF document on the
+/// main thread, where the document objects are still created in the order of the
+/// labels.
+void ImportOCAF2::prepareShapes(std::vector<TopoDS_Shape> shapes)
+{
+    // only the top level shapes are created with a label
+    bool topLevel = true;
+    while(shapes.size()) {
+        std::vector<PreparedShape> prepared;
+        prepared.reserve(shapes.size());
+        for(auto &shape : shapes) {
+            if(myPreparedShapes.count(shape))
+                continue;
+            prepared.emplace_back();
+            auto &entry = prepared.back();
+            entry.shape.setShape(shape);
+            if(!topLevel)
+                continue;
+            TDF_LabelSequence seq;
+            entry.label = aShapeTool->FindShape(shape);
+            if(!entry.label.IsNull() && aShapeTool->GetSubShapes(entry.label,seq)) {
+                for(int i=1;i<=seq.Length();++i)
+                    entry.subShapes.push_back(aShapeTool->GetShape(seq.Value(i)));
+            }
+        }
+        topLevel = false;
+        QtConcurrent::blockingMap(prepared,&ImportOCAF2::prepareShape);
+
+        std::vector<TopoDS_Shape> children;
+        for(auto &entry : prepared) {
+            const auto &tshape = entry.shape;
+            if(canExpand(tshape)) {
+                std::vector<TopoDS_Shape> compounds(1,tshape.getShape());
+                while(compounds.size()) {
+                    TopoDS_Shape compound = compounds.back();
+                    compounds.pop_back();
+                    for(TopoDS_Iterator it(compound);it.More();it.Next()) {
+                        if(it.Value().ShapeType() == TopAbs_COMPOUND)
+                            compounds.push_back(it.Value());
+                        else
+                            children.push_back(it.Value());
+                    }
+                }
+            }
+            TopoDS_Shape key = tshape.getShape();
+            myPreparedShapes.emplace(key,std::move(entry));
+        }
+        shapes = std::move(children);
+    }
+}
+
 App::Document *ImportOCAF2::getDocument(App::Document *doc, TDF_Label label) {
     if(filePath.empty() || mode==SingleDoc || merge)
         return doc;
@@ -631,6 +757,7 @@ App::DocumentObject* ImportOCAF2::loadShapes()
 
     labels.Clear();
     myShapes.clear();
+    myPreparedShapes.clear();
     myNames.clear();
     myCollapsedObjects.clear();
 
@@ -638,11 +765,20 @@ App::DocumentObject* ImportOCAF2::loadShapes()
     aShapeTool->GetFreeShapes (labels);
     boost::dynamic_bitset<> vis;
     int count = 0;
+    std::vector<TopoDS_Shape> shapes;
+    std::unordered_set<TopoDS_Shape, ShapeHasher> visited;
     for (Standard_Integer i=1; i <= labels.Length(); i++ ) {
         auto label = labels.Value(i);
         if(!importHidden && !aColorTool->IsVisible(label))
             continue;
         ++count;
+        if(parallel)
+            collectShapes(aShapeTool->GetShape(label),shapes,visited);
+    }
+    if(shapes.size()) {
+        FC_TIME_INIT(t);
+        prepareShapes(std::move(shapes));
+        FC_TIME_LOG(t,"prepared " << myPreparedShapes.size() << " shapes");
     }
     for (Standard_Integer i=1; i <= labels.Length(); i++ ) {
         auto label = labels.Value(i);
@@ -684,6 +820,7 @@ App::DocumentObject* ImportOCAF2::loadShapes()
         ret = feature;
         ret->recomputeFeature(true);
     }
+    myPreparedShapes.clear();
     sequencer = 0;
     return ret;
 }
@@ -33,6 +33,7 @@
 #include <set>
 #include <map>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 #include <App/Material.h>
 #include <App/Part.h>
@@ -81,6 +82,7 @@ public:
     void setReduceObjects(bool enable) {reduceObjects=enable;}
     void setShowProgress(bool enable) {showProgress=enable;}
     void setExpandCompound(bool enable) {expandCompound=enable;}
+    void setParallel(bool enable) {parallel=enable;}
 
     enum ImportMode {
         SingleDoc = 0,
@@ -107,6 +109,17 @@ private:
 
     struct ColorInfo;
 
+    /// A shape prepared in a worker thread by prepareShapes()
+    struct PreparedShape {
+        Part::TopoShape shape;
+        TDF_Label label;
+        /// The sub-shapes of the label, and the face and edge indices of
+        /// each of them in shape
+        std::vector<TopoDS_Shape> subShapes;
+        std::vector<std::vector<int> > subFaces;
+        std::vector<std::vector<int> > subEdges;
+    };
+
     App::DocumentObject *loadShape(App::Document *doc, TDF_Label label, 
             const TopoDS_Shape &shape, bool baseOnly=false, bool newDoc=true);
     App::Document *getDocument(App::Document *doc, TDF_Label label);
@@ -123,6 +136,11 @@ private:
     std::string getLabelName(TDF_Label label);
     Part::Feature *expandShape(App::Document *doc, TDF_Label label, 
             const TopoDS_Shape &shape, ColorInfo &colorInfo);
+    bool canExpand(const Part::TopoShape &shape) const;
+    void collectShapes(const TopoDS_Shape &shape, std::vector<TopoDS_Shape> &shapes,
+            std::unordered_set<TopoDS_Shape, ShapeHasher> &visited);
+    void prepareShapes(std::vector<TopoDS_Shape> shapes);
+    static void prepareShape(PreparedShape &prepared);
 
     virtual void applyEdgeColors(Part::Feature*, const std::vector<App::Color>&) {}
     virtual void applyFaceColors(Part::Feature*, const std::vector<App::Color>&) {}
@@ -158,11 +176,13 @@ private:
     bool reduceObjects;
     bool showProgress;
     bool expandCompound;
+    bool parallel;
 
     int mode;
     std::string filePath;
 
     std::unordered_map<TopoDS_Shape, Info, ShapeHasher> myShapes;
+    std::unordered_map<TopoDS_Shape, PreparedShape, ShapeHasher> myPreparedShapes;
     std::unordered_map<TDF_Label, std::string, LabelHasher> myNames;
     std::unordered_map<App::DocumentObject*, App::PropertyPlacement*> myCollapsedObjects;
 
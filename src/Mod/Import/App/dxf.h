@@ -245,6 +245,10 @@ public:
 class ImportExport CDxfRead{
 private:
     std::ifstream* m_ifs;
+    std::vector<char> m_buffer;     // read buffer, get_line() takes the lines from here
+    size_t m_buffer_pos;
+    size_t m_buffer_end;
+    bool m_eof;
 
     bool m_fail;
     char m_str[1024];
@@ -279,8 +283,11 @@ private:
     bool ReadDimension();
     bool ReadBlockInfo();
 
+    bool next_line(const char*& line, size_t& len);
     void get_line();
     void put_line(const char *value);
+    bool parse_value(double& value) const;
+    bool parse_value(int& value) const;
     void DerefACI();
 
 protected:
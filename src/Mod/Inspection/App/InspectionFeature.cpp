@@ -22,13 +22,28 @@
 
 
 #include "PreCompiled.h"
+#include <atomic>
 #include <numeric>
 #include <gp_Pnt.hxx>
+#include <BRepBuilderAPI_Copy.hxx>
 #include <BRepExtrema_DistShapeShape.hxx>
 #include <BRepBuilderAPI_MakeVertex.hxx>
 #include <BRepClass3d_SolidClassifier.hxx>
 #include <BRepGProp_Face.hxx>
+#include <BRepMesh_IncrementalMesh.hxx>
+#include <BRepTopAdaptor_FClass2d.hxx>
+#include <BRep_Builder.hxx>
+#include <BRep_Tool.hxx>
+#include <Poly_Triangulation.hxx>
+#include <Precision.hxx>
+#include <ShapeAnalysis_Surface.hxx>
+#include <TopExp.hxx>
+#include <TopExp_Explorer.hxx>
+#include <TopTools_IndexedDataMapOfShapeListOfShape.hxx>
+#include <TopTools_IndexedMapOfShape.hxx>
 #include <TopoDS.hxx>
+#include <TopoDS_Compound.hxx>
+#include <TopoDS_Face.hxx>
 #include <TopoDS_Vertex.hxx>
 
 #include <QEventLoop>
@@ -53,6 +68,7 @@
 #include <Mod/Mesh/App/Core/MeshKernel.h>
 #include <Mod/Points/App/PointsFeature.h>
 #include <Mod/Points/App/PointsGrid.h>
+#include <Mod/Points/App/PointTiles.h>
 #include <Mod/Part/App/PartFeature.h>
 
 #include "InspectionFeature.h"
@@ -403,9 +419,19 @@ float InspectNominalFastMesh::getDistance(const Base::Vector3f& point) const
 
 // ----------------------------------------------------------------
 
-InspectNominalPoints::InspectNominalPoints(const Points::PointKernel& Kernel, float /*offset*/)
+InspectNominalPoints::InspectNominalPoints(const Points::PointKernel& Kernel, float offset)
   : _rKernel(Kernel)
+  , _pGrid(0)
+  , _tiles(Kernel.getTiles())
+  , _fRadius(offset)
 {
+    if (_tiles) {
+        // the tiles are in the local coordinate system of the kernel
+        _clInvTrf = Kernel.getTransform();
+        _clInvTrf.inverseGauss();
+        return;
+    }
+
     int uGridPerAxis = 50; // totally 125.000 grid elements 
     this->_pGrid = new Points::PointsGrid (Kernel, uGridPerAxis);
 }
@@ -417,6 +443,9 @@ InspectNominalPoints::~InspectNominalPoints()
 
 float InspectNominalPoints::getDistance(const Base::Vector3f& point) const
 {
+    if (_tiles)
+        return getTileDistance(point);
+
     //TODO: Make faster
     std::set<unsigned long> indices;
     unsigned long x,y,z;
@@ -436,75 +465,363 @@ float InspectNominalPoints::getDistance(const Base::Vector3f& point) const
     return (float)fMinDist;
 }
 
+float InspectNominalPoints::getTileDistance(const Base::Vector3f& point) const
+{
+    // only points within the search radius matter
+    Base::Vector3f local = _clInvTrf * point;
+    Base::BoundBox3f box(local.x - _fRadius, local.y - _fRadius, local.z - _fRadius,
+                         local.x + _fRadius, local.y + _fRadius, local.z + _fRadius);
+
+    float fMinDist = FLT_MAX;
+    _tiles->visit(box, [&](const Points::PointTiles::value_type* pts, std::size_t count) {
+        for (std::size_t i=0; i<count; i++) {
+            float fDist = Base::DistanceP2(local, pts[i]);
+            if (fDist < fMinDist)
+                fMinDist = fDist;
+        }
+    });
+
+    return fMinDist < FLT_MAX ? std::sqrt(fMinDist) : FLT_MAX;
+}
+
 // ----------------------------------------------------------------
 
-InspectNominalShape::InspectNominalShape(const TopoDS_Shape& shape, float /*radius*/)
+namespace Inspection {
+/// Tessellation of the nominal shape to find the faces near a point
+struct InspectNominalShape::ShapeData
+{
+    // the tessellated copy of the shape
+    TopoDS_Shape shape;
+    std::vector<TopoDS_Face> faces;
+    MeshCore::MeshKernel mesh;
+    std::unique_ptr<MeshCore::MeshFacetGrid> grid;
+    std::vector<int> facetToFace;
+    // three uv parameters per facet, infinite if the triangulation has none
+    std::vector<gp_Pnt2d> facetUV;
+    // the edges and vertices without a face and the faces without triangulation
+    TopoDS_Shape freeShapes;
+    Base::BoundBox3f freeBox;
+};
+
+/// The objects used for projection and classification that must not be shared between threads
+struct InspectNominalShape::ThreadData
+{
+    std::unique_ptr<BRepClass3d_SolidClassifier> classifier;
+    std::vector<Handle(ShapeAnalysis_Surface)> surfaces;
+    std::vector<std::unique_ptr<BRepTopAdaptor_FClass2d> > domains;
+    BRepExtrema_DistShapeShape distss;
+    std::unique_ptr<BRepExtrema_DistShapeShape> freeDistss;
+};
+
+struct InspectNominalShape::Projection
+{
+    double distance;
+    gp_Pnt2d uv;
+    bool inFace;
+};
+}
+
+InspectNominalShape::InspectNominalShape(const TopoDS_Shape& shape, float radius)
     : _rShape(shape)
     , isSolid(false)
+    , radius(radius)
+    , deflection(0)
+    , data(new ShapeData)
 {
-    distss = new BRepExtrema_DistShapeShape();
-    distss->LoadS1(_rShape);
+    static std::atomic<unsigned long long> lastId(0);
+    instanceId = ++lastId;
+
+    if (_rShape.IsNull())
+        return;
 
-    // When having a solid then use its shell because otherwise the distance
-    // for inner points will always be zero
-    if (!_rShape.IsNull() && _rShape.ShapeType() == TopAbs_SOLID) {
+    // When having a solid then its shell is used for the distance because
+    // otherwise the distance for inner points will always be zero
+    if (_rShape.ShapeType() == TopAbs_SOLID) {
         TopExp_Explorer xp;
         xp.Init(_rShape, TopAbs_SHELL);
-        if (xp.More()) {
-           distss->LoadS1(xp.Current());
-           isSolid = true;
+        isSolid = xp.More();
+    }
+
+    ParameterGrp::handle hGrp = App::GetApplication().GetParameterGroupByPath
+        ("User parameter:BaseApp/Preferences/Mod/Part");
+    float deviation = hGrp->GetFloat("MeshDeviation",0.2);
+
+    Base::BoundBox3d bbox = Part::TopoShape(_rShape).getBoundBox();
+    deflection = (float)((bbox.LengthX() + bbox.LengthY() + bbox.LengthZ())/300.0 * deviation);
+    // do not replace the triangulation of the document's shape
+    data->shape = BRepBuilderAPI_Copy(_rShape).Shape();
+    BRepMesh_IncrementalMesh(data->shape, deflection);
+
+    MeshCore::MeshPointArray points;
+    MeshCore::MeshFacetArray facets;
+    std::vector<TopoDS_Shape> freeShapes;
+    TopTools_IndexedMapOfShape mapOfFaces;
+    TopExp::MapShapes(data->shape, TopAbs_FACE, mapOfFaces);
+    for (int i=1; i<=mapOfFaces.Extent(); i++) {
+        const TopoDS_Face& face = TopoDS::Face(mapOfFaces(i));
+        TopLoc_Location loc;
+        Handle(Poly_Triangulation) poly = BRep_Tool::Triangulation(face, loc);
+        if (poly.IsNull()) {
+            freeShapes.push_back(face);
+            continue;
         }
 
+        int faceIndex = (int)data->faces.size();
+        data->faces.push_back(face);
+
+        gp_Trsf trsf = loc.Transformation();
+        const TColgp_Array1OfPnt& nodes = poly->Nodes();
+        unsigned long offset = points.size();
+        for (int j=nodes.Lower(); j<=nodes.Upper(); j++) {
+            gp_Pnt p = nodes(j).Transformed(trsf);
+            points.push_back(MeshCore::MeshPoint(Base::Vector3f((float)p.X(), (float)p.Y(), (float)p.Z())));
+        }
+
+        bool hasUV = poly->HasUVNodes();
+        const Poly_Array1OfTriangle& triangles = poly->Triangles();
+        for (int j=triangles.Lower(); j<=triangles.Upper(); j++) {
+            Standard_Integer n[3];
+            triangles(j).Get(n[0], n[1], n[2]);
+            facets.push_back(MeshCore::MeshFacet(offset + n[0] - nodes.Lower(),
+                                                 offset + n[1] - nodes.Lower(),
+                                                 offset + n[2] - nodes.Lower()));
+            data->facetToFace.push_back(faceIndex);
+            for (int k=0; k<3; k++) {
+                data->facetUV.push_back(hasUV ? poly->UVNodes()(n[k])
+                                              : gp_Pnt2d(Precision::Infinite(), Precision::Infinite()));
+            }
+        }
     }
-    //distss->SetDeflection(radius);
+
+    // wires, edges and vertices are not covered by the tessellation
+    TopTools_IndexedDataMapOfShapeListOfShape edgeFaces;
+    TopExp::MapShapesAndAncestors(data->shape, TopAbs_EDGE, TopAbs_FACE, edgeFaces);
+    for (int i=1; i<=edgeFaces.Extent(); i++) {
+        if (edgeFaces(i).IsEmpty())
+            freeShapes.push_back(edgeFaces.FindKey(i));
+    }
+    TopTools_IndexedDataMapOfShapeListOfShape vertexEdges;
+    TopExp::MapShapesAndAncestors(data->shape, TopAbs_VERTEX, TopAbs_EDGE, vertexEdges);
+    for (int i=1; i<=vertexEdges.Extent(); i++) {
+        if (vertexEdges(i).IsEmpty())
+            freeShapes.push_back(vertexEdges.FindKey(i));
+    }
+    if (!freeShapes.empty()) {
+        TopoDS_Compound comp;
+        BRep_Builder builder;
+        builder.MakeCompound(comp);
+        for (auto it = freeShapes.begin(); it != freeShapes.end(); ++it)
+            builder.Add(comp, *it);
+        data->freeShapes = comp;
+        Base::BoundBox3d freeBox = Part::TopoShape(comp).getBoundBox();
+        data->freeBox = Base::BoundBox3f((float)freeBox.MinX, (float)freeBox.MinY, (float)freeBox.MinZ,
+                                         (float)freeBox.MaxX, (float)freeBox.MaxY, (float)freeBox.MaxZ);
+        data->freeBox.Enlarge(radius);
+    }
+
+    if (facets.empty())
+        return;
+    data->mesh.Adopt(points, facets);
+
+    // Max. limit of grid elements
+    float fMaxGridElements=8000000.0f;
+    Base::BoundBox3f box = data->mesh.GetBoundBox();
+
+    // estimate the minimum allowed grid length
+    float fMinGridLen = (float)pow((box.LengthX()*box.LengthY()*box.LengthZ()/fMaxGridElements), 0.3333f);
+    float fGridLen = 5.0f * MeshCore::MeshAlgorithm(data->mesh).GetAverageEdgeLength();
+    fGridLen = std::max<float>(fMinGridLen, fGridLen);
+
+    data->grid.reset(new MeshCore::MeshFacetGrid(data->mesh, fGridLen));
+    _box = box;
+    _box.Enlarge(radius + deflection);
 }
 
 InspectNominalShape::~InspectNominalShape()
 {
-    delete distss;
+}
+
+InspectNominalShape::ThreadData& InspectNominalShape::getThreadData() const
+{
+    // A thread usually works for a few instances at the same time, so the
+    // last ones are cached to avoid locking for every point. The entries of
+    // deleted instances are never used again because the ids are unique.
+    struct CacheEntry {
+        unsigned long long id;
+        ThreadData* td;
+    };
+    const int cacheSize = 8;
+    static thread_local CacheEntry cache[cacheSize] = {};
+    static thread_local int next = 0;
+    for (int i=0; i<cacheSize; i++) {
+        if (cache[i].id == instanceId)
+            return *cache[i].td;
+    }
+
+    ThreadData* res;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::unique_ptr<ThreadData>& td = threadData[std::this_thread::get_id()];
+        if (!td) {
+            td.reset(new ThreadData);
+            td->surfaces.resize(data->faces.size());
+            td->domains.resize(data->faces.size());
+            if (isSolid)
+                td->classifier.reset(new BRepClass3d_SolidClassifier(data->shape));
+        }
+        res = td.get();
+    }
+    cache[next].id = instanceId;
+    cache[next].td = res;
+    next = (next + 1) % cacheSize;
+    return *res;
+}
+
+bool InspectNominalShape::projectOnFace(ThreadData& td, int index, const gp_Pnt& pnt,
+                                        const gp_Pnt2d& seed, Projection& proj) const
+{
+    const TopoDS_Face& face = data->faces[index];
+    const Standard_Real tol = Precision::Confusion();
+
+    Handle(ShapeAnalysis_Surface)& surface = td.surfaces[index];
+    if (surface.IsNull())
+        surface = new ShapeAnalysis_Surface(BRep_Tool::Surface(face));
+    std::unique_ptr<BRepTopAdaptor_FClass2d>& domain = td.domains[index];
+    if (!domain)
+        domain.reset(new BRepTopAdaptor_FClass2d(face, tol));
+
+    // the parameters of the nearest triangle are a good start value for the projection
+    if (Precision::IsInfinite(seed.X()))
+        proj.uv = surface->ValueOfUV(pnt, tol);
+    else
+        proj.uv = surface->NextValueOfUV(seed, pnt, tol);
+
+    if (domain->Perform(proj.uv) != TopAbs_OUT) {
+        proj.distance = pnt.Distance(surface->Value(proj.uv));
+        proj.inFace = true;
+        return true;
+    }
+
+    // the nearest point is on the boundary of the face
+    BRepBuilderAPI_MakeVertex mkVert(pnt);
+    td.distss.LoadS1(face);
+    td.distss.LoadS2(mkVert.Vertex());
+    if (!td.distss.Perform() || td.distss.NbSolution() < 1)
+        return false;
+
+    proj.distance = td.distss.Value();
+    proj.inFace = td.distss.SupportTypeShape1(1) == BRepExtrema_IsInFace;
+    if (proj.inFace) {
+        Standard_Real u, v;
+        td.distss.ParOnFaceS1(1, u, v);
+        proj.uv.SetCoord(u, v);
+    }
+    return true;
 }
 
 float InspectNominalShape::getDistance(const Base::Vector3f& point) const
 {
-    gp_Pnt pnt3d(point.x,point.y,point.z);
-    BRepBuilderAPI_MakeVertex mkVert(pnt3d);
-    distss->LoadS2(mkVert.Vertex());
+    float fMinDist = getFaceDistance(point);
+    if (data->freeShapes.IsNull() || !data->freeBox.IsInBox(point))
+        return fMinDist;
 
-    float fMinDist=FLT_MAX;
-    if (distss->Perform() && distss->NbSolution() > 0) {
-        fMinDist = (float)distss->Value();
-        // the shape is a solid, check if the vertex is inside
-        if (isSolid) {
-            const Standard_Real tol = 0.001;
-            BRepClass3d_SolidClassifier classifier(_rShape);
-            classifier.Perform(pnt3d, tol);
-            if (classifier.State() == TopAbs_IN) {
-                fMinDist = -fMinDist;
-            }
+    // the shapes without tessellation are rare, so they are checked directly
+    ThreadData& td = getThreadData();
+    if (!td.freeDistss) {
+        td.freeDistss.reset(new BRepExtrema_DistShapeShape);
+        td.freeDistss->LoadS1(data->freeShapes);
+    }
+    BRepBuilderAPI_MakeVertex mkVert(gp_Pnt(point.x,point.y,point.z));
+    td.freeDistss->LoadS2(mkVert.Vertex());
+    if (!td.freeDistss->Perform() || td.freeDistss->NbSolution() < 1)
+        return fMinDist;
 
+    float fDist = (float)td.freeDistss->Value();
+    if (fDist > radius || fDist >= std::fabs(fMinDist))
+        return fMinDist;
+    return fDist;
+}
+
+float InspectNominalShape::getFaceDistance(const Base::Vector3f& point) const
+{
+    if (!data->grid || !_box.IsInBox(point))
+        return FLT_MAX; // must be inside bbox
+
+    unsigned long nearest = data->grid->SearchNearestFromPoint(point, radius + deflection);
+    if (nearest == ULONG_MAX)
+        return FLT_MAX;
+
+    // The surfaces deviate from the tessellation by at most the deflection, so
+    // the nearest point lies on a face with a triangle inside this distance
+    float limit = data->mesh.GetFacet(nearest).DistanceToPoint(point) + 2.0f * deflection;
+    Base::BoundBox3f box(point.x - limit, point.y - limit, point.z - limit,
+                         point.x + limit, point.y + limit, point.z + limit);
+    std::vector<unsigned long> candidates;
+    data->grid->Inside(box, candidates, true);
+
+    // per face the parameters of the nearest point of its nearest triangle
+    std::map<int, std::pair<float, gp_Pnt2d> > seeds;
+    for (std::vector<unsigned long>::iterator it = candidates.begin(); it != candidates.end(); ++it) {
+        MeshCore::MeshGeomFacet facet = data->mesh.GetFacet(*it);
+        Base::Vector3f foot;
+        float dist = facet.DistanceToPoint(point, foot);
+        if (dist > limit)
+            continue;
+
+        int face = data->facetToFace[*it];
+        auto seed = seeds.find(face);
+        if (seed != seeds.end() && seed->second.first <= dist)
+            continue;
+
+        const gp_Pnt2d* uv = &data->facetUV[3 * (*it)];
+        float w0, w1, w2;
+        facet.Weights(foot, w0, w1, w2);
+        gp_Pnt2d start = uv[0];
+        if (!Precision::IsInfinite(start.X())) {
+            start.SetCoord(w0 * uv[0].X() + w1 * uv[1].X() + w2 * uv[2].X(),
+                           w0 * uv[0].Y() + w1 * uv[1].Y() + w2 * uv[2].Y());
         }
-        else if (fMinDist > 0) {
-            // check if the distance was compued from a face
-            for (Standard_Integer index = 1; index <= distss->NbSolution(); index++) {
-                if (distss->SupportTypeShape1(index) == BRepExtrema_IsInFace) {
-                    TopoDS_Shape face = distss->SupportOnShape1(index);
-                    Standard_Real u, v;
-                    distss->ParOnFaceS1(index, u, v);
-                    //gp_Pnt pnt = distss->PointOnShape1(index);
-                    BRepGProp_Face props(TopoDS::Face(face));
-                    gp_Vec normal;
-                    gp_Pnt center;
-                    props.Normal(u, v, center, normal);
-                    gp_Vec dir(center, pnt3d);
-                    Standard_Real scalar = normal.Dot(dir);
-                    if (scalar < 0) {
-                        fMinDist = -fMinDist;
-                    }
-                    break;
-                }
+        seeds[face] = std::make_pair(dist, start);
+    }
+
+    ThreadData& td = getThreadData();
+    gp_Pnt pnt3d(point.x,point.y,point.z);
+    Projection best;
+    int bestFace = -1;
+    for (auto it = seeds.begin(); it != seeds.end(); ++it) {
+        Projection proj;
+        if (projectOnFace(td, it->first, pnt3d, it->second.second, proj)) {
+            if (bestFace < 0 || proj.distance < best.distance) {
+                best = proj;
+                bestFace = it->first;
             }
         }
     }
+
+    if (bestFace < 0)
+        return FLT_MAX;
+
+    float fMinDist = (float)best.distance;
+    // the shape is a solid, check if the vertex is inside
+    if (isSolid) {
+        const Standard_Real tol = 0.001;
+        td.classifier->Perform(pnt3d, tol);
+        if (td.classifier->State() == TopAbs_IN) {
+            fMinDist = -fMinDist;
+        }
+    }
+    else if (fMinDist > 0 && best.inFace) {
+        // the distance was computed from a face
+        BRepGProp_Face props(data->faces[bestFace]);
+        gp_Vec normal;
+        gp_Pnt center;
+        props.Normal(best.uv.X(), best.uv.Y(), center, normal);
+        gp_Vec dir(center, pnt3d);
+        Standard_Real scalar = normal.Dot(dir);
+        if (scalar < 0) {
+            fMinDist = -fMinDist;
+        }
+    }
     return fMinDist;
 }
 
@@ -613,7 +930,6 @@ App::DocumentObjectExecReturn* Feature::execute(void)
         actual = new InspectActualPoints(pts->Points.getValue());
     }
     else if (pcActual->getTypeId().isDerivedFrom(Part::Feature::getClassTypeId())) {
-        useMultithreading = false;
         Part::Feature* part = static_cast<Part::Feature*>(pcActual);
         actual = new InspectActualShape(part->Shape.getShape());
     }
@@ -635,7 +951,6 @@ App::DocumentObjectExecReturn* Feature::execute(void)
             nominal = new InspectNominalPoints(pts->Points.getValue(), this->SearchRadius.getValue());
         }
         else if ((*it)->getTypeId().isDerivedFrom(Part::Feature::getClassTypeId())) {
-            useMultithreading = false;
             Part::Feature* part = static_cast<Part::Feature*>(*it);
             nominal = new InspectNominalShape(part->Shape.getValue(), this->SearchRadius.getValue());
         }
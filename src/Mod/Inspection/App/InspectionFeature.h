@@ -24,6 +24,11 @@
 #ifndef INSPECTION_FEATURE_H
 #define INSPECTION_FEATURE_H
 
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+
 #include <App/DocumentObject.h>
 #include <App/PropertyLinks.h>
 #include <App/PropertyStandard.h>
@@ -33,7 +38,8 @@
 #include <Mod/Points/App/Points.h>
 
 class TopoDS_Shape;
-class BRepExtrema_DistShapeShape;
+class gp_Pnt;
+class gp_Pnt2d;
 
 namespace MeshCore {
 class MeshKernel;
@@ -41,7 +47,7 @@ class MeshGrid;
 }
 
 namespace Mesh   { class MeshObject; }
-namespace Points { class PointsGrid; }
+namespace Points { class PointsGrid; class PointTiles; }
 namespace Part   { class TopoShape;  }
 
 namespace Inspection
@@ -72,6 +78,9 @@ private:
     Base::Matrix4D _clTrf;
 };
 
+/** For out-of-core point clouds the resident overview is inspected, because
+ * that is what is displayed and colored by the distances.
+ */
 class InspectionExport InspectActualPoints : public InspectActualGeometry
 {
 public:
@@ -135,6 +144,9 @@ protected:
     Base::Matrix4D _clTrf;
 };
 
+/** For out-of-core point clouds the tiles near a point are loaded on demand,
+ * so the distance is computed to the points at full resolution.
+ */
 class InspectionExport InspectNominalPoints : public InspectNominalGeometry
 {
 public:
@@ -142,11 +154,24 @@ public:
     ~InspectNominalPoints();
     virtual float getDistance(const Base::Vector3f&) const;
 
+private:
+    float getTileDistance(const Base::Vector3f&) const;
+
 private:
     const Points::PointKernel& _rKernel;
     Points::PointsGrid* _pGrid;
+    std::shared_ptr<Points::PointTiles> _tiles;
+    Base::Matrix4D _clInvTrf;
+    float _fRadius;
 };
 
+/** The shape is tessellated once to find the faces near a point quickly.
+ * The distance is then refined on the exact surfaces, seeded with the
+ * parameters of the nearest triangles. A copy of the shape is tessellated,
+ * so the triangulation of the document's shape stays untouched. The
+ * projection and classification objects are not thread-safe, so every
+ * thread gets its own set of them, found through a thread local cache.
+ */
 class InspectionExport InspectNominalShape : public InspectNominalGeometry
 {
 public:
@@ -155,9 +180,24 @@ public:
     virtual float getDistance(const Base::Vector3f&) const;
 
 private:
-    BRepExtrema_DistShapeShape* distss;
+    struct ShapeData;
+    struct ThreadData;
+    struct Projection;
+    ThreadData& getThreadData() const;
+    float getFaceDistance(const Base::Vector3f&) const;
+    bool projectOnFace(ThreadData&, int face, const gp_Pnt&, const gp_Pnt2d& seed, Projection&) const;
+
+private:
     const TopoDS_Shape& _rShape;
     bool isSolid;
+    float radius;
+    float deflection;
+    Base::BoundBox3f _box;
+    std::unique_ptr<ShapeData> data;
+    // unique over all instances to identify the entries of the thread local cache
+    unsigned long long instanceId;
+    mutable std::mutex mutex;
+    mutable std::map<std::thread::id, std::unique_ptr<ThreadData> > threadData;
 };
 
 class InspectionExport PropertyDistanceList: public App::_PropertyFloatList
@@ -0,0 +1,73 @@
+#**************************************************************************
+#   Copyright (c) 2021 FreeCAD Developers                                 *
+#                                                                         *
+#   This file is part of the FreeCAD CAx development system.              *
+#                                                                         *
+#   This program is free software; you can redistribute it and/or modify  *
+#   it under the terms of the GNU Lesser General Public License (LGPL)    *
+#   as published by the Free Software Foundation; either version 2 of     *
+#   the License, or (at your option) any later version.                   *
+#   for detail see the LICENCE text file.                                 *
+#                                                                         *
+#   FreeCAD is distributed in the hope that it will be useful,            *
+#   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+#   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+#   GNU Library General Public License for more details.                  *
+#                                                                         *
+#   You should have received a copy of the GNU Library General Public     *
+#   License along with FreeCAD; if not, write to the Free Software        *
+#   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  *
+#   USA                                                                   *
+#**************************************************************************
+
+import FreeCAD, unittest, Part, Points
+import Inspection
+from FreeCAD import Vector
+
+#---------------------------------------------------------------------------
+# define the test cases to test the FreeCAD Inspection module
+#---------------------------------------------------------------------------
+
+
+class InspectionNominalShapeCases(unittest.TestCase):
+    def setUp(self):
+        self.Doc = FreeCAD.newDocument("InspectionTest")
+        self.Actual = self.Doc.addObject("Points::Feature","Actual")
+        self.Actual.Points = Points.Points([Vector(5,0.5,0), Vector(5,0,0.3), Vector(5,3,0)])
+
+    def inspect(self, shape, radius):
+        nominal = self.Doc.addObject("Part::Feature","Nominal")
+        nominal.Shape = shape
+        inspection = self.Doc.addObject("Inspection::Feature","Inspection")
+        inspection.Actual = self.Actual
+        inspection.Nominals = [nominal]
+        inspection.SearchRadius = radius
+        self.Doc.recompute()
+        return inspection.Distances
+
+    def testWire(self):
+        wire = Part.makePolygon([Vector(0,0,0), Vector(10,0,0), Vector(10,10,0)])
+        dist = self.inspect(wire, 1.0)
+        self.assertAlmostEqual(dist[0], 0.5, places=4)
+        self.assertAlmostEqual(dist[1], 0.3, places=4)
+        # outside of the search radius
+        self.assertGreater(dist[2], 1e30)
+
+    def testVertex(self):
+        dist = self.inspect(Part.Vertex(Vector(5,0,0)), 1.0)
+        self.assertAlmostEqual(dist[0], 0.5, places=4)
+        self.assertAlmostEqual(dist[1], 0.3, places=4)
+        self.assertGreater(dist[2], 1e30)
+
+    def testFaceAndWire(self):
+        face = Part.makePlane(10, 10, Vector(0,0,-1))
+        edge = Part.makeLine(Vector(0,0,0), Vector(10,0,0))
+        dist = self.inspect(Part.makeCompound([face, edge]), 2.0)
+        # the free edge is nearer than the face
+        self.assertAlmostEqual(dist[0], 0.5, places=4)
+        self.assertAlmostEqual(dist[1], 0.3, places=4)
+        # the face is nearer than the free edge
+        self.assertAlmostEqual(dist[2], 1.0, places=4)
+
+    def tearDown(self):
+        FreeCAD.closeDocument(self.Doc.Name)
@@ -19,36 +19,100 @@
  *   Suite 330, Boston, MA  02111-1307, USA                                *
  *                                                                         *
  ***************************************************************************/
-
 #include "PreCompiled.h"
 #ifndef _PreComp_
 # include <algorithm>
 #endif
 
-#include <QFuture>
-#include <QFutureWatcher>
 #include <QtConcurrentMap>
-#include <boost_bind_bind.hpp>
 
-//#define OPTIMIZE_CURVATURE
-#ifdef OPTIMIZE_CURVATURE
-#include <Eigen/Eigenvalues>
-#else
+#include <Mod/Mesh/App/WildMagic4/Wm4Vector2.h>
 #include <Mod/Mesh/App/WildMagic4/Wm4Vector3.h>
-#include <Mod/Mesh/App/WildMagic4/Wm4MeshCurvature.h>
-#endif
+#include <Mod/Mesh/App/WildMagic4/Wm4Matrix2.h>
+#include <Mod/Mesh/App/WildMagic4/Wm4Matrix3.h>
 
 #include "Curvature.h"
-#include "Algorithm.h"
 #include "Approximation.h"
 #include "MeshKernel.h"
-#include "Iterator.h"
 #include "Tools.h"
 #include <Base/Sequencer.h>
 #include <Base/Tools.h>
 
 using namespace MeshCore;
-namespace bp = boost::placeholders;
+
+namespace {
+// Number of vertices resp. facets handled by one parallel task
+const unsigned long VertexBlockSize = 4096;
+const unsigned long FacetBlockSize = 256;
+
+struct IndexRange
+{
+    unsigned long first, last;
+};
+
+std::vector<IndexRange> makeRanges(unsigned long count, unsigned long blockSize)
+{
+    std::vector<IndexRange> ranges;
+    ranges.reserve(count / blockSize + 1);
+    for (unsigned long i = 0; i < count; i += blockSize) {
+        IndexRange r;
+        r.first = i;
+        r.last = std::min<unsigned long>(i + blockSize, count);
+        ranges.push_back(r);
+    }
+    return ranges;
+}
+
+inline Wm4::Vector3<double> toVector3d(const Base::Vector3f& p)
+{
+    return Wm4::Vector3<double>(p.x, p.y, p.z);
+}
+}
+
+// --------------------------------------------------------
+
+PointFacetAdjacency::PointFacetAdjacency()
+{
+}
+
+PointFacetAdjacency::PointFacetAdjacency(const MeshKernel& kernel)
+{
+    Rebuild(kernel);
+}
+
+void PointFacetAdjacency::Rebuild(const MeshKernel& kernel)
+{
+    const MeshFacetArray& rFacets = kernel.GetFacets();
+    unsigned long numPoints = kernel.CountPoints();
+
+    // count the facets of each point and turn the counts into offsets
+    myOffsets.assign(numPoints + 1, 0);
+    for (MeshFacetArray::_TConstIterator it = rFacets.begin(); it != rFacets.end(); ++it) {
+        const unsigned long* p = it->_aulPoints;
+        myOffsets[p[0] + 1]++;
+        if (p[1] != p[0])
+            myOffsets[p[1] + 1]++;
+        if (p[2] != p[0] && p[2] != p[1])
+            myOffsets[p[2] + 1]++;
+    }
+    for (unsigned long i = 0; i < numPoints; i++)
+        myOffsets[i + 1] += myOffsets[i];
+
+    // the facets are visited in ascending order so that each row is sorted
+    myFacets.resize(myOffsets[numPoints]);
+    std::vector<unsigned long> fill(myOffsets.begin(), myOffsets.end() - 1);
+    unsigned long index = 0;
+    for (MeshFacetArray::_TConstIterator it = rFacets.begin(); it != rFacets.end(); ++it, ++index) {
+        const unsigned long* p = it->_aulPoints;
+        myFacets[fill[p[0]]++] = index;
+        if (p[1] != p[0])
+            myFacets[fill[p[1]]++] = index;
+        if (p[2] != p[0] && p[2] != p[1])
+            myFacets[fill[p[2]]++] = index;
+    }
+}
+
+// --------------------------------------------------------
 
 MeshCurvature::MeshCurvature(const MeshKernel& kernel)
   : myKernel(kernel), myMinPoints(20), myRadius(0.5f)
@@ -62,341 +126,306 @@ MeshCurvature::MeshCurvature(const MeshKernel& kernel, const std::vector<unsigne
 {
 }
 
+const PointFacetAdjacency& MeshCurvature::GetAdjacency()
+{
+    // build the neighbourhood once and share it between per-face and per-vertex computation
+    if (myAdjacency.CountPoints() != myKernel.CountPoints())
+        myAdjacency.Rebuild(myKernel);
+    return myAdjacency;
+}
+
 void MeshCurvature::ComputePerFace(bool parallel)
 {
-    Base::Vector3f rkDir0, rkDir1, rkPnt;
-    Base::Vector3f rkNormal;
     myCurvature.clear();
-    MeshRefPointToFacets search(myKernel);
-    FacetCurvature face(myKernel, search, myRadius, myMinPoints);
+    FacetCurvature face(myKernel, GetAdjacency(), myRadius, myMinPoints);
+
+    myCurvature.resize(mySegment.size());
+    std::vector<IndexRange> ranges = makeRanges(mySegment.size(), FacetBlockSize);
+    const unsigned long* segm = mySegment.data();
+    CurvatureInfo* curv = myCurvature.data();
 
     if (!parallel) {
-        Base::SequencerLauncher seq("Curvature estimation", mySegment.size());
-        for (std::vector<unsigned long>::iterator it = mySegment.begin(); it != mySegment.end(); ++it) {
-            CurvatureInfo info = face.Compute(*it);
-            myCurvature.push_back(info);
+        Base::SequencerLauncher seq("Curvature estimation", ranges.size());
+        for (std::vector<IndexRange>::iterator it = ranges.begin(); it != ranges.end(); ++it) {
+            face.Compute(segm + it->first, segm + it->last, curv + it->first);
             seq.next();
         }
     }
     else {
-        QFuture<CurvatureInfo> future = QtConcurrent::mapped
-            (mySegment, boost::bind(&FacetCurvature::Compute, &face, bp::_1));
-        QFutureWatcher<CurvatureInfo> watcher;
-        watcher.setFuture(future);
-        watcher.waitForFinished();
-        for (QFuture<CurvatureInfo>::const_iterator it = future.begin(); it != future.end(); ++it) {
-            myCurvature.push_back(*it);
-        }
+        QtConcurrent::blockingMap(ranges, [&](const IndexRange& r) {
+            face.Compute(segm + r.first, segm + r.last, curv + r.first);
+        });
     }
 }
 
-#ifdef OPTIMIZE_CURVATURE
-namespace MeshCore {
-void GenerateComplementBasis (Eigen::Vector3f& rkU, Eigen::Vector3f& rkV,
-                              const Eigen::Vector3f& rkW)
-{
-    float fInvLength;
-
-    if (fabs(rkW[0]) >= fabs(rkW[1]))
-    {
-        // W.x or W.z is the largest magnitude component, swap them
-        fInvLength = 1.0/sqrt(rkW[0]*rkW[0] + rkW[2]*rkW[2]);
-        rkU[0] = -rkW[2]*fInvLength;
-        rkU[1] =  0.0;
-        rkU[2] = +rkW[0]*fInvLength;
-        rkV[0] = rkW[1]*rkU[2];
-        rkV[1] =  rkW[2]*rkU[0] - rkW[0]*rkU[2];
-        rkV[2] = -rkW[1]*rkU[0];
-    }
-    else
-    {
-        // W.y or W.z is the largest magnitude component, swap them
-        fInvLength = 1.0/sqrt(rkW[1]*rkW[1] + rkW[2]*rkW[2]);
-        rkU[0] =  0.0;
-        rkU[1] = +rkW[2]*fInvLength;
-        rkU[2] = -rkW[1]*fInvLength;
-        rkV[0] =  rkW[1]*rkU[2] - rkW[2]*rkU[1];
-        rkV[1] = -rkW[0]*rkU[2];
-        rkV[2] =  rkW[0]*rkU[1];
-    }
-}
-}
-
 void MeshCurvature::ComputePerVertex()
 {
-    // get all points
-    const MeshPointArray& pts = myKernel.GetPoints();
+    // This is the estimation of Wm4::MeshCurvature but instead of accumulating the
+    // matrices of all vertices over the triangles each vertex gathers its own
+    // triangles. So the vertices can be computed in parallel and only the normals
+    // need to be stored. The triangles of a vertex are visited in the same order as
+    // in Wm4::MeshCurvature and thus the results are identical.
+    myCurvature.clear();
 
-    MeshCore::MeshRefPointToFacets pt2f(myKernel);
-    MeshCore::MeshRefPointToPoints pt2p(myKernel);
-    unsigned long numPoints = myKernel.CountPoints();
+    // in case of an empty mesh no curvature can be calculated
+    if (myKernel.CountPoints() == 0 || myKernel.CountFacets() == 0)
+        return;
 
-    myCurvature.clear();
-    myCurvature.reserve(numPoints);
-
-    std::vector<Eigen::Vector3f> akNormal(numPoints);
-    std::vector<Eigen::Vector3f> akVertex(numPoints);
-    for (unsigned long i=0; i<numPoints; i++) {
-        Base::Vector3f n = pt2f.GetNormal(i);
-        akNormal[i][0] = n.x;
-        akNormal[i][1] = n.y;
-        akNormal[i][2] = n.z;
-        const Base::Vector3f& p = pts[i];
-        akVertex[i][0] = p.x;
-        akVertex[i][1] = p.y;
-        akVertex[i][2] = p.z;
-    }
+    const PointFacetAdjacency& adjacency = GetAdjacency();
+    const MeshPointArray& rPoints = myKernel.GetPoints();
+    const MeshFacetArray& rFacets = myKernel.GetFacets();
+    unsigned long numPoints = myKernel.CountPoints();
 
-    // One could iterate over the triangles and then for each vertex of a triangle compute the derivates.
-    // One could also iterate over the points and then for each adjacent point calculate the derivates.
-    // Both methods must lead to the same values in the above matrices.
-    //
-    // Iterate over the vertexes
-    for (unsigned long i=0; i<numPoints; i++) {
-        Eigen::Matrix3f akDNormal;
-        akDNormal.setZero();
-        Eigen::Matrix3f akWWTrn;
-        akWWTrn.setZero();
-        Eigen::Matrix3f akDWTrn;
-        akDWTrn.setZero();
-
-        int iV0 = i;
-        int iV1;
-        const std::set<unsigned long>& nb = pt2p[i];
-        for (std::set<unsigned long>::const_iterator it = nb.begin(); it != nb.end(); ++it) {
-            iV1 = *it;
-
-            // Compute edge from V0 to V1, project to tangent plane of vertex,
-            // and compute difference of adjacent normals.
-            Eigen::Vector3f kE = akVertex[iV1] - akVertex[iV0];
-            Eigen::Vector3f kW = kE - (kE.dot(akNormal[iV0]))*akNormal[iV0];
-            Eigen::Vector3f kD = akNormal[iV1] - akNormal[iV0];
-            for (int iRow = 0; iRow < 3; iRow++)
-            {
-                for (int iCol = 0; iCol < 3; iCol++)
-                {
-                    akWWTrn(iRow,iCol) += 2*kW[iRow]*kW[iCol];
-                    akDWTrn(iRow,iCol) += 2*kD[iRow]*kW[iCol];
+    std::vector< Wm4::Vector3<double> > normals(numPoints);
+    myCurvature.resize(numPoints);
+    std::vector<IndexRange> ranges = makeRanges(numPoints, VertexBlockSize);
+
+    // compute normal vectors (the length of a triangle normal provides a weighted sum)
+    QtConcurrent::blockingMap(ranges, [&](const IndexRange& r) {
+        for (unsigned long i = r.first; i < r.last; i++) {
+            Wm4::Vector3<double> kSum(0.0, 0.0, 0.0);
+            for (const unsigned long* it = adjacency.begin(i); it != adjacency.end(i); ++it) {
+                const unsigned long* aiV = rFacets[*it]._aulPoints;
+                Wm4::Vector3<double> kV0 = toVector3d(rPoints[aiV[0]]);
+                Wm4::Vector3<double> kEdge1 = toVector3d(rPoints[aiV[1]]) - kV0;
+                Wm4::Vector3<double> kEdge2 = toVector3d(rPoints[aiV[2]]) - kV0;
+                Wm4::Vector3<double> kNormal = kEdge1.Cross(kEdge2);
+                for (int j = 0; j < 3; j++) {
+                    if (aiV[j] == i)
+                        kSum += kNormal;
                 }
             }
+            kSum.Normalize();
+            normals[i] = kSum;
         }
+    });
+
+    // compute the matrix of normal derivatives and the principal curvatures
+    QtConcurrent::blockingMap(ranges, [&](const IndexRange& r) {
+        for (unsigned long i = r.first; i < r.last; i++) {
+            const Wm4::Vector3<double>& kN = normals[i];
+            Wm4::Vector3<double> kP = toVector3d(rPoints[i]);
+            Wm4::Matrix3<double> kWWTrn(true);
+            Wm4::Matrix3<double> kDWTrn(true);
+
+            for (const unsigned long* it = adjacency.begin(i); it != adjacency.end(i); ++it) {
+                const unsigned long* aiV = rFacets[*it]._aulPoints;
+                for (int j = 0; j < 3; j++) {
+                    if (aiV[j] != i)
+                        continue;
+
+                    // Compute the edges from V0 to V1 and V2, project them to the tangent
+                    // plane of the vertex, and compute difference of adjacent normals.
+                    for (int k = 1; k < 3; k++) {
+                        unsigned long iV = aiV[(j+k)%3];
+                        Wm4::Vector3<double> kE = toVector3d(rPoints[iV]) - kP;
+                        Wm4::Vector3<double> kW = kE - (kE.Dot(kN))*kN;
+                        Wm4::Vector3<double> kD = normals[iV] - kN;
+                        for (int iRow = 0; iRow < 3; iRow++) {
+                            for (int iCol = 0; iCol < 3; iCol++) {
+                                kWWTrn[iRow][iCol] += kW[iRow]*kW[iCol];
+                                kDWTrn[iRow][iCol] += kD[iRow]*kW[iCol];
+                            }
+                        }
+                    }
+                }
+            }
 
-        // Add in N*N^T to W*W^T for numerical stability.  In theory 0*0^T gets
-        // added to D*W^T, but of course no update needed in the implementation.
-        // Compute the matrix of normal derivatives.
-        for (int iRow = 0; iRow < 3; iRow++)
-        {
-            for (int iCol = 0; iCol < 3; iCol++)
-            {
-                akWWTrn(iRow,iCol) = 0.5*akWWTrn(iRow,iCol) + akNormal[i][iRow]*akNormal[i][iCol];
-                akDWTrn(iRow,iCol) *= 0.5;
+            // Add in N*N^T to W*W^T for numerical stability.
+            for (int iRow = 0; iRow < 3; iRow++) {
+                for (int iCol = 0; iCol < 3; iCol++) {
+                    kWWTrn[iRow][iCol] = 0.5*kWWTrn[iRow][iCol] + kN[iRow]*kN[iCol];
+                    kDWTrn[iRow][iCol] *= 0.5;
+                }
             }
-        }
 
-        akDNormal = akDWTrn*akWWTrn.inverse();
-
-        // If N is a unit-length normal at a vertex, let U and V be unit-length
-        // tangents so that {U, V, N} is an orthonormal set.  Define the matrix
-        // J = [U | V], a 3-by-2 matrix whose columns are U and V.  Define J^T
-        // to be the transpose of J, a 2-by-3 matrix.  Let dN/dX denote the
-        // matrix of first-order derivatives of the normal vector field.  The
-        // shape matrix is
-        //   S = (J^T * J)^{-1} * J^T * dN/dX * J = J^T * dN/dX * J
-        // where the superscript of -1 denotes the inverse.  (The formula allows
-        // for J built from non-perpendicular vectors.) The matrix S is 2-by-2.
-        // The principal curvatures are the eigenvalues of S.  If k is a principal
-        // curvature and W is the 2-by-1 eigenvector corresponding to it, then
-        // S*W = k*W (by definition).  The corresponding 3-by-1 tangent vector at
-        // the vertex is called the principal direction for k, and is J*W.
-        // compute U and V given N
-        float minCurvature;
-        float maxCurvature;
-        Base::Vector3f minDirection;
-        Base::Vector3f maxDirection;
-
-        Eigen::Vector3f kU, kV;
-        Eigen::Vector3f kN = akNormal[i];
-        float len = kN.squaredNorm();
-        if (len == 0)
-            continue; // skip
-        MeshCore::GenerateComplementBasis(kU,kV,kN);
-
-        // Compute S = J^T * dN/dX * J.  In theory S is symmetric, but
-        // because we have estimated dN/dX, we must slightly adjust our
-        // calculations to make sure S is symmetric.
-        float fS01 = kU.dot(akDNormal*kV);
-        float fS10 = kV.dot(akDNormal*kU);
-        float fSAvr = 0.5*(fS01+fS10);
-        Eigen::Matrix2f kS;
-        kS(0,0) = kU.dot(akDNormal*kU);
-        kS(0,1) = fSAvr;
-        kS(1,0) = fSAvr;
-        kS(1,1) = kV.dot(akDNormal*kV);
-
-        // compute the eigenvalues of S (min and max curvatures)
-        float fTrace = kS(0,0) + kS(1,1);
-        float fDet = kS(0,0)*kS(1,1) - kS(0,1)*kS(1,0);
-        float fDiscr = fTrace*fTrace - (4.0)*fDet;
-        float fRootDiscr = sqrt(fabs(fDiscr));
-        minCurvature = (0.5)*(fTrace - fRootDiscr);
-        maxCurvature = (0.5)*(fTrace + fRootDiscr);
-
-        // compute the eigenvectors of S
-        Eigen::Vector2f kW0(kS(0,1),minCurvature-kS(0,0));
-        Eigen::Vector2f kW1(minCurvature-kS(1,1),kS(1,0));
-        if (kW0.squaredNorm() >= kW1.squaredNorm())
-        {
-            float len = kW0.squaredNorm();
-            if (len > 0 && len != 1)
-                kW0.normalize();
-            Eigen::Vector3f v = kU*kW0[0] + kV*kW0[1];
-            minDirection.Set(v[0],v[1],v[2]);
-        }
-        else
-        {
-            float len = kW1.squaredNorm();
-            if (len > 0 && len != 1)
-                kW1.normalize();
-            Eigen::Vector3f v = kU*kW1[0] + kV*kW1[1];
-            minDirection.Set(v[0],v[1],v[2]);
-        }
+            Wm4::Matrix3<double> kDNormal = kDWTrn*kWWTrn.Inverse();
+
+            // The principal curvatures are the eigenvalues of the shape matrix
+            // S = J^T * dN/dX * J with J = [U | V] and {U, V, N} an orthonormal set.
+            // The principal directions are J*W with W the eigenvectors of S.
+            Wm4::Vector3<double> kU, kV;
+            Wm4::Vector3<double>::GenerateComplementBasis(kU, kV, kN);
+
+            // In theory S is symmetric, but because dN/dX is estimated it's
+            // slightly adjusted to make sure S is symmetric.
+            double fS01 = kU.Dot(kDNormal*kV);
+            double fS10 = kV.Dot(kDNormal*kU);
+            double fSAvr = 0.5*(fS01+fS10);
+            Wm4::Matrix2<double> kS(kU.Dot(kDNormal*kU), fSAvr,
+                                    fSAvr, kV.Dot(kDNormal*kV));
+
+            // compute the eigenvalues of S (min and max curvatures)
+            double fTrace = kS[0][0] + kS[1][1];
+            double fDet = kS[0][0]*kS[1][1] - kS[0][1]*kS[1][0];
+            double fDiscr = fTrace*fTrace - 4.0*fDet;
+            double fRootDiscr = Wm4::Math<double>::Sqrt(Wm4::Math<double>::FAbs(fDiscr));
+            double fMinCurvature = 0.5*(fTrace - fRootDiscr);
+            double fMaxCurvature = 0.5*(fTrace + fRootDiscr);
+
+            // compute the eigenvectors of S
+            Wm4::Vector3<double> kMinDir, kMaxDir;
+            Wm4::Vector2<double> kW0(kS[0][1], fMinCurvature-kS[0][0]);
+            Wm4::Vector2<double> kW1(fMinCurvature-kS[1][1], kS[1][0]);
+            if (kW0.SquaredLength() >= kW1.SquaredLength()) {
+                kW0.Normalize();
+                kMinDir = kW0.X()*kU + kW0.Y()*kV;
+            }
+            else {
+                kW1.Normalize();
+                kMinDir = kW1.X()*kU + kW1.Y()*kV;
+            }
 
-        kW0 = Eigen::Vector2f(kS(0,1),maxCurvature-kS(0,0));
-        kW1 = Eigen::Vector2f(maxCurvature-kS(1,1),kS(1,0));
-        if (kW0.squaredNorm() >= kW1.squaredNorm())
-        {
-            float len = kW0.squaredNorm();
-            if (len > 0 && len != 1)
-                kW0.normalize();
-            Eigen::Vector3f v = kU*kW0[0] + kV*kW0[1];
-            maxDirection.Set(v[0],v[1],v[2]);
-        }
-        else
-        {
-            float len = kW1.squaredNorm();
-            if (len > 0 && len != 1)
-                kW1.normalize();
-            Eigen::Vector3f v = kU*kW1[0] + kV*kW1[1];
-            maxDirection.Set(v[0],v[1],v[2]);
-        }
+            kW0 = Wm4::Vector2<double>(kS[0][1], fMaxCurvature-kS[0][0]);
+            kW1 = Wm4::Vector2<double>(fMaxCurvature-kS[1][1], kS[1][0]);
+            if (kW0.SquaredLength() >= kW1.SquaredLength()) {
+                kW0.Normalize();
+                kMaxDir = kW0.X()*kU + kW0.Y()*kV;
+            }
+            else {
+                kW1.Normalize();
+                kMaxDir = kW1.X()*kU + kW1.Y()*kV;
+            }
 
-        CurvatureInfo ci;
-        ci.fMaxCurvature = maxCurvature;
-        ci.cMaxCurvDir = maxDirection;
-        ci.fMinCurvature = minCurvature;
-        ci.cMinCurvDir = minDirection;
-        myCurvature.push_back(ci);
-    }
+            CurvatureInfo& ci = myCurvature[i];
+            ci.cMaxCurvDir = Base::Vector3f((float)kMaxDir.X(), (float)kMaxDir.Y(), (float)kMaxDir.Z());
+            ci.cMinCurvDir = Base::Vector3f((float)kMinDir.X(), (float)kMinDir.Y(), (float)kMinDir.Z());
+            ci.fMaxCurvature = (float)fMaxCurvature;
+            ci.fMinCurvature = (float)fMinCurvature;
+        }
+    });
 }
-#else
-void MeshCurvature::ComputePerVertex()
-{
-    myCurvature.clear();
 
-    // get all points
-    std::vector< Wm4::Vector3<double> > aPnts;
-    aPnts.reserve(myKernel.CountPoints());
-    MeshPointIterator cPIt(myKernel);
-    for (cPIt.Init(); cPIt.More(); cPIt.Next()) {
-        Wm4::Vector3<double> cP(cPIt->x, cPIt->y, cPIt->z);
-        aPnts.push_back(cP);
+// --------------------------------------------------------
+
+namespace {
+const unsigned long NoFacet = ~0ul;
+
+/** The buffers of a neighbourhood search that are reused for all facets of a task. */
+class NeighbourSearch
+{
+public:
+    NeighbourSearch() : mask(63), slots(64, NoFacet)
+    {
     }
 
-    // get all point connections
-    std::vector<int> aIdx;
-    aIdx.reserve(3*myKernel.CountFacets());
-    const MeshFacetArray& raFts = myKernel.GetFacets();
-    for (MeshFacetArray::const_iterator jt = raFts.begin(); jt != raFts.end(); ++jt) {
-        for (int i=0; i<3; i++) {
-            aIdx.push_back((int)jt->_aulPoints[i]);
+    /// Appends the points of all facets connected to \a index whose centers lie within \a dist
+    void collect(const MeshKernel& kernel, const PointFacetAdjacency& adjacency,
+                 unsigned long index, float dist, std::vector<unsigned long>& points)
+    {
+        const MeshFacetArray& rFacets = kernel.GetFacets();
+        Base::Vector3f center = kernel.GetFacet(index).GetGravityPoint();
+        float maxDist2 = dist * dist;
+
+        clear();
+        insert(index);
+        stack.push_back(index);
+        while (!stack.empty()) {
+            const MeshFacet& face = rFacets[stack.back()];
+            stack.pop_back();
+            for (int i = 0; i < 3; i++) {
+                unsigned long pos = face._aulPoints[i];
+                points.push_back(pos);
+                for (const unsigned long* it = adjacency.begin(pos); it != adjacency.end(pos); ++it) {
+                    Base::Vector3f gravity = kernel.GetFacet(*it).GetGravityPoint();
+                    if (Base::DistanceP2(center, gravity) <= maxDist2 && insert(*it))
+                        stack.push_back(*it);
+                }
+            }
         }
     }
 
-    // in case of an empty mesh no curvature can be calculated
-    if (myKernel.CountPoints() == 0 || myKernel.CountFacets() == 0)
-        return;
-
-    // compute vertex based curvatures
-    Wm4::MeshCurvature<double> meshCurv(myKernel.CountPoints(), &(aPnts[0]), myKernel.CountFacets(), &(aIdx[0]));
-
-    // get curvature information now
-    const Wm4::Vector3<double>* aMaxCurvDir = meshCurv.GetMaxDirections();
-    const Wm4::Vector3<double>* aMinCurvDir = meshCurv.GetMinDirections();
-    const double* aMaxCurv = meshCurv.GetMaxCurvatures();
-    const double* aMinCurv = meshCurv.GetMinCurvatures();
-
-    myCurvature.reserve(myKernel.CountPoints());
-    for (unsigned long i=0; i<myKernel.CountPoints(); i++) {
-        CurvatureInfo ci;
-        ci.cMaxCurvDir = Base::Vector3f((float)aMaxCurvDir[i].X(), (float)aMaxCurvDir[i].Y(), (float)aMaxCurvDir[i].Z());
-        ci.cMinCurvDir = Base::Vector3f((float)aMinCurvDir[i].X(), (float)aMinCurvDir[i].Y(), (float)aMinCurvDir[i].Z());
-        ci.fMaxCurvature = (float)aMaxCurv[i];
-        ci.fMinCurvature = (float)aMinCurv[i];
-        myCurvature.push_back(ci);
+private:
+    // Small open addressing hash set of the visited facets. Its size depends on the
+    // size of the neighbourhood and not on the size of the mesh.
+    bool insert(unsigned long index)
+    {
+        if (2 * (used.size() + 1) > slots.size())
+            grow();
+        std::size_t pos = hash(index);
+        while (slots[pos] != NoFacet) {
+            if (slots[pos] == index)
+                return false;
+            pos = (pos + 1) & mask;
+        }
+        slots[pos] = index;
+        used.push_back(pos);
+        return true;
     }
-}
-#endif // OPTIMIZE_CURVATURE
-
-// --------------------------------------------------------
-
-namespace MeshCore {
-class FitPointCollector : public MeshCollector
-{
-public:
-    FitPointCollector(std::set<unsigned long>& ind) : indices(ind){}
-    virtual void Append(const MeshCore::MeshKernel& kernel, unsigned long index)
+    void clear()
     {
-        unsigned long ulP1, ulP2, ulP3;
-        kernel.GetFacetPoints(index, ulP1, ulP2, ulP3);
-        indices.insert(ulP1);
-        indices.insert(ulP2);
-        indices.insert(ulP3);
+        for (std::vector<std::size_t>::iterator it = used.begin(); it != used.end(); ++it)
+            slots[*it] = NoFacet;
+        used.clear();
+    }
+    void grow()
+    {
+        std::vector<unsigned long> values;
+        values.reserve(used.size());
+        for (std::vector<std::size_t>::iterator it = used.begin(); it != used.end(); ++it)
+            values.push_back(slots[*it]);
+        used.clear();
+        slots.assign(2 * slots.size(), NoFacet);
+        mask = slots.size() - 1;
+        for (std::vector<unsigned long>::iterator it = values.begin(); it != values.end(); ++it)
+            insert(*it);
+    }
+    std::size_t hash(unsigned long index) const
+    {
+        return (static_cast<std::size_t>(index) * 2654435761u) & mask;
     }
 
 private:
-    std::set<unsigned long>& indices;
+    std::size_t mask;
+    std::vector<unsigned long> slots;
+    std::vector<std::size_t> used;
+    std::vector<unsigned long> stack;
 };
-}
-
-// --------------------------------------------------------
 
-FacetCurvature::FacetCurvature(const MeshKernel& kernel, const MeshRefPointToFacets& search, float r, unsigned long pt)
-  : myKernel(kernel), mySearch(search), myMinPoints(pt), myRadius(r)
+struct FacetBuffers
 {
-}
+    NeighbourSearch search;
+    std::vector<unsigned long> points;
+    std::vector<Base::Vector3f> fitPoints;
+};
 
-CurvatureInfo FacetCurvature::Compute(unsigned long index) const
+CurvatureInfo computeFacet(const MeshKernel& kernel, const PointFacetAdjacency& adjacency,
+                           float radius, unsigned long minPoints,
+                           unsigned long index, FacetBuffers& buf)
 {
-    Base::Vector3f rkDir0, rkDir1, rkPnt;
+    Base::Vector3f rkDir0, rkDir1;
     Base::Vector3f rkNormal;
 
-    MeshGeomFacet face = myKernel.GetFacet(index);
+    MeshGeomFacet face = kernel.GetFacet(index);
     Base::Vector3f face_gravity = face.GetGravityPoint();
     Base::Vector3f face_normal = face.GetNormal();
-    std::set<unsigned long> point_indices;
-    FitPointCollector collect(point_indices);
+    std::vector<unsigned long>& point_indices = buf.points;
+    point_indices.clear();
 
-    float searchDist = myRadius;
+    // the points of all attempts are merged
+    float searchDist = radius;
     int attempts=0;
     do {
-        mySearch.Neighbours(index, searchDist, collect);
+        buf.search.collect(kernel, adjacency, index, searchDist, point_indices);
         if (point_indices.empty())
             break;
-        float min_points = myMinPoints;
+        std::sort(point_indices.begin(), point_indices.end());
+        point_indices.erase(std::unique(point_indices.begin(), point_indices.end()), point_indices.end());
+        float min_points = minPoints;
         float use_points = point_indices.size();
         searchDist = searchDist * sqrt(min_points/use_points);
     }
-    while((point_indices.size() < myMinPoints) && (attempts++ < 3));
+    while((point_indices.size() < minPoints) && (attempts++ < 3));
 
-    std::vector<Base::Vector3f> fitPoints;
-    const MeshPointArray& verts = myKernel.GetPoints();
-    fitPoints.reserve(point_indices.size());
-    for (std::set<unsigned long>::iterator it = point_indices.begin(); it != point_indices.end(); ++it) {
+    std::vector<Base::Vector3f>& fitPoints = buf.fitPoints;
+    const MeshPointArray& verts = kernel.GetPoints();
+    fitPoints.clear();
+    for (std::vector<unsigned long>::iterator it = point_indices.begin(); it != point_indices.end(); ++it) {
         fitPoints.push_back(verts[*it] - face_gravity);
     }
 
     float fMin, fMax;
-    if (fitPoints.size() >= myMinPoints) {
+    if (fitPoints.size() >= minPoints) {
         SurfaceFit surf_fit;
         surf_fit.AddPoints(fitPoints);
         surf_fit.Fit();
@@ -444,3 +473,26 @@ CurvatureInfo FacetCurvature::Compute(unsigned long index) const
 
     return info;
 }
+}
+
+// --------------------------------------------------------
+
+FacetCurvature::FacetCurvature(const MeshKernel& kernel, const PointFacetAdjacency& search, float r, unsigned long pt)
+  : myKernel(kernel), mySearch(search), myMinPoints(pt), myRadius(r)
+{
+}
+
+CurvatureInfo FacetCurvature::Compute(unsigned long index) const
+{
+    CurvatureInfo info;
+    Compute(&index, &index + 1, &info);
+    return info;
+}
+
+void FacetCurvature::Compute(const unsigned long* first, const unsigned long* last, CurvatureInfo* out) const
+{
+    FacetBuffers buf;
+    for (const unsigned long* it = first; it != last; ++it, ++out) {
+        *out = computeFacet(myKernel, mySearch, myRadius, myMinPoints, *it, buf);
+    }
+}
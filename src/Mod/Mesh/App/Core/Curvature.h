@@ -29,7 +29,6 @@
 namespace MeshCore {
 
 class MeshKernel;
-class MeshRefPointToFacets;
 
 /** Curvature information. */
 struct MeshExport CurvatureInfo
@@ -38,15 +37,39 @@ struct MeshExport CurvatureInfo
     Base::Vector3f cMaxCurvDir, cMinCurvDir;
 };
 
+/** Compact point to facets map.
+ * Unlike MeshRefPointToFacets the neighbours of all points are stored in two flat
+ * arrays (compressed sparse rows) instead of a set per point. This needs a fraction
+ * of the memory and can be read by several threads at the same time.
+ * The facets around a point are sorted by their index and every facet appears once.
+ */
+class MeshExport PointFacetAdjacency
+{
+public:
+    PointFacetAdjacency();
+    PointFacetAdjacency(const MeshKernel& kernel);
+
+    void Rebuild(const MeshKernel& kernel);
+    unsigned long CountPoints() const { return myOffsets.empty() ? 0 : myOffsets.size() - 1; }
+    const unsigned long* begin(unsigned long pos) const { return myFacets.data() + myOffsets[pos]; }
+    const unsigned long* end(unsigned long pos) const { return myFacets.data() + myOffsets[pos + 1]; }
+
+private:
+    std::vector<unsigned long> myOffsets;
+    std::vector<unsigned long> myFacets;
+};
+
 class MeshExport FacetCurvature
 {
 public:
-    FacetCurvature(const MeshKernel& kernel, const MeshRefPointToFacets& search, float, unsigned long);
+    FacetCurvature(const MeshKernel& kernel, const PointFacetAdjacency& search, float, unsigned long);
     CurvatureInfo Compute(unsigned long index) const;
+    /// Computes the curvature of the facets [first, last) into \a out and reuses the search buffers.
+    void Compute(const unsigned long* first, const unsigned long* last, CurvatureInfo* out) const;
 
 private:
     const MeshKernel& myKernel;
-    const MeshRefPointToFacets& mySearch;
+    const PointFacetAdjacency& mySearch;
     unsigned long myMinPoints;
     float myRadius;
 };
@@ -62,8 +85,12 @@ public:
     void ComputePerVertex();
     const std::vector<CurvatureInfo>& GetCurvature() const { return myCurvature; }
 
+private:
+    const PointFacetAdjacency& GetAdjacency();
+
 private:
     const MeshKernel& myKernel;
+    PointFacetAdjacency myAdjacency;
     unsigned long myMinPoints;
     float myRadius;
     std::vector<unsigned long> mySegment;
@@ -45,6 +45,7 @@
 # include <Standard_Failure.hxx>
 #endif
 
+#include <QtConcurrentMap>
 
 #include "MeshAlgos.h"
 #include "CurveProjector.h"
@@ -60,6 +61,7 @@
 #include <Base/Exception.h>
 #include <Base/Console.h>
 #include <Base/Sequencer.h>
+#include <Base/TimeInfo.h>
 
 
 using namespace MeshPart;
@@ -686,6 +688,7 @@ void CurveProjectorWithToolMesh::makeToolMesh( const TopoDS_Edge& aEdge,std::vec
 
 MeshProjection::MeshProjection(const MeshKernel& rMesh)
   : _rcMesh(rMesh)
+  , _stats()
 {
 }
 
@@ -818,30 +821,63 @@ void MeshProjection::findSectionParameters(const TopoDS_Edge& edge, const Base::
 
 void MeshProjection::projectToMesh (const TopoDS_Shape &aShape, float fMaxDist, std::vector<PolyLine>& rPolyLines) const
 {
+    Base::TimeInfo timer;
+    _stats = Statistics();
+
     // calculate the average edge length and create a grid
     MeshAlgorithm clAlg( _rcMesh );
     float fAvgLen = clAlg.GetAverageEdgeLength();
     MeshFacetGrid cGrid( _rcMesh, 5.0f*fAvgLen );
 
+    struct EdgeProjection {
+        TopoDS_Edge edge;
+        std::vector<SplitEdge> splitEdges;
+        std::size_t ambiguous;
+        std::string error;
+    };
+
     TopExp_Explorer Ex;
+    std::vector<EdgeProjection> edges;
+    for (Ex.Init(aShape, TopAbs_EDGE); Ex.More(); Ex.Next()) {
+        EdgeProjection proj;
+        proj.edge = TopoDS::Edge(Ex.Current());
+        proj.ambiguous = 0;
+        edges.push_back(proj);
+    }
 
-    int iCnt=0;
-    for (Ex.Init(aShape, TopAbs_EDGE); Ex.More(); Ex.Next())
-        iCnt++;
+    Base::SequencerLauncher seq( "Project curve on mesh", 2 );
+    seq.next();
 
-    Base::SequencerLauncher seq( "Project curve on mesh", iCnt );
+    // the edges are independent of each other and share the grid
+    QtConcurrent::blockingMap(edges, [&](EdgeProjection& proj) {
+        try {
+            proj.ambiguous = projectEdgeToEdge(proj.edge, fMaxDist, cGrid, proj.splitEdges);
+        }
+        catch (const Standard_Failure& e) {
+            proj.error = e.GetMessageString() ? e.GetMessageString() : "Failed to project edge";
+        }
+    });
+    seq.next();
 
-    for (Ex.Init(aShape, TopAbs_EDGE); Ex.More(); Ex.Next()) {
-        const TopoDS_Edge& aEdge = TopoDS::Edge(Ex.Current());
-        std::vector<SplitEdge> rSplitEdges;
-        projectEdgeToEdge(aEdge, fMaxDist, cGrid, rSplitEdges);
+    std::size_t ambiguous = 0;
+    for (auto& it : edges) {
+        if (!it.error.empty())
+            throw Base::RuntimeError(it.error);
         PolyLine polyline;
-        polyline.points.reserve(rSplitEdges.size());
-        for (auto it : rSplitEdges)
-            polyline.points.push_back(it.cPt);
+        polyline.points.reserve(it.splitEdges.size());
+        for (auto jt : it.splitEdges)
+            polyline.points.push_back(jt.cPt);
         rPolyLines.push_back(polyline);
-        seq.next();
+        ambiguous += it.ambiguous;
+        _stats.hits += it.splitEdges.size();
     }
+
+    if (ambiguous > 0)
+        Base::Console().Log("More than one possible intersection points at %lu mesh edges\n",
+                            static_cast<unsigned long>(ambiguous));
+
+    _stats.edges = edges.size();
+    _stats.projecting = Base::TimeInfo::diffTimeF(timer);
 }
 
 void MeshProjection::projectOnMesh(const std::vector<Base::Vector3f>& pointsIn,
@@ -926,104 +962,161 @@ void MeshProjection::projectOnMesh(const std::vector<Base::Vector3f>& pointsIn,
 
 void MeshProjection::projectParallelToMesh (const TopoDS_Shape &aShape, const Base::Vector3f& dir, std::vector<PolyLine>& rPolyLines) const
 {
-    // calculate the average edge length and create a grid
-    MeshAlgorithm clAlg(_rcMesh);
-    float fAvgLen = clAlg.GetAverageEdgeLength();
-    MeshFacetGrid cGrid(_rcMesh, 5.0f*fAvgLen);
-    TopExp_Explorer Ex;
-
-    int iCnt=0;
-    for (Ex.Init(aShape, TopAbs_EDGE); Ex.More(); Ex.Next())
-        iCnt++;
+    Base::TimeInfo timer;
 
-    Base::SequencerLauncher seq( "Project curve on mesh", iCnt );
+    struct EdgeSamples {
+        TopoDS_Edge edge;
+        std::vector<Base::Vector3f> points;
+        std::string error;
+    };
 
+    TopExp_Explorer Ex;
+    std::vector<EdgeSamples> edges;
     for (Ex.Init(aShape, TopAbs_EDGE); Ex.More(); Ex.Next()) {
-        const TopoDS_Edge& aEdge = TopoDS::Edge(Ex.Current());
-        std::vector<Base::Vector3f> points;
-        discretize(aEdge, points, 5);
-
-        typedef std::pair<Base::Vector3f, unsigned long> HitPoint;
-        std::vector<HitPoint> hitPoints;
-        typedef std::pair<HitPoint, HitPoint> HitPoints;
-        std::vector<HitPoints> hitPointPairs;
-        for (auto it : points) {
-            Base::Vector3f result;
-            unsigned long index;
-            if (clAlg.NearestFacetOnRay(it, dir, cGrid, result, index)) {
-                hitPoints.emplace_back(result, index);
-
-                if (hitPoints.size() > 1) {
-                    HitPoint p1 = hitPoints[hitPoints.size()-2];
-                    HitPoint p2 = hitPoints[hitPoints.size()-1];
-                    hitPointPairs.emplace_back(p1, p2);
-                }
-            }
-        }
+        EdgeSamples samples;
+        samples.edge = TopoDS::Edge(Ex.Current());
+        edges.push_back(samples);
+    }
 
-        MeshCore::MeshProjection meshProjection(_rcMesh);
-        PolyLine polyline;
-        for (auto it : hitPointPairs) {
-            points.clear();
-            if (meshProjection.projectLineOnMesh(cGrid, it.first.first, it.first.second,
-                                                 it.second.first, it.second.second, dir, points)) {
-                polyline.points.insert(polyline.points.end(), points.begin(), points.end());
-            }
+    // sample all edges up front
+    QtConcurrent::blockingMap(edges, [this](EdgeSamples& samples) {
+        try {
+            discretize(samples.edge, samples.points, 5);
         }
-        rPolyLines.push_back(polyline);
+        catch (const Standard_Failure& e) {
+            samples.error = e.GetMessageString() ? e.GetMessageString() : "Failed to discretize edge";
+        }
+    });
 
-        seq.next();
+    std::vector< std::vector<Base::Vector3f> > samples(edges.size());
+    for (std::size_t i = 0; i < edges.size(); i++) {
+        if (!edges[i].error.empty())
+            throw Base::RuntimeError(edges[i].error);
+        samples[i].swap(edges[i].points);
     }
+    float sampling = Base::TimeInfo::diffTimeF(timer);
+
+    projectParallel(samples, dir, rPolyLines);
+    _stats.sampling = sampling;
 }
 
 void MeshProjection::projectParallelToMesh (const std::vector<PolyLine> &aEdges, const Base::Vector3f& dir, std::vector<PolyLine>& rPolyLines) const
 {
-    // calculate the average edge length and create a grid
+    std::vector< std::vector<Base::Vector3f> > samples;
+    samples.reserve(aEdges.size());
+    for (auto it : aEdges)
+        samples.push_back(it.points);
+
+    projectParallel(samples, dir, rPolyLines);
+}
+
+void MeshProjection::projectParallel(const std::vector< std::vector<Base::Vector3f> >& samples,
+                                     const Base::Vector3f& dir, std::vector<PolyLine>& rPolyLines) const
+{
+    Base::TimeInfo timer;
+    _stats = Statistics();
+    _stats.edges = samples.size();
+
+    Base::SequencerLauncher seq( "Project curve on mesh", 3 );
+
+    // calculate the average edge length and create a grid which is shared by all threads
     MeshAlgorithm clAlg(_rcMesh);
     float fAvgLen = clAlg.GetAverageEdgeLength();
     MeshFacetGrid cGrid(_rcMesh, 5.0f*fAvgLen);
+    seq.next();
 
-    Base::SequencerLauncher seq( "Project curve on mesh", aEdges.size() );
-
-    for (auto it : aEdges) {
-        std::vector<Base::Vector3f> points = it.points;
-
-        typedef std::pair<Base::Vector3f, unsigned long> HitPoint;
-        std::vector<HitPoint> hitPoints;
-        typedef std::pair<HitPoint, HitPoint> HitPoints;
-        std::vector<HitPoints> hitPointPairs;
-        for (auto it : points) {
-            Base::Vector3f result;
-            unsigned long index;
-            if (clAlg.NearestFacetOnRay(it, dir, cGrid, result, index)) {
-                hitPoints.emplace_back(result, index);
-
-                if (hitPoints.size() > 1) {
-                    HitPoint p1 = hitPoints[hitPoints.size()-2];
-                    HitPoint p2 = hitPoints[hitPoints.size()-1];
-                    hitPointPairs.emplace_back(p1, p2);
-                }
+    struct HitPoint {
+        Base::Vector3f point;
+        Base::Vector3f result;
+        unsigned long index;
+        bool hit;
+    };
+
+    // project the sample points of all polylines at once
+    std::vector<HitPoint> hitPoints;
+    std::vector<std::size_t> hitOffsets;
+    hitOffsets.reserve(samples.size() + 1);
+    for (auto& it : samples) {
+        hitOffsets.push_back(hitPoints.size());
+        for (auto& jt : it) {
+            HitPoint hp;
+            hp.point = jt;
+            hp.index = 0;
+            hp.hit = false;
+            hitPoints.push_back(hp);
+        }
+    }
+    hitOffsets.push_back(hitPoints.size());
+
+    QtConcurrent::blockingMap(hitPoints, [&](HitPoint& hp) {
+        hp.hit = clAlg.NearestFacetOnRay(hp.point, dir, cGrid, hp.result, hp.index);
+    });
+    seq.next();
+
+    _stats.samples = hitPoints.size();
+    _stats.projecting = Base::TimeInfo::diffTimeF(timer);
+    timer.setCurrent();
+
+    struct HitSegment {
+        const HitPoint* p1;
+        const HitPoint* p2;
+        std::vector<Base::Vector3f> points;
+        bool ok;
+    };
+
+    // connect consecutive hits of each polyline
+    std::vector<HitSegment> segments;
+    std::vector<std::size_t> segmentOffsets;
+    segmentOffsets.reserve(samples.size() + 1);
+    for (std::size_t i = 0; i < samples.size(); i++) {
+        segmentOffsets.push_back(segments.size());
+        const HitPoint* prev = 0;
+        for (std::size_t j = hitOffsets[i]; j < hitOffsets[i+1]; j++) {
+            const HitPoint& hp = hitPoints[j];
+            if (!hp.hit)
+                continue;
+            _stats.hits++;
+            if (prev) {
+                HitSegment segm;
+                segm.p1 = prev;
+                segm.p2 = &hp;
+                segm.ok = false;
+                segments.push_back(segm);
             }
+            prev = &hp;
         }
+    }
+    segmentOffsets.push_back(segments.size());
 
+    QtConcurrent::blockingMap(segments, [&](HitSegment& segm) {
         MeshCore::MeshProjection meshProjection(_rcMesh);
+        segm.ok = meshProjection.projectLineOnMesh(cGrid, segm.p1->result, segm.p1->index,
+                                                   segm.p2->result, segm.p2->index, dir, segm.points);
+    });
+
+    // stitch the projected segments in their original order
+    for (std::size_t i = 0; i < samples.size(); i++) {
         PolyLine polyline;
-        for (auto it : hitPointPairs) {
-            points.clear();
-            if (meshProjection.projectLineOnMesh(cGrid, it.first.first, it.first.second,
-                                                 it.second.first, it.second.second, dir, points)) {
-                polyline.points.insert(polyline.points.end(), points.begin(), points.end());
-            }
+        for (std::size_t j = segmentOffsets[i]; j < segmentOffsets[i+1]; j++) {
+            const HitSegment& segm = segments[j];
+            if (segm.ok)
+                polyline.points.insert(polyline.points.end(), segm.points.begin(), segm.points.end());
         }
         rPolyLines.push_back(polyline);
-
-        seq.next();
     }
+    seq.next();
+
+    _stats.stitching = Base::TimeInfo::diffTimeF(timer);
+
+    Base::Console().Log("Projected %lu sample points of %lu polylines: %lu hits, projection %.3f s, stitching %.3f s\n",
+                        static_cast<unsigned long>(_stats.samples), static_cast<unsigned long>(_stats.edges),
+                        static_cast<unsigned long>(_stats.hits), _stats.projecting, _stats.stitching);
 }
 
-void MeshProjection::projectEdgeToEdge( const TopoDS_Edge &aEdge, float fMaxDist, const MeshFacetGrid& rGrid,
-                                         std::vector<SplitEdge>& rSplitEdges ) const
+std::size_t MeshProjection::projectEdgeToEdge( const TopoDS_Edge &aEdge, float fMaxDist, const MeshFacetGrid& rGrid,
+                                                std::vector<SplitEdge>& rSplitEdges ) const
 {
+    std::size_t ambiguous = 0;
     std::vector<unsigned long> auFInds;
     std::map<std::pair<unsigned long, unsigned long>, std::list<unsigned long> > pEdgeToFace;
     const std::vector<MeshFacet>& rclFAry = _rcMesh.GetFacets();
@@ -1062,11 +1155,8 @@ void MeshProjection::projectEdgeToEdge( const TopoDS_Edge &aEdge, float fMaxDist
     MeshPointIterator cPI( _rcMesh );
     MeshFacetIterator cFI( _rcMesh );
 
-    Base::SequencerLauncher seq( "Project curve on mesh", pEdgeToFace.size() );
     std::map<std::pair<unsigned long, unsigned long>, std::list<unsigned long> >::iterator it;
     for ( it = pEdgeToFace.begin(); it != pEdgeToFace.end(); ++it ) {
-        seq.next();
-
         // edge points
         unsigned long uE0 = it->first.first;
         cPI.Set( uE0 );
@@ -1154,7 +1244,7 @@ void MeshProjection::projectEdgeToEdge( const TopoDS_Edge &aEdge, float fMaxDist
                     rParamSplitEdges[fSol] = splitEdge;
                 }
                 else if ( nCntSol > 1 ) {
-                    Base::Console().Log("More than one possible intersection points\n");
+                    ambiguous++;
                 }
             }
         }
@@ -1165,4 +1255,6 @@ void MeshProjection::projectEdgeToEdge( const TopoDS_Edge &aEdge, float fMaxDist
          rParamSplitEdges.begin(); itS != rParamSplitEdges.end(); ++itS) {
          rSplitEdges.push_back( itS->second );
     }
+
+    return ambiguous;
 }
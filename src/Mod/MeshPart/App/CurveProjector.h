@@ -174,6 +174,16 @@ public:
     {
         std::vector<Base::Vector3f> points;
     };
+    /// Counters and timings in seconds of the last projection
+    struct Statistics
+    {
+        std::size_t edges;
+        std::size_t samples;
+        std::size_t hits;
+        double sampling;
+        double projecting;
+        double stitching;
+    };
 
     /// Construction
     MeshProjection(const MeshKernel& rMesh);
@@ -221,14 +231,30 @@ public:
      * split the facet at the found points. @see projectToMesh() for more details.
      */
     void splitMeshByShape (const TopoDS_Shape &aShape, float fMaxDist) const;
+    /// Returns the counters and timings of the last projection
+    const Statistics& getStatistics() const {
+        return _stats;
+    }
 
 protected:
-    void projectEdgeToEdge(const TopoDS_Edge &aCurve, float fMaxDist, const MeshCore::MeshFacetGrid& rGrid,
-                           std::vector<SplitEdge>& rSplitEdges) const;
+    /**
+     * Projects the intersections of the curve with the mesh edges. This method is called
+     * from several threads. It returns the number of mesh edges where no unique intersection
+     * point could be found.
+     */
+    std::size_t projectEdgeToEdge(const TopoDS_Edge &aCurve, float fMaxDist, const MeshCore::MeshFacetGrid& rGrid,
+                                  std::vector<SplitEdge>& rSplitEdges) const;
     bool findIntersection(const Edge&, const Edge&, const Base::Vector3f& dir, Base::Vector3f& res) const;
+    /**
+     * Projects the sample points of all polylines in parallel along \a dir onto the mesh and
+     * connects consecutive hits of each polyline to one projected polyline.
+     */
+    void projectParallel(const std::vector< std::vector<Base::Vector3f> >& samples,
+                         const Base::Vector3f& dir, std::vector<PolyLine>& rPolyLines) const;
 
 private:
     const MeshKernel& _rcMesh;
+    mutable Statistics _stats;
 };
 
 } // namespace MeshPart
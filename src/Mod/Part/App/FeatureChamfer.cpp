@@ -37,6 +37,7 @@
 
 #include <App/Document.h>
 #include "TopoShapeOpCode.h"
+#include "ShapeCache.h"
 #include "FeatureChamfer.h"
 
 
@@ -106,6 +107,15 @@ App::DocumentObjectExecReturn *Chamfer::execute(void)
         const auto &subs = EdgeLinks.getShadowSubs();
         if(subs.size()!=(size_t)Edges.getSize())
             return new App::DocumentObjectExecReturn("Edge link size mismatch");
+
+        ShapeCache::Key key(this);
+        key.addShape(baseTopoShape);
+        TopoShape res;
+        if(ShapeCache::find(key, res)) {
+            this->Shape.setValue(res);
+            return Part::Feature::execute();
+        }
+
         size_t i=0;
         for(const auto &info : Edges.getValues()) {
             auto &sub = subs[i];
@@ -127,8 +137,10 @@ App::DocumentObjectExecReturn *Chamfer::execute(void)
         if (shape.IsNull())
             return new App::DocumentObjectExecReturn("Resulting shape is null");
 
-        TopoShape res(0,getDocument()->getStringHasher());
-        this->Shape.setValue(res.makEShape(mkChamfer,baseTopoShape,TOPOP_CHAMFER));
+        res = TopoShape(0,getDocument()->getStringHasher());
+        res.makEShape(mkChamfer,baseTopoShape,TOPOP_CHAMFER);
+        ShapeCache::insert(key, res);
+        this->Shape.setValue(res);
 #endif
 
         return Part::Feature::execute();
@@ -47,6 +47,7 @@
 
 
 #include "TopoShapeOpCode.h"
+#include "ShapeCache.h"
 #include "FeatureExtrusion.h"
 #include <Base/Tools.h>
 #include <Base/Exception.h>
@@ -312,8 +313,22 @@ App::DocumentObjectExecReturn *Extrusion::execute(void)
 
     try {
         Extrusion::ExtrusionParameters params = computeFinalParameters();
-        TopoShape result(0,getDocument()->getStringHasher());
-        extrudeShape(result,Feature::getTopoShape(link),params);
+        TopoShape base = Feature::getTopoShape(link);
+
+        // The direction may come from other linked object
+        std::ostringstream ss;
+        ss.precision(17);
+        ss << params.dir.X() << ',' << params.dir.Y() << ',' << params.dir.Z();
+        ShapeCache::Key key(this);
+        key.addShape(base);
+        key.addData(ss.str());
+
+        TopoShape result;
+        if (!ShapeCache::find(key, result)) {
+            result = TopoShape(0,getDocument()->getStringHasher());
+            extrudeShape(result,base,params);
+            ShapeCache::insert(key, result);
+        }
         this->Shape.setValue(result);
         return Part::Feature::execute();
     }
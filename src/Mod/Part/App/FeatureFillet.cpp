@@ -34,6 +34,7 @@
 
 #include <App/Document.h>
 #include "TopoShapeOpCode.h"
+#include "ShapeCache.h"
 #include "FeatureFillet.h"
 #include <Base/Exception.h>
 
@@ -105,6 +106,15 @@ App::DocumentObjectExecReturn *Fillet::execute(void)
         const auto &subs = EdgeLinks.getShadowSubs();
         if(subs.size()!=(size_t)Edges.getSize())
             return new App::DocumentObjectExecReturn("Edge link size mismatch");
+
+        ShapeCache::Key key(this);
+        key.addShape(baseTopoShape);
+        TopoShape res;
+        if(ShapeCache::find(key, res)) {
+            this->Shape.setValue(res);
+            return Part::Feature::execute();
+        }
+
         size_t i=0;
         for(const auto &info : Edges.getValues()) {
             auto &sub = subs[i];
@@ -125,8 +135,10 @@ App::DocumentObjectExecReturn *Fillet::execute(void)
         if (shape.IsNull())
             return new App::DocumentObjectExecReturn("Resulting shape is null");
 
-        TopoShape res(0,getDocument()->getStringHasher());
-        this->Shape.setValue(res.makEShape(mkFillet,baseTopoShape,TOPOP_FILLET));
+        res = TopoShape(0,getDocument()->getStringHasher());
+        res.makEShape(mkFillet,baseTopoShape,TOPOP_FILLET);
+        ShapeCache::insert(key, res);
+        this->Shape.setValue(res);
 #endif
 
         return Part::Feature::execute();
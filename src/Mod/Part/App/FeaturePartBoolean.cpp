@@ -35,6 +35,7 @@
 #include <App/Document.h>
 #include <Base/Parameter.h>
 #include "TopoShapeOpCode.h"
+#include "ShapeCache.h"
 
 
 using namespace Part;
@@ -91,6 +92,16 @@ App::DocumentObjectExecReturn *Boolean::execute(void)
         if (ToolShape.IsNull())
             throw NullShapeException("Tool shape is null");
 
+#ifndef FC_NO_ELEMENT_MAP
+        ShapeCache::Key key(this, opCode());
+        key.addShapes(shapes);
+        TopoShape res;
+        if (ShapeCache::find(key, res)) {
+            this->Shape.setValue(res);
+            return Part::Feature::execute();
+        }
+#endif
+
         std::unique_ptr<BRepAlgoAPI_BooleanOperation> mkBool(makeOperation(BaseShape, ToolShape));
         if (!mkBool->IsDone()) {
             std::stringstream error;
@@ -139,10 +150,11 @@ App::DocumentObjectExecReturn *Boolean::execute(void)
         this->Shape.setValue(resShape);
         this->History.setValues(history);
 #else
-        TopoShape res(0,getDocument()->getStringHasher());
+        res = TopoShape(0,getDocument()->getStringHasher());
         res.makEShape(*mkBool,shapes,opCode());
         if (this->Refine.getValue()) 
             res = res.makERefine();
+        ShapeCache::insert(key, res);
         this->Shape.setValue(res);
 #endif
         return Part::Feature::execute();
@@ -24,6 +24,7 @@
 #include <App/Application.h>
 #include <App/Document.h>
 #include "PartParams.h"
+#include "ShapeCache.h"
 
 using namespace Part;
 
@@ -59,3 +60,7 @@ PartParams *PartParams::instance() {
         inst = new PartParams;
     return inst;
 }
+
+void PartParams::onShapeResultCacheSizeChanged() {
+    ShapeCache::clear();
+}
@@ -67,6 +67,9 @@ public:
     FC_APP_PART_PARAM(UseBaseObjectName,bool,Bool,false) \
     FC_APP_PART_PARAM(AutoGroupSolids,bool,Bool,false) \
     FC_APP_PART_PARAM(SingleSolid,bool,Bool,false) \
+    FC_APP_PART_PARAM(ParallelElementMap,bool,Bool,true) \
+    FC_APP_PART_PARAM(ParallelElementMapThreshold,int,Int,1000) \
+    FC_APP_PART_PARAM2(ShapeResultCacheSize,int,Int,128) \
 
 #undef FC_APP_PART_PARAM
 #define FC_APP_PART_PARAM(_name,_ctype,_type,_def) \
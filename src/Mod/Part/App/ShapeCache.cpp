@@ -0,0 +1,270 @@
+/***************************************************************************
+ *   Copyright (c) 2021 FreeCAD Developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "PreCompiled.h"
+
+#ifndef _PreComp_
+# include <list>
+# include <unordered_map>
+#endif
+
+#include <mutex>
+#include <boost/functional/hash.hpp>
+#include <boost_bind_bind.hpp>
+
+#include <Base/Console.h>
+#include <Base/Writer.h>
+#include <App/Application.h>
+#include <App/Document.h>
+#include <App/DocumentObject.h>
+
+#include "ShapeCache.h"
+#include "PropertyTopoShape.h"
+#include "PartParams.h"
+
+FC_LOG_LEVEL_INIT("Part",true,true)
+
+using namespace Part;
+namespace bp = boost::placeholders;
+
+namespace {
+
+struct CacheEntry {
+    CacheEntry(const ShapeCache::Key &key, const TopoShape &result, std::size_t memSize)
+        :key(key), result(result), memSize(memSize)
+    {}
+
+    ShapeCache::Key key;
+    TopoShape result;
+    std::size_t memSize;
+};
+
+class ShapeCacheP {
+public:
+    ShapeCacheP() {
+        connDeleteDocument = App::GetApplication().signalDeleteDocument.connect(
+                boost::bind(&ShapeCacheP::slotDeleteDocument, this, bp::_1));
+        connStartSaveDocument = App::GetApplication().signalStartSaveDocument.connect(
+                boost::bind(&ShapeCacheP::slotStartSaveDocument, this, bp::_1));
+    }
+
+    void slotDeleteDocument(const App::Document &doc) {
+        eraseDocument(doc);
+    }
+
+    void slotStartSaveDocument(const App::Document &doc) {
+        // The element maps of the cached shapes hold references to the string
+        // IDs of the document, which would make the string hasher save IDs
+        // that are no longer used by the document itself.
+        eraseDocument(doc);
+    }
+
+    void eraseDocument(const App::Document &doc) {
+        auto hasher = doc.getStringHasher();
+        std::lock_guard<std::mutex> lock(mutex);
+        for(auto it=entries.begin(); it!=entries.end();) {
+            if(it->result.Hasher == hasher)
+                it = erase(it);
+            else
+                ++it;
+        }
+    }
+
+    /// Must be called with the mutex locked
+    std::list<CacheEntry>::iterator erase(std::list<CacheEntry>::iterator it) {
+        auto range = index.equal_range(it->key.hash());
+        for(auto iter=range.first; iter!=range.second; ++iter) {
+            if(iter->second == it) {
+                index.erase(iter);
+                break;
+            }
+        }
+        memSize -= it->memSize;
+        return entries.erase(it);
+    }
+
+    /// Must be called with the mutex locked
+    void trim(std::size_t limit) {
+        while(memSize > limit && entries.size())
+            erase(--entries.end());
+    }
+
+    void clear() {
+        std::lock_guard<std::mutex> lock(mutex);
+        index.clear();
+        entries.clear();
+        memSize = 0;
+    }
+
+    std::mutex mutex;
+    /// Cached entries ordered from the most to the least recently used
+    std::list<CacheEntry> entries;
+    std::unordered_multimap<std::size_t, std::list<CacheEntry>::iterator> index;
+    std::size_t memSize = 0;
+    boost::signals2::scoped_connection connDeleteDocument;
+    boost::signals2::scoped_connection connStartSaveDocument;
+};
+
+ShapeCacheP &getCache() {
+    static ShapeCacheP *inst = new ShapeCacheP;
+    return *inst;
+}
+
+std::size_t cacheLimit() {
+    int size = PartParams::ShapeResultCacheSize();
+    return size > 0 ? (std::size_t)size * 1024 * 1024 : 0;
+}
+
+} // anonymous namespace
+
+///////////////////////////////////////////////////////////
+
+ShapeCache::Key::Key(const App::DocumentObject *obj, const char *op)
+    :_hash(0), _enabled(isEnabled())
+{
+    // Saving the properties is not free, skip it if the key is not used
+    if(!_enabled)
+        return;
+
+    _name = obj->getFullName();
+    _hasher = obj->getDocument()->getStringHasher();
+
+    // Use the saved content of the properties to identify the parameters of
+    // the operation, excluding those that does not affect recomputation.
+    Base::StringWriter writer;
+    writer.Stream() << obj->getTypeId().getName() << ' ' << (op?op:"") << '\n';
+    std::map<std::string, App::Property*> props;
+    obj->getPropertyMap(props);
+    for(auto &v : props) {
+        auto prop = v.second;
+        if(prop == &obj->Label
+                || prop == &obj->Label2
+                || prop == &obj->Visibility
+                || prop == &obj->ExpressionEngine
+                || prop->isDerivedFrom(PropertyPartShape::getClassTypeId())
+                || (obj->getPropertyType(prop) & (App::Prop_Output|App::Prop_NoRecompute)))
+            continue;
+        writer.Stream() << v.first << '\n';
+        prop->Save(writer);
+    }
+    _data = writer.getString();
+
+    boost::hash_combine(_hash, _data);
+    boost::hash_combine(_hash, static_cast<const void*>(_hasher));
+}
+
+void ShapeCache::Key::addShape(const TopoShape &shape) {
+    if(!_enabled)
+        return;
+    _shapes.push_back(shape);
+    boost::hash_combine(_hash, ShapeHasher()(shape));
+    boost::hash_combine(_hash, shape.Tag);
+}
+
+void ShapeCache::Key::addShapes(const std::vector<TopoShape> &shapes) {
+    for(auto &input : shapes)
+        addShape(input);
+}
+
+void ShapeCache::Key::addData(const std::string &data) {
+    if(!_enabled)
+        return;
+    _data += data;
+    boost::hash_combine(_hash, data);
+}
+
+bool ShapeCache::Key::operator==(const Key &other) const {
+    if(_hash != other._hash
+            || _hasher != other._hasher
+            || _shapes.size() != other._shapes.size()
+            || _data != other._data)
+        return false;
+    for(std::size_t i=0; i<_shapes.size(); ++i) {
+        const auto &s1 = _shapes[i];
+        const auto &s2 = other._shapes[i];
+        if(!s1.getShape().IsEqual(s2.getShape())
+                || s1.Tag != s2.Tag
+                || s1.Hasher != s2.Hasher
+                || !s1.isSameElementMap(s2))
+            return false;
+    }
+    return true;
+}
+
+///////////////////////////////////////////////////////////
+
+bool ShapeCache::isEnabled() {
+    return PartParams::ShapeResultCacheSize() > 0;
+}
+
+bool ShapeCache::find(const Key &key, TopoShape &result) {
+    if(!key._enabled || !isEnabled())
+        return false;
+    auto &cache = getCache();
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    auto range = cache.index.equal_range(key.hash());
+    for(auto it=range.first; it!=range.second; ++it) {
+        if(it->second->key == key) {
+            cache.entries.splice(cache.entries.begin(), cache.entries, it->second);
+            result = it->second->result;
+            FC_LOG("shape cache hit " << key._name);
+            return true;
+        }
+    }
+    return false;
+}
+
+void ShapeCache::insert(const Key &key, const TopoShape &result) {
+    std::size_t limit = cacheLimit();
+    if(!key._enabled || !limit || result.isNull())
+        return;
+    // The entry keeps the input shapes alive as well
+    std::size_t memSize = result.getMemSize();
+    for(auto &input : key._shapes)
+        memSize += input.getMemSize();
+    if(memSize > limit)
+        return;
+
+    auto &cache = getCache();
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    auto range = cache.index.equal_range(key.hash());
+    for(auto it=range.first; it!=range.second; ++it) {
+        if(it->second->key == key) {
+            cache.erase(it->second);
+            break;
+        }
+    }
+    cache.trim(limit - memSize);
+    cache.entries.emplace_front(key, result, memSize);
+    cache.index.emplace(key.hash(), cache.entries.begin());
+    cache.memSize += memSize;
+}
+
+void ShapeCache::clear() {
+    getCache().clear();
+}
+
+std::size_t ShapeCache::getMemSize() {
+    auto &cache = getCache();
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    return cache.memSize;
+}
@@ -0,0 +1,118 @@
+/***************************************************************************
+ *   Copyright (c) 2021 FreeCAD Developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef PART_SHAPECACHE_H
+#define PART_SHAPECACHE_H
+
+#include <string>
+#include <vector>
+#include "TopoShape.h"
+
+namespace App {
+class DocumentObject;
+}
+
+namespace Part
+{
+
+/** Cache of the shape result of Part features
+ *
+ * The cache maps the inputs of a shape operation to its resulting shape
+ * (including the element map), so that recomputing a feature with identical
+ * inputs, e.g. after undo/redo or when a parameter is changed back and forth,
+ * can skip the actual OCC operation.
+ *
+ * The input shapes are identified by their underlying TopoDS_TShape, location
+ * and element map. The cache entry holds a reference to the input shapes, so
+ * that their identity can not be reused by other shapes while the entry is
+ * alive. The cached results are evicted in least recently used order once
+ * the total memory of the results and the input shapes exceeds the limit set
+ * by parameter ShapeResultCacheSize (in MB). Setting the parameter to zero
+ * disables the cache. The entries of a document are dropped before it is
+ * saved, so that their element maps do not keep unused string IDs alive.
+ */
+class PartExport ShapeCache
+{
+public:
+    /// Key identifying the inputs of a shape operation
+    class PartExport Key
+    {
+    public:
+        /** Constructor
+         *
+         * @param obj: the feature performing the operation. All properties of
+         *             the feature that may affect recomputation are included
+         *             in the key.
+         * @param op: optional operation code
+         */
+        Key(const App::DocumentObject *obj, const char *op=0);
+
+        /// Add an input shape
+        void addShape(const TopoShape &shape);
+
+        /// Add a list of input shapes
+        void addShapes(const std::vector<TopoShape> &shapes);
+
+        /// Add any other parameter that is not stored in the feature properties
+        void addData(const std::string &data);
+
+        bool operator==(const Key &other) const;
+
+        std::size_t hash() const {
+            return _hash;
+        }
+
+    private:
+        friend class ShapeCache;
+        std::string _name;
+        std::string _data;
+        std::vector<TopoShape> _shapes;
+        App::StringHasherRef _hasher;
+        std::size_t _hash;
+        bool _enabled;
+    };
+
+    /// Check if the cache is enabled
+    static bool isEnabled();
+
+    /** Find a cached result
+     *
+     * @param key: key of the inputs
+     * @param result: output the cached shape
+     *
+     * @return Return true if found.
+     */
+    static bool find(const Key &key, TopoShape &result);
+
+    /// Add a shape result into the cache
+    static void insert(const Key &key, const TopoShape &result);
+
+    /// Clear the cache
+    static void clear();
+
+    /// Return the total memory used by the cached shapes
+    static std::size_t getMemSize();
+};
+
+} //namespace Part
+
+#endif // PART_SHAPECACHE_H
@@ -173,6 +173,7 @@
 
 #include <array>
 #include <deque>
+#include <QtConcurrentMap>
 #include <boost/algorithm/string/predicate.hpp>
 #include <Base/Exception.h>
 #include <Base/Console.h>
@@ -191,6 +192,7 @@
 #include "BRepOffsetAPI_MakeOffsetFix.h"
 #include "Geometry.h"
 #include "FaceMakerBullseye.h"
+#include "PartParams.h"
 
 #define TOPOP_VERSION 15
 
@@ -379,10 +381,7 @@ public:
         }
 
         TopoDS_Shape stripLocation(const TopoDS_Shape &parent, const TopoDS_Shape &child) {
-            if(parent.Location() != owner->loc) {
-                owner->loc = parent.Location();
-                owner->locInv = parent.Location().Inverted();
-            }
+            owner->initLocation(parent);
             return child.Located(owner->locInv*child.Location());
         }
 
@@ -415,6 +414,18 @@ public:
         :shape(s.Located(TopLoc_Location()))
     {}
 
+    /** Update the cached inverse location of the parent shape
+     *
+     * Call this before querying the cache concurrently with the same parent
+     * shape, so that the queries do not modify the cache.
+     */
+    void initLocation(const TopoDS_Shape &parent) {
+        if(parent.Location() != loc) {
+            loc = parent.Location();
+            locInv = parent.Location().Inverted();
+        }
+    }
+
     Info &getInfo(TopAbs_ShapeEnum type, bool clearTopoShapes=false) {
         auto &info = infos[type];
         if(!info.owner) {
@@ -1372,6 +1383,17 @@ struct MapperThruSections: MapperMaker {
     }
 };
 
+// Obtain the result of an OCC maker, which builds it if not done yet, and log
+// the time of the OCC operation apart from the naming time of makESHAPE()
+template<class T>
+static TopoDS_Shape buildShape(T &mk, const char *op)
+{
+    FC_TIME_INIT(t);
+    TopoDS_Shape res = mk.Shape();
+    FC_TIME_LOG(t, (op?op:TOPOP_MAKER) << " build");
+    return res;
+}
+
 TopoShape &TopoShape::makEShape(BRepOffsetAPI_ThruSections &mk, const TopoShape &source,
         const char *op)
 {
@@ -1383,7 +1405,7 @@ TopoShape &TopoShape::makEShape(BRepOffsetAPI_ThruSections &mk, const std::vecto
         const char *op)
 {
     if(!op) op = TOPOP_THRU_SECTIONS;
-    return makESHAPE(mk.Shape(),MapperThruSections(mk,sources),sources,op);
+    return makESHAPE(buildShape(mk,op),MapperThruSections(mk,sources),sources,op);
 }
 
 TopoShape &TopoShape::makELoft(const std::vector<TopoShape> &shapes,
@@ -2604,14 +2626,16 @@ TopoShape &TopoShape::makEShape(const char *maker,
     }
     mk->SetArguments(shapeArguments);
     mk->SetTools(shapeTools);
-    if (tol > 0.0) {
+    if (tol > 0.0)
         mk->SetFuzzyValue(tol);
-        mk->Build();
+
+    FC_TIME_INIT(t);
+    mk->Build();
+    FC_TIME_LOG(t, op << " boolean");
+    if (tol > 0.0)
         makEShape(*mk,_shapes,op);
-    } else {
-        mk->Build();
+    else
         makEShape(*mk,shapes,op);
-    }
 
     if(buildShell)
         makEShell();
@@ -2653,7 +2677,7 @@ struct ShapeInfo {
 TopoShape &TopoShape::makEShape(BRepBuilderAPI_MakeShape &mkShape,
         const std::vector<TopoShape> &shapes, const char *op)
 {
-    return makESHAPE(mkShape.Shape(),MapperMaker(mkShape),shapes,op);
+    return makESHAPE(buildShape(mkShape,op),MapperMaker(mkShape),shapes,op);
 }
 
 const char *TopoShape::setElementComboName(const char *element,
@@ -2746,6 +2770,247 @@ struct NameInfo {
     const char *shapetype;
 };
 
+/// Build the sub-shape index map of a given type in a shape cache
+struct SubShapeCacheBuilder {
+    typedef void result_type;
+    typedef std::pair<TopoShape::Cache*, TopAbs_ShapeEnum> Task;
+
+    void operator()(const Task &task) const {
+        task.first->getInfo(task.second);
+    }
+};
+
+/// Modification and generation history of an input sub-element
+struct ElementHistory {
+    int index;
+    TopoDS_Shape element;
+    std::vector<TopoDS_Shape> modified;
+    std::vector<TopoDS_Shape> generated;
+};
+
+/// Name candidate of a new sub-element collected from the history
+struct ElementNameEntry {
+    std::string element;
+    NameKey key;
+    NameInfo info;
+};
+
+/// Name collecting job of one type of sub-element of an input shape
+struct ElementNameJob {
+    ShapeInfo *info = nullptr;
+    const TopoShape *other = nullptr;
+    std::vector<ElementHistory> history;
+    std::vector<ElementNameEntry> entries;
+    /// pending log messages as pair(isError, message)
+    std::vector<std::pair<bool, std::string> > messages;
+};
+
+/** Collect name candidates from the history of input sub-elements
+ *
+ * The collector only reads the element maps and the sub-shape caches, which
+ * allows multiple jobs to run concurrently. Log messages are saved in the job
+ * and printed by the caller.
+ */
+struct ElementNameCollector {
+    typedef void result_type;
+
+    const TopoShape &shape;
+    const std::array<ShapeInfo*,TopAbs_SHAPE> &infoMap;
+    const char *op;
+
+    ElementNameCollector(const TopoShape &shape,
+            const std::array<ShapeInfo*,TopAbs_SHAPE> &infoMap, const char *op)
+        :shape(shape),infoMap(infoMap),op(op)
+    {}
+
+    void operator()(ElementNameJob &job) const;
+};
+
+#define JOB_MSG(_error,_msg) do {\
+    std::ostringstream _ss;\
+    _ss << _msg;\
+    job.messages.emplace_back(_error,_ss.str());\
+}while(0)
+
+void ElementNameCollector::operator()(ElementNameJob &job) const
+{
+    auto &info = *job.info;
+    const auto &other = *job.other;
+    std::ostringstream ss;
+
+    for(auto &history : job.history) {
+        int i = history.index;
+        const auto &otherElement = history.element;
+
+        // Find all new objects that are a modification of the old object
+        ss.str("");
+        ss << info.shapetype << i;
+        std::vector<App::StringIDRef> sids;
+        NameKey key(info.type, other.getElementName(ss.str().c_str(),
+                    Data::ComplexGeoData::MapToNamed,&sids));
+
+        int k=0;
+        for(auto &newShape : history.modified) {
+            ++k;
+            if(newShape.ShapeType()>=TopAbs_SHAPE) {
+                JOB_MSG(true, "unknown modified shape type " << newShape.ShapeType()
+                        << " from " << info.shapetype << i);
+                continue;
+            }
+            auto &newInfo = *infoMap[newShape.ShapeType()];
+            if(newInfo.type != newShape.ShapeType()) {
+                JOB_MSG(false, "modified shape type " << TopoShape::shapeName(newShape.ShapeType())
+                        << " mismatch with " << info.shapetype << i);
+                continue;
+            }
+            int j = newInfo.find(newShape);
+            if(!j) {
+                // This warning occurs in makERevolve. It generates
+                // some shape from a vertex that never made into the
+                // final shape. There may be other cases there.
+                if(FC_LOG_INSTANCE.isEnabled(FC_LOGLEVEL_LOG))
+                    JOB_MSG(false, "Cannot find " << op << " modified " <<
+                        newInfo.shapetype << " from " << info.shapetype << i);
+                continue;
+            }
+            ss.str("");
+            ss << newInfo.shapetype << j;
+            std::string element = ss.str();
+
+            if(shape.getElementName(element.c_str(),Data::ComplexGeoData::MapToNamed)!=element.c_str())
+                continue;
+
+            key.tag = other.Tag;
+            job.entries.emplace_back();
+            auto &entry = job.entries.back();
+            entry.element = std::move(element);
+            entry.key = key;
+            entry.info.sids = sids;
+            entry.info.index = k;
+            entry.info.shapetype = info.shapetype;
+        }
+
+        int checkParallel = -1;
+        gp_Pln pln;
+
+        // Find all new objects that were generated from an old object
+        // (e.g. a face generated from an edge)
+        k=0;
+        for(auto &newShape : history.generated) {
+            if(newShape.ShapeType()>=TopAbs_SHAPE) {
+                JOB_MSG(true, "unknown generated shape type " << newShape.ShapeType()
+                        << " from " << info.shapetype << i);
+                continue;
+            }
+
+            int parallelFace = -1;
+            int coplanarFace = -1;
+            auto &newInfo = *infoMap[newShape.ShapeType()];
+            std::vector<TopoDS_Shape> newShapes;
+            int shapeOffset = 0;
+            if(newInfo.type == newShape.ShapeType()) {
+                newShapes.push_back(newShape);
+            } else {
+                // It is possible for the maker to report generating a
+                // higher level shape, such as shell or solid. For
+                // example, when extruding, OCC will report the
+                // extruding face generating the entire solid. However,
+                // it will also report the edges of the extruding face
+                // generating the side faces. In this case, too much
+                // information is bad for us. We don't want the name of
+                // the side face (and its edges) to be coupled with
+                // other (unrelated) edges in the extruding face.
+                //
+                // shapeOffset below is used to make sure the higher
+                // level mapped names comes late after sorting. We'll
+                // ignore those names if there are more precise mapping
+                // available.
+                shapeOffset = 3;
+
+                if(info.type==TopAbs_FACE && checkParallel<0) {
+                    if(!TopoShape(otherElement).findPlane(pln))
+                        checkParallel = 0;
+                    else
+                        checkParallel = 1;
+                }
+                for(TopExp_Explorer xp(newShape,newInfo.type);xp.More();xp.Next()) {
+                    newShapes.push_back(xp.Current());
+
+                    if((parallelFace<0||coplanarFace<0) && checkParallel>0) {
+                        // Specialized checking for high level mapped
+                        // face that are either coplanar or parallel
+                        // with the source face, which are common in
+                        // operations like extrusion. Once found, the
+                        // first coplanar face will assign an index of
+                        // INT_MIN+1, and the first parallel face
+                        // INT_MIN. The purpose of these special
+                        // indexing is to make the name more stable for
+                        // those generated faces.
+                        //
+                        // For example, the top or bottom face of an
+                        // extrusion will be named using the extruding
+                        // face. With a fixed index, the name is no
+                        // longer affected by adding/removing of holes
+                        // inside the extruding face/sketch.
+                        gp_Pln plnOther;
+                        if(TopoShape(newShapes.back()).findPlane(plnOther)) {
+                            if(pln.Axis().IsParallel(plnOther.Axis(),Precision::Angular())) {
+                                if(coplanarFace<0) {
+                                    gp_Vec vec(pln.Axis().Location(),plnOther.Axis().Location());
+                                    Standard_Real D1 = gp_Vec(pln.Axis().Direction()).Dot(vec);
+                                    if (D1 < 0) D1 = - D1;
+                                    Standard_Real D2 = gp_Vec(plnOther.Axis().Direction()).Dot(vec);
+                                    if (D2 < 0) D2 = - D2;
+                                    if(D1 <= Precision::Confusion() && D2 <= Precision::Confusion()) {
+                                        coplanarFace = (int)newShapes.size();
+                                        continue;
+                                    }
+                                }
+                                if(parallelFace<0)
+                                    parallelFace = (int)newShapes.size();
+                            }
+                        }
+                    }
+                }
+            }
+            key.shapetype += shapeOffset;
+            for(auto &newShape : newShapes) {
+                ++k;
+                int j = newInfo.find(newShape);
+                if(!j) {
+                    if(FC_LOG_INSTANCE.isEnabled(FC_LOGLEVEL_LOG))
+                        JOB_MSG(false, "Cannot find " << op << " generated " <<
+                                newInfo.shapetype << " from " << info.shapetype << i);
+                    continue;
+                }
+                ss.str("");
+                ss << newInfo.shapetype << j;
+
+                std::string element = ss.str();
+                if(shape.getElementName(element.c_str(),Data::ComplexGeoData::MapToNamed)!=element.c_str())
+                    continue;
+
+                key.tag = other.Tag;
+                job.entries.emplace_back();
+                auto &entry = job.entries.back();
+                entry.element = std::move(element);
+                entry.key = key;
+                entry.info.sids = sids;
+                if(k == parallelFace)
+                    entry.info.index = INT_MIN;
+                else if(k == coplanarFace)
+                    entry.info.index = INT_MIN+1;
+                else
+                    entry.info.index = -k;
+                entry.info.shapetype = info.shapetype;
+            }
+            key.shapetype -= shapeOffset;
+        }
+    }
+}
+
+#undef JOB_MSG
+
 TopoShape &TopoShape::makESHAPE(const TopoDS_Shape &shape, const Mapper &mapper,
         const std::vector<TopoShape> &shapes, const char *op)
 {
@@ -2758,8 +3023,8 @@ TopoShape &TopoShape::makESHAPE(const TopoDS_Shape &shape, const Mapper &mapper,
         return *this;
 
     size_t canMap=0;
-    for(auto &shape : shapes) {
-        if(canMapElement(shape))
+    for(auto &input : shapes) {
+        if(canMapElement(input))
             ++canMap;
     }
     if(!canMap)
@@ -2771,11 +3036,38 @@ TopoShape &TopoShape::makESHAPE(const TopoDS_Shape &shape, const Mapper &mapper,
     std::string _op = op;
     _op += '_';
 
+    FC_TIME_INIT2(t,t1);
+
     INIT_SHAPE_CACHE();
+
+    // Build the sub-shape index maps of the new shape and the input shapes
+    {
+        std::vector<SubShapeCacheBuilder::Task> tasks;
+        std::set<Cache*> caches;
+        size_t mapSize = 0;
+        caches.insert(_Cache.get());
+        for(auto &input : shapes) {
+            if(canMapElement(input) && caches.insert(input._Cache.get()).second)
+                mapSize += input.getElementMapSize();
+        }
+        for(auto cache : caches) {
+            for(auto type : {TopAbs_VERTEX, TopAbs_EDGE, TopAbs_FACE})
+                tasks.emplace_back(cache,type);
+        }
+        if(PartParams::ParallelElementMap()
+                && (int)mapSize >= PartParams::ParallelElementMapThreshold())
+            QtConcurrent::blockingMap(tasks,SubShapeCacheBuilder());
+        else {
+            for(auto &task : tasks)
+                SubShapeCacheBuilder()(task);
+        }
+    }
     ShapeInfo vinfo(_Shape,TopAbs_VERTEX,_Cache->getInfo(TopAbs_VERTEX));
     ShapeInfo einfo(_Shape,TopAbs_EDGE,_Cache->getInfo(TopAbs_EDGE));
     ShapeInfo finfo(_Shape,TopAbs_FACE,_Cache->getInfo(TopAbs_FACE));
+    FC_TIME_LOG(t1, op << " sub-shape cache");
     mapSubElement(shapes);
+    FC_TIME_LOG(t1, op << " sub-element mapping");
 
     std::array<ShapeInfo*,3> infos = {&vinfo,&einfo,&finfo};
 
@@ -2795,7 +3087,15 @@ TopoShape &TopoShape::makESHAPE(const TopoDS_Shape &shape, const Mapper &mapper,
     std::map<std::string,std::map<NameKey,NameInfo> > newNames;
 
     // First, collect names from other shapes that generates or modifies the
-    // new shape
+    // new shape. The history of each type of sub-element of each input shape
+    // is queried serially, because the mapper (and the underlying OCC maker)
+    // is not thread safe. The names are then collected by one job per element
+    // type and input shape, which may run concurrently. The job results are
+    // merged in the same order as they are queued to keep naming
+    // deterministic.
+    std::vector<ElementNameJob> jobs;
+    jobs.reserve(infos.size()*shapes.size());
+    size_t historyCount = 0;
     for(auto &pinfo : infos) {
         auto &info = *pinfo;
         for(size_t n=0;n<shapes.size();++n) {
@@ -2806,168 +3106,49 @@ TopoShape &TopoShape::makESHAPE(const TopoDS_Shape &shape, const Mapper &mapper,
             if(!otherMap.count())
                 continue;
 
+            jobs.emplace_back();
+            auto &job = jobs.back();
+            job.info = &info;
+            job.other = &other;
+            job.history.reserve(otherMap.count());
             for (int i=1; i<=otherMap.count(); i++) {
-                const auto &otherElement = otherMap.find(other._Shape,i);
-                // Find all new objects that are a modification of the old object
-                ss.str("");
-                ss << info.shapetype << i;
-                std::vector<App::StringIDRef> sids;
-                NameKey key(info.type, other.getElementName(ss.str().c_str(),MapToNamed,&sids));
-
-                int k=0;
-                for(auto &newShape : mapper.modified(otherElement)) {
-                    ++k;
-                    if(newShape.ShapeType()>=TopAbs_SHAPE) {
-                        FC_ERR("unknown modified shape type " << newShape.ShapeType()
-                                << " from " << info.shapetype << i);
-                        continue;
-                    }
-                    auto &newInfo = *infoMap[newShape.ShapeType()];
-                    if(newInfo.type != newShape.ShapeType()) {
-                        FC_WARN("modified shape type " << shapeName(newShape.ShapeType())
-                                << " mismatch with " << info.shapetype << i);
-                        continue;
-                    }
-                    int j = newInfo.find(newShape);
-                    if(!j) {
-                        // This warning occurs in makERevolve. It generates
-                        // some shape from a vertex that never made into the
-                        // final shape. There may be other cases there.
-                        if(FC_LOG_INSTANCE.isEnabled(FC_LOGLEVEL_LOG))
-                            FC_WARN("Cannot find " << op << " modified " <<
-                                newInfo.shapetype << " from " << info.shapetype << i);
-                        continue;
-                    }
-                    ss.str("");
-                    ss << newInfo.shapetype << j;
-                    std::string element = ss.str();
-
-                    if(getElementName(element.c_str(),MapToNamed)!=element.c_str())
-                        continue;
-
-                    key.tag = other.Tag;
-                    auto &name_info = newNames[element][key];
-                    name_info.sids = sids;
-                    name_info.index = k;
-                    name_info.shapetype = info.shapetype;
-                }
-
-                int checkParallel = -1;
-                gp_Pln pln;
+                job.history.emplace_back();
+                auto &history = job.history.back();
+                history.index = i;
+                history.element = otherMap.find(other._Shape,i);
+                history.modified = mapper.modified(history.element);
+                history.generated = mapper.generated(history.element);
+                historyCount += history.modified.size() + history.generated.size();
+            }
+        }
+    }
+    FC_TIME_LOG(t1, op << " element history");
 
-                // Find all new objects that were generated from an old object
-                // (e.g. a face generated from an edge)
-                k=0;
-                for(auto &newShape : mapper.generated(otherElement)) {
-                    if(newShape.ShapeType()>=TopAbs_SHAPE) {
-                        FC_ERR("unknown generated shape type " << newShape.ShapeType()
-                                << " from " << info.shapetype << i);
-                        continue;
-                    }
+    // Make sure the concurrent sub-shape queries below do not modify the cache
+    _Cache->initLocation(_Shape);
 
-                    int parallelFace = -1;
-                    int coplanarFace = -1;
-                    auto &newInfo = *infoMap[newShape.ShapeType()];
-                    std::vector<TopoDS_Shape> newShapes;
-                    int shapeOffset = 0;
-                    if(newInfo.type == newShape.ShapeType()) {
-                        newShapes.push_back(newShape);
-                    } else {
-                        // It is possible for the maker to report generating a
-                        // higher level shape, such as shell or solid. For
-                        // example, when extruding, OCC will report the
-                        // extruding face generating the entire solid. However,
-                        // it will also report the edges of the extruding face
-                        // generating the side faces. In this case, too much
-                        // information is bad for us. We don't want the name of
-                        // the side face (and its edges) to be coupled with
-                        // other (unrelated) edges in the extruding face.
-                        //
-                        // shapeOffset below is used to make sure the higher
-                        // level mapped names comes late after sorting. We'll
-                        // ignore those names if there are more precise mapping
-                        // available.
-                        shapeOffset = 3;
-
-                        if(info.type==TopAbs_FACE && checkParallel<0) {
-                            if(!TopoShape(otherElement).findPlane(pln))
-                                checkParallel = 0;
-                            else
-                                checkParallel = 1;
-                        }
-                        for(TopExp_Explorer xp(newShape,newInfo.type);xp.More();xp.Next()) {
-                            newShapes.push_back(xp.Current());
-
-                            if((parallelFace<0||coplanarFace<0) && checkParallel>0) {
-                                // Specialized checking for high level mapped
-                                // face that are either coplanar or parallel
-                                // with the source face, which are common in
-                                // operations like extrusion. Once found, the
-                                // first coplanar face will assign an index of
-                                // INT_MIN+1, and the first parallel face
-                                // INT_MIN. The purpose of these special
-                                // indexing is to make the name more stable for
-                                // those generated faces.
-                                //
-                                // For example, the top or bottom face of an
-                                // extrusion will be named using the extruding
-                                // face. With a fixed index, the name is no
-                                // longer affected by adding/removing of holes
-                                // inside the extruding face/sketch.
-                                gp_Pln plnOther;
-                                if(TopoShape(newShapes.back()).findPlane(plnOther)) {
-                                    if(pln.Axis().IsParallel(plnOther.Axis(),Precision::Angular())) {
-                                        if(coplanarFace<0) {
-                                            gp_Vec vec(pln.Axis().Location(),plnOther.Axis().Location());
-                                            Standard_Real D1 = gp_Vec(pln.Axis().Direction()).Dot(vec);
-                                            if (D1 < 0) D1 = - D1;
-                                            Standard_Real D2 = gp_Vec(plnOther.Axis().Direction()).Dot(vec);
-                                            if (D2 < 0) D2 = - D2;
-                                            if(D1 <= Precision::Confusion() && D2 <= Precision::Confusion()) {
-                                                coplanarFace = (int)newShapes.size();
-                                                continue;
-                                            }
-                                        }
-                                        if(parallelFace<0)
-                                            parallelFace = (int)newShapes.size();
-                                    }
-                                }
-                            }
-                        }
-                    }
-                    key.shapetype += shapeOffset;
-                    for(auto &newShape : newShapes) {
-                        ++k;
-                        int j = newInfo.find(newShape);
-                        if(!j) {
-                            if(FC_LOG_INSTANCE.isEnabled(FC_LOGLEVEL_LOG))
-                                FC_WARN("Cannot find " << op << " generated " <<
-                                        newInfo.shapetype << " from " << info.shapetype << i);
-                            continue;
-                        }
-                        ss.str("");
-                        ss << newInfo.shapetype << j;
-
-                        std::string element = ss.str();
-                        if(getElementName(element.c_str(),MapToNamed)!=element.c_str())
-                            continue;
+    ElementNameCollector collector(*this,infoMap,op);
+    if(jobs.size()>1 && PartParams::ParallelElementMap()
+            && (int)historyCount >= PartParams::ParallelElementMapThreshold())
+    {
+        QtConcurrent::blockingMap(jobs,collector);
+    } else {
+        for(auto &job : jobs)
+            collector(job);
+    }
 
-                        key.tag = other.Tag;
-                        auto &name_info = newNames[element][key];
-                        name_info.sids = sids;
-                        if(k == parallelFace)
-                            name_info.index = INT_MIN;
-                        else if(k == coplanarFace)
-                            name_info.index = INT_MIN+1;
-                        else
-                            name_info.index = -k;
-                        name_info.shapetype = info.shapetype;
-                    }
-                    key.shapetype -= shapeOffset;
-                }
-            }
+    for(auto &job : jobs) {
+        for(auto &msg : job.messages) {
+            if(msg.first)
+                FC_ERR(msg.second);
+            else
+                FC_WARN(msg.second);
         }
+        for(auto &entry : job.entries)
+            newNames[entry.element][entry.key] = std::move(entry.info);
     }
+    jobs.clear();
+    FC_TIME_LOG(t1, op << " element name collection");
 
     // We shall first exclude those names generated from high level mapping. If
     // there are still any unnamed elements left after we go through the process
@@ -3267,6 +3448,8 @@ TopoShape &TopoShape::makESHAPE(const TopoDS_Shape &shape, const Mapper &mapper,
             break;
         delayed = true;
     }
+    FC_TIME_LOG(t1, op << " element name assignment");
+    FC_TIME_LOG(t, op << " element map");
     return *this;
 }
 
@@ -3570,21 +3753,24 @@ TopoShape &TopoShape::makEShape(BRepOffsetAPI_MakePipeShell &mkShape,
         const std::vector<TopoShape> &source, const char *op)
 {
     if(!op) op = TOPOP_PIPE_SHELL;
-    return makESHAPE(mkShape.Shape(),MapperMaker(mkShape),source,op);
+    return makESHAPE(buildShape(mkShape,op),MapperMaker(mkShape),source,op);
 }
 
 TopoShape &TopoShape::makEShape(BRepFeat_MakePrism &mkShape,
         const TopoShape &source, const char *op)
 {
     if(!op) op = TOPOP_PRISM;
-    return makESHAPE(mkShape.Shape(),MapperMaker(mkShape),{source},op);
+    return makESHAPE(buildShape(mkShape,op),MapperMaker(mkShape),{source},op);
 }
 
 TopoShape &TopoShape::makEShape(BRepPrimAPI_MakeHalfSpace &mkShape,
         const TopoShape &source, const char *op)
 {
     if(!op) op = TOPOP_HALF_SPACE;
-    return makESHAPE(mkShape.Solid(),MapperMaker(mkShape),{source},op);
+    FC_TIME_INIT(t);
+    TopoDS_Shape solid = mkShape.Solid();
+    FC_TIME_LOG(t, op << " build");
+    return makESHAPE(solid,MapperMaker(mkShape),{source},op);
 }
 
 TopoShape &TopoShape::makEDraft(const TopoShape &shape, const std::vector<TopoShape> &_faces,
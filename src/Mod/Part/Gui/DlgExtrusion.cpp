@@ -103,6 +103,7 @@ public:
 DlgExtrusion::DlgExtrusion(QWidget* parent, Qt::WindowFlags fl)
   : QDialog(parent, fl), ui(new Ui_DlgExtrusion), filter(nullptr)
 {
+    setPerElementNotification();
     ui->setupUi(this);
     ui->statusLabel->clear();
     ui->dirX->setDecimals(Base::UnitsApi::getDecimals());
@@ -235,6 +235,7 @@ namespace PartGui {
 DlgFilletEdges::DlgFilletEdges(FilletType type, Part::FilletBase* fillet, QWidget* parent, Qt::WindowFlags fl)
   : QWidget(parent, fl), ui(new Ui_DlgFilletEdges()), d(new Private())
 {
+    setPerElementNotification();
     ui->setupUi(this);
     ui->filletStartRadius->setMaximum(INT_MAX);
     ui->filletStartRadius->setMinimum(0);
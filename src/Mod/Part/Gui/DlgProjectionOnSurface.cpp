@@ -135,6 +135,7 @@ DlgProjectionOnSurface::DlgProjectionOnSurface(QWidget *parent)
   , filterEdge(nullptr)
   , filterFace(nullptr)
 {
+    setPerElementNotification();
     ui->setupUi(this);
     ui->pushButtonAddEdge->setCheckable(true);
     ui->pushButtonAddFace->setCheckable(true);
@@ -103,6 +103,7 @@ public:
 DlgRevolution::DlgRevolution(QWidget* parent, Qt::WindowFlags fl)
   : QDialog(parent, fl), filter(0)
 {
+    setPerElementNotification();
     ui = new Ui_DlgRevolution();
 
     ui->setupUi(this);
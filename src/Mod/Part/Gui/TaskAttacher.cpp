@@ -142,6 +142,7 @@ TaskAttacher::TaskAttacher(Gui::ViewProviderDocumentObject *ViewProvider, QWidge
       ViewProvider(ViewProvider),
       visibilityFunc(visFunc)
 {
+    setPerElementNotification();
     //check if we are attachable
     if (!ViewProvider->getObject()->hasExtension(Part::AttachExtension::getExtensionClassTypeId()))
         throw Base::RuntimeError("Object has no Part::AttachExtension");
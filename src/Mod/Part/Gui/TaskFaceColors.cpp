@@ -268,6 +268,7 @@ public:
 FaceColors::FaceColors(ViewProviderPartExt* vp, QWidget* parent)
   : d(new Private(vp))
 {
+    setPerElementNotification();
     Q_UNUSED(parent);
     d->ui->setupUi(this);
     d->ui->groupBox->setTitle(QString::fromUtf8(vp->getObject()->Label.getValue()));
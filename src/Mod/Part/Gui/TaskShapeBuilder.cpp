@@ -110,6 +110,7 @@ public:
 ShapeBuilderWidget::ShapeBuilderWidget(QWidget* parent)
   : d(new Private())
 {
+    setPerElementNotification();
     Q_UNUSED(parent);
     d->ui.setupUi(this);
     d->ui.label->setText(QString());
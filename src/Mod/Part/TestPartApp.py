@@ -59,6 +59,100 @@ class PartTestCases(unittest.TestCase):
         FreeCAD.closeDocument("PartTest")
         #print ("omit closing document for debugging")
 
+class PartTestShapeCache(unittest.TestCase):
+    def setUp(self):
+        self.Param = FreeCAD.ParamGet("User parameter:BaseApp/Preferences/Mod/Part")
+        self.CacheSize = self.Param.GetInt("ShapeResultCacheSize", 128)
+        self.Param.SetInt("ShapeResultCacheSize", 128)
+        self.Doc = FreeCAD.newDocument("PartShapeCache")
+        self.Box = self.Doc.addObject("Part::Box","Box")
+        self.Cylinder = self.Doc.addObject("Part::Cylinder","Cylinder")
+        self.Cylinder.Radius = 2
+        self.Cylinder.Height = 20
+        self.Plane = self.Doc.addObject("Part::Plane","Plane")
+        self.Plane.Length = 10
+        self.Plane.Width = 10
+        self.Extrusion = self.Doc.addObject("Part::Extrusion","Extrusion")
+        self.Extrusion.Base = self.Plane
+        self.Extrusion.LengthFwd = 5
+        self.Doc.recompute()
+
+    def testHitAfterToggle(self):
+        cut = self.Doc.addObject("Part::Cut","Cut")
+        cut.Base = self.Box
+        cut.Tool = self.Cylinder
+        self.Doc.recompute()
+        shape = cut.Shape
+        cut.Refine = True
+        self.Doc.recompute()
+        self.assertFalse(cut.Shape.isSame(shape))
+        cut.Refine = False
+        self.Doc.recompute()
+        self.assertTrue(cut.Shape.isSame(shape))
+
+        shape = self.Extrusion.Shape
+        self.Extrusion.LengthFwd = 10
+        self.Doc.recompute()
+        self.assertFalse(self.Extrusion.Shape.isSame(shape))
+        self.assertAlmostEqual(self.Extrusion.Shape.Volume, 1000)
+        self.Extrusion.LengthFwd = 5
+        self.Doc.recompute()
+        self.assertTrue(self.Extrusion.Shape.isSame(shape))
+        self.assertAlmostEqual(self.Extrusion.Shape.Volume, 500)
+
+    def testMissAfterInputChange(self):
+        cut = self.Doc.addObject("Part::Cut","Cut")
+        cut.Base = self.Box
+        cut.Tool = self.Cylinder
+        self.Doc.recompute()
+        shape = cut.Shape
+        volume = shape.Volume
+        self.Box.Length = 20
+        self.Doc.recompute()
+        self.assertFalse(cut.Shape.isSame(shape))
+        self.assertAlmostEqual(cut.Shape.Volume, volume + 1000)
+        # an equal but recomputed input is a different shape
+        self.Box.Length = 10
+        self.Doc.recompute()
+        self.assertFalse(cut.Shape.isSame(shape))
+        self.assertAlmostEqual(cut.Shape.Volume, volume)
+
+        shape = self.Extrusion.Shape
+        self.Plane.Length = 20
+        self.Doc.recompute()
+        self.assertFalse(self.Extrusion.Shape.isSame(shape))
+        self.assertAlmostEqual(self.Extrusion.Shape.Volume, 1000)
+        self.Plane.Length = 10
+        self.Doc.recompute()
+        self.assertAlmostEqual(self.Extrusion.Shape.Volume, 500)
+
+    def testExtrusionLinkedDirection(self):
+        line = self.Doc.addObject("Part::Line","Line")
+        line.X2 = 0
+        line.Y2 = 0
+        line.Z2 = 1
+        self.Extrusion.DirMode = "Edge"
+        self.Extrusion.DirLink = (line, ["Edge1"])
+        self.Extrusion.LengthFwd = 10
+        self.Doc.recompute()
+        shape = self.Extrusion.Shape
+        self.assertAlmostEqual(shape.BoundBox.ZLength, 10, 3)
+
+        # only the linked line changes, not the extrusion or its base
+        line.X2 = 1
+        self.Doc.recompute()
+        self.assertFalse(self.Extrusion.Shape.isSame(shape))
+        self.assertAlmostEqual(self.Extrusion.Shape.BoundBox.ZLength, 10 / 2**0.5, 3)
+
+        line.X2 = 0
+        self.Doc.recompute()
+        self.assertTrue(self.Extrusion.Shape.isSame(shape))
+        self.assertAlmostEqual(self.Extrusion.Shape.BoundBox.ZLength, 10, 3)
+
+    def tearDown(self):
+        FreeCAD.closeDocument("PartShapeCache")
+        self.Param.SetInt("ShapeResultCacheSize", self.CacheSize)
+
 class PartTestBSplineCurve(unittest.TestCase):
     def setUp(self):
         self.Doc = FreeCAD.newDocument("PartTest")
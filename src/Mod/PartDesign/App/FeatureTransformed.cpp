@@ -82,6 +82,14 @@ Transformed::Transformed()
     ADD_PROPERTY_TYPE(TransformOffset,(Base::Placement()),"Base",(App::PropertyType)(App::Prop_None),
         "Offset placement applied to the source shape before pattern transformation.");
 
+    ADD_PROPERTY_TYPE(BatchBoolean,(false),"Base",(App::PropertyType)(App::Prop_None),
+        "Transform all pattern instances first, and then fuse/cut them with the support\n"
+        "in a single boolean operation. Disable to apply the instances one by one, which\n"
+        "is slower but reports the failed instance.");
+
+    ADD_PROPERTY_TYPE(Tolerance,(0.0),"Base",(App::PropertyType)(App::Prop_None),
+        "Tolerance of the boolean operation (fuzzy value). In addition to tolerances of the shapes.");
+
     //init Refine property
     Base::Reference<ParameterGrp> hGrp = App::GetApplication().GetUserParameter()
         .GetGroup("BaseApp")->GetGroup("Preferences")->GetGroup("Mod/PartDesign");
@@ -354,7 +362,7 @@ App::DocumentObjectExecReturn *Transformed::execute(void)
                     if (cutShapes.size() <= 1 && NewSolid.getValue())
                         support.makECompound(fuseShapes);
                     else
-                        support.makEFuse(fuseShapes);
+                        support.makEFuse(fuseShapes, 0, Tolerance.getValue());
                 }
                 if(cutShapes.size() > 1) {
                     if (support.isNull()) { // means new solid without fuseShapes
@@ -366,7 +374,7 @@ App::DocumentObjectExecReturn *Transformed::execute(void)
                         }
                     } else {
                         cutShapes[0] = support;
-                        result.makECut(cutShapes);
+                        result.makECut(cutShapes, 0, Tolerance.getValue());
                     }
                 }else
                     result = support;
@@ -385,6 +393,73 @@ App::DocumentObjectExecReturn *Transformed::execute(void)
         }
         originalShapes.clear();
     }
+    else if (BatchBoolean.getValue()) {
+        // Transform all instances first, and then fuse/cut them with the
+        // support in one boolean operation. Consecutive originals with the
+        // same operation are batched together, so that the order of fusing
+        // and cutting is the same as applying the instances one by one.
+        std::vector<TopoShape> tools;
+        bool fuseTools = true;
+        auto applyTools = [&]() {
+            if (tools.empty())
+                return;
+            tools.insert(tools.begin(), support);
+            try {
+                if (fuseTools) {
+                    result.makEFuse(tools, 0, Tolerance.getValue());
+                    support = this->getSolid(result);
+                    if (support.isNull())
+                        throw Base::CADKernelError("Resulting shape is not a solid");
+                } else {
+                    result.makECut(tools, 0, Tolerance.getValue());
+                    support = result;
+                }
+            } catch (Standard_Failure& e) {
+                std::string msg("Boolean operation failed");
+                if (e.GetMessageString() != NULL)
+                    msg += std::string(": '") + e.GetMessageString() + "'";
+                throw Base::CADKernelError(msg.c_str());
+            }
+            tools.clear();
+        };
+
+        try {
+            int i=0;
+            for (const TopoShape &shape : originalShapes) {
+                auto &sub = originalSubs[i];
+                int idx = startIndices[i];
+                bool fuse = fuses[i++];
+                if (fuse != fuseTools) {
+                    applyTools();
+                    fuseTools = fuse;
+                }
+
+                std::vector<gp_Trsf>::const_iterator t = transformations.begin();
+                if (idx != 0)
+                    ++t; // Skip first transformation, which is always the identity transformation
+                for (; t != transformations.end(); ++t,++idx) {
+                    ss.str("");
+                    ss << 'I' << idx;
+                    auto shapeCopy = CopyShape.getValue()?shape.makECopy():shape;
+                    if (shapeCopy.isNull())
+                        return new App::DocumentObjectExecReturn("Transformed: Linked shape object is empty");
+                    try {
+                        tools.push_back(shapeCopy.makETransform(*t, ss.str().c_str(), true));
+                    }catch(Standard_Failure &) {
+                        std::string msg("Transformation failed ");
+                        msg += sub;
+                        return new App::DocumentObjectExecReturn(msg.c_str());
+                    }
+                }
+            }
+            applyTools();
+        } catch (Base::Exception &e) {
+            std::string msg(e.what());
+            msg += "\nSet property 'BatchBoolean' to false to find out the failed instance.";
+            return new App::DocumentObjectExecReturn(msg.c_str());
+        }
+        originalShapes.clear();
+    }
 
 
     // NOTE: It would be possible to build a compound from all original addShapes/subShapes and then
@@ -621,6 +696,7 @@ void Transformed::onChanged(const App::Property *prop) {
 
 void Transformed::setupObject () {
     CopyShape.setValue(false);
+    BatchBoolean.setValue(true);
 }
 
 bool Transformed::isElementGenerated(const TopoShape &shape, const char *name) const
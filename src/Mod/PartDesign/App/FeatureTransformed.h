@@ -58,6 +58,10 @@ public:
 
     App::PropertyPlacement TransformOffset;
 
+    App::PropertyBool BatchBoolean;
+
+    App::PropertyLength Tolerance;
+
     /**
      * Returns the BaseFeature property's object(if any) otherwise return first original,
      *         which serves as "Support" for old style workflows
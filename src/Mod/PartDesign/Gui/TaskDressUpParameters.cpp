@@ -72,6 +72,7 @@ TaskDressUpParameters::TaskDressUpParameters(ViewProviderDressUp *DressUpView, b
     , allowFaces(selectFaces)
     , allowEdges(selectEdges)
 {
+    setPerElementNotification();
     // remember initial transaction ID
     App::GetApplication().getActiveTransaction(&transactionID);
 
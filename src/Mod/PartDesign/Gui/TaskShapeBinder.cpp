@@ -61,6 +61,7 @@ TaskShapeBinder::TaskShapeBinder(ViewProviderShapeBinder *view, bool /*newObj*/,
                              tr("Datum shape parameters"), true, parent)
     , SelectionObserver(view)
 {
+    setPerElementNotification();
     // we need a separate container widget to add all controls to
     proxy = new QWidget(this);
     ui = new Ui_TaskShapeBinder();
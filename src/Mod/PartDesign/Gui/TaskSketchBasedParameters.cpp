@@ -69,6 +69,7 @@ TaskSketchBasedParameters::TaskSketchBasedParameters(PartDesignGui::ViewProvider
                                                      const std::string& pixmapname, const QString& parname)
     : TaskFeatureParameters(vp, parent, pixmapname, parname)
 {
+    setPerElementNotification();
 
 }
 
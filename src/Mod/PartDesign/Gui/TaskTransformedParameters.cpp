@@ -86,6 +86,7 @@ TaskTransformedParameters::TaskTransformedParameters(ViewProviderTransformed *Tr
       insideMultiTransform(false),
       blockUpdate(false)
 {
+    setPerElementNotification();
     selectionMode = none;
 
     if (TransformedView) {
@@ -108,6 +109,7 @@ TaskTransformedParameters::TaskTransformedParameters(TaskMultiTransformParameter
       insideMultiTransform(true),
       blockUpdate(false)
 {
+    setPerElementNotification();
     selectionMode = none;
 }
 
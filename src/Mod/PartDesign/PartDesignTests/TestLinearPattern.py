@@ -138,6 +138,33 @@ class TestLinearPattern(unittest.TestCase):
         self.Doc.recompute()
         self.assertAlmostEqual(self.LinearPattern.Shape.Volume, 1e4)
 
+    def testBatchBooleanLinearPattern(self):
+        self.Body = self.Doc.addObject('PartDesign::Body','Body')
+        self.Body.SingleSolid = True
+        self.Box = self.Doc.addObject('PartDesign::AdditiveBox','Box')
+        self.Body.addObject(self.Box)
+        self.Box.Length=100.00
+        self.Box.Width=10.00
+        self.Box.Height=10.00
+        self.SubBox = self.Doc.addObject('PartDesign::SubtractiveBox','SubBox')
+        self.Body.addObject(self.SubBox)
+        self.SubBox.Length=5.00
+        self.SubBox.Width=10.00
+        self.SubBox.Height=10.00
+        self.Doc.recompute()
+        self.LinearPattern = self.Doc.addObject("PartDesign::LinearPattern","LinearPattern")
+        self.LinearPattern.Originals = [self.SubBox]
+        self.LinearPattern.Direction = (self.Doc.X_Axis,[""])
+        self.LinearPattern.Length = 90.0
+        self.LinearPattern.Occurrences = 10
+        self.Body.addObject(self.LinearPattern)
+        self.assertTrue(self.LinearPattern.BatchBoolean)
+        self.Doc.recompute()
+        self.assertAlmostEqual(self.LinearPattern.Shape.Volume, 5e3)
+        self.LinearPattern.BatchBoolean = False
+        self.Doc.recompute()
+        self.assertAlmostEqual(self.LinearPattern.Shape.Volume, 5e3)
+
     def tearDown(self):
         #closing doc
         FreeCAD.closeDocument("PartDesignTestLinearPattern")
@@ -25,7 +25,7 @@
 
 #ifndef _PreComp_
 # include <cinttypes>
-# include <iomanip>
+# include <cmath>
 # include <boost/algorithm/string.hpp>
 # include <boost/lexical_cast.hpp>
 #endif
@@ -36,6 +36,7 @@
 #include <Base/Reader.h>
 #include <Base/Exception.h>
 #include "Command.h"
+#include "GCodeParser.h"
 
 using namespace Base;
 using namespace Path;
@@ -98,107 +99,80 @@ bool Command::has(const std::string& attr) const
     return Parameters.count(a) > 0;
 }
 
-std::string Command::toGCode (int precision, bool padzero) const
+void Command::appendValue(std::string &str, double value, int precision, bool padzero)
 {
-    std::stringstream str;
-    str.fill('0');
-    str << Name;
+    static const double scales[] = {
+        1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9,
+        1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18
+    };
+
     if(precision<0)
         precision = 0;
-    double scale = std::pow(10.0,precision+1);
+    double scale = precision < 18 ? scales[precision] : std::pow(10.0,precision+1);
     std::int64_t iscale = static_cast<std::int64_t>(scale)/10;
-    for(std::map<std::string,double>::const_iterator i = Parameters.begin(); i != Parameters.end(); ++i) {
-        if(i->first == "N") continue;
+    std::int64_t v = static_cast<std::int64_t>(value*scale);
+    if(v<0) {
+        v = -v;
+        str += '-'; //shall we allow -0 ?
+    }
+    v+=5;
+    v /= 10;
 
-        str << " " << i->first;
+    // the digits are written backwards into a buffer
+    char buf[24];
+    char *end = buf + sizeof(buf);
+    char *p = end;
+    std::int64_t ipart = v/iscale;
+    do {
+        *--p = static_cast<char>('0' + ipart%10);
+        ipart /= 10;
+    } while(ipart);
+    str.append(p, end - p);
+    if(!precision)
+        return;
 
-        std::int64_t v = static_cast<std::int64_t>(i->second*scale);
-        if(v<0) {
-            v = -v;
-            str << '-'; //shall we allow -0 ?
+    int width = precision;
+    std::int64_t digits = v%iscale;
+    if(!padzero) {
+        if(!digits)
+            return;
+        while(digits%10 == 0) {
+            digits/=10;
+            --width;
         }
-        v+=5;
-        v /= 10;
-        str << (v/iscale);
-        if(!precision) continue;
+    }
+    p = end;
+    for(int i=0; i<width; i++) {
+        *--p = static_cast<char>('0' + digits%10);
+        digits /= 10;
+    }
+    str += '.';
+    str.append(p, end - p);
+}
 
-        int width = precision;
-        std::int64_t digits = v%iscale;
-        if(!padzero) {
-            if(!digits) continue;
-            while(digits%10 == 0) {
-                digits/=10;
-                --width;
-            }
-        }
-        str << '.' << std::setw(width) << std::right << digits;
+std::string Command::toGCode (int precision, bool padzero) const
+{
+    std::string str(Name);
+    for(std::map<std::string,double>::const_iterator i = Parameters.begin(); i != Parameters.end(); ++i) {
+        if(i->first == "N") continue;
+
+        str += ' ';
+        str += i->first;
+        appendValue(str, i->second, precision, padzero);
     }
-    return str.str();
+    return str;
 }
 
 void Command::setFromGCode (const std::string& str)
 {
     Parameters.clear();
-    std::string mode = "none";
-    std::string key;
-    std::string value;
-    for (unsigned int i=0; i < str.size(); i++) {
-        if ( (isdigit(str[i])) || (str[i] == '-') || (str[i] == '.') ) {
-            value += str[i];
-        } else if (isalpha(str[i])) {
-            if (mode == "command") {
-                if (!key.empty() && !value.empty()) {
-                    std::string cmd = key + value;
-                    boost::to_upper(cmd);
-                    Name = cmd;
-                    key = "";
-                    value = "";
-                    mode = "argument";
-                } else {
-                    throw Base::BadFormatError("Badly formatted GCode command");
-                }
-                mode = "argument";
-            } else if (mode == "none") {
-                mode = "command";
-            } else if (mode == "argument") {
-                if (!key.empty() && !value.empty()) {
-                    double val = std::atof(value.c_str());
-                    boost::to_upper(key);
-                    Parameters[key] = val;
-                    key = "";
-                    value = "";
-                } else {
-                    throw Base::BadFormatError("Badly formatted GCode argument");
-                }
-            } else if (mode == "comment") {
-                value += str[i];
-            }
-            key = str[i];
-        } else if (str[i] == '(') {
-            mode = "comment";
-        } else if (str[i] == ')') {
-            key = "(";
-            value += ")";
-        } else {
-            // add non-ascii characters only if this is a comment
-            if (mode == "comment") {
-                value += str[i];
-            }
-        }
-    }
-    if (!key.empty() && !value.empty()) {
-        if ( (mode == "command") || (mode == "comment") ) {
-            std::string cmd = key + value;
-            if (mode == "command")
-                boost::to_upper(cmd);
-            Name = cmd;
-        } else {
-            double val = std::atof(value.c_str());
-            boost::to_upper(key);
-            Parameters[key] = val;
-        }
-    } else {
-        throw Base::BadFormatError("Badly formatted GCode argument");
+    GCodeParser parser;
+    GCodeBlock block;
+    parser.parseBlock(str.data(), str.data() + str.size(), block);
+    Name = block.name;
+    for (int index = 0; index < GCodeBlock::NumKeys; index++) {
+        if (block.has(index))
+            Parameters[GCodeParser::keyName(index)] = block.values[index];
     }
 }
 
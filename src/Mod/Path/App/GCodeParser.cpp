@@ -0,0 +1,254 @@
+/***************************************************************************
+ *   Copyright (c) 2021 FreeCAD Developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "PreCompiled.h"
+
+#ifndef _PreComp_
+# include <algorithm>
+# include <cctype>
+# include <cstdlib>
+# include <boost/algorithm/string.hpp>
+#endif
+
+#include <Base/Exception.h>
+#include "GCodeParser.h"
+
+using namespace Path;
+
+GCodeParser::GCodeParser()
+    : cursor(nullptr), pending(nullptr), limit(nullptr), inComment(false)
+{
+}
+
+GCodeParser::GCodeParser(const char *begin, const char *end)
+    : cursor(nullptr), pending(nullptr), limit(end), inComment(false)
+{
+    cursor = findBlockStart(begin);
+}
+
+const char *GCodeParser::findBlockStart(const char *it) const
+{
+    for (; it != limit; ++it) {
+        switch (*it) {
+        case '(':
+        case 'g':
+        case 'G':
+        case 'm':
+        case 'M':
+            return it;
+        }
+    }
+    return limit;
+}
+
+bool GCodeParser::next(GCodeBlock &block)
+{
+    while (cursor != limit) {
+        if (*cursor == '(') {
+            // start of comment, before opening it add the pending command
+            const char *blockBegin = inComment ? nullptr : pending;
+            inComment = true;
+            pending = cursor;
+            cursor = std::find(cursor + 1, limit, ')');
+            if (blockBegin) {
+                parseBlock(blockBegin, pending, block);
+                return true;
+            }
+        }
+        else if (*cursor == ')') {
+            // end of comment
+            const char *blockBegin = pending;
+            const char *blockEnd = cursor + 1;
+            pending = nullptr;
+            inComment = false;
+            cursor = findBlockStart(blockEnd);
+            parseBlock(blockBegin, blockEnd, block);
+            return true;
+        }
+        else {
+            // command
+            const char *blockBegin = pending;
+            pending = cursor;
+            cursor = findBlockStart(cursor + 1);
+            if (blockBegin) {
+                parseBlock(blockBegin, pending, block);
+                return true;
+            }
+        }
+    }
+
+    // add the last command found, if any
+    if (pending && !inComment) {
+        const char *blockBegin = pending;
+        pending = nullptr;
+        parseBlock(blockBegin, limit, block);
+        return true;
+    }
+    return false;
+}
+
+void GCodeParser::parseBlock(const char *begin, const char *end, GCodeBlock &block)
+{
+    enum Mode { None, Command, Argument, Comment };
+
+    Mode mode = None;
+    char key = 0;
+    value.clear();
+    block.mask = 0;
+
+    auto setParameter = [&]() {
+        int index = keyIndex(key);
+        // isalpha() may accept letters beyond A-Z depending on the locale
+        if (index < 0)
+            throw Base::BadFormatError("Badly formatted GCode argument");
+        block.set(index, parseNumber(value.data(), value.data() + value.size()));
+    };
+
+    for (const char *it = begin; it != end; ++it) {
+        unsigned char c = static_cast<unsigned char>(*it);
+        if (isdigit(c) || c == '-' || c == '.') {
+            value += c;
+        }
+        else if (isalpha(c)) {
+            if (mode == Command) {
+                if (!key || value.empty())
+                    throw Base::BadFormatError("Badly formatted GCode command");
+                block.name.assign(1, key);
+                block.name += value;
+                boost::to_upper(block.name);
+                key = 0;
+                value.clear();
+                mode = Argument;
+            }
+            else if (mode == None) {
+                mode = Command;
+            }
+            else if (mode == Argument) {
+                if (!key || value.empty())
+                    throw Base::BadFormatError("Badly formatted GCode argument");
+                setParameter();
+                key = 0;
+                value.clear();
+            }
+            else if (mode == Comment) {
+                value += c;
+            }
+            key = c;
+        }
+        else if (c == '(') {
+            mode = Comment;
+        }
+        else if (c == ')') {
+            key = '(';
+            value += ')';
+        }
+        else if (mode == Comment) {
+            // add non-ascii characters only if this is a comment
+            value += c;
+        }
+    }
+
+    if (!key || value.empty())
+        throw Base::BadFormatError("Badly formatted GCode argument");
+
+    if (mode == Command || mode == Comment) {
+        block.name.assign(1, key);
+        block.name += value;
+        if (mode == Command)
+            boost::to_upper(block.name);
+    }
+    else {
+        setParameter();
+    }
+}
+
+int GCodeParser::keyIndex(char key)
+{
+    if (key >= 'a' && key <= 'z')
+        return key - 'a';
+    if (key >= 'A' && key <= 'Z')
+        return key - 'A';
+    if (key == '(')
+        return GCodeBlock::ParenKey;
+    return -1;
+}
+
+const std::string &GCodeParser::keyName(int index)
+{
+    static const std::string names[GCodeBlock::NumKeys] = {
+        "A","B","C","D","E","F","G","H","I","J","K","L","M",
+        "N","O","P","Q","R","S","T","U","V","W","X","Y","Z","("
+    };
+    return names[index];
+}
+
+double GCodeParser::parseNumber(const char *begin, const char *end)
+{
+    // Values with up to 15 significant digits are converted exactly with a
+    // single division by an exact power of ten, anything else is left to atof()
+    static const double powers[] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+
+    const char *it = begin;
+    bool negative = false;
+    if (it != end && *it == '-') {
+        negative = true;
+        ++it;
+    }
+
+    uint64_t mantissa = 0;
+    int digits = 0;
+    int fraction = 0;
+    bool hasDigits = false;
+    bool inFraction = false;
+    for (; it != end; ++it) {
+        char c = *it;
+        if (c >= '0' && c <= '9') {
+            hasDigits = true;
+            mantissa = mantissa * 10 + (c - '0');
+            if (mantissa)
+                ++digits;
+            if (inFraction)
+                ++fraction;
+            if (digits > 15)
+                return std::atof(std::string(begin, end).c_str());
+        }
+        else if (c == '.' && !inFraction) {
+            inFraction = true;
+        }
+        else {
+            break;
+        }
+    }
+
+    if (!hasDigits)
+        return 0.0;
+    if (fraction > 22)
+        return std::atof(std::string(begin, end).c_str());
+
+    double result = static_cast<double>(mantissa);
+    if (fraction)
+        result /= powers[fraction];
+    return negative ? -result : result;
+}
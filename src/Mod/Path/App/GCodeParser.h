@@ -0,0 +1,93 @@
+/***************************************************************************
+ *   Copyright (c) 2021 FreeCAD Developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef PATH_GCODEPARSER_H
+#define PATH_GCODEPARSER_H
+
+#include <cstdint>
+#include <string>
+
+namespace Path
+{
+
+/** The decoded words of a single G-code block. The parameters are indexed by
+ * GCodeParser::keyIndex(), the value of a key is only valid if its bit in
+ * mask is set.
+ */
+struct PathExport GCodeBlock
+{
+    /// the parameter key '(' that only shows up in malformed input
+    static const int ParenKey = 26;
+    static const int NumKeys = 27;
+
+    std::string name;
+    uint32_t mask = 0;
+    double values[NumKeys];
+
+    bool has(int key) const {
+        return (mask & (1u << key)) != 0;
+    }
+    void set(int key, double value) {
+        values[key] = value;
+        mask |= 1u << key;
+    }
+};
+
+/** Single pass G-code tokenizer
+ *
+ * The input is split into blocks the way Toolpath::setFromGCode() always
+ * did it: a block starts at every G or M word and a comment in parentheses
+ * is a block of its own. The words are decoded without creating a string per
+ * word or block, the buffers are reused from block to block.
+ */
+class PathExport GCodeParser
+{
+public:
+    GCodeParser();
+    GCodeParser(const char *begin, const char *end);
+
+    /// Reads the next block, returns false if there is none left
+    bool next(GCodeBlock &block);
+    /// Decodes the words of a single block like Command::setFromGCode()
+    void parseBlock(const char *begin, const char *end, GCodeBlock &block);
+
+    /// Returns the parameter index of a key or -1
+    static int keyIndex(char key);
+    /// Returns the parameter key of an index
+    static const std::string &keyName(int index);
+    /// Parses a number the same way as atof() does
+    static double parseNumber(const char *begin, const char *end);
+
+private:
+    const char *findBlockStart(const char *it) const;
+
+private:
+    const char *cursor;     // the next block start or closing parenthesis
+    const char *pending;    // the start of the block that is not yet decoded
+    const char *limit;
+    bool inComment;
+    std::string value;
+};
+
+} //namespace Path
+
+#endif // PATH_GCODEPARSER_H
@@ -25,6 +25,7 @@
 
 #ifndef _PreComp_
 # include <boost/algorithm/string.hpp>
+# include <boost/functional/hash.hpp>
 # include <boost/regex.hpp>
 #endif
 
@@ -42,6 +43,7 @@
 //#include "Mod/Robot/App/kdl_cp/rotational_interpolation_sa.hpp"
 //#include "Mod/Robot/App/kdl_cp/utilities/error.h"
 
+#include "GCodeParser.h"
 #include "Path.h"
 #include <Mod/Path/App/PathSegmentWalker.h>
 
@@ -50,21 +52,60 @@ using namespace Base;
 
 TYPESYSTEM_SOURCE(Path::Toolpath , Base::Persistence)
 
+namespace {
+// the axis parameters that have a slot in a record, sorted like the keys of Command::Parameters
+const char axisNames[] = "ABCFIJKXYZ";
+const int numAxes = 10;
+
+inline int axisSlot(char axis)
+{
+    switch (axis) {
+    case 'A': return 0;
+    case 'B': return 1;
+    case 'C': return 2;
+    case 'F': return 3;
+    case 'I': return 4;
+    case 'J': return 5;
+    case 'K': return 6;
+    case 'X': return 7;
+    case 'Y': return 8;
+    case 'Z': return 9;
+    default:  return -1;
+    }
+}
+
+inline int axisSlot(const std::string &key)
+{
+    return key.size() == 1 ? axisSlot(key[0]) : -1;
+}
+
+inline std::size_t countBits(uint16_t mask)
+{
+    std::size_t count = 0;
+    for (; mask; mask &= mask - 1)
+        ++count;
+    return count;
+}
+
+const std::string &axisKey(int slot)
+{
+    static const std::string keys[numAxes] = {"A","B","C","F","I","J","K","X","Y","Z"};
+    return keys[slot];
+}
+}
+
 Toolpath::Toolpath()
 {
 }
 
 Toolpath::Toolpath(const Toolpath& otherPath)
-    : vpcCommands(otherPath.vpcCommands.size())
-    , center(otherPath.center)
+    : center(otherPath.center)
 {
     *this = otherPath;
-    recalculate();
 }
 
 Toolpath::~Toolpath()
 {
-    clear();
 }
 
 Toolpath &Toolpath::operator=(const Toolpath& otherPath)
@@ -72,12 +113,12 @@ Toolpath &Toolpath::operator=(const Toolpath& otherPath)
     if (this == &otherPath)
         return *this;
 
-    clear();
-    vpcCommands.resize(otherPath.vpcCommands.size());
-    int i = 0;
-    for (std::vector<Command*>::const_iterator it=otherPath.vpcCommands.begin();it!=otherPath.vpcCommands.end();++it,i++) {
-        vpcCommands[i] = new Command(**it);
-    }
+    records = otherPath.records;
+    values = otherPath.values;
+    names = otherPath.names;
+    keys = otherPath.keys;
+    nameIndex = otherPath.nameIndex;
+    keyIndex = otherPath.keyIndex;
     center = otherPath.center;
     recalculate();
     return *this;
@@ -85,16 +126,202 @@ Toolpath &Toolpath::operator=(const Toolpath& otherPath)
 
 void Toolpath::clear(void)
 {
-    for(std::vector<Command*>::iterator it = vpcCommands.begin();it!=vpcCommands.end();++it)
-        delete ( *it );
-    vpcCommands.clear();
+    records.clear();
+    values.clear();
+    names.clear();
+    keys.clear();
+    nameIndex.clear();
+    keyIndex.clear();
     recalculate();
 }
 
+uint32_t Toolpath::internName(const std::string &name)
+{
+    auto res = nameIndex.insert(std::make_pair(name, static_cast<uint32_t>(names.size())));
+    if (res.second)
+        names.push_back(name);
+    return res.first->second;
+}
+
+uint32_t Toolpath::internKey(const std::string &key)
+{
+    auto res = keyIndex.insert(std::make_pair(key, static_cast<uint32_t>(keys.size())));
+    if (res.second)
+        keys.push_back(key);
+    return res.first->second;
+}
+
+void Toolpath::appendBlock(const GCodeBlock &block)
+{
+    Record rec;
+    rec.offset = static_cast<uint32_t>(values.size());
+    rec.opcode = internName(block.name);
+    rec.mask = 0;
+    rec.extras = 0;
+    for (int slot = 0; slot < numAxes; slot++) {
+        int index = GCodeParser::keyIndex(axisNames[slot]);
+        if (block.has(index)) {
+            rec.mask |= 1 << slot;
+            values.push_back(block.values[index]);
+        }
+    }
+
+    // the other parameters sorted by key like in Command::Parameters
+    auto addExtra = [&](int index) {
+        values.push_back(static_cast<double>(internKey(GCodeParser::keyName(index))));
+        values.push_back(block.values[index]);
+        ++rec.extras;
+    };
+    if (block.has(GCodeBlock::ParenKey))
+        addExtra(GCodeBlock::ParenKey);
+    for (int index = 0; index < GCodeBlock::ParenKey; index++) {
+        if (block.has(index) && axisSlot(GCodeParser::keyName(index)) < 0)
+            addExtra(index);
+    }
+    records.push_back(rec);
+}
+
+void Toolpath::insertRecord(std::size_t pos, const Command &cmd)
+{
+    Record rec;
+    rec.opcode = internName(cmd.Name);
+    rec.mask = 0;
+    rec.extras = 0;
+
+    // the values are appended and moved into place afterwards
+    std::size_t start = values.size();
+    for (auto it = cmd.Parameters.begin(); it != cmd.Parameters.end(); ++it) {
+        int slot = axisSlot(it->first);
+        if (slot >= 0) {
+            rec.mask |= 1 << slot;
+            values.push_back(it->second);
+        }
+    }
+    for (auto it = cmd.Parameters.begin(); it != cmd.Parameters.end(); ++it) {
+        if (axisSlot(it->first) < 0) {
+            values.push_back(static_cast<double>(internKey(it->first)));
+            values.push_back(it->second);
+            ++rec.extras;
+        }
+    }
+
+    std::size_t count = values.size() - start;
+    if (pos < records.size()) {
+        rec.offset = records[pos].offset;
+        std::rotate(values.begin() + rec.offset, values.begin() + start, values.end());
+        for (auto it = records.begin() + pos; it != records.end(); ++it)
+            it->offset += static_cast<uint32_t>(count);
+    }
+    else {
+        rec.offset = static_cast<uint32_t>(start);
+    }
+    records.insert(records.begin() + pos, rec);
+}
+
+std::size_t Toolpath::valueCount(std::size_t pos) const
+{
+    const Record &rec = records[pos];
+    return countBits(rec.mask) + 2 * rec.extras;
+}
+
+const double *Toolpath::findValue(const Record &rec, char axis) const
+{
+    int slot = axisSlot(axis);
+    if (slot < 0 || !(rec.mask & (1 << slot)))
+        return nullptr;
+    return &values[rec.offset + countBits(rec.mask & ((1 << slot) - 1))];
+}
+
+bool Toolpath::hasParam(unsigned int pos, char axis) const
+{
+    return findValue(records[pos], axis) != nullptr;
+}
+
+double Toolpath::getParam(unsigned int pos, char axis, double fallback) const
+{
+    const double *value = findValue(records[pos], axis);
+    return value ? *value : fallback;
+}
+
+std::size_t Toolpath::hashRange(unsigned int begin, unsigned int end) const
+{
+    std::hash<std::string> hashString;
+    std::size_t seed = 0;
+    if (end > records.size())
+        end = records.size();
+    for (unsigned int pos = begin; pos < end; pos++) {
+        const Record &rec = records[pos];
+        // hash the names and not their index, which depends on the history
+        boost::hash_combine(seed, hashString(names[rec.opcode]));
+        boost::hash_combine(seed, rec.mask);
+        const double *value = &values[rec.offset];
+        for (int count = countBits(rec.mask); count > 0; count--)
+            boost::hash_combine(seed, *value++);
+        for (uint16_t i = 0; i < rec.extras; i++, value += 2) {
+            boost::hash_combine(seed, hashString(keys[static_cast<std::size_t>(value[0])]));
+            boost::hash_combine(seed, value[1]);
+        }
+    }
+    return seed;
+}
+
+void Toolpath::getCommand(unsigned int pos, Command &cmd) const
+{
+    const Record &rec = records[pos];
+    cmd.Name = names[rec.opcode];
+    cmd.Parameters.clear();
+    const double *value = &values[rec.offset];
+    for (int slot = 0; slot < numAxes; slot++) {
+        if (rec.mask & (1 << slot))
+            cmd.Parameters.insert(std::make_pair(axisKey(slot), *value++));
+    }
+    for (uint16_t i = 0; i < rec.extras; i++, value += 2)
+        cmd.Parameters.insert(std::make_pair(keys[static_cast<std::size_t>(value[0])], value[1]));
+}
+
+Command Toolpath::getCommand(unsigned int pos) const
+{
+    Command cmd;
+    getCommand(pos, cmd);
+    return cmd;
+}
+
+void Toolpath::appendGCode(std::string &str, const Record &rec) const
+{
+    // same output as Command::toGCode(), the axis values and the other
+    // parameters are both sorted by key so they can be merged
+    str += names[rec.opcode];
+    const double *axis = &values[rec.offset];
+    const double *other = axis + countBits(rec.mask);
+    const double *otherEnd = other + 2 * rec.extras;
+    int slot = 0;
+    while (true) {
+        while (slot < numAxes && !(rec.mask & (1 << slot)))
+            ++slot;
+        if (other != otherEnd) {
+            const std::string &key = keys[static_cast<std::size_t>(other[0])];
+            if (slot == numAxes || key.compare(0, std::string::npos, &axisNames[slot], 1) < 0) {
+                if (key != "N") {
+                    str += ' ';
+                    str += key;
+                    Command::appendValue(str, other[1]);
+                }
+                other += 2;
+                continue;
+            }
+        }
+        if (slot == numAxes)
+            break;
+        str += ' ';
+        str += axisNames[slot];
+        Command::appendValue(str, *axis++);
+        ++slot;
+    }
+}
+
 void Toolpath::addCommand(const Command &Cmd)
 {
-    Command *tmp = new Command(Cmd);
-    vpcCommands.push_back(tmp);
+    insertRecord(records.size(), Cmd);
     recalculate();
 }
 
@@ -102,9 +329,8 @@ void Toolpath::insertCommand(const Command &Cmd, int pos)
 {
     if (pos == -1) {
         addCommand(Cmd);
-    } else if (pos <= static_cast<int>(vpcCommands.size())) {
-        Command *tmp = new Command(Cmd);
-        vpcCommands.insert(vpcCommands.begin()+pos,tmp);
+    } else if (pos <= static_cast<int>(records.size())) {
+        insertRecord(pos, Cmd);
     } else {
         throw Base::IndexError("Index not in range");
     }
@@ -113,39 +339,71 @@ void Toolpath::insertCommand(const Command &Cmd, int pos)
 
 void Toolpath::deleteCommand(int pos)
 {
-    if (pos == -1) {
-        //delete(*vpcCommands.rbegin()); // causes crash
-        vpcCommands.pop_back();
-    } else if (pos <= static_cast<int>(vpcCommands.size())) {
-        vpcCommands.erase (vpcCommands.begin()+pos);
-    } else {
+    if (pos == -1)
+        pos = static_cast<int>(records.size()) - 1;
+    if (pos < 0 || pos >= static_cast<int>(records.size()))
         throw Base::IndexError("Index not in range");
-    }
+
+    std::size_t offset = records[pos].offset;
+    std::size_t count = valueCount(pos);
+    values.erase(values.begin() + offset, values.begin() + offset + count);
+    records.erase(records.begin() + pos);
+    for (auto it = records.begin() + pos; it != records.end(); ++it)
+        it->offset -= static_cast<uint32_t>(count);
     recalculate();
 }
 
+namespace {
+enum MoveType { Other, Rapid, Feed, Arc };
+
+std::vector<MoveType> classifyNames(const std::vector<std::string> &names)
+{
+    std::vector<MoveType> types;
+    types.reserve(names.size());
+    for (const std::string &name : names) {
+        if ((name == "G0") || (name == "G00"))
+            types.push_back(Rapid);
+        else if ((name == "G1") || (name == "G01"))
+            types.push_back(Feed);
+        else if ((name == "G2") || (name == "G02") || (name == "G3") || (name == "G03"))
+            types.push_back(Arc);
+        else
+            types.push_back(Other);
+    }
+    return types;
+}
+}
+
 double Toolpath::getLength()
 {
-    if(vpcCommands.size()==0)
+    if(records.size()==0)
         return 0;
+    std::vector<MoveType> types = classifyNames(names);
     double l = 0;
     Vector3d last(0,0,0);
     Vector3d next;
-    for(std::vector<Command*>::const_iterator it = vpcCommands.begin();it!=vpcCommands.end();++it) {
-        std::string name = (*it)->Name;
-        next = (*it)->getPlacement(last).getPosition();
-        if ( (name == "G0") || (name == "G00") || (name == "G1") || (name == "G01") ) {
-            // straight line
-            l += (next - last).Length();
-            last = next;
-        } else if ( (name == "G2") || (name == "G02") || (name == "G3") || (name == "G03") ) {
-            // arc
-            Vector3d center = (*it)->getCenter();
+    for (const Record &rec : records) {
+        MoveType type = types[rec.opcode];
+        if (type == Other)
+            continue;
+        const double *x = findValue(rec, 'X');
+        const double *y = findValue(rec, 'Y');
+        const double *z = findValue(rec, 'Z');
+        next.Set(x ? *x : last.x, y ? *y : last.y, z ? *z : last.z);
+        if (type == Arc) {
+            const double *i = findValue(rec, 'I');
+            const double *j = findValue(rec, 'J');
+            const double *k = findValue(rec, 'K');
+            Vector3d center(i ? *i : 0.0, j ? *j : 0.0, k ? *k : 0.0);
             double radius = (last - center).Length();
             double angle = (next - center).GetAngle(last - center);
             l += angle * radius;
-            last = next;
         }
+        else {
+            // straight line
+            l += (next - last).Length();
+        }
+        last = next;
     }
     return l;
 }
@@ -169,41 +427,48 @@ double Toolpath::getCycleTime(double hFeed, double vFeed, double hRapid, double
         vRapid = vFeed;
     }
 
-    if (vpcCommands.size() == 0) {
+    if (records.size() == 0) {
         return 0;
     }
+    std::vector<MoveType> types = classifyNames(names);
     double l = 0;
     double time = 0;
     bool verticalMove = false;
     Vector3d last(0,0,0);
     Vector3d next;
-    for (std::vector<Command*>::const_iterator it = vpcCommands.begin();it!=vpcCommands.end();++it) {
-        std::string name = (*it)->Name;
-        float feedrate = (*it)->getParam("F");
+    for (const Record &rec : records) {
+        MoveType type = types[rec.opcode];
+        float feedrate;
 
         l = 0;
         verticalMove = false;
         feedrate = hFeed;
-        next = (*it)->getPlacement(last).getPosition();
+        const double *x = findValue(rec, 'X');
+        const double *y = findValue(rec, 'Y');
+        const double *z = findValue(rec, 'Z');
+        next.Set(x ? *x : last.x, y ? *y : last.y, z ? *z : last.z);
 
         if (last.z != next.z){
             verticalMove = true;
             feedrate = vFeed;
         }
 
-        if ((name == "G0") || (name == "G00")){
+        if (type == Rapid){
             // Rapid Move
             l += (next - last).Length();
             feedrate = hRapid;
             if(verticalMove){
                 feedrate = vRapid;
             }
-        }else if ((name == "G1") || (name == "G01")) {
+        }else if (type == Feed) {
             // Feed Move
             l += (next - last).Length();
-        }else if ((name == "G2") || (name == "G02") || (name == "G3") || (name == "G03") ) {
+        }else if (type == Arc) {
             // Arc Move
-            Vector3d center = (*it)->getCenter();
+            const double *i = findValue(rec, 'I');
+            const double *j = findValue(rec, 'J');
+            const double *k = findValue(rec, 'K');
+            Vector3d center(i ? *i : 0.0, j ? *j : 0.0, k ? *k : 0.0);
             double radius = (last - center).Length();
             double angle = (next - center).GetAngle(last - center);
             l += angle * radius;
@@ -287,72 +552,34 @@ Base::BoundBox3d Toolpath::getBoundBox() const
     return visitor.bb;
 }
 
-static void bulkAddCommand(const std::string &gcodestr, std::vector<Command*> &commands, bool &inches)
+void Toolpath::setFromGCode(const std::string &str)
 {
-    Command *cmd = new Command();
-    cmd->setFromGCode(gcodestr);
-    if ("G20" == cmd->Name) {
-        inches = true;
-        delete cmd;
-    } else if ("G21" == cmd->Name) {
-        inches = false;
-        delete cmd;
-    } else {
-        if (inches) {
-            cmd->scaleBy(25.4);
-        }
-        commands.push_back(cmd);
-    }
+    setFromGCode(str.data(), str.data() + str.size());
 }
 
-void Toolpath::setFromGCode(const std::string instr)
+void Toolpath::setFromGCode(const char *begin, const char *end)
 {
     clear();
 
-    // remove comments
-    //boost::regex e("\\(.*?\\)");
-    //std::string str = boost::regex_replace(instr, e, "");
-    std::string str(instr);
-
     // split input string by () or G or M commands
-    std::string mode = "command";
-    std::size_t found = str.find_first_of("(gGmM");
-    int last = -1;
+    GCodeParser parser(begin, end);
+    GCodeBlock block;
     bool inches = false;
-    while (found != std::string::npos)
-    {
-        if (str[found] == '(') {
-            // start of comment
-            if ( (last > -1) && (mode == "command") ) {
-                // before opening a comment, add the last found command
-                std::string gcodestr = str.substr(last, found-last);
-                bulkAddCommand(gcodestr, vpcCommands, inches);
-            }
-            mode = "comment";
-            last = found;
-            found = str.find_first_of(')', found+1);
-        } else if (str[found] == ')') {
-            // end of comment
-            std::string gcodestr = str.substr(last, found-last+1);
-            bulkAddCommand(gcodestr, vpcCommands, inches);
-            last = -1;
-            found = str.find_first_of("(gGmM", found+1);
-            mode = "command";
-        } else if (mode == "command") {
-            // command
-            if (last > -1) {
-                std::string gcodestr = str.substr(last, found-last);
-                bulkAddCommand(gcodestr, vpcCommands, inches);
+    while (parser.next(block)) {
+        if ("G20" == block.name) {
+            inches = true;
+        } else if ("G21" == block.name) {
+            inches = false;
+        } else {
+            if (inches) {
+                // the same parameters as Command::scaleBy()
+                for (const char *key = "XYZIJRQF"; *key; ++key) {
+                    int index = GCodeParser::keyIndex(*key);
+                    if (block.has(index))
+                        block.values[index] *= 25.4;
+                }
             }
-            last = found;
-            found = str.find_first_of("(gGmM", found+1);
-        }
-    }
-    // add the last command found, if any
-    if (last > -1) {
-        if (mode == "command") {
-            std::string gcodestr = str.substr(last,std::string::npos);
-            bulkAddCommand(gcodestr, vpcCommands, inches);
+            appendBlock(block);
         }
     }
     recalculate();
@@ -361,9 +588,10 @@ void Toolpath::setFromGCode(const std::string instr)
 std::string Toolpath::toGCode(void) const
 {
     std::string result;
-    for (std::vector<Command*>::const_iterator it=vpcCommands.begin();it!=vpcCommands.end();++it) {
-        result += (*it)->toGCode();
-        result += "\n";
+    result.reserve(records.size() * 32);
+    for (const Record &rec : records) {
+        appendGCode(result, rec);
+        result += '\n';
     }
     return result;
 }
@@ -371,7 +599,7 @@ std::string Toolpath::toGCode(void) const
 void Toolpath::recalculate(void) // recalculates the path cache
 {
 
-    if(vpcCommands.size()==0)
+    if(records.size()==0)
         return;
 
     // TODO recalculate the KDL stuff. At the moment, this is unused.
@@ -435,7 +663,7 @@ void Toolpath::recalculate(void) // recalculates the path cache
 
 unsigned int Toolpath::getMemSize (void) const
 {
-    return vpcCommands.size() * 100;
+    return records.size() * sizeof(Record) + values.size() * sizeof(double);
 }
 
 void Toolpath::setCenter(const Base::Vector3d &c)
@@ -458,8 +686,12 @@ void Toolpath::Save (Writer &writer) const
         saveCenter(writer, center);
         writer.Stream() << writer.ind() << "<Commands>\n";
         auto &s = writer.beginCharStream(false) << '\n';
-        for(auto &cmd : vpcCommands)
-            s << cmd->toGCode() << '\n';
+        std::string line;
+        for(const Record &rec : records) {
+            line.clear();
+            appendGCode(line, rec);
+            s << line << '\n';
+        }
         writer.endCharStream() << '\n' << writer.ind() << "</Commands>\n";
         writer.decInd();
     } else {
@@ -481,8 +713,18 @@ void Toolpath::setFileName(const char *file) const {
 
 void Toolpath::SaveDocFile (Base::Writer &writer) const
 {
-    for(auto &cmd : vpcCommands)
-        writer.Stream() << cmd->toGCode() << '\n';
+    // write in large chunks instead of line by line
+    std::string buffer;
+    buffer.reserve(1 << 16);
+    for(const Record &rec : records) {
+        appendGCode(buffer, rec);
+        buffer += '\n';
+        if (buffer.size() >= (1 << 16) - 256) {
+            writer.Stream().write(buffer.c_str(), buffer.size());
+            buffer.clear();
+        }
+    }
+    writer.Stream().write(buffer.c_str(), buffer.size());
 }
 
 void Toolpath::Restore(XMLReader &reader)
@@ -512,16 +754,18 @@ void Toolpath::Restore(XMLReader &reader)
     if(count) {
         reader.readElement("Commands");
         auto &s = reader.beginCharStream(false);
-        vpcCommands.resize(count);
+        records.reserve(count);
         std::string line;
-        for(auto &cmd : vpcCommands) {
-            cmd = new Command;
+        GCodeParser parser;
+        GCodeBlock block;
+        for(unsigned i=0; i<count; i++) {
             while(std::getline(s,line)) {
                 boost::trim(line);
                 if(!line.empty())
                     break;
             }
-            cmd->setFromGCode(line);
+            parser.parseBlock(line.data(), line.data() + line.size(), block);
+            appendBlock(block);
         }
         reader.readEndElement("Commands");
     }
@@ -530,14 +774,12 @@ void Toolpath::Restore(XMLReader &reader)
 
 void Toolpath::RestoreDocFile(Base::Reader &reader)
 {
+    // the blocks are split by the parser, so the file is read as a whole
     std::string gcode;
-    std::string line;
-    while (reader >> line) {
-        gcode += line;
-        gcode += " ";
-    }
+    char buffer[1 << 16];
+    while (reader.read(buffer, sizeof(buffer)) || reader.gcount() > 0)
+        gcode.append(buffer, static_cast<std::size_t>(reader.gcount()));
     setFromGCode(gcode);
-
 }
 
 
@@ -24,6 +24,7 @@
 #ifndef PATH_Path_H
 #define PATH_Path_H
 
+#include <unordered_map>
 #include "Command.h"
 //#include "Mod/Robot/App/kdl_cp/path_composite.hpp"
 //#include "Mod/Robot/App/kdl_cp/frames_io.hpp"
@@ -33,6 +34,7 @@
 
 namespace Path
 {
+    struct GCodeBlock;
 
     /** The representation of a CNC Toolpath */
     
@@ -62,14 +64,19 @@ namespace Path
             double getLength(void); // return the Length (mm) of the Path
             double getCycleTime(double, double, double, double); // return the Cycle Time (s) of the Path
             void recalculate(void); // recalculates the points
-            void setFromGCode(const std::string); // sets the path from the contents of the given GCode string
+            void setFromGCode(const std::string&); // sets the path from the contents of the given GCode string
+            void setFromGCode(const char *begin, const char *end);
             std::string toGCode(void) const; // gets a gcode string representation from the Path
             Base::BoundBox3d getBoundBox(void) const;
             
             // shortcut functions
-            unsigned int getSize(void) const { return vpcCommands.size(); }
-            const std::vector<Command*> &getCommands(void) const { return vpcCommands; }
-            const Command &getCommand(unsigned int pos)    const { return *vpcCommands[pos]; }
+            unsigned int getSize(void) const { return records.size(); }
+            Command getCommand(unsigned int pos) const; // returns a copy of the command at the given position
+            void getCommand(unsigned int pos, Command &cmd) const; // fills in the command at the given position
+            const std::string &getCommandName(unsigned int pos) const { return names[records[pos].opcode]; }
+            bool hasParam(unsigned int pos, char axis) const; // returns true if the command has the given axis parameter
+            double getParam(unsigned int pos, char axis, double fallback = 0.0) const; // returns the value of an axis parameter
+            std::size_t hashRange(unsigned int begin, unsigned int end) const; // hash of the commands [begin, end) to detect changes
         
             // support for rotation
             const Base::Vector3d& getCenter() const { return center; }
@@ -79,9 +86,36 @@ namespace Path
 
             static const int SchemaVersion = 2;
 
+        protected:
+            /** The commands are not stored as Command objects but packed into
+             * records. The command name is interned, the axis parameters
+             * X,Y,Z,A,B,C,I,J,K,F are marked in a bit mask and their values
+             * are stored consecutively in one array, followed by pairs of
+             * interned key and value for any other parameter.
+             */
+            struct Record {
+                uint32_t offset;    // index of the first value
+                uint32_t opcode;    // index into names
+                uint16_t mask;      // the axis parameters present
+                uint16_t extras;    // number of other parameters
+            };
+
+            uint32_t internName(const std::string &name);
+            uint32_t internKey(const std::string &key);
+            void appendBlock(const GCodeBlock &block);
+            void insertRecord(std::size_t pos, const Command &cmd);
+            std::size_t valueCount(std::size_t pos) const;
+            const double *findValue(const Record &rec, char axis) const;
+            void appendGCode(std::string &str, const Record &rec) const;
+
         protected:
             mutable std::string filename;
-            std::vector<Command*> vpcCommands;
+            std::vector<Record> records;
+            std::vector<double> values;
+            std::vector<std::string> names;
+            std::vector<std::string> keys;
+            std::unordered_map<std::string, uint32_t> nameIndex;
+            std::unordered_map<std::string, uint32_t> keyIndex;
             Base::Vector3d center;
             //KDL::Path_Composite *pcPath;
             
@@ -109,9 +109,70 @@ void PathSegmentVisitor::g38(int id, const Base::Vector3d &last, const Base::Vec
     (void)next;
 }
 
+void PathSegmentVisitor::arc(int id, const Base::Vector3d &last, const Base::Vector3d &next, const PathArc &arc)
+{
+    std::deque<Base::Vector3d> points;
+    arc.discretize(points, arc.getSegments(arc.deviation));
+    g23(id, last, next, points, arc.center);
+}
+
+int PathArc::getSegments(double deviation) const
+{
+    double amax = std::max(fmod(fabs(a - A), 360), std::max(fmod(fabs(b - B), 360), fmod(fabs(c - C), 360)));
+    return std::max(ARC_MIN_SEGMENTS, 3.0/(deviation/std::max(angle, amax))); //we use a rather simple rule here, provisorily
+}
+
+void PathArc::discretize(std::deque<Base::Vector3d> &pts, int segments) const
+{
+    Base::Vector3d last0(last);
+    last0.*pz = 0.0;
+    Base::Vector3d center0(center);
+    center0.*pz = 0.0;
+
+    double dZ = (next.*pz - last.*pz)/segments; //How far each segment will helix in Z
+
+    double dangle = angle/segments;
+    double da = (a - A) / segments;
+    double db = (b - B) / segments;
+    double dc = (c - C) / segments;
+
+    for (int j = 1; j < segments; j++) {
+        Base::Vector3d inter;
+        Base::Rotation rot(norm, dangle*j);
+        rot.multVec((last0 - center0), inter);
+        inter.*pz = last.*pz + dZ * j; //Enable displaying helices
+
+        Base::Rotation arot = yawPitchRoll(A + da*j, B + db*j, C + dc*j);
+        Base::Vector3d rinter = compensateRotation(center0 + inter, arot, rotCenter);
+
+        pts.push_back(rinter);
+    }
+}
+
+PathSegmentWalker::State::State(const Base::Vector3d &start)
+    :last(start)
+    ,A(0.0)
+    ,B(0.0)
+    ,C(0.0)
+    ,absolute(true)
+    ,absolutecenter(false)
+    ,pz(&Base::Vector3d::z)
+{}
+
+bool PathSegmentWalker::State::operator==(const State &other) const
+{
+    return last.x == other.last.x && last.y == other.last.y && last.z == other.last.z
+        && A == other.A && B == other.B && C == other.C
+        && absolute == other.absolute && absolutecenter == other.absolutecenter
+        && pz == other.pz;
+}
+
 PathSegmentWalker::PathSegmentWalker(const Toolpath &tp_)
     :tp(tp_)
-{}
+{
+    ParameterGrp::handle hGrp = App::GetApplication().GetParameterGroupByPath("User parameter:BaseApp/Preferences/Mod/Part");
+    deviation = hGrp->GetFloat("MeshDeviation",0.2);
+}
 
 
 void PathSegmentWalker::walk(PathSegmentVisitor &cb, const Base::Vector3d &startPosition)
@@ -120,28 +181,34 @@ void PathSegmentWalker::walk(PathSegmentVisitor &cb, const Base::Vector3d &start
         return;
     }
 
-    ParameterGrp::handle hGrp = App::GetApplication().GetParameterGroupByPath("User parameter:BaseApp/Preferences/Mod/Part");
-    float deviation = hGrp->GetFloat("MeshDeviation",0.2);
+    cb.setup(startPosition);
+
+    walk(cb, State(startPosition), 0, tp.getSize());
+}
 
+PathSegmentWalker::State PathSegmentWalker::walk(PathSegmentVisitor &cb, const State &state, unsigned int begin, unsigned int end)
+{
     Base::Vector3d rotCenter = tp.getCenter();
-    Base::Vector3d last(startPosition);
-    Base::Rotation lrot;
-    double A = 0.0;
-    double B = 0.0;
-    double C = 0.0;
+    Base::Vector3d last(state.last);
+    double A = state.A;
+    double B = state.B;
+    double C = state.C;
+    Base::Rotation lrot = yawPitchRoll(A, B, C);
 
-    bool absolute = true;
-    bool absolutecenter = false;
+    bool absolute = state.absolute;
+    bool absolutecenter = state.absolutecenter;
 
     // for mapping the coordinates to XY plane
-    double Base::Vector3d::*pz = &Base::Vector3d::z;
+    double Base::Vector3d::*pz = state.pz;
 
-    cb.setup(last);
+    if (end > tp.getSize())
+        end = tp.getSize();
 
-    for (unsigned int  i = 0; i < tp.getSize(); i++) {
+    Path::Command cmd;
+    for (unsigned int  i = begin; i < end; i++) {
         std::deque<Base::Vector3d> points;
 
-        const Path::Command &cmd = tp.getCommand(i);
+        tp.getCommand(i, cmd);
         const std::string &name = cmd.Name;
         Base::Vector3d next = cmd.getPlacement().getPosition();
         double a = A;
@@ -229,29 +296,23 @@ void PathSegmentWalker::walk(PathSegmentVisitor &cb, const Base::Vector3d &start
             } else if (angle == 0)
                 angle = M_PI * 2;
 
-            double amax = std::max(fmod(fabs(a - A), 360), std::max(fmod(fabs(b - B), 360), fmod(fabs(c - C), 360)));
-
-            int segments = std::max(ARC_MIN_SEGMENTS, 3.0/(deviation/std::max(angle, amax))); //we use a rather simple rule here, provisorily
-            double dZ = (next.*pz - last.*pz)/segments; //How far each segment will helix in Z
-
-            double dangle = angle/segments;
-            double da = (a - A) / segments;
-            double db = (b - B) / segments;
-            double dc = (c - C) / segments;
-
-            for (int j = 1; j < segments; j++) {
-                Base::Vector3d inter;
-                Base::Rotation rot(norm, dangle*j);
-                rot.multVec((last0 - center0), inter);
-                inter.*pz = last.*pz + dZ * j; //Enable displaying helices
-
-                Base::Rotation arot = yawPitchRoll(A + da*j, B + db*j, C + dc*j);
-                Base::Vector3d rinter = compensateRotation(center0 + inter, arot, rotCenter);
-
-                points.push_back(rinter);
-            }
-
-            cb.g23(i, last, rnext, points, center);
+            PathArc arc;
+            arc.last = last;
+            arc.next = next;
+            arc.center = center;
+            arc.norm = norm;
+            arc.rotCenter = rotCenter;
+            arc.angle = angle;
+            arc.A = A;
+            arc.B = B;
+            arc.C = C;
+            arc.a = a;
+            arc.b = b;
+            arc.c = c;
+            arc.pz = pz;
+            arc.deviation = deviation;
+
+            cb.arc(i, last, rnext, arc);
 
             last = next;
             A = a;
@@ -353,6 +414,16 @@ void PathSegmentWalker::walk(PathSegmentVisitor &cb, const Base::Vector3d &start
             pz = &Base::Vector3d::x;
         }
     }
+
+    State result;
+    result.last = last;
+    result.A = A;
+    result.B = B;
+    result.C = C;
+    result.absolute = absolute;
+    result.absolutecenter = absolutecenter;
+    result.pz = pz;
+    return result;
 }
 
 
@@ -30,6 +30,31 @@
 namespace Path
 {
 
+/**
+ * PathArc describes the movement of a G2/G3 command before it is split into
+ * straight segments. It is handed to PathSegmentVisitor::arc() so a visitor
+ * can postpone the interpolation or use fewer segments.
+ */
+class PathExport PathArc
+{
+public:
+    /// returns the number of segments needed for the given deviation
+    int getSegments(double deviation) const;
+    /// appends the interpolated points, excluding the start and the end point
+    void discretize(std::deque<Base::Vector3d> &pts, int segments) const;
+
+    Base::Vector3d last;        // start point, without rotation applied
+    Base::Vector3d next;        // end point, without rotation applied
+    Base::Vector3d center;
+    Base::Vector3d norm;
+    Base::Vector3d rotCenter;
+    double angle;
+    double A, B, C;             // rotary axes at the start
+    double a, b, c;             // rotary axes at the end
+    double Base::Vector3d::*pz; // axis normal to the working plane
+    double deviation;           // deviation used by the walker
+};
+
 /**
  * PathSegmentVisitor is the companion class to PathSegmentWalker. Its members are called
  * with the segmented points of each command.
@@ -47,6 +72,9 @@ class PathExport PathSegmentVisitor
     virtual void g8x(int id, const Base::Vector3d &last, const Base::Vector3d &next, const std::deque<Base::Vector3d> &pts,
                      const std::deque<Base::Vector3d> &p, const std::deque<Base::Vector3d> &q);
     virtual void g38(int id, const Base::Vector3d &last, const Base::Vector3d &next);
+
+    /// called for arcs, the default implementation discretises the arc and calls g23()
+    virtual void arc(int id, const Base::Vector3d &last, const Base::Vector3d &next, const PathArc &arc);
 };
 
 /**
@@ -57,13 +85,35 @@ class PathExport PathSegmentVisitor
 class PathExport PathSegmentWalker
 {
 public:
+    /// The modal state in effect before a command
+    struct PathExport State {
+        State(const Base::Vector3d &start = Base::Vector3d());
+        bool operator==(const State &other) const;
+        bool operator!=(const State &other) const {
+            return !(*this == other);
+        }
+
+        Base::Vector3d last;
+        double A, B, C;
+        bool absolute;
+        bool absolutecenter;
+        double Base::Vector3d::*pz;
+    };
+
     PathSegmentWalker(const Toolpath &tp_);
 
 
     void walk(PathSegmentVisitor &cb, const Base::Vector3d &startPosition);
 
+    /** Walks the commands [begin, end) starting with the given state.
+     * PathSegmentVisitor::setup() is not called. Returns the state after
+     * the last command, so that the walk can be resumed from there.
+     */
+    State walk(PathSegmentVisitor &cb, const State &state, unsigned int begin, unsigned int end);
+
 private:
     const Toolpath &tp;
+    float deviation;
 };
 
 
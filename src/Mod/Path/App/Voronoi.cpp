@@ -29,6 +29,9 @@
 # include <iomanip>
 # include <boost/algorithm/string.hpp>
 # include <boost/lexical_cast.hpp>
+# include <algorithm>
+# include <functional>
+# include <thread>
 #endif
 
 #include <Base/Vector3D.h>
@@ -44,6 +47,30 @@ TYPESYSTEM_SOURCE(Path::Voronoi , Base::BaseClass)
 
 // Helpers
 
+// Below this many elements the work is done on the calling thread
+static const std::size_t ParallelThreshold = 16384;
+
+// Split [0, count) into one contiguous range per hardware thread and call
+// func(begin, end) for each of them. Ranges are disjoint, so func may write to
+// elements of its own range without synchronisation.
+static void parallelFor(std::size_t count, const std::function<void(std::size_t, std::size_t)> &func) {
+  std::size_t threads = std::thread::hardware_concurrency();
+  if (count < ParallelThreshold || threads < 2) {
+    func(0, count);
+    return;
+  }
+  threads = std::min(threads, count / (ParallelThreshold / 4));
+  std::size_t chunk = (count + threads - 1) / threads;
+  std::vector<std::thread> workers;
+  for (std::size_t begin = chunk; begin < count; begin += chunk) {
+    workers.emplace_back(func, begin, std::min(begin + chunk, count));
+  }
+  func(0, std::min(chunk, count));
+  for (auto &worker : workers) {
+    worker.join();
+  }
+}
+
 // Voronoi::diagram_type
 
 Voronoi::diagram_type::diagram_type()
@@ -72,46 +99,48 @@ Base::Vector3d Voronoi::diagram_type::scaledVector(const vertex_type &v, double
 }
 
 
-int Voronoi::diagram_type::index(const Voronoi::diagram_type::cell_type   *cell)   const {
-  auto it = cell_index.find(intptr_t(cell));
-  if (it == cell_index.end()) {
+template<typename T>
+static int elementIndex(const std::vector<T> &elements, const T *element) {
+  if (elements.empty()) {
     return Voronoi::InvalidIndex;
   }
-  return it->second;
-}
-int Voronoi::diagram_type::index(const Voronoi::diagram_type::edge_type   *edge)   const {
-  auto it = edge_index.find(intptr_t(edge));
-  if (it == edge_index.end()) {
+  uintptr_t first = uintptr_t(&elements.front());
+  uintptr_t addr  = uintptr_t(element);
+  if (addr < first || addr > uintptr_t(&elements.back()) || (addr - first) % sizeof(T)) {
     return Voronoi::InvalidIndex;
   }
-  return it->second;
+  return int((addr - first) / sizeof(T));
+}
+
+int Voronoi::diagram_type::index(const Voronoi::diagram_type::cell_type   *cell)   const {
+  return elementIndex(cells(), cell);
+}
+int Voronoi::diagram_type::index(const Voronoi::diagram_type::edge_type   *edge)   const {
+  return elementIndex(edges(), edge);
 }
 int Voronoi::diagram_type::index(const Voronoi::diagram_type::vertex_type *vertex) const {
-  auto it = vertex_index.find(intptr_t(vertex));
-  if (it == vertex_index.end()) {
-    return Voronoi::InvalidIndex;
-  }
-  return it->second;
+  return elementIndex(vertices(), vertex);
 }
 
-void Voronoi::diagram_type::reIndex() {
-  int idx = 0;
-  cell_index.clear();
-  edge_index.clear();
-  vertex_index.clear();
-
-  idx = 0;
-  for (auto it = cells().begin(); it != cells().end(); ++it, ++idx) {
-    cell_index[intptr_t(&(*it))] = idx;
-  }
-  idx = 0;
-  for (auto it = edges().begin(); it != edges().end(); ++it, ++idx) {
-    edge_index[intptr_t(&(*it))] = idx;
-  }
-  idx = 0;
-  for (auto it = vertices().begin(); it != vertices().end(); ++it, ++idx) {
-    vertex_index[intptr_t(&(*it))] = idx;
+static double segmentAngle(const Voronoi::segment_type &segment) {
+  Voronoi::point_type p0 = low(segment);
+  Voronoi::point_type p1 = high(segment);
+  if (p0.x() == p1.x()) {
+    if ((p0.y() > 0 && p1.y() > 0) || (p0.y() > 0 && p1.y() > 0)) {
+      return M_PI_2;
+    }
+    return -M_PI_2;
   }
+  return atan((p0.y() - p1.y()) / (p0.x() - p1.x()));
+}
+
+void Voronoi::diagram_type::cacheAngles() {
+  segment_angle.resize(segments.size());
+  parallelFor(segments.size(), [this](std::size_t begin, std::size_t end) {
+    for (std::size_t i = begin; i < end; ++i) {
+      segment_angle[i] = segmentAngle(segments[i]);
+    }
+  });
 }
 
 Voronoi::point_type Voronoi::diagram_type::retrievePoint(const Voronoi::diagram_type::cell_type *cell) const {
@@ -187,26 +216,35 @@ void Voronoi::construct()
 {
   vd->clear();
   construct_voronoi(vd->points.begin(), vd->points.end(), vd->segments.begin(), vd->segments.end(), (voronoi_diagram_type*)vd);
-  vd->reIndex();
+  vd->cacheAngles();
 }
 
 void Voronoi::colorExterior(const Voronoi::diagram_type::edge_type *edge, std::size_t colorValue) {
-  if (edge->color()) {
-    // end recursion
-    return;
-  }
-  edge->color(colorValue);
-  edge->twin()->color(colorValue);
-  auto v = edge->vertex1();
-  if (v == NULL || !edge->is_primary()) {
-    return;
+  // flood fill with an explicit stack, exterior regions of large diagrams
+  // are too deep for recursion
+  std::vector<const Voronoi::diagram_type::edge_type*> stack(1, edge);
+  while (!stack.empty()) {
+    edge = stack.back();
+    stack.pop_back();
+    if (edge->color()) {
+      continue;
+    }
+    edge->color(colorValue);
+    edge->twin()->color(colorValue);
+    auto v = edge->vertex1();
+    if (v == NULL || !edge->is_primary()) {
+      continue;
+    }
+    v->color(colorValue);
+    // push in reverse so edges are visited in the same order as before
+    std::size_t top = stack.size();
+    auto e = v->incident_edge();
+    do {
+      stack.push_back(e);
+      e = e->rot_next();
+    } while (e != v->incident_edge());
+    std::reverse(stack.begin() + top, stack.end());
   }
-  v->color(colorValue);
-  auto e = v->incident_edge();
-  do {
-    colorExterior(e, colorValue);
-    e = e->rot_next();
-  } while (e != v->incident_edge());
 }
 
 void Voronoi::colorExterior(Voronoi::color_type color) {
@@ -217,38 +255,27 @@ void Voronoi::colorExterior(Voronoi::color_type color) {
   }
 }
 
+// The diagram stores the two half edges of an edge next to each other, so the
+// twin of edge 2k is edge 2k+1. Edge pairs are independent of each other which
+// allows processing them in parallel.
+
 void Voronoi::colorTwins(Voronoi::color_type color) {
-  for (diagram_type::const_edge_iterator it = vd->edges().begin(); it != vd->edges().end(); ++it) {
-    if (!it->color()) {
-      auto twin = it->twin();
-      if (!twin->color()) {
-        twin->color(color);
+  const auto &edges = vd->edges();
+  parallelFor(edges.size() / 2, [&](std::size_t begin, std::size_t end) {
+    for (std::size_t i = begin; i < end; ++i) {
+      const auto &edge = edges[2 * i];
+      if (!edge.color() && !edge.twin()->color()) {
+        edge.twin()->color(color);
       }
     }
-  }
+  });
 }
 
-double Voronoi::diagram_type::angleOfSegment(int i, Voronoi::diagram_type::angle_map_t *angle) const {
-  Voronoi::diagram_type::angle_map_t::const_iterator a = angle ? angle->find(i) : Voronoi::diagram_type::angle_map_t::const_iterator();
-  if (!angle || a == angle->end()) {
-    Voronoi::point_type p0 = low(segments[i]);
-    Voronoi::point_type p1 = high(segments[i]);
-    double ang = 0;
-    if (p0.x() == p1.x()) {
-      if ((p0.y() > 0 && p1.y() > 0) || (p0.y() > 0 && p1.y() > 0)) {
-        ang = M_PI_2;
-      } else {
-        ang = -M_PI_2;
-      }
-    } else {
-      ang = atan((p0.y() - p1.y()) / (p0.x() - p1.x()));
-    }
-    if (angle) {
-      angle->insert(angle_map_t::value_type(i, ang));
-    }
-    return ang;
+double Voronoi::diagram_type::angleOfSegment(int i) const {
+  if (std::size_t(i) < segment_angle.size()) {
+    return segment_angle[i];
   }
-  return a->second;
+  return segmentAngle(segments[i]);
 }
 
 static bool pointsMatch(const Voronoi::point_type &p0, const Voronoi::point_type &p1) {
@@ -266,46 +293,106 @@ bool Voronoi::diagram_type::segmentsAreConnected(int i, int j) const {
 void Voronoi::colorColinear(Voronoi::color_type color, double degree) {
   double rad = degree * M_PI / 180;
 
-  Voronoi::diagram_type::angle_map_t angle;
   int psize = vd->points.size();
-
-  for (diagram_type::const_edge_iterator it = vd->edges().begin(); it != vd->edges().end(); ++it) {
-    int i0 = it->cell()->source_index() - psize;
-    int i1 = it->twin()->cell()->source_index() - psize;
-    if (it->color() == 0
-        && it->cell()->contains_segment()
-        && it->twin()->cell()->contains_segment()
-        && vd->segmentsAreConnected(i0, i1)) {
-      double a0 = vd->angleOfSegment(i0, &angle);
-      double a1 = vd->angleOfSegment(i1, &angle);
-      double a = a0 - a1;
-      if (a > M_PI_2) {
-        a -= M_PI;
-      } else if (a < -M_PI_2) {
-        a += M_PI;
+  const auto &edges = vd->edges();
+
+  parallelFor(edges.size() / 2, [&](std::size_t begin, std::size_t end) {
+    for (std::size_t i = begin; i < end; ++i) {
+      const auto &edge = edges[2 * i];
+      const auto *twin = edge.twin();
+      if ((edge.color() && twin->color())
+          || !edge.cell()->contains_segment()
+          || !twin->cell()->contains_segment()) {
+        continue;
       }
-      if (fabs(a) < rad) {
-        it->color(color);
-        it->twin()->color(color);
+      int i0 = edge.cell()->source_index() - psize;
+      int i1 = twin->cell()->source_index() - psize;
+      if (vd->segmentsAreConnected(i0, i1)) {
+        double a = vd->angleOfSegment(i0) - vd->angleOfSegment(i1);
+        if (a > M_PI_2) {
+          a -= M_PI;
+        } else if (a < -M_PI_2) {
+          a += M_PI;
+        }
+        if (fabs(a) < rad) {
+          edge.color(color);
+          twin->color(color);
+        }
       }
     }
-  }
+  });
 }
 
 void Voronoi::resetColor(Voronoi::color_type color) {
-  for (auto it = vd->cells().begin(); it != vd->cells().end(); ++it) {
-    if (color == 0 || it->color() == color) {
-      it->color(0);
+  const auto &cells = vd->cells();
+  const auto &edges = vd->edges();
+  const auto &vertices = vd->vertices();
+  parallelFor(cells.size(), [&](std::size_t begin, std::size_t end) {
+    for (std::size_t i = begin; i < end; ++i) {
+      if (color == 0 || cells[i].color() == color) {
+        cells[i].color(0);
+      }
     }
-  }
-  for (auto it = vd->edges().begin(); it != vd->edges().end(); ++it) {
-    if (it->color() == color) {
-      it->color(0);
+  });
+  parallelFor(edges.size(), [&](std::size_t begin, std::size_t end) {
+    for (std::size_t i = begin; i < end; ++i) {
+      if (edges[i].color() == color) {
+        edges[i].color(0);
+      }
     }
-  }
-  for (auto it = vd->vertices().begin(); it != vd->vertices().end(); ++it) {
-    if (it->color() == color) {
-      it->color(0);
+  });
+  parallelFor(vertices.size(), [&](std::size_t begin, std::size_t end) {
+    for (std::size_t i = begin; i < end; ++i) {
+      if (vertices[i].color() == color) {
+        vertices[i].color(0);
+      }
     }
-  }
+  });
+}
+
+void Voronoi::getVertexCoordinates(std::vector<double> &coords) const {
+  const auto &vertices = vd->vertices();
+  coords.resize(2 * vertices.size());
+  double scale = vd->getScale();
+  parallelFor(vertices.size(), [&](std::size_t begin, std::size_t end) {
+    for (std::size_t i = begin; i < end; ++i) {
+      coords[2 * i]     = vertices[i].x() / scale;
+      coords[2 * i + 1] = vertices[i].y() / scale;
+    }
+  });
+}
+
+void Voronoi::getEdgeVertexIndices(std::vector<int32_t> &indices) const {
+  const auto &edges = vd->edges();
+  indices.resize(2 * edges.size());
+  parallelFor(edges.size(), [&](std::size_t begin, std::size_t end) {
+    for (std::size_t i = begin; i < end; ++i) {
+      const auto *v0 = edges[i].vertex0();
+      const auto *v1 = edges[i].vertex1();
+      indices[2 * i]     = v0 ? vd->index(v0) : -1;
+      indices[2 * i + 1] = v1 ? vd->index(v1) : -1;
+    }
+  });
+}
+
+void Voronoi::getEdgeColors(std::vector<uint64_t> &colors) const {
+  const auto &edges = vd->edges();
+  colors.resize(edges.size());
+  parallelFor(edges.size(), [&](std::size_t begin, std::size_t end) {
+    for (std::size_t i = begin; i < end; ++i) {
+      colors[i] = edges[i].color() & Voronoi::ColorMask;
+    }
+  });
+}
+
+void Voronoi::getEdgeFlags(std::vector<uint8_t> &flags) const {
+  const auto &edges = vd->edges();
+  flags.resize(edges.size());
+  parallelFor(edges.size(), [&](std::size_t begin, std::size_t end) {
+    for (std::size_t i = begin; i < end; ++i) {
+      flags[i] = (edges[i].is_primary() ? EdgePrimary : 0)
+               | (edges[i].is_linear()  ? EdgeLinear  : 0)
+               | (edges[i].is_finite()  ? EdgeFinite  : 0);
+    }
+  });
 }
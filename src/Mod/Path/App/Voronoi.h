@@ -22,6 +22,7 @@
 #ifndef PATH_VORONOI_H
 #define PATH_VORONOI_H
 
+#include <cstdint>
 #include <map>
 #include <string>
 #include <Base/BaseClass.h>
@@ -77,15 +78,14 @@ namespace Path
       Base::Vector3d scaledVector(const point_type &p, double z) const;
       Base::Vector3d scaledVector(const vertex_type &v, double z) const;
 
-      typedef std::map<intptr_t, int> cell_map_type;
-      typedef std::map<intptr_t, int> edge_map_type;
-      typedef std::map<intptr_t, int> vertex_map_type;
-
+      // the diagram stores its elements in vectors, so the index of an
+      // element is derived from its address
       int index(const cell_type   *cell)   const;
       int index(const edge_type   *edge)   const;
       int index(const vertex_type *vertex) const;
 
-      void reIndex();
+      // cache the angles of all input segments, called after construction
+      void cacheAngles();
 
       std::vector<point_type>       points;
       std::vector<segment_type>     segments;
@@ -93,15 +93,12 @@ namespace Path
       point_type    retrievePoint(const cell_type *cell) const;
       segment_type  retrieveSegment(const cell_type *cell) const;
 
-      typedef std::map<int, double> angle_map_t;
-      double angleOfSegment(int i, angle_map_t *angle = 0) const;
+      double angleOfSegment(int i) const;
       bool segmentsAreConnected(int i, int j) const;
 
     private:
-      double          scale;
-      cell_map_type   cell_index;
-      edge_map_type   edge_index;
-      vertex_map_type vertex_index;
+      double              scale;
+      std::vector<double> segment_angle;
     };
 
     void addPoint(const point_type &p);
@@ -119,6 +116,18 @@ namespace Path
     void colorTwins(color_type color);
     void colorColinear(color_type color, double degree);
 
+    // flat copies of the diagram for bulk access, see VoronoiPy
+    void getVertexCoordinates(std::vector<double> &coords) const;
+    void getEdgeVertexIndices(std::vector<int32_t> &indices) const;
+    void getEdgeColors(std::vector<uint64_t> &colors) const;
+    void getEdgeFlags(std::vector<uint8_t> &flags) const;
+
+    enum EdgeFlag {
+      EdgePrimary   = 0x01,
+      EdgeLinear    = 0x02,
+      EdgeFinite    = 0x04,
+    };
+
     template<typename T>
     T* create(int index) {
       return new T(vd, index);
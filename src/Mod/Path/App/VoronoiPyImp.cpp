@@ -317,6 +317,51 @@ PyObject* VoronoiPy::getSegments(PyObject *args) {
   return Py::new_reference_to(list);
 }
 
+// Returns a memoryview of the given format on a copy of the values, which can be
+// wrapped by numpy without any further copy.
+template<typename T>
+static PyObject* toBuffer(const std::vector<T> &values, const char *format) {
+  Py::Object bytes = Py::asObject(PyBytes_FromStringAndSize(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(T)));
+  Py::Object view = Py::asObject(PyMemoryView_FromObject(bytes.ptr()));
+  return PyObject_CallMethod(view.ptr(), "cast", "s", format);
+}
+
+PyObject* VoronoiPy::getVertexCoordinates(PyObject *args) {
+  if (!PyArg_ParseTuple(args, "")) {
+    throw  Py::RuntimeError("no arguments accepted");
+  }
+  std::vector<double> coords;
+  getVoronoiPtr()->getVertexCoordinates(coords);
+  return toBuffer(coords, "d");
+}
+
+PyObject* VoronoiPy::getEdgeVertexIndices(PyObject *args) {
+  if (!PyArg_ParseTuple(args, "")) {
+    throw  Py::RuntimeError("no arguments accepted");
+  }
+  std::vector<int32_t> indices;
+  getVoronoiPtr()->getEdgeVertexIndices(indices);
+  return toBuffer(indices, "i");
+}
+
+PyObject* VoronoiPy::getEdgeColors(PyObject *args) {
+  if (!PyArg_ParseTuple(args, "")) {
+    throw  Py::RuntimeError("no arguments accepted");
+  }
+  std::vector<uint64_t> colors;
+  getVoronoiPtr()->getEdgeColors(colors);
+  return toBuffer(colors, "Q");
+}
+
+PyObject* VoronoiPy::getEdgeFlags(PyObject *args) {
+  if (!PyArg_ParseTuple(args, "")) {
+    throw  Py::RuntimeError("no arguments accepted");
+  }
+  std::vector<uint8_t> flags;
+  getVoronoiPtr()->getEdgeFlags(flags);
+  return toBuffer(flags, "B");
+}
+
 PyObject* VoronoiPy::numPoints(PyObject *args)
 {
   if (!PyArg_ParseTuple(args, "")) {
@@ -44,6 +44,7 @@
 #endif
 
 #include <Inventor/SbXfBox3d.h>
+#include <Inventor/nodes/SoLevelOfDetail.h>
 #include <boost/algorithm/string/replace.hpp>
 
 #include "ViewProviderPath.h"
@@ -144,6 +145,7 @@ PROPERTY_SOURCE(PathGui::ViewProviderPath, Gui::ViewProviderGeometryObject)
 
 ViewProviderPath::ViewProviderPath()
     :pt0Index(-1),blockPropertyChange(false),edgeStart(-1),coordStart(-1),coordEnd(-1),bboxCached(false)
+    ,decimated(false),chunkDeviation(0.0),waypointsValid(false),decimatedValid(false)
 {
     ParameterGrp::handle hGrp = App::GetApplication().GetParameterGroupByPath("User parameter:BaseApp/Preferences/Mod/Path");
     unsigned long lcol = hGrp->GetUnsigned("DefaultNormalPathColor",11141375UL); // dark green (0,170,0)
@@ -205,6 +207,12 @@ ViewProviderPath::ViewProviderPath()
     pcMarkerColor = new SoBaseColor;
     pcMarkerColor->ref();
 
+    pcDecimatedRoot = new SoSeparator;
+    pcDecimatedRoot->ref();
+
+    pcDecimatedColor = new SoMaterial;
+    pcDecimatedColor->ref();
+
     pcArrowSwitch = new SoSwitch();
     pcArrowSwitch->ref();
 
@@ -230,8 +238,6 @@ ViewProviderPath::ViewProviderPath()
     NormalColor.touch();
     MarkerColor.touch();
 
-    DisplayMode.setStatus(App::Property::Status::Hidden, true);
-    
     unsigned long sstyle = hGrp->GetInt("DefaultSelectionStyle",0);
     if(sstyle==0 || sstyle==1)
         SelectionStyle.setValue(sstyle);
@@ -251,6 +257,8 @@ ViewProviderPath::~ViewProviderPath()
     pcMatBind->unref();
     pcMarkerColor->unref();
     pcArrowSwitch->unref();
+    pcDecimatedRoot->unref();
+    pcDecimatedColor->unref();
 }
 
 void ViewProviderPath::attach(App::DocumentObject *pcObj)
@@ -280,6 +288,18 @@ void ViewProviderPath::attach(App::DocumentObject *pcObj)
     pcPathRoot->addChild(pcArrowSwitch);
 
     addDisplayMaskMode(pcPathRoot, "Waypoints");
+
+    // Draw the decimated polylines of each chunk, the colors are indexed
+    // by the color index of the segments
+    SoMaterialBinding* decimatedBind = new SoMaterialBinding;
+    decimatedBind->value = SoMaterialBinding::PER_PART_INDEXED;
+    SoSeparator* decimatedsep = new SoSeparator;
+    decimatedsep->addChild(pcDecimatedColor);
+    decimatedsep->addChild(decimatedBind);
+    decimatedsep->addChild(pcDrawStyle);
+    decimatedsep->addChild(pcDecimatedRoot);
+
+    addDisplayMaskMode(decimatedsep, "Decimated");
 }
 
 bool ViewProviderPath::useNewSelectionModel(void) const {
@@ -288,8 +308,16 @@ bool ViewProviderPath::useNewSelectionModel(void) const {
 
 void ViewProviderPath::setDisplayMode(const char* ModeName)
 {
-    if ( strcmp("Waypoints",ModeName)==0 )
+    if ( strcmp("Waypoints",ModeName)==0 ) {
         setDisplayMaskMode("Waypoints");
+        decimated = false;
+    }
+    else if ( strcmp("Decimated",ModeName)==0 ) {
+        setDisplayMaskMode("Decimated");
+        decimated = true;
+    }
+    if (pcObject)
+        updateVisual();
     inherited::setDisplayMode( ModeName );
 }
 
@@ -297,12 +325,22 @@ std::vector<std::string> ViewProviderPath::getDisplayModes(void) const
 {
     std::vector<std::string> StrList;
     StrList.push_back("Waypoints");
+    StrList.push_back("Decimated");
     return StrList;
 }
 
+const char* ViewProviderPath::getDefaultDisplayMode() const
+{
+    ParameterGrp::handle hGrp = App::GetApplication().GetParameterGroupByPath("User parameter:BaseApp/Preferences/Mod/Path");
+    if (hGrp->GetBool("DefaultPathDecimated", false))
+        return "Decimated";
+    return "Waypoints";
+}
+
 std::string ViewProviderPath::getElement(const SoDetail* detail) const
 {
-    if(edgeStart>=0 && detail && detail->getTypeId() == SoLineDetail::getClassTypeId()) {
+    // the decimated polylines can't be mapped back to the commands
+    if(!decimated && edgeStart>=0 && detail && detail->getTypeId() == SoLineDetail::getClassTypeId()) {
         const SoLineDetail* line_detail = static_cast<const SoLineDetail*>(detail);
         int index = line_detail->getLineIndex()+edgeStart;
         if(index>=0 && index<(int)edge2Command.size()) {
@@ -328,7 +366,7 @@ SoDetail* ViewProviderPath::getDetail(const char* subelement) const
 {
     int index = std::atoi(subelement);
     SoDetail* detail = 0;
-    if (index>0 && index<=(int)command2Edge.size()) {
+    if (!decimated && index>0 && index<=(int)command2Edge.size()) {
         index = command2Edge[index-1];
         if(index>=0 && edgeStart>=0 && edgeStart<=index) {
             detail = new SoLineDetail();
@@ -345,38 +383,7 @@ void ViewProviderPath::onChanged(const App::Property* prop)
     if (prop == &LineWidth) {
         pcDrawStyle->lineWidth = LineWidth.getValue();
     } else if (prop == &NormalColor) {
-        if (colorindex.size() > 0 && coordStart>=0 && coordStart<(int)colorindex.size()) {
-            const App::Color& c = NormalColor.getValue();
-            ParameterGrp::handle hGrp = App::GetApplication().GetParameterGroupByPath("User parameter:BaseApp/Preferences/Mod/Path");
-            unsigned long rcol = hGrp->GetUnsigned("DefaultRapidPathColor",2852126975UL); // dark red (170,0,0)
-            float rr,rg,rb;
-            rr = ((rcol >> 24) & 0xff) / 255.0; rg = ((rcol >> 16) & 0xff) / 255.0; rb = ((rcol >> 8) & 0xff) / 255.0;
-
-            unsigned long pcol = hGrp->GetUnsigned("DefaultProbePathColor",4293591295UL); // yellow (255,255,5)
-            float pr,pg,pb;
-            pr = ((pcol >> 24) & 0xff) / 255.0; pg = ((pcol >> 16) & 0xff) / 255.0; pb = ((pcol >> 8) & 0xff) / 255.0;
-
-            pcMatBind->value = SoMaterialBinding::PER_PART;
-            // resizing and writing the color vector:
-
-            int count = coordEnd-coordStart;
-            if(count > (int)colorindex.size()-coordStart) count = colorindex.size()-coordStart;
-            pcLineColor->diffuseColor.setNum(count);
-            SbColor* colors = pcLineColor->diffuseColor.startEditing();
-            for(int i=0;i<count;i++) {
-                switch(colorindex[i+coordStart]){
-                case 0:
-                    colors[i] = SbColor(rr,rg,rb);
-                    break;
-                case 1:
-                    colors[i] = SbColor(c.r,c.g,c.b);
-                    break;
-                default:
-                    colors[i] = SbColor(pr,pg,pb);
-                }
-            }
-            pcLineColor->diffuseColor.finishEditing();
-        }
+        updateColors();
     } else if (prop == &MarkerColor) {
         const App::Color& c = MarkerColor.getValue();
         pcMarkerColor->rgb.setValue(c.r,c.g,c.b);
@@ -397,9 +404,39 @@ void ViewProviderPath::onChanged(const App::Property* prop)
         inherited::onChanged(prop);
 }
 
+void ViewProviderPath::updateColors()
+{
+    const App::Color& c = NormalColor.getValue();
+    ParameterGrp::handle hGrp = App::GetApplication().GetParameterGroupByPath("User parameter:BaseApp/Preferences/Mod/Path");
+    unsigned long rcol = hGrp->GetUnsigned("DefaultRapidPathColor",2852126975UL); // dark red (170,0,0)
+    float rr,rg,rb;
+    rr = ((rcol >> 24) & 0xff) / 255.0; rg = ((rcol >> 16) & 0xff) / 255.0; rb = ((rcol >> 8) & 0xff) / 255.0;
+
+    unsigned long pcol = hGrp->GetUnsigned("DefaultProbePathColor",4293591295UL); // yellow (255,255,5)
+    float pr,pg,pb;
+    pr = ((pcol >> 24) & 0xff) / 255.0; pg = ((pcol >> 16) & 0xff) / 255.0; pb = ((pcol >> 8) & 0xff) / 255.0;
+
+    // indexed by the color index: rapid, feed, probe
+    SbColor table[3] = {SbColor(rr,rg,rb), SbColor(c.r,c.g,c.b), SbColor(pr,pg,pb)};
+    pcDecimatedColor->diffuseColor.setValues(0,3,table);
+
+    if (colorindex.size() > 0 && coordStart>=0 && coordStart<(int)colorindex.size()) {
+        pcMatBind->value = SoMaterialBinding::PER_PART;
+        // resizing and writing the color vector:
+
+        int count = coordEnd-coordStart;
+        if(count > (int)colorindex.size()-coordStart) count = colorindex.size()-coordStart;
+        pcLineColor->diffuseColor.setNum(count);
+        SbColor* colors = pcLineColor->diffuseColor.startEditing();
+        for(int i=0;i<count;i++)
+            colors[i] = table[std::min<int>(colorindex[i+coordStart],2)];
+        pcLineColor->diffuseColor.finishEditing();
+    }
+}
+
 void ViewProviderPath::showBoundingBox(bool show) {
     if(show) {
-        if(!pcLineCoords->point.getNum())
+        if(chunks.empty())
             return;
     }
     inherited::showBoundingBox(show);
@@ -455,45 +492,221 @@ void ViewProviderPath::hideSelection() {
     pcArrowSwitch->whichChild = -1;
 }
 
-class VisualPathSegmentVisitor
-: public PathSegmentVisitor
+namespace {
+
+// number of commands walked at once, the geometry is cached per chunk
+const unsigned int ChunkSize = 4096;
+
+// ratio of the chunk size to the tolerance of each level of detail, the
+// level is chosen when the chunk covers about ratio x ratio pixels
+const float DecimateRatios[] = {0.0f, 1024.0f, 256.0f, 64.0f};
+const int DecimateLevels = 4;
+
+// number of segments to approximate the arc within the given tolerance
+int arcSegments(const PathArc &arc, double tolerance)
 {
-public:
-    VisualPathSegmentVisitor(
-        const Toolpath &tp,
-        SoCoordinate3 *pcLineCoords_,
-        SoCoordinate3 *pcMarkerCoords_,
-        std::vector<int> &command2Edge_,
-        std::deque<int> &edge2Command_,
-        std::deque<int> &edgeIndices_,
-        std::vector<int> &colorindex_,
-        std::deque<Base::Vector3d> &points_,
-        std::deque<Base::Vector3d> &markers_)
-    : pcLineCoords(pcLineCoords_)
-    , pcMarkerCoords(pcMarkerCoords_)
-    , command2Edge(command2Edge_)
-    , edge2Command(edge2Command_)
-    , edgeIndices(edgeIndices_)
-    , colorindex(colorindex_)
-    , points(points_)
-    , markers(markers_)
+    int segments = arc.getSegments(arc.deviation);
+    if (arc.a != arc.A || arc.b != arc.B || arc.c != arc.C)
+        return segments;
+    Base::Vector3d last0(arc.last);
+    last0.*arc.pz = 0.0;
+    Base::Vector3d center0(arc.center);
+    center0.*arc.pz = 0.0;
+    double radius = (last0 - center0).Length();
+    double step = tolerance < radius ? 2.0 * acos(1.0 - tolerance / radius) : M_PI * 2.0 / 3.0;
+    return std::max(1, std::min(segments, static_cast<int>(std::ceil(arc.angle / step))));
+}
+
+// Drops the points closer than tolerance to the previously kept point. A
+// point is always kept if the color of the next segment is different.
+void decimate(const SbVec3f &entry, const std::vector<SbVec3f> &pts, const std::vector<uint8_t> &cols,
+              float tolerance, std::vector<SbVec3f> &resPts, std::vector<uint8_t> &resCols)
+{
+    float tol2 = tolerance * tolerance;
+    SbVec3f kept = entry;
+    for (std::size_t i=0; i<pts.size(); ++i) {
+        if (i+1 == pts.size() || cols[i+1] != cols[i] || (pts[i] - kept).sqrLength() > tol2) {
+            resPts.push_back(pts[i]);
+            resCols.push_back(cols[i]);
+            kept = pts[i];
+        }
+    }
+}
+
+SoGroup *makePolyline(const SbVec3f &entry, const std::vector<SbVec3f> &pts, const std::vector<uint8_t> &cols)
+{
+    int count = static_cast<int>(pts.size());
+
+    SoCoordinate3 *coords = new SoCoordinate3;
+    coords->point.setNum(count+1);
+    SbVec3f *verts = coords->point.startEditing();
+    verts[0] = entry;
+    std::copy(pts.begin(), pts.end(), verts+1);
+    coords->point.finishEditing();
+
+    SoIndexedLineSet *lines = new SoIndexedLineSet;
+    lines->coordIndex.setNum(count+2);
+    int32_t *idx = lines->coordIndex.startEditing();
+    for (int i=0; i<=count; ++i)
+        idx[i] = i;
+    idx[count+1] = -1;
+    lines->coordIndex.finishEditing();
+
+    lines->materialIndex.setNum(count);
+    int32_t *mat = lines->materialIndex.startEditing();
+    std::copy(cols.begin(), cols.end(), mat);
+    lines->materialIndex.finishEditing();
+
+    SoGroup *group = new SoGroup;
+    group->addChild(coords);
+    group->addChild(lines);
+    return group;
+}
+
+} // namespace
+
+/** The result of walking the commands [begin, end)
+ *
+ * The points are collected as they are reported by the walker, except for
+ * the arcs which are kept as PathArc and only discretised when the geometry
+ * of a display mode is built. The discretised points are not kept, they only
+ * live in the Coin nodes.
+ */
+struct ViewProviderPath::PathChunk
+{
+    struct Edge {
+        unsigned int command;   // relative to begin
+        unsigned int end;       // index after the last point of the edge
+    };
+    struct Arc {
+        PathArc arc;
+        unsigned int at;        // the interpolated points go before points[at]
+        uint8_t color;
+    };
+
+    unsigned int begin = 0;
+    unsigned int end = 0;
+    std::size_t hash = 0;
+    PathSegmentWalker::State state;
+    PathSegmentWalker::State endState;
+
+    std::vector<SbVec3f> points;
+    std::vector<uint8_t> colors;        // 0: rapid, 1: feed, 2: probe
+    std::vector<Arc> arcs;
+    std::vector<Edge> edges;
+    std::vector<SbVec3f> markers;
+    Base::BoundBox3d bbox;
+
+    // display mode "Decimated", see updateNode()
+    SoSeparator *node = nullptr;
+    SbVec3f entry;
+
+    ~PathChunk() {
+        if (node)
+            node->unref();
+    }
+
+    /// the last point drawn by this chunk or \a from if there is none
+    SbVec3f exit(const SbVec3f &from) const {
+        if (points.empty())
+            return from;
+        return points.back();
+    }
+
+    /// the number of points discretize() reports with tolerance 0
+    std::size_t countPoints() const {
+        std::size_t count = points.size();
+        for (const auto &arc : arcs)
+            count += arc.arc.getSegments(arc.arc.deviation) - 1;
+        return count;
+    }
+
+    /** Interpolates the arcs and calls \a addPoint(point, color) for all
+     * points, tolerance 0 means the deviation of the walker. \a endEdge(edge,
+     * count) is called at the end of each edge with the number of points
+     * reported so far.
+     */
+    template <class AddPoint, class EndEdge>
+    void discretize(double tolerance, AddPoint addPoint, EndEdge endEdge) const
     {
-        pcLineCoords->point.deleteValues(0);
-        pcMarkerCoords->point.deleteValues(0);
+        std::deque<Base::Vector3d> interior;
+        auto arc = arcs.begin();
+        std::size_t edge = 0;
+        std::size_t count = 0;
+        for (std::size_t i=0; i<points.size(); ++i) {
+            for (; edge<edges.size() && edges[edge].end==i; ++edge)
+                endEdge(edge, count);
+            for (; arc!=arcs.end() && arc->at==i; ++arc) {
+                interior.clear();
+                arc->arc.discretize(interior, tolerance > 0.0 ?
+                        arcSegments(arc->arc, tolerance) : arc->arc.getSegments(arc->arc.deviation));
+                for (const auto &pt : interior) {
+                    addPoint(SbVec3f(pt.x,pt.y,pt.z), arc->color);
+                    ++count;
+                }
+            }
+            addPoint(points[i], colors[i]);
+            ++count;
+        }
+        for (; edge<edges.size(); ++edge)
+            endEdge(edge, count);
+    }
 
-        command2Edge.clear();
-        edge2Command.clear();
-        edgeIndices.clear();
+    void discretize(double tolerance, std::vector<SbVec3f> &pts, std::vector<uint8_t> &cols) const
+    {
+        discretize(tolerance,
+            [&](const SbVec3f &pt, uint8_t color) {
+                pts.push_back(pt);
+                cols.push_back(color);
+            },
+            [](std::size_t, std::size_t) {});
+    }
 
-        colorindex.clear();
+    /// builds the levels of detail of the chunk, starting at \a from
+    void updateNode(const SbVec3f &from) {
+        if (node) {
+            if (entry == from)
+                return;
+            node->unref();
+        }
+        entry = from;
+        node = new SoSeparator;
+        node->ref();
+        if (points.empty())
+            return;
 
-        command2Edge.resize(tp.getSize(),-1);
+        Base::BoundBox3d box(bbox);
+        box.Add(Base::Vector3d(from[0],from[1],from[2]));
+        double size = std::max(box.CalcDiagonalLength(), 1e-6);
+
+        SoLevelOfDetail *lod = new SoLevelOfDetail;
+        std::vector<SbVec3f> pts, resPts;
+        std::vector<uint8_t> cols, resCols;
+        discretize(0.0, pts, cols);
+        lod->addChild(makePolyline(entry, pts, cols));
+        for (int level=1; level<DecimateLevels; ++level) {
+            float ratio = DecimateRatios[level];
+            double tolerance = size / ratio;
+            pts.clear();
+            cols.clear();
+            resPts.clear();
+            resCols.clear();
+            discretize(tolerance, pts, cols);
+            decimate(entry, pts, cols, tolerance, resPts, resCols);
+            lod->addChild(makePolyline(entry, resPts, resCols));
+            lod->screenArea.set1Value(level-1, ratio * ratio);
+        }
+        node->addChild(lod);
     }
+};
 
-    virtual void setup(const Base::Vector3d &last)
+class VisualPathSegmentVisitor
+: public PathSegmentVisitor
+{
+public:
+    VisualPathSegmentVisitor(ViewProviderPath::PathChunk &chunk_)
+    : chunk(chunk_)
     {
-        points.push_back(last);
-        markers.push_back(last);
     }
 
     virtual void g0(int id, const Base::Vector3d &last, const Base::Vector3d &next, const std::deque<Base::Vector3d> &pts)
@@ -508,11 +721,24 @@ public:
         gx(id, &next, pts, 1);
     }
 
-    virtual void g23(int id, const Base::Vector3d &last, const Base::Vector3d &next, const std::deque<Base::Vector3d> &pts, const Base::Vector3d &center)
+    virtual void arc(int id, const Base::Vector3d &last, const Base::Vector3d &next, const PathArc &arc)
     {
         (void)last;
-        gx(id, &next, pts, 1);
-        markers.push_back(center);
+
+        ViewProviderPath::PathChunk::Arc entry;
+        entry.arc = arc;
+        entry.at = chunk.points.size();
+        entry.color = 1;
+        chunk.arcs.push_back(entry);
+
+        // a coarse approximation is good enough for the bounding box
+        std::deque<Base::Vector3d> pts;
+        arc.discretize(pts, std::max(4, static_cast<int>(arc.angle / (M_PI / 16.0))));
+        for (const auto &pt : pts)
+            chunk.bbox.Add(pt);
+
+        gx(id, &next, std::deque<Base::Vector3d>(), 1);
+        addMarker(arc.center);
     }
 
     virtual void g8x(int id, const Base::Vector3d &last, const Base::Vector3d &next, const std::deque<Base::Vector3d> &pts,
@@ -522,25 +748,21 @@ public:
 
         gx(id, NULL, pts, 0);
 
-        points.push_back(p[0]);
-        markers.push_back(p[0]);
-        colorindex.push_back(0);
+        addPoint(p[0], 0);
+        addMarker(p[0]);
 
-        points.push_back(p[1]);
-        markers.push_back(p[1]);
-        colorindex.push_back(0);
+        addPoint(p[1], 0);
+        addMarker(p[1]);
 
-        points.push_back(next);
-        markers.push_back(next);
-        colorindex.push_back(1);
+        addPoint(next, 1);
+        addMarker(next);
 
         for (std::deque<Base::Vector3d>::const_iterator it=q.begin(); q.end() != it; ++it) {
-            markers.push_back(*it);
+            addMarker(*it);
         }
 
-        points.push_back(p[2]);
-        markers.push_back(p[2]);
-        colorindex.push_back(0);
+        addPoint(p[2], 0);
+        addMarker(p[2]);
 
         pushCommand(id);
     }
@@ -548,54 +770,214 @@ public:
     virtual void g38(int id, const Base::Vector3d &last, const Base::Vector3d &next)
     {
       Base::Vector3d p1(next.x,next.y,last.z);
-      points.push_back(p1);
-      colorindex.push_back(0);
+      addPoint(p1, 0);
 
-      points.push_back(next);
-      colorindex.push_back(2);
+      addPoint(next, 2);
 
       Base::Vector3d p3(next.x,next.y,last.z);
-      points.push_back(p3);
-      colorindex.push_back(0);
+      addPoint(p3, 0);
 
       pushCommand(id);
     }
 
 private:
-    SoCoordinate3 *pcLineCoords;
-    SoCoordinate3 *pcMarkerCoords;
+    ViewProviderPath::PathChunk &chunk;
 
-    std::vector<int> &command2Edge;
-    std::deque<int> &edge2Command;
-    std::deque<int> &edgeIndices;
+    void addPoint(const Base::Vector3d &pt, uint8_t color) {
+        chunk.points.push_back(SbVec3f(pt.x,pt.y,pt.z));
+        chunk.colors.push_back(color);
+        chunk.bbox.Add(pt);
+    }
 
-    std::vector<int> &colorindex;
-    std::deque<Base::Vector3d> &points;
-    std::deque<Base::Vector3d> &markers;
+    void addMarker(const Base::Vector3d &pt) {
+        chunk.markers.push_back(SbVec3f(pt.x,pt.y,pt.z));
+    }
 
-    virtual void gx(int id, const Base::Vector3d *next, const std::deque<Base::Vector3d> &pts, int color)
+    void gx(int id, const Base::Vector3d *next, const std::deque<Base::Vector3d> &pts, uint8_t color)
     {
         for (std::deque<Base::Vector3d>::const_iterator it=pts.begin(); pts.end() != it; ++it) {
-          points.push_back(*it);
-          colorindex.push_back(color);
+          addPoint(*it, color);
         }
 
         if (next != NULL) {
-            points.push_back(*next);
-            markers.push_back(*next);
-            colorindex.push_back(color);
+            addPoint(*next, color);
+            addMarker(*next);
 
             pushCommand(id);
         }
     }
 
     void pushCommand(int id) {
-      command2Edge[id] = edgeIndices.size();
-      edgeIndices.push_back(points.size());
-      edge2Command.push_back(id);
+      ViewProviderPath::PathChunk::Edge edge;
+      edge.command = id - chunk.begin;
+      edge.end = chunk.points.size();
+      chunk.edges.push_back(edge);
     }
 };
 
+void ViewProviderPath::updateChunks()
+{
+    Path::Feature* pcPathObj = static_cast<Path::Feature*>(pcObject);
+    const Toolpath &tp = pcPathObj->Path.getValue();
+    unsigned int size = tp.getSize();
+
+    std::vector<std::unique_ptr<PathChunk> > old;
+    old.swap(chunks);
+
+    // the rotation center affects all points and the arcs are discretised
+    // with the mesh deviation
+    ParameterGrp::handle hGrp = App::GetApplication().GetParameterGroupByPath("User parameter:BaseApp/Preferences/Mod/Part");
+    double deviation = hGrp->GetFloat("MeshDeviation",0.2);
+    if (tp.getCenter() != chunkCenter || deviation != chunkDeviation) {
+        old.clear();
+        chunkCenter = tp.getCenter();
+        chunkDeviation = deviation;
+    }
+
+    PathSegmentWalker walker(tp);
+    PathSegmentWalker::State state(StartPosition.getValue());
+
+    // keep the leading chunks that did not change
+    std::size_t first = 0;
+    for (; first<old.size(); ++first) {
+        PathChunk &chunk = *old[first];
+        if (chunk.end > size || chunk.state != state || tp.hashRange(chunk.begin, chunk.end) != chunk.hash)
+            break;
+        state = chunk.endState;
+        chunks.push_back(std::move(old[first]));
+    }
+    unsigned int pos = chunks.empty() ? 0 : chunks.back()->end;
+
+    // find the trailing chunks whose commands were only moved by inserting
+    // or deleting commands before them
+    long delta = static_cast<long>(size) - static_cast<long>(old.empty() ? 0 : old.back()->end);
+    std::size_t next = old.size();
+    for (; next>first; --next) {
+        PathChunk &chunk = *old[next-1];
+        long begin = static_cast<long>(chunk.begin) + delta;
+        if (begin < static_cast<long>(pos)
+                || tp.hashRange(begin, static_cast<long>(chunk.end) + delta) != chunk.hash)
+            break;
+    }
+
+    // walk the remaining commands and reuse a trailing chunk as soon as the
+    // state before it is the same as before
+    while (pos < size) {
+        unsigned int end = std::min(size, pos + ChunkSize);
+        if (next < old.size()) {
+            PathChunk &chunk = *old[next];
+            unsigned int begin = static_cast<unsigned int>(chunk.begin + delta);
+            if (begin == pos) {
+                ++next;
+                if (chunk.state == state) {
+                    chunk.begin = begin;
+                    chunk.end = static_cast<unsigned int>(chunk.end + delta);
+                    state = chunk.endState;
+                    pos = chunk.end;
+                    chunks.push_back(std::move(old[next-1]));
+                    continue;
+                }
+                end = static_cast<unsigned int>(chunk.end + delta);
+            }
+            else if (begin < end) {
+                end = begin;
+            }
+        }
+
+        std::unique_ptr<PathChunk> chunk(new PathChunk);
+        chunk->begin = pos;
+        chunk->end = end;
+        chunk->hash = tp.hashRange(pos, end);
+        chunk->state = state;
+        VisualPathSegmentVisitor collect(*chunk);
+        state = walker.walk(collect, state, pos, end);
+        chunk->endState = state;
+        chunks.push_back(std::move(chunk));
+        pos = end;
+    }
+}
+
+void ViewProviderPath::updateWaypoints()
+{
+    waypointsValid = true;
+
+    Path::Feature* pcPathObj = static_cast<Path::Feature*>(pcObject);
+    const Toolpath &tp = pcPathObj->Path.getValue();
+
+    std::size_t numPoints = 1;
+    std::size_t numMarkers = 1;
+    std::size_t numEdges = 0;
+    for (auto &chunk : chunks) {
+        numPoints += chunk->countPoints();
+        numMarkers += chunk->markers.size();
+        numEdges += chunk->edges.size();
+    }
+
+    pcLineCoords->point.deleteValues(0);
+    pcMarkerCoords->point.deleteValues(0);
+
+    command2Edge.clear();
+    edge2Command.clear();
+    edgeIndices.clear();
+
+    colorindex.clear();
+
+    command2Edge.resize(tp.getSize(),-1);
+
+    if (numEdges == 0)
+        return;
+
+    const Base::Vector3d &start = StartPosition.getValue();
+
+    pcLineCoords->point.setNum(numPoints);
+    SbVec3f* verts = pcLineCoords->point.startEditing();
+    verts[0].setValue(start.x,start.y,start.z);
+
+    pcMarkerCoords->point.setNum(numMarkers);
+    SbVec3f* marks = pcMarkerCoords->point.startEditing();
+    marks[0].setValue(start.x,start.y,start.z);
+
+    // the points are interpolated straight into the coordinates, the chunks
+    // don't keep them
+    colorindex.reserve(numPoints);
+    int offset = 1;
+    int markerOffset = 1;
+    for (auto &chunk : chunks) {
+        std::copy(chunk->markers.begin(), chunk->markers.end(), marks+markerOffset);
+        int chunkOffset = offset;
+        chunk->discretize(0.0,
+            [&](const SbVec3f &pt, uint8_t color) {
+                verts[offset++] = pt;
+                colorindex.push_back(color);
+            },
+            [&](std::size_t edge, std::size_t count) {
+                int id = chunk->begin + chunk->edges[edge].command;
+                command2Edge[id] = edgeIndices.size();
+                edgeIndices.push_back(chunkOffset + count);
+                edge2Command.push_back(id);
+            });
+        markerOffset += chunk->markers.size();
+    }
+
+    pcLineCoords->point.finishEditing();
+    pcMarkerCoords->point.finishEditing();
+}
+
+void ViewProviderPath::updateDecimated()
+{
+    decimatedValid = true;
+
+    pcDecimatedRoot->removeAllChildren();
+
+    const Base::Vector3d &start = StartPosition.getValue();
+    SbVec3f entry(start.x,start.y,start.z);
+    for (auto &chunk : chunks) {
+        chunk->updateNode(entry);
+        pcDecimatedRoot->addChild(chunk->node);
+        entry = chunk->exit(entry);
+    }
+}
+
 void ViewProviderPath::updateVisual(bool rebuild) {
 
     hideSelection();
@@ -605,43 +987,24 @@ void ViewProviderPath::updateVisual(bool rebuild) {
     pcLines->coordIndex.deleteValues(0);
 
     if(rebuild) {
-        Path::Feature* pcPathObj = static_cast<Path::Feature*>(pcObject);
-        const Toolpath &tp = pcPathObj->Path.getValue();
-
-        std::deque<Base::Vector3d> points;
-        std::deque<Base::Vector3d> markers;
-
-        VisualPathSegmentVisitor collect(tp,
-            pcLineCoords,
-            pcMarkerCoords,
-            command2Edge,
-            edge2Command,
-            edgeIndices,
-            colorindex,
-            points,
-            markers);
-
-        PathSegmentWalker segments(tp);
-        segments.walk(collect, StartPosition.getValue());
-
-
-        if (!edgeIndices.empty()) {
-            pcLineCoords->point.setNum(points.size());
-            SbVec3f* verts = pcLineCoords->point.startEditing();
-            int i=0;
-            for(const auto &pt : points)
-                verts[i++].setValue(pt.x,pt.y,pt.z);
-            pcLineCoords->point.finishEditing();
-
-            pcMarkerCoords->point.setNum(markers.size());
-            for(unsigned int i=0;i<markers.size();i++)
-                pcMarkerCoords->point.set1Value(i,markers[i].x,markers[i].y,markers[i].z);
-
-            bboxCached = false;
+        updateChunks();
+        waypointsValid = false;
+        decimatedValid = false;
+
+        bboxCached = false;
+        if (!chunks.empty())
             updateBoundingBox();
-        }
     }
 
+    // the geometry of the display modes is only built when shown
+    if (decimated) {
+        if (!decimatedValid)
+            updateDecimated();
+        return;
+    }
+    if (!waypointsValid)
+        updateWaypoints();
+
     // count = index + separators
     edgeStart = -1;
     int i;
@@ -700,13 +1063,8 @@ Base::BoundBox3d ViewProviderPath::_getBoundingBox(
     if(!bboxCached) {
         bboxCached = true;
         Base::BoundBox3d bbox;
-        Base::Vector3d pt;
-        for (int i=1;i<pcLineCoords->point.getNum();i++) {
-            pt.x = pcLineCoords->point[i].getValue()[0];
-            pt.y = pcLineCoords->point[i].getValue()[1];
-            pt.z = pcLineCoords->point[i].getValue()[2];
-            bbox.Add(pt);
-        }
+        for (const auto &chunk : chunks)
+            bbox.Add(chunk->bbox);
         bboxCache = bbox;
     }
 
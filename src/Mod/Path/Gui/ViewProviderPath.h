@@ -24,6 +24,7 @@
 #ifndef PATH_ViewProviderPath_H
 #define PATH_ViewProviderPath_H
 
+#include <memory>
 #include <App/PropertyGeo.h>
 #include <Gui/Selection.h>
 #include <Gui/ViewProviderGeometryObject.h>
@@ -38,6 +39,7 @@ class SoBaseColor;
 class SoMaterialBinding;
 class SoTransform;
 class SoSwitch;
+class SoSeparator;
 
 namespace PathGui
 {
@@ -71,6 +73,7 @@ public:
     void attach(App::DocumentObject *pcObject);
     void setDisplayMode(const char* ModeName);
     std::vector<std::string> getDisplayModes() const;
+    virtual const char* getDefaultDisplayMode() const;
     void updateData(const App::Property*);
     virtual QIcon getIcon() const;
 
@@ -86,6 +89,9 @@ public:
 
     friend class PathSelectionObserver;
 
+    /// A range of commands with its cached geometry, see updateChunks()
+    struct PathChunk;
+
 protected:
     virtual Base::BoundBox3d _getBoundingBox(
             const char *subname=0, const Base::Matrix4D *mat=0, unsigned transform=true,
@@ -94,6 +100,11 @@ protected:
     virtual void onChanged(const App::Property* prop);
     virtual unsigned long getBoundColor() const;
 
+    void updateChunks();
+    void updateWaypoints();
+    void updateDecimated();
+    void updateColors();
+
     SoCoordinate3         * pcLineCoords;
     SoCoordinate3         * pcMarkerCoords;
     SoDrawStyle           * pcDrawStyle;
@@ -119,6 +130,17 @@ protected:
 
     mutable Base::BoundBox3d bboxCache;
     mutable bool bboxCached;
+
+    // Display mode "Decimated"
+    SoSeparator           * pcDecimatedRoot;
+    SoMaterial            * pcDecimatedColor;
+    bool                    decimated;
+
+    std::vector<std::unique_ptr<PathChunk> > chunks;
+    Base::Vector3d          chunkCenter;
+    double                  chunkDeviation;
+    bool                    waypointsValid;
+    bool                    decimatedValid;
  };
 
  typedef Gui::ViewProviderPythonFeatureT<ViewProviderPath> ViewProviderPathPython;
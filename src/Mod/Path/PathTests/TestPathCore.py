@@ -164,3 +164,59 @@ G0 Z0.500000
         path = Path.Path(commands)
 
         self.assertEqual(path.Length, 2)
+
+    def test60(self):
+        """Test inserting and deleting commands in the middle of a Path"""
+        p = Path.Path()
+        p.setFromGCode('G0 X1 Y2\nG81 X3 Y4 Z-1 R1 Q0.5\nG1 X5 F100\n')
+
+        p.insertCommand(Path.Command("G1", {"X": 7, "S": 2000}), 1)
+        self.assertEqual(p.Size, 4)
+        self.assertEqual(p.Commands[1].Parameters, {'S': 2000.0, 'X': 7.0})
+        self.assertEqual(p.Commands[2].Parameters, {'Q': 0.5, 'R': 1.0, 'X': 3.0, 'Y': 4.0, 'Z': -1.0})
+
+        p.deleteCommand(2)
+        self.assertEqual(p.toGCode(), 'G0 X1.000000 Y2.000000\nG1 S2000.000000 X7.000000\nG1 F100.000000 X5.000000\n')
+        self.assertEqual(p.Commands[2].Parameters, {'F': 100.0, 'X': 5.0})
+
+    def test70(self):
+        """Test parsing comments and lowercase words from gcode"""
+        p = Path.Path()
+        p.setFromGCode('G0 X1 (move to start) G1 Y2\n(final comment)\n')
+        self.assertEqual(p.Size, 4)
+        self.assertEqual(p.Commands[1].Name, '(move to start)')
+        self.assertEqual(p.Commands[1].Parameters, {})
+        self.assertEqual(p.toGCode(), 'G0 X1.000000\n(move to start)\nG1 Y2.000000\n(final comment)\n')
+
+        p.setFromGCode('g1 x1.5 y-2 f100\nm3 s1000\n')
+        self.assertEqual(p.Commands[0].Name, 'G1')
+        self.assertEqual(p.Commands[0].Parameters, {'F': 100.0, 'X': 1.5, 'Y': -2.0})
+        self.assertEqual(p.toGCode(), 'G1 F100.000000 X1.500000 Y-2.000000\nM3 S1000.000000\n')
+
+        c = Path.Command('g2 x1 y0.5 i0.5 j0')
+        self.assertEqual(str(c), 'Command G2 [ I:0.5 J:0 X:1 Y:0.5 ]')
+
+    def test80(self):
+        """Test unit conversion and number parsing of gcode"""
+        # G20 switches to inches, the positions and the feed rate are scaled
+        p = Path.Path()
+        p.setFromGCode('G20\nG1 X1 Y2 Z0.5 F10 S100\nG21\nG1 X1\n')
+        self.assertEqual(p.Size, 2)
+        self.assertEqual(p.toGCode(), 'G1 F254.000000 S100.000000 X25.400000 Y50.800000 Z12.700000\nG1 X1.000000\n')
+
+        # values with more than 15 significant digits are parsed like float()
+        c = Path.Command('G1 X1.23456789012345678 Y0.1234567890123456789012345 Z-0.123456789012345')
+        self.assertEqual(c.Parameters['X'], 1.23456789012345678)
+        self.assertEqual(c.Parameters['Y'], 0.1234567890123456789012345)
+        self.assertEqual(c.Parameters['Z'], -0.123456789012345)
+
+    def test90(self):
+        """Test rejecting malformed gcode"""
+        self.assertRaises(ValueError, Path.Command, 'G1 X')
+        self.assertRaises(ValueError, Path.Command, 'G1 X1 Y')
+
+        p = Path.Path()
+        with self.assertRaises(Exception):
+            p.setFromGCode('G0 X1\nG1 X\n')
+        with self.assertRaises(Exception):
+            p.setFromGCode('G1 X1 Y Z2\n')
@@ -170,3 +170,29 @@ class TestPathVoronoi(PathTestUtils.PathTestBase):
         self.assertRoughly(e.valueAt(e.FirstParameter).z, 2.37)
         self.assertRoughly(e.valueAt(e.LastParameter).z,  5.14)
 
+
+    def test70(self):
+        '''Check bulk access matches the element objects'''
+
+        coords = vd.getVertexCoordinates()
+        self.assertEqual(len(coords), 2 * vd.numVertices())
+        for v in vd.Vertices:
+            self.assertRoughly(coords[2 * v.Index], v.X)
+            self.assertRoughly(coords[2 * v.Index + 1], v.Y)
+
+        indices = vd.getEdgeVertexIndices()
+        colors = vd.getEdgeColors()
+        flags = vd.getEdgeFlags()
+        self.assertEqual(len(indices), 2 * vd.numEdges())
+        self.assertEqual(len(colors), vd.numEdges())
+        self.assertEqual(len(flags), vd.numEdges())
+        for e in vd.Edges:
+            i = e.Index
+            self.assertEqual(e.Twin.Index, i ^ 1)
+            self.assertEqual(colors[i], e.Color)
+            self.assertEqual(flags[i] & 1 != 0, e.isPrimary())
+            self.assertEqual(flags[i] & 2 != 0, e.isLinear())
+            self.assertEqual(flags[i] & 4 != 0, e.isFinite())
+            vs = e.Vertices
+            self.assertEqual(indices[2 * i],     vs[0].Index if vs[0] else -1)
+            self.assertEqual(indices[2 * i + 1], vs[1].Index if vs[1] else -1)
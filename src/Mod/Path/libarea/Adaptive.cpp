@@ -26,6 +26,13 @@
 #include <cstring>
 #include <ctime>
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <random>
+#include <thread>
 
 namespace ClipperLib
 {
@@ -909,6 +916,28 @@ PerfCounter Perf_AppendToolPath("AppendToolPath");
 PerfCounter Perf_IsAllowedToCutTrough("IsAllowedToCutTrough");
 PerfCounter Perf_IsClearPath("IsClearPath");
 
+//***********************************
+// State shared by the region threads
+//***********************************
+struct ProcessingState
+{
+	ProcessingState() : stop(false), callerThread(std::this_thread::get_id()), lastProgressTime(clock()), running(0) {}
+
+	std::atomic<bool> stop;
+	std::mutex mutex;
+	std::condition_variable wakeUp;
+	std::thread::id callerThread; // the only thread allowed to call the progress callback
+	clock_t lastProgressTime;
+	TPaths pendingProgress; // progress of the worker threads, reported by the caller thread
+	int running;			// number of running worker threads
+	std::exception_ptr error;
+};
+
+inline bool Adaptive2d::IsStopped() const
+{
+	return processing->stop;
+}
+
 //***********************************
 // Cleared area bounding support
 //***********************************
@@ -1114,7 +1143,9 @@ class Interpolation
 
 	double getRandomAngle()
 	{
-		return MIN_ANGLE + (MAX_ANGLE - MIN_ANGLE) * double(rand()) / double(RAND_MAX);
+		// own generator instead of rand(), so the result of a region does not
+		// depend on the other threads
+		return MIN_ANGLE + (MAX_ANGLE - MIN_ANGLE) * double(random() - random.min()) / double(random.max() - random.min());
 	}
 	size_t getPointCount()
 	{
@@ -1124,6 +1155,7 @@ class Interpolation
   private:
 	vector<double> angles;
 	vector<double> areas;
+	std::minstd_rand random;
 };
 
 //***************************************
@@ -1687,7 +1719,6 @@ std::list<AdaptiveOutput> Adaptive2d::Execute(const DPaths &stockPaths, const DP
 		scaleFactor = maxScaleFactor;
 	//scaleFactor = round(scaleFactor);
 
-	current_region=0;
 	cout << "Tool Diameter: " << toolDiameter << endl;
 	cout << "Accuracy: " << round(10000.0/scaleFactor)/10 << " um" << endl;
 	cout << flush;
@@ -1695,8 +1726,7 @@ std::list<AdaptiveOutput> Adaptive2d::Execute(const DPaths &stockPaths, const DP
 	toolRadiusScaled = long(toolDiameter * scaleFactor / 2);
 	stepOverScaled = toolRadiusScaled * stepOverFactor;
 	progressCallback = &progressCallbackFn;
-	lastProgressTime = clock();
-	stopProcessing = false;
+	processing = std::make_shared<ProcessingState>();
 
 	if(helixRampDiameter<NTOL)
 		helixRampDiameter=0.75*toolDiameter;
@@ -1775,8 +1805,9 @@ std::list<AdaptiveOutput> Adaptive2d::Execute(const DPaths &stockPaths, const DP
 	//CleanPolygons(stockInputPaths,0.707);
 
 	//***************************************
-	//	Resolve hierarchy and run processing
+	//	Resolve hierarchy
 	//***************************************
+	std::vector<std::pair<Paths, Paths>> regions; // bound paths and tool bound paths of each region
 	double cornerRoundingOffset = 0.15 * toolRadiusScaled / 2;
 	if (opType == OperationType::otClearingInside || opType == OperationType::otClearingOutside)
 	{
@@ -1830,7 +1861,7 @@ std::list<AdaptiveOutput> Adaptive2d::Execute(const DPaths &stockPaths, const DP
 				clipof.Clear();
 				clipof.AddPaths(toolBoundPaths, JoinType::jtRound, EndType::etClosedPolygon);
 				clipof.Execute(boundPaths, toolRadiusScaled + finishPassOffsetScaled);
-				ProcessPolyNode(boundPaths, toolBoundPaths);
+				regions.push_back(std::make_pair(boundPaths, toolBoundPaths));
 			}
 		}
 	}
@@ -1889,11 +1920,93 @@ std::list<AdaptiveOutput> Adaptive2d::Execute(const DPaths &stockPaths, const DP
 					clipof.AddPaths(toolBoundPaths, JoinType::jtRound, EndType::etClosedPolygon);
 					clipof.Execute(boundPaths, toolRadiusScaled + finishPassOffsetScaled);
 
-					ProcessPolyNode(boundPaths, toolBoundPaths);
+					regions.push_back(std::make_pair(boundPaths, toolBoundPaths));
 				}
 			}
 		}
 	}
+
+	//***************************************
+	//	Run processing
+	//***************************************
+	// each region has its own cleared area, so they are independent of each other
+	std::vector<std::list<AdaptiveOutput>> regionResults(regions.size());
+	size_t numThreads = threads > 0 ? size_t(threads) : size_t(std::thread::hardware_concurrency());
+#ifdef DEV_MODE
+	numThreads = 1; // the debug callbacks and performance counters are not thread safe
+#endif
+	if (numThreads > regions.size())
+		numThreads = regions.size();
+
+	if (numThreads <= 1)
+	{
+		for (size_t i = 0; i < regions.size() && !IsStopped(); i++)
+			ProcessPolyNode(regions[i].first, regions[i].second, int(i + 1), regionResults[i]);
+	}
+	else
+	{
+		std::atomic<size_t> nextRegion(0);
+		auto storeError = [this]() {
+			std::lock_guard<std::mutex> lock(processing->mutex);
+			if (!processing->error)
+				processing->error = std::current_exception();
+			processing->stop = true;
+		};
+		auto worker = [&]() {
+			try
+			{
+				for (size_t i = nextRegion++; i < regions.size() && !IsStopped(); i = nextRegion++)
+					ProcessPolyNode(regions[i].first, regions[i].second, int(i + 1), regionResults[i]);
+			}
+			catch (...)
+			{
+				storeError();
+			}
+			std::lock_guard<std::mutex> lock(processing->mutex);
+			processing->running--;
+			processing->wakeUp.notify_all();
+		};
+
+		processing->running = int(numThreads);
+		std::vector<std::thread> pool;
+		for (size_t i = 0; i < numThreads; i++)
+			pool.emplace_back(worker);
+
+		// report the progress of the workers, the callback may call python
+		// so it is only called from this thread
+		std::unique_lock<std::mutex> lock(processing->mutex);
+		while (processing->running > 0 || !processing->pendingProgress.empty())
+		{
+			if (processing->pendingProgress.empty())
+			{
+				processing->wakeUp.wait_for(lock, std::chrono::milliseconds(100));
+				continue;
+			}
+			TPaths progressPaths;
+			progressPaths.swap(processing->pendingProgress);
+			lock.unlock();
+			try
+			{
+				if (progressCallback && (*progressCallback)(progressPaths))
+					processing->stop = true;
+			}
+			catch (...)
+			{
+				storeError();
+			}
+			lock.lock();
+		}
+		lock.unlock();
+
+		for (auto &thread : pool)
+			thread.join();
+		if (processing->error)
+			std::rethrow_exception(processing->error);
+	}
+
+	// merge in the order of the regions, independent of the thread timing
+	for (auto &regionResult : regionResults)
+		results.splice(results.end(), regionResult);
 	return results;
 }
 
@@ -2168,16 +2281,17 @@ bool Adaptive2d::ResolveLinkPath(const IntPoint &startPoint, const IntPoint &end
 	size_t sindex;
 	double par;
 
-	// put a time limit on the resolving the link path
-	clock_t time_limit = (clock_t)(max(keepToolDownDistRatio, 3.0) * CLOCKS_PER_SEC / 6);
+	// put a time limit on the resolving the link path, clock() would count
+	// the processor time of all threads
+	std::chrono::duration<double> time_limit(max(keepToolDownDistRatio, 3.0) / 6);
 
-	clock_t time_out = clock() + time_limit;
+	auto time_out = std::chrono::steady_clock::now() + time_limit;
 
 	while (!queue.empty())
 	{
-		if (stopProcessing)
+		if (IsStopped())
 			return false;
-		if (clock() > time_out)
+		if (std::chrono::steady_clock::now() > time_out)
 		{
 			cout << "Unable to resolve tool down linking path (limit reached)." << endl;
 			return false;
@@ -2245,7 +2359,7 @@ bool Adaptive2d::ResolveLinkPath(const IntPoint &startPoint, const IntPoint &end
 			IntPoint midPoint(0.5 * double(pointPair.first.X + pointPair.second.X), 0.5 * double(pointPair.first.Y + pointPair.second.Y));
 			for (long i = 1;; i++)
 			{
-				if (stopProcessing)
+				if (IsStopped())
 					return false;
 				double offset = i * scanStep;
 				IntPoint checkPoint1(midPoint.X + offset * pDir.X, midPoint.Y + offset * pDir.Y);
@@ -2551,14 +2665,22 @@ void Adaptive2d::AppendToolPath(TPaths &progressPaths, AdaptiveOutput &output,
 
 void Adaptive2d::CheckReportProgress(TPaths &progressPaths, bool force)
 {
-	if (!force && (clock() - lastProgressTime < PROGRESS_TICKS))
-		return; // not yet
-	lastProgressTime = clock();
-	if (progressPaths.size() == 0)
-		return;
-	if (progressCallback)
+	bool callerThread;
+	{
+		std::lock_guard<std::mutex> lock(processing->mutex);
+		if (!force && (clock() - processing->lastProgressTime < PROGRESS_TICKS))
+			return; // not yet
+		processing->lastProgressTime = clock();
+		if (progressPaths.size() == 0)
+			return;
+		callerThread = std::this_thread::get_id() == processing->callerThread;
+		// worker threads hand over their progress to the caller thread
+		if (!callerThread)
+			processing->pendingProgress.insert(processing->pendingProgress.end(), progressPaths.begin(), progressPaths.end());
+	}
+	if (callerThread && progressCallback)
 		if ((*progressCallback)(progressPaths))
-			stopProcessing = true; // call python function, if returns true signal stop processing
+			processing->stop = true; // call python function, if returns true signal stop processing
 	// clean the paths - keep the last point
 	if (progressPaths.back().second.size() == 0)
 		return;
@@ -2599,11 +2721,10 @@ void Adaptive2d::AddPathToProgress(TPaths &progressPaths, const Path pth, Motion
 	}
 }
 
-void Adaptive2d::ProcessPolyNode(Paths boundPaths, Paths toolBoundPaths)
+void Adaptive2d::ProcessPolyNode(Paths boundPaths, Paths toolBoundPaths, int region, std::list<AdaptiveOutput> &regionResults)
 {
 	Perf_ProcessPolyNode.Start();
-	current_region++;
-	cout << "** Processing region: " << current_region << endl;
+	cout << "** Processing region: " << region << endl;
 
 	// node paths are already constrained to tool boundary path for adaptive path before finishing pass
 	Clipper clip;
@@ -2711,7 +2832,7 @@ void Adaptive2d::ProcessPolyNode(Paths boundPaths, Paths toolBoundPaths)
 	//*******************************
 	for (long pass = 0; pass < PASSES_LIMIT; pass++)
 	{
-		if (stopProcessing)
+		if (IsStopped())
 			break;
 
 		passToolPath.clear();
@@ -2749,7 +2870,7 @@ void Adaptive2d::ProcessPolyNode(Paths boundPaths, Paths toolBoundPaths)
 		//*******************************
 		for (long point_index = 0; point_index < POINTS_PER_PASS_LIMIT; point_index++)
 		{
-			if (stopProcessing)
+			if (IsStopped())
 				break;
 
 			total_points++;
@@ -3039,7 +3160,7 @@ void Adaptive2d::ProcessPolyNode(Paths boundPaths, Paths toolBoundPaths)
 		Path finShiftedPath;
 
 		bool allCutsAllowed = true;
-		while(!stopProcessing && PopPathWithClosestPoint(finishingPaths, lastPoint, finShiftedPath)) {
+		while(!IsStopped() && PopPathWithClosestPoint(finishingPaths, lastPoint, finShiftedPath)) {
 			if(finShiftedPath.empty())
 				continue;
 			// skip finishing passes outside the stock boundary - no sense to cut where is no material
@@ -3131,7 +3252,7 @@ void Adaptive2d::ProcessPolyNode(Paths boundPaths, Paths toolBoundPaths)
 				<< "Hint: try to modify accuracy and/or step-over." << endl;
 		}
 	}
-	results.push_back(output);
+	regionResults.push_back(output);
 }
 
 } // namespace AdaptivePath
@@ -21,6 +21,8 @@
 ***************************************************************************/
 
 #include "clipper.hpp"
+#include <functional>
+#include <memory>
 #include <vector>
 #include <list>
 #include <time.h>
@@ -70,6 +72,7 @@ typedef std::vector<DPath> DPaths;
 typedef std::pair<int, DPath> TPath; // first parameter is MotionType, must use int due to problem with serialization to JSON in python
 
 class ClearedArea;
+struct ProcessingState;
 
 typedef std::vector<TPath> TPaths;
 
@@ -81,7 +84,7 @@ struct AdaptiveOutput
 	int ReturnMotionType; // MotionType enum, problem with serialization if enum is used
 };
 
-// used to isolate state -> enable potential adding of multi-threaded processing of separate regions
+// used to isolate state -> the separate regions are processed by multiple threads
 
 class Adaptive2d
 {
@@ -96,6 +99,7 @@ class Adaptive2d
 	bool finishingProfile = true;
 	double keepToolDownDistRatio = 3.0; // keep tool down distance ratio
 	OperationType opType = OperationType::otClearingInside;
+	int threads = 0; // number of threads processing the regions, 0 = number of cores
 
 	std::list<AdaptiveOutput> Execute(const DPaths &stockPaths, const DPaths &paths, std::function<bool(TPaths)> progressCallbackFn);
 
@@ -118,14 +122,13 @@ class Adaptive2d
 	long helixRampRadiusScaled = 0;
 	double referenceCutArea = 0;
 	double optimalCutAreaPD = 0;
-	bool stopProcessing = false;
-	int current_region=0;
-	clock_t lastProgressTime = 0;
+	std::shared_ptr<ProcessingState> processing; // shared by the threads of Execute
 
 	std::function<bool(TPaths)> *progressCallback = NULL;
 	Path toolGeometry; // tool geometry at coord 0,0, should not be modified
 
-	void ProcessPolyNode(Paths boundPaths, Paths toolBoundPaths);
+	void ProcessPolyNode(Paths boundPaths, Paths toolBoundPaths, int region, std::list<AdaptiveOutput> &regionResults);
+	bool IsStopped() const;
 	bool FindEntryPoint(TPaths &progressPaths, const Paths &toolBoundPaths, const Paths &bound, ClearedArea &cleared /*output*/,
 						IntPoint &entryPoint /*output*/, IntPoint &toolPos, DoublePoint &toolDir);
 	bool FindEntryPointOutside(TPaths &progressPaths, const Paths &toolBoundPaths, const Paths &bound, ClearedArea &cleared /*output*/,
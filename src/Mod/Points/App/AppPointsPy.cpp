@@ -67,6 +67,15 @@ public:
     virtual ~Module() {}
 
 private:
+    void setupReader(Reader& reader)
+    {
+        ParameterGrp::handle hGrp = App::GetApplication().GetParameterGroupByPath
+            ("User parameter:BaseApp/Preferences/Mod/Points");
+        unsigned long threshold = hGrp->GetUnsigned("OutOfCoreThreshold", 50000000);
+        unsigned long overview = hGrp->GetUnsigned("OverviewSize", 2000000);
+        reader.setOutOfCore(threshold, overview);
+    }
+
     Py::Object open(const Py::Tuple& args)
     {
         char* Name;
@@ -97,6 +106,7 @@ private:
                 throw Py::RuntimeError("Unsupported file extension");
             }
 
+            setupReader(*reader);
             reader->read(EncodedName);
 
             App::Document *pcDoc = App::GetApplication().newDocument("Unnamed");
@@ -209,6 +219,7 @@ private:
                 throw Py::RuntimeError("Unsupported file extension");
             }
 
+            setupReader(*reader);
             reader->read(EncodedName);
 
             App::Document *pcDoc = App::GetApplication().getDocument(DocName);
@@ -0,0 +1,668 @@
+/***************************************************************************
+ *   Copyright (c) 2021 FreeCAD Developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#include "PreCompiled.h"
+#ifndef _PreComp_
+# include <algorithm>
+# include <cmath>
+# include <cstring>
+# include <list>
+# include <unordered_map>
+#endif
+
+#include <Base/Console.h>
+#include <Base/Exception.h>
+#include <Base/FileInfo.h>
+#include <Base/Swap.h>
+
+#include "PointTiles.h"
+
+FC_LOG_LEVEL_INIT("Points", true, true)
+
+using namespace Points;
+
+// Tile file layout, all values are stored in little endian order:
+//
+//   char[4]  magic "FCPT"
+//   uint32   version
+//   uint64   number of points
+//   uint64   number of tiles
+//   uint64   offset of the tile table
+//   float[6] bounding box
+//   ...      points of all tiles as float[3]
+//   ...      tile table: float[6] bounding box, uint64 offset, uint32 count
+//
+static const char TileMagic[4] = {'F','C','P','T'};
+static const uint32_t TileVersion = 1;
+
+namespace {
+
+// tile files are little endian, so the bytes are swapped on big endian machines
+bool swapBytes()
+{
+    static const bool swap = Base::SwapOrder() == HIGH_ENDIAN;
+    return swap;
+}
+
+template <typename T>
+void writeRaw(std::ostream& out, T value)
+{
+    if (swapBytes())
+        Base::SwapEndian(value);
+    out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+void readRaw(std::istream& in, T& value)
+{
+    in.read(reinterpret_cast<char*>(&value), sizeof(T));
+    if (swapBytes())
+        Base::SwapEndian(value);
+}
+
+void swapPoints(PointTiles::value_type* points, std::size_t count)
+{
+    for (std::size_t i=0; i<count; i++) {
+        Base::SwapEndian(points[i].x);
+        Base::SwapEndian(points[i].y);
+        Base::SwapEndian(points[i].z);
+    }
+}
+
+void writeBox(std::ostream& out, const Base::BoundBox3f& box)
+{
+    writeRaw(out, box.MinX);
+    writeRaw(out, box.MinY);
+    writeRaw(out, box.MinZ);
+    writeRaw(out, box.MaxX);
+    writeRaw(out, box.MaxY);
+    writeRaw(out, box.MaxZ);
+}
+
+void readBox(std::istream& in, Base::BoundBox3f& box)
+{
+    readRaw(in, box.MinX);
+    readRaw(in, box.MinY);
+    readRaw(in, box.MinZ);
+    readRaw(in, box.MaxX);
+    readRaw(in, box.MaxY);
+    readRaw(in, box.MaxZ);
+}
+
+/// Tile cache shared by all tile files
+class TileCache
+{
+public:
+    typedef std::pair<const PointTiles*, std::size_t> Key;
+
+    struct KeyHasher {
+        std::size_t operator()(const Key& key) const {
+            return std::hash<const void*>()(key.first) ^ (key.second * 0x9e3779b97f4a7c15ULL);
+        }
+    };
+
+    static TileCache& instance()
+    {
+        static TileCache cache;
+        return cache;
+    }
+
+    PointTiles::TileData find(const PointTiles* tiles, std::size_t index)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = index_.find(Key(tiles, index));
+        if (it == index_.end())
+            return PointTiles::TileData();
+        entries.splice(entries.begin(), entries, it->second);
+        return it->second->second;
+    }
+
+    void insert(const PointTiles* tiles, std::size_t index, const PointTiles::TileData& data)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        Key key(tiles, index);
+        if (index_.count(key))
+            return;
+        entries.emplace_front(key, data);
+        index_[key] = entries.begin();
+        numPoints += data->size();
+        evict();
+    }
+
+    void remove(const PointTiles* tiles)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto it = entries.begin(); it != entries.end();) {
+            if (it->first.first == tiles) {
+                numPoints -= it->second->size();
+                index_.erase(it->first);
+                it = entries.erase(it);
+            }
+            else {
+                ++it;
+            }
+        }
+    }
+
+    void setCapacity(std::size_t n)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        capacity = n;
+        evict();
+    }
+
+    std::size_t getCapacity()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return capacity;
+    }
+
+private:
+    TileCache() : numPoints(0), capacity(1 << 24)
+    {
+    }
+
+    void evict()
+    {
+        // always keep the most recent tile
+        while (numPoints > capacity && entries.size() > 1) {
+            numPoints -= entries.back().second->size();
+            index_.erase(entries.back().first);
+            entries.pop_back();
+        }
+    }
+
+private:
+    std::mutex mutex;
+    std::list<std::pair<Key, PointTiles::TileData> > entries;
+    std::unordered_map<Key, std::list<std::pair<Key, PointTiles::TileData> >::iterator, KeyHasher> index_;
+    std::size_t numPoints;
+    std::size_t capacity;
+};
+
+} // namespace
+
+// ----------------------------------------------------------------------------
+
+namespace Points {
+
+/// Writes a tile file one tile after the other
+class TileFileWriter
+{
+public:
+    explicit TileFileWriter(const std::string& file)
+        : fileName(file)
+        , out(Base::FileInfo(file), std::ios::out | std::ios::trunc | std::ios::binary)
+        , numPoints(0)
+    {
+        if (!out)
+            throw Base::FileException("Failed to create tile file", file.c_str());
+        // placeholder of the header, written in finish()
+        writeHeader(0);
+    }
+
+    void writeTile(const PointTiles::value_type* points, std::size_t count)
+    {
+        if (count == 0)
+            return;
+        PointTiles::Tile tile;
+        for (std::size_t i=0; i<count; i++)
+            tile.box.Add(points[i]);
+        tile.offset = static_cast<uint64_t>(out.tellp());
+        tile.count = static_cast<uint32_t>(count);
+        if (swapBytes()) {
+            std::vector<PointTiles::value_type> swapped(points, points + count);
+            swapPoints(swapped.data(), count);
+            out.write(reinterpret_cast<const char*>(swapped.data()), count * sizeof(PointTiles::value_type));
+        }
+        else {
+            out.write(reinterpret_cast<const char*>(points), count * sizeof(PointTiles::value_type));
+        }
+        if (!out)
+            throw Base::FileException("Failed to write tile file", fileName.c_str());
+        boundBox.Add(tile.box);
+        numPoints += count;
+        tiles.push_back(tile);
+    }
+
+    const std::string& getFileName() const
+    {
+        return fileName;
+    }
+
+    void finish()
+    {
+        uint64_t tableOffset = static_cast<uint64_t>(out.tellp());
+        for (const auto& tile : tiles) {
+            writeBox(out, tile.box);
+            writeRaw(out, tile.offset);
+            writeRaw(out, tile.count);
+        }
+        out.seekp(0);
+        writeHeader(tableOffset);
+        out.close();
+        if (out.fail())
+            throw Base::FileException("Failed to write tile file", fileName.c_str());
+    }
+
+private:
+    void writeHeader(uint64_t tableOffset)
+    {
+        out.write(TileMagic, sizeof(TileMagic));
+        writeRaw(out, TileVersion);
+        writeRaw(out, static_cast<uint64_t>(numPoints));
+        writeRaw(out, static_cast<uint64_t>(tiles.size()));
+        writeRaw(out, tableOffset);
+        writeBox(out, boundBox);
+    }
+
+private:
+    std::string fileName;
+    Base::ofstream out;
+    std::size_t numPoints;
+    Base::BoundBox3f boundBox;
+    std::vector<PointTiles::Tile> tiles;
+};
+
+} // namespace Points
+
+// ----------------------------------------------------------------------------
+
+PointTiles::PointTiles()
+    : temporary(false)
+    , numPoints(0)
+{
+}
+
+PointTiles::~PointTiles()
+{
+    TileCache::instance().remove(this);
+    stream.close();
+    if (temporary) {
+        Base::FileInfo fi(fileName);
+        if (fi.exists() && !fi.deleteFile())
+            FC_WARN("Failed to remove tile file " << fileName);
+    }
+}
+
+std::shared_ptr<PointTiles> PointTiles::open(const std::string& file, bool temporary)
+{
+    std::shared_ptr<PointTiles> res(new PointTiles);
+    res->fileName = file;
+    res->temporary = temporary;
+    res->stream.open(Base::FileInfo(file), std::ios::in | std::ios::binary);
+    if (!res->stream)
+        throw Base::FileException("Failed to open tile file", file.c_str());
+
+    char magic[4];
+    uint32_t version = 0;
+    uint64_t numPoints = 0, numTiles = 0, tableOffset = 0;
+    res->stream.read(magic, sizeof(magic));
+    readRaw(res->stream, version);
+    readRaw(res->stream, numPoints);
+    readRaw(res->stream, numTiles);
+    readRaw(res->stream, tableOffset);
+    readBox(res->stream, res->boundBox);
+    if (!res->stream || std::memcmp(magic, TileMagic, sizeof(magic)) != 0)
+        throw Base::BadFormatError("Not a tile file");
+    if (version != TileVersion)
+        throw Base::BadFormatError("Unsupported tile file version");
+
+    res->numPoints = static_cast<std::size_t>(numPoints);
+    res->stream.seekg(static_cast<std::streamoff>(tableOffset));
+    res->tiles.resize(static_cast<std::size_t>(numTiles));
+    for (auto& tile : res->tiles) {
+        readBox(res->stream, tile.box);
+        readRaw(res->stream, tile.offset);
+        readRaw(res->stream, tile.count);
+    }
+    if (!res->stream)
+        throw Base::BadFormatError("Truncated tile file");
+    return res;
+}
+
+std::shared_ptr<PointTiles> PointTiles::restore(std::istream& in, const std::string& file)
+{
+    {
+        Base::ofstream out(Base::FileInfo(file), std::ios::out | std::ios::trunc | std::ios::binary);
+        if (!out)
+            throw Base::FileException("Failed to create tile file", file.c_str());
+        out << in.rdbuf();
+        if (!out)
+            throw Base::FileException("Failed to write tile file", file.c_str());
+    }
+    return open(file, true);
+}
+
+PointTiles::TileData PointTiles::loadTile(std::size_t index) const
+{
+    TileCache& cache = TileCache::instance();
+    TileData data = cache.find(this, index);
+    if (data)
+        return data;
+
+    const Tile& tile = tiles[index];
+    std::shared_ptr<std::vector<value_type> > points(new std::vector<value_type>(tile.count));
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stream.clear();
+        stream.seekg(static_cast<std::streamoff>(tile.offset));
+        stream.read(reinterpret_cast<char*>(points->data()), tile.count * sizeof(value_type));
+        if (!stream)
+            throw Base::FileException("Failed to read tile file", fileName.c_str());
+    }
+    if (swapBytes())
+        swapPoints(points->data(), points->size());
+
+    cache.insert(this, index, points);
+    return points;
+}
+
+void PointTiles::visit(const Base::BoundBox3f& box,
+                       const std::function<void(const value_type*, std::size_t)>& func) const
+{
+    for (std::size_t i=0; i<tiles.size(); i++) {
+        if (!tiles[i].box.Intersect(box))
+            continue;
+        TileData data = loadTile(i);
+        func(data->data(), data->size());
+    }
+}
+
+std::vector<PointTiles::value_type> PointTiles::getOverview(std::size_t maxPoints) const
+{
+    std::vector<value_type> overview;
+    if (numPoints == 0 || maxPoints == 0)
+        return overview;
+
+    overview.reserve(std::min(numPoints, maxPoints) + tiles.size());
+    double ratio = std::min(1.0, double(maxPoints) / double(numPoints));
+    for (std::size_t i=0; i<tiles.size(); i++) {
+        TileData data = loadTile(i);
+        std::size_t count = static_cast<std::size_t>(std::ceil(data->size() * ratio));
+        if (count == 0)
+            continue;
+        double step = double(data->size()) / double(count);
+        for (std::size_t j=0; j<count; j++)
+            overview.push_back((*data)[static_cast<std::size_t>(j * step)]);
+    }
+    return overview;
+}
+
+std::shared_ptr<PointTiles> PointTiles::transformed(const Base::Matrix4D& mat, const std::string& file) const
+{
+    TileFileWriter writer(file);
+    std::vector<value_type> points;
+    for (std::size_t i=0; i<tiles.size(); i++) {
+        TileData data = loadTile(i);
+        points.assign(data->begin(), data->end());
+        for (auto& pt : points)
+            mat.multVec(pt, pt);
+        writer.writeTile(points.data(), points.size());
+    }
+    writer.finish();
+    return open(file, true);
+}
+
+void PointTiles::save(std::ostream& out) const
+{
+    Base::ifstream in(Base::FileInfo(fileName), std::ios::in | std::ios::binary);
+    if (!in)
+        throw Base::FileException("Failed to open tile file", fileName.c_str());
+    out << in.rdbuf();
+}
+
+void PointTiles::setCacheSize(std::size_t numPoints)
+{
+    TileCache::instance().setCapacity(numPoints);
+}
+
+std::size_t PointTiles::getCacheSize()
+{
+    return TileCache::instance().getCapacity();
+}
+
+// ----------------------------------------------------------------------------
+
+PointTilesBuilder::PointTilesBuilder(const std::string& file, const Base::BoundBox3f& box,
+                                     std::size_t numPoints, std::size_t maxTilePoints)
+    : writer(new TileFileWriter(file))
+    , spillSize(0)
+    , boundBox(box)
+    , grid(1)
+    , maxTilePoints(std::max<std::size_t>(maxTilePoints, 1024))
+{
+    // the largest number of points that is split in memory
+    maxCellPoints = this->maxTilePoints * 16;
+
+    // Choose the grid so that a cell holds a few tiles on average. The
+    // cells are split further by the octree in finish().
+    std::size_t cells = numPoints / (this->maxTilePoints * 4) + 1;
+    grid = static_cast<std::size_t>(std::ceil(std::cbrt(double(cells))));
+    grid = std::min<std::size_t>(std::max<std::size_t>(grid, 1), 64);
+
+    buffers.resize(grid * grid * grid);
+    segments.resize(buffers.size());
+
+    spillName = Base::FileInfo::getTempFileName("PointTiles");
+    spill.open(Base::FileInfo(spillName), std::ios::out | std::ios::trunc | std::ios::binary);
+    if (!spill)
+        throw Base::FileException("Failed to create temporary file", spillName.c_str());
+}
+
+PointTilesBuilder::~PointTilesBuilder()
+{
+    if (spill.is_open())
+        spill.close();
+    Base::FileInfo fi(spillName);
+    if (fi.exists())
+        fi.deleteFile();
+}
+
+static const std::size_t SpillBufferSize = 1 << 14;
+
+static Base::BoundBox3f octantBox(const Base::BoundBox3f& box, const Base::Vector3f& center, int i)
+{
+    Base::BoundBox3f sub;
+    sub.MinX = (i & 1) ? center.x : box.MinX;
+    sub.MaxX = (i & 1) ? box.MaxX : center.x;
+    sub.MinY = (i & 2) ? center.y : box.MinY;
+    sub.MaxY = (i & 2) ? box.MaxY : center.y;
+    sub.MinZ = (i & 4) ? center.z : box.MinZ;
+    sub.MaxZ = (i & 4) ? box.MaxZ : center.z;
+    return sub;
+}
+
+static inline int octantIndex(const Base::Vector3f& pt, const Base::Vector3f& center)
+{
+    return (pt.x > center.x ? 1 : 0) | (pt.y > center.y ? 2 : 0) | (pt.z > center.z ? 4 : 0);
+}
+
+std::size_t PointTilesBuilder::cellIndex(const value_type& pt) const
+{
+    auto index = [this](float value, float min, float len) {
+        if (len <= 0.0f)
+            return std::size_t(0);
+        long i = static_cast<long>((value - min) / len * grid);
+        return static_cast<std::size_t>(std::min<long>(std::max<long>(i, 0), grid - 1));
+    };
+    std::size_t x = index(pt.x, boundBox.MinX, boundBox.LengthX());
+    std::size_t y = index(pt.y, boundBox.MinY, boundBox.LengthY());
+    std::size_t z = index(pt.z, boundBox.MinZ, boundBox.LengthZ());
+    return (z * grid + y) * grid + x;
+}
+
+void PointTilesBuilder::add(const value_type* points, std::size_t count)
+{
+    for (std::size_t i=0; i<count; i++) {
+        std::size_t cell = cellIndex(points[i]);
+        buffers[cell].push_back(points[i]);
+        if (buffers[cell].size() >= SpillBufferSize)
+            flush(cell);
+    }
+}
+
+void PointTilesBuilder::flush(std::size_t cell)
+{
+    spillBuffer(buffers[cell], segments[cell]);
+}
+
+void PointTilesBuilder::spillBuffer(std::vector<value_type>& buffer, std::vector<Segment>& segs)
+{
+    if (buffer.empty())
+        return;
+    Segment segment;
+    segment.offset = spillSize;
+    segment.count = static_cast<uint32_t>(buffer.size());
+    spill.write(reinterpret_cast<const char*>(buffer.data()), buffer.size() * sizeof(value_type));
+    if (!spill)
+        throw Base::FileException("Failed to write temporary file", spillName.c_str());
+    spillSize += buffer.size() * sizeof(value_type);
+    segs.push_back(segment);
+    buffer.clear();
+}
+
+void PointTilesBuilder::readSpilled(std::istream& in, uint64_t offset, std::size_t count,
+                                    std::vector<value_type>& points) const
+{
+    points.resize(count);
+    in.seekg(static_cast<std::streamoff>(offset));
+    in.read(reinterpret_cast<char*>(points.data()), count * sizeof(value_type));
+    if (!in)
+        throw Base::FileException("Failed to read temporary file", spillName.c_str());
+}
+
+void PointTilesBuilder::splitSpilled(std::istream& in, const std::vector<Segment>& segs,
+                                     const Base::BoundBox3f& box, int depth)
+{
+    std::size_t count = 0;
+    for (const auto& segment : segs)
+        count += segment.count;
+    if (count == 0)
+        return;
+
+    std::vector<value_type> points;
+    if (count <= maxCellPoints) {
+        points.resize(count);
+        char* ptr = reinterpret_cast<char*>(points.data());
+        for (const auto& segment : segs) {
+            in.seekg(static_cast<std::streamoff>(segment.offset));
+            in.read(ptr, segment.count * sizeof(value_type));
+            ptr += segment.count * sizeof(value_type);
+        }
+        if (!in)
+            throw Base::FileException("Failed to read temporary file", spillName.c_str());
+        split(points, box, depth);
+        return;
+    }
+
+    if (depth >= 16) {
+        // the points (nearly) coincide, write them as they come
+        for (const auto& segment : segs) {
+            for (std::size_t i=0; i<segment.count; i+=maxTilePoints) {
+                std::size_t num = std::min<std::size_t>(maxTilePoints, segment.count - i);
+                readSpilled(in, segment.offset + i * sizeof(value_type), num, points);
+                writer->writeTile(points.data(), num);
+            }
+        }
+        return;
+    }
+
+    // too many points to split in memory, partition them into octants on disk
+    Base::Vector3f center = box.GetCenter();
+    std::vector<value_type> octantPoints[8];
+    std::vector<Segment> octants[8];
+    for (const auto& segment : segs) {
+        for (std::size_t i=0; i<segment.count; i+=SpillBufferSize) {
+            std::size_t num = std::min<std::size_t>(SpillBufferSize, segment.count - i);
+            readSpilled(in, segment.offset + i * sizeof(value_type), num, points);
+            for (const auto& pt : points) {
+                int j = octantIndex(pt, center);
+                octantPoints[j].push_back(pt);
+                if (octantPoints[j].size() >= SpillBufferSize)
+                    spillBuffer(octantPoints[j], octants[j]);
+            }
+        }
+    }
+    for (int i=0; i<8; i++)
+        spillBuffer(octantPoints[i], octants[i]);
+    spill.flush();
+    if (!spill)
+        throw Base::FileException("Failed to write temporary file", spillName.c_str());
+
+    for (int i=0; i<8; i++)
+        splitSpilled(in, octants[i], octantBox(box, center, i), depth + 1);
+}
+
+void PointTilesBuilder::split(std::vector<value_type>& points, const Base::BoundBox3f& box, int depth)
+{
+    if (points.size() <= maxTilePoints || depth >= 16) {
+        writer->writeTile(points.data(), points.size());
+        return;
+    }
+
+    Base::Vector3f center = box.GetCenter();
+    std::vector<value_type> octants[8];
+    for (const auto& pt : points)
+        octants[octantIndex(pt, center)].push_back(pt);
+    std::vector<value_type>().swap(points);
+
+    for (int i=0; i<8; i++)
+        split(octants[i], octantBox(box, center, i), depth + 1);
+}
+
+std::shared_ptr<PointTiles> PointTilesBuilder::finish(bool temporary)
+{
+    for (std::size_t cell=0; cell<buffers.size(); cell++)
+        flush(cell);
+    // the spill file stays open, splitSpilled() appends to it
+    spill.flush();
+    if (!spill)
+        throw Base::FileException("Failed to write temporary file", spillName.c_str());
+
+    Base::ifstream in(Base::FileInfo(spillName), std::ios::in | std::ios::binary);
+    if (!in)
+        throw Base::FileException("Failed to read temporary file", spillName.c_str());
+    float lenX = boundBox.LengthX() / grid;
+    float lenY = boundBox.LengthY() / grid;
+    float lenZ = boundBox.LengthZ() / grid;
+    for (std::size_t cell=0; cell<segments.size(); cell++) {
+        std::size_t x = cell % grid;
+        std::size_t y = (cell / grid) % grid;
+        std::size_t z = cell / (grid * grid);
+        Base::BoundBox3f box(boundBox.MinX + x * lenX,
+                             boundBox.MinY + y * lenY,
+                             boundBox.MinZ + z * lenZ,
+                             boundBox.MinX + (x + 1) * lenX,
+                             boundBox.MinY + (y + 1) * lenY,
+                             boundBox.MinZ + (z + 1) * lenZ);
+        splitSpilled(in, segments[cell], box, 0);
+    }
+    in.close();
+    spill.close();
+
+    writer->finish();
+    std::string file = writer->getFileName();
+    writer.reset();
+    return PointTiles::open(file, temporary);
+}
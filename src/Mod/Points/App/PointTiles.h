@@ -0,0 +1,181 @@
+/***************************************************************************
+ *   Copyright (c) 2021 FreeCAD Developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef POINTS_POINTTILES_H
+#define POINTS_POINTTILES_H
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <Base/BoundBox.h>
+#include <Base/Matrix.h>
+#include <Base/Stream.h>
+#include <Base/Vector3D.h>
+
+namespace Points
+{
+
+class TileFileWriter;
+
+/** Out-of-core storage of a point cloud
+ *
+ * The points are partitioned into octree tiles that are stored in a file.
+ * Only the tile index is kept in memory, the points of a tile are loaded on
+ * demand and kept in a cache of limited size shared by all tile files.
+ *
+ * A tile file is immutable once written, so it can be shared by copies of
+ * a PointKernel.
+ */
+class PointsExport PointTiles
+{
+public:
+    typedef Base::Vector3f value_type;
+    typedef std::shared_ptr<const std::vector<value_type> > TileData;
+
+    struct Tile {
+        Base::BoundBox3f box;
+        uint64_t offset;
+        uint32_t count;
+    };
+
+    /** Open a tile file
+     * @param file: path of the tile file
+     * @param temporary: if true the file is removed once it is no longer used
+     */
+    static std::shared_ptr<PointTiles> open(const std::string& file, bool temporary);
+    /// Copy the tile file content from \a in into \a file and open it as temporary file
+    static std::shared_ptr<PointTiles> restore(std::istream& in, const std::string& file);
+
+    ~PointTiles();
+
+    const std::string& getFileName() const {
+        return fileName;
+    }
+    /// Number of points of all tiles
+    std::size_t size() const {
+        return numPoints;
+    }
+    std::size_t countTiles() const {
+        return tiles.size();
+    }
+    const Tile& getTile(std::size_t index) const {
+        return tiles[index];
+    }
+    const Base::BoundBox3f& getBoundBox() const {
+        return boundBox;
+    }
+
+    /// Load the points of a tile. This function is thread safe.
+    TileData loadTile(std::size_t index) const;
+    /// Call \a func with the points of every tile intersecting \a box
+    void visit(const Base::BoundBox3f& box,
+               const std::function<void(const value_type*, std::size_t)>& func) const;
+    /// Returns at most \a maxPoints points sampled evenly from all tiles
+    std::vector<value_type> getOverview(std::size_t maxPoints) const;
+    /// Write the transformed points into a new temporary tile file
+    std::shared_ptr<PointTiles> transformed(const Base::Matrix4D& mat, const std::string& file) const;
+
+    /// Copy the tile file into a stream
+    void save(std::ostream&) const;
+
+    /// Maximum number of points kept in the tile cache
+    static void setCacheSize(std::size_t numPoints);
+    static std::size_t getCacheSize();
+
+private:
+    PointTiles();
+
+private:
+    std::string fileName;
+    bool temporary;
+    std::size_t numPoints;
+    Base::BoundBox3f boundBox;
+    std::vector<Tile> tiles;
+
+    mutable std::mutex mutex;
+    mutable Base::ifstream stream;
+};
+
+/** Builds a tile file from points that are added in blocks
+ *
+ * The bounding box of all points must be known in advance. The points are
+ * binned into a regular grid of cells whose buffers are spilled into a
+ * temporary file whenever they get full. finish() then splits one cell at a
+ * time into octree tiles of at most \a maxTilePoints points. Cells with
+ * more than 16 * \a maxTilePoints points are first partitioned into octants
+ * on disk, so the memory needed is bounded by a multiple of the tile size
+ * and not by the number of points of a cell.
+ */
+class PointsExport PointTilesBuilder
+{
+public:
+    typedef PointTiles::value_type value_type;
+
+    /**
+     * @param file: the tile file to write
+     * @param box: bounding box of all points that will be added
+     * @param numPoints: the expected number of points to choose the grid size
+     * @param maxTilePoints: maximum number of points of a tile
+     */
+    PointTilesBuilder(const std::string& file, const Base::BoundBox3f& box,
+                      std::size_t numPoints, std::size_t maxTilePoints = 1 << 18);
+    ~PointTilesBuilder();
+
+    void add(const value_type* points, std::size_t count);
+    /// Write the tile file and open it
+    std::shared_ptr<PointTiles> finish(bool temporary);
+
+private:
+    struct Segment {
+        uint64_t offset;
+        uint32_t count;
+    };
+
+    std::size_t cellIndex(const value_type&) const;
+    void flush(std::size_t cell);
+    void spillBuffer(std::vector<value_type>& buffer, std::vector<Segment>& segs);
+    void readSpilled(std::istream& in, uint64_t offset, std::size_t count,
+                     std::vector<value_type>& points) const;
+    void splitSpilled(std::istream& in, const std::vector<Segment>& segs,
+                      const Base::BoundBox3f& box, int depth);
+    void split(std::vector<value_type>& points, const Base::BoundBox3f& box, int depth);
+
+private:
+
+    std::unique_ptr<TileFileWriter> writer;
+    std::string spillName;
+    Base::ofstream spill;
+    uint64_t spillSize;
+    Base::BoundBox3f boundBox;
+    std::size_t grid;
+    std::size_t maxTilePoints;
+    std::size_t maxCellPoints;
+    std::vector<std::vector<value_type> > buffers;
+    std::vector<std::vector<Segment> > segments;
+};
+
+} // namespace Points
+
+#endif // POINTS_POINTTILES_H
@@ -31,7 +31,9 @@
 #include <boost/math/special_functions/fpclassify.hpp>
 #include <QtConcurrentMap>
 
+#include <Base/Console.h>
 #include <Base/Exception.h>
+#include <Base/FileInfo.h>
 #include <Base/Matrix.h>
 #include <Base/Persistence.h>
 #include <Base/Stream.h>
@@ -40,6 +42,7 @@
 #include "Points.h"
 #include "PointsAlgos.h"
 #include "PointsPy.h"
+#include "PointTiles.h"
 
 #ifdef _WIN32
 # include <ppl.h>
@@ -53,10 +56,15 @@ TYPESYSTEM_SOURCE(Points::PointKernel, Data::ComplexGeoData)
 PointKernel::PointKernel(const PointKernel& pts)
   : _Mtrx(pts._Mtrx)
   , _Points(pts._Points)
+  , _Tiles(pts._Tiles)
 {
 
 }
 
+PointKernel::~PointKernel()
+{
+}
+
 const std::vector<const char*>& PointKernel::getElementTypes(void) const
 {
     static std::vector<const char*> temp;
@@ -85,6 +93,9 @@ Data::Segment* PointKernel::getSubElement(const char* /*Type*/, unsigned long /*
 
 void PointKernel::transformGeometry(const Base::Matrix4D &rclMat)
 {
+    if (_Tiles)
+        _Tiles = _Tiles->transformed(rclMat, Base::FileInfo::getTempFileName("PointTiles"));
+
     std::vector<value_type>& kernel = getBasicPoints();
 #ifdef _WIN32
     // Win32-only at the moment since ppl.h is a Microsoft library. Points is not using Qt so we cannot use QtConcurrent
@@ -120,6 +131,11 @@ Base::BoundBox3d PointKernel::getBoundBox(void)const
     for (const_point_iterator it = begin(); it != end(); ++it)
         bnd.Add(*it);
 #endif
+    if (_Tiles && _Tiles->size()) {
+        const Base::BoundBox3f& box = _Tiles->getBoundBox();
+        Base::BoundBox3d tileBox(box.MinX, box.MinY, box.MinZ, box.MaxX, box.MaxY, box.MaxZ);
+        bnd.Add(tileBox.Transformed(_Mtrx));
+    }
     return bnd;
 }
 
@@ -129,6 +145,7 @@ void PointKernel::operator = (const PointKernel& Kernel)
         // copy the mesh structure
         setTransform(Kernel._Mtrx);
         this->_Points = Kernel._Points;
+        this->_Tiles = Kernel._Tiles;
     }
 }
 
@@ -137,6 +154,29 @@ unsigned int PointKernel::getMemSize (void) const
     return _Points.size() * sizeof(value_type);
 }
 
+void PointKernel::setTiles(const std::shared_ptr<PointTiles>& tiles, size_type overviewSize)
+{
+    _Tiles = tiles;
+    if (_Tiles)
+        _Points = _Tiles->getOverview(overviewSize);
+}
+
+PointKernel::size_type PointKernel::countAll() const
+{
+    return _Tiles ? _Tiles->size() : size();
+}
+
+void PointKernel::detachTiles()
+{
+    if (_Tiles) {
+        Base::Console().Warning("Editing a point cloud of %lu points loaded in tiles, "
+                                "only its %lu overview points are kept\n",
+                                static_cast<unsigned long>(_Tiles->size()),
+                                static_cast<unsigned long>(_Points.size()));
+        _Tiles.reset();
+    }
+}
+
 PointKernel::size_type PointKernel::countValid(void) const
 {
     size_type num = 0;
@@ -181,15 +221,25 @@ void PointKernel::Save (Base::Writer &writer) const
         std::string filename = _PersistenceName;
         if(filename.empty())
             filename = "Points";
+        std::string tiles = filename + ".tiles";
         filename += writer.isPreferBinary()?".bin":".txt";
         writer.Stream() << writer.ind()
-            << "<Points file=\"" << writer.addFile(filename.c_str(), this) << "\" " 
-            << "mtrx=\"" << _Mtrx.toString() << "\"/>\n";
+            << "<Points file=\"" << writer.addFile(filename.c_str(), this) << "\" ";
+        // the full resolution points, the resident points are an overview
+        if (_Tiles)
+            writer.Stream() << "tiles=\"" << writer.addFile(tiles.c_str(), this) << "\" ";
+        writer.Stream() << "mtrx=\"" << _Mtrx.toString() << "\"/>\n";
     }
 }
 
 void PointKernel::SaveDocFile (Base::Writer &writer) const
 {
+    if (boost::ends_with(writer.getCurrentFileName(), ".tiles")) {
+        if (_Tiles)
+            _Tiles->save(writer.Stream());
+        return;
+    }
+
     Base::OutputStream str(writer.Stream(),writer.isPreferBinary());
     uint32_t uCt = (uint32_t)size();
     str << uCt;
@@ -214,6 +264,11 @@ void PointKernel::Restore(Base::XMLReader &reader)
             // initiate a file read
             reader.addFile(file.c_str(),this);
         }
+        if (reader.hasAttribute("tiles")) {
+            std::string tiles (reader.getAttribute("tiles") );
+            if (!tiles.empty())
+                reader.addFile(tiles.c_str(),this);
+        }
     } else if(reader.hasAttribute("count")) {
         unsigned count = reader.getAttributeAsUnsigned("count");
         _Points.resize(count);
@@ -228,6 +283,12 @@ void PointKernel::Restore(Base::XMLReader &reader)
 
 void PointKernel::RestoreDocFile(Base::Reader &reader)
 {
+    if (boost::ends_with(reader.getFileName(), ".tiles")) {
+        // the tiles are loaded on demand, so extract them into a temporary file
+        _Tiles = PointTiles::restore(reader, Base::FileInfo::getTempFileName("PointTiles"));
+        return;
+    }
+
     Base::InputStream str(reader,boost::ends_with(reader.getFileName(),".bin"));
     uint32_t uCt = 0;
     str >> uCt;
@@ -275,6 +336,7 @@ bool PointKernel::isSame(const Data::ComplexGeoData &_other) const
         return false;
     const auto &other = static_cast<const PointKernel &>(_other);
     return _Mtrx == other._Mtrx
+        && _Tiles == other._Tiles
         && _Points == other._Points;
 }
 
@@ -26,6 +26,7 @@
 
 #include <vector>
 #include <iterator>
+#include <memory>
 
 #include <Base/Vector3D.h>
 #include <Base/Matrix.h>
@@ -38,6 +39,8 @@
 namespace Points
 {
 
+class PointTiles;
+
 
 /** Point kernel
  */
@@ -59,9 +62,7 @@ public:
         resize(size);
     }
     PointKernel(const PointKernel&);
-    virtual ~PointKernel()
-    {
-    }
+    virtual ~PointKernel();
 
     void operator = (const PointKernel&);
 
@@ -84,9 +85,9 @@ public:
     const std::vector<value_type>& getBasicPoints() const
     { return this->_Points; }
     void setBasicPoints(const std::vector<value_type>& pts)
-    { this->_Points = pts; }
+    { dropTiles(); this->_Points = pts; }
     void swap(std::vector<value_type>& pts)
-    { this->_Points.swap(pts); }
+    { dropTiles(); this->_Points.swap(pts); }
 
     virtual void getPoints(std::vector<Base::Vector3d> &Points,
         std::vector<Base::Vector3d> &Normals,
@@ -110,22 +111,50 @@ public:
 
     virtual bool isSame(const Data::ComplexGeoData &other) const;
 
+    /** @name Out-of-core points */
+    //@{
+    /** Attach tiles holding the points at full resolution. The resident
+     * points are replaced by an overview of at most \a overviewSize points
+     * sampled from the tiles. Functions that only know about the resident
+     * points (display, grid, ...) work on the overview.
+     *
+     * Point indices refer to the overview, so the functions editing the
+     * points (resize(), erase(), setPoint(), push_back(), ...) detach the
+     * tiles first.
+     */
+    void setTiles(const std::shared_ptr<PointTiles>& tiles, size_type overviewSize);
+    const std::shared_ptr<PointTiles>& getTiles() const
+    { return this->_Tiles; }
+    bool hasTiles() const
+    { return this->_Tiles != nullptr; }
+    /// number of points including the ones only stored in tiles
+    size_type countAll() const;
+    /// Drop the tiles and keep the overview points, with a warning
+    void detachTiles();
+    //@}
+
+private:
+    void dropTiles()
+    { if (this->_Tiles) detachTiles(); }
+
 private:
     Base::Matrix4D _Mtrx;
     std::vector<value_type> _Points;
+    std::shared_ptr<PointTiles> _Tiles;
 
 public:
     /// number of points stored 
     size_type size(void) const {return this->_Points.size();}
     size_type countValid(void) const;
     std::vector<value_type> getValidPoints() const;
-    void resize(size_type n){_Points.resize(n);}
+    void resize(size_type n){dropTiles();_Points.resize(n);}
     void reserve(size_type n){_Points.reserve(n);}
     inline void erase(size_type first, size_type last) {
+        dropTiles();
         _Points.erase(_Points.begin()+first,_Points.begin()+last);
     }
 
-    void clear(void){_Points.clear();}
+    void clear(void){_Points.clear();_Tiles.reset();}
 
 
     /// get the points
@@ -134,10 +163,12 @@ public:
     }
     /// set the points
     inline void setPoint(const int idx,const Base::Vector3d& point) {
+        dropTiles();
         _Points[idx] = transformToInside(point);
     }
     /// insert the points
     inline void push_back(const Base::Vector3d& point) {
+        dropTiles();
         _Points.push_back(transformToInside(point));
     }
 
@@ -27,11 +27,17 @@
 # include <unistd.h>
 #endif
 # include <sstream>
+# include <cstring>
+# include <QFile>
+# include <QThread>
 #endif
 
+#include <QtConcurrentMap>
+
 
 #include "PointsAlgos.h"
 #include "Points.h"
+#include "PointTiles.h"
 
 #include <Base/Converter.h>
 #include <Base/Exception.h>
@@ -39,12 +45,14 @@
 #include <Base/Console.h>
 #include <Base/Sequencer.h>
 #include <Base/Stream.h>
+#include <Base/Swap.h>
 
 #include <boost/shared_ptr.hpp>
 #include <boost/regex.hpp>
 #include <boost/lexical_cast.hpp>
 #include <boost/algorithm/string.hpp>
 #include <boost/math/special_functions/fpclassify.hpp>
+#include <Eigen/Core>
 
 using namespace Points;
 
@@ -123,6 +131,8 @@ Reader::Reader()
 {
     width = 0;
     height = 0;
+    tileThreshold = 0;
+    overviewSize = 0;
 }
 
 Reader::~Reader()
@@ -131,11 +141,40 @@ Reader::~Reader()
 
 void Reader::clear()
 {
+    points.clear();
     intensity.clear();
     colors.clear();
     normals.clear();
 }
 
+void Reader::setOutOfCore(std::size_t threshold, std::size_t overview)
+{
+    tileThreshold = threshold;
+    overviewSize = overview;
+}
+
+bool Reader::useTiles(const std::string& filename, std::size_t numPoints, bool hasProperties) const
+{
+    if (tileThreshold == 0 || numPoints <= tileThreshold)
+        return false;
+    if (hasProperties) {
+        // tiles only store positions
+        Base::Console().Warning("%s: %lu points exceed the out-of-core threshold, but the file is "
+                                "loaded completely to keep its per-point properties\n",
+                                filename.c_str(), static_cast<unsigned long>(numPoints));
+        return false;
+    }
+    return true;
+}
+
+void Reader::setTiles(const std::string& filename, const std::shared_ptr<PointTiles>& tiles)
+{
+    points.setTiles(tiles, overviewSize);
+    Base::Console().Message("%s: %lu points are kept out-of-core, %lu points are shown\n",
+                            filename.c_str(), static_cast<unsigned long>(points.countAll()),
+                            static_cast<unsigned long>(points.size()));
+}
+
 const PointKernel& Reader::getPoints() const
 {
     return points;
@@ -214,7 +253,6 @@ public:
     virtual ~Converter() {
     }
     virtual std::string toString(float) const = 0;
-    virtual double toDouble(Base::InputStream&) const = 0;
     virtual int getSizeOf() const = 0;
 };
 template <typename T>
@@ -228,11 +266,6 @@ public:
         oss << c;
         return oss.str();
     }
-    virtual double toDouble(Base::InputStream& str) const {
-        T c;
-        str >> c;
-        return static_cast<double>(c);
-    }
     virtual int getSizeOf() const {
         return sizeof(T);
     }
@@ -240,73 +273,6 @@ public:
 
 typedef boost::shared_ptr<Converter> ConverterPtr;
 
-class DataStreambuf : public std::streambuf
-{
-public:
-    explicit DataStreambuf(const std::vector<char>& data) : _buffer(data) {
-        _beg = 0;
-        _end = data.size();
-        _cur = 0;
-    }
-    ~DataStreambuf() {
-    }
-
-protected:
-    virtual int_type uflow() {
-        if (_cur == _end)
-            return traits_type::eof();
-
-        return static_cast<DataStreambuf::int_type>(_buffer[_cur++]) & 0x000000ff;
-    }
-    virtual int_type underflow() {
-        if (_cur == _end)
-            return traits_type::eof();
-
-        return static_cast<DataStreambuf::int_type>(_buffer[_cur]) & 0x000000ff;
-    }
-    virtual int_type pbackfail(int_type ch) {
-        if (_cur == _beg || (ch != traits_type::eof() && ch != _buffer[_cur-1]))
-            return traits_type::eof();
-
-        return static_cast<DataStreambuf::int_type>(_buffer[--_cur]) & 0x000000ff;
-    }
-    virtual std::streamsize showmanyc() {
-        return _end - _cur;
-    }
-    virtual pos_type seekoff(std::streambuf::off_type off,
-        std::ios_base::seekdir way,
-        std::ios_base::openmode = 
-            std::ios::in | std::ios::out) {
-        int p_pos=-1;
-        if (way == std::ios_base::beg)
-            p_pos = _beg;
-        else if (way == std::ios_base::end)
-            p_pos = _end;
-        else if (way == std::ios_base::cur)
-            p_pos = _cur;
-
-        if (p_pos > _end)
-            return traits_type::eof();
-
-        if (((p_pos + off) > _end) || ((p_pos + off) < _beg))
-            return traits_type::eof();
-
-        _cur = p_pos+ off;
-
-        return ((p_pos+off) - _beg);
-    }
-    virtual pos_type seekpos(std::streambuf::pos_type pos,
-        std::ios_base::openmode which =
-        std::ios::in | std::ios::out) {
-        (void)which;
-        return seekoff(pos, std::ios_base::beg);
-    }
-
-private:
-    const std::vector<char>& _buffer;
-    int _beg, _end, _cur;
-};
-
 //Taken from https://github.com/PointCloudLibrary/pcl/blob/master/io/src/lzf.cpp
 unsigned int 
 lzfDecompress (const void *const in_data,  unsigned int in_len,
@@ -493,6 +459,476 @@ lzfDecompress (const void *const in_data,  unsigned int in_len,
 }
 }
 
+// ----------------------------------------------------------------------------
+
+namespace Points {
+
+/// Numeric type of a field in a ply or pcd file
+enum class FieldType {
+    Int8, UInt8, Int16, UInt16, Int32, UInt32, Float32, Float64
+};
+
+/** Where the values of a field go. The decoders write straight into the
+ * final arrays of the reader, either as scaled float with a stride or, for
+ * the pcd rgb/rgba fields, as a packed color.
+ */
+struct FieldTarget
+{
+    enum Kind { Ignore, Value, PackedColor };
+    Kind kind = Ignore;
+    float* values = nullptr;
+    std::size_t stride = 1;
+    float scale = 1.0f;
+    App::Color* colors = nullptr;
+};
+
+template <typename T>
+inline T readValue(const char* ptr, bool swap)
+{
+    T value;
+    std::memcpy(&value, ptr, sizeof(T));
+    if (swap)
+        Base::SwapEndian<T>(value);
+    return value;
+}
+
+template <typename T>
+inline uint32_t toPacked(T value)
+{
+    return static_cast<uint32_t>(value);
+}
+
+// a float rgb field holds the bits of the packed color
+template <>
+inline uint32_t toPacked<float>(float value)
+{
+    uint32_t packed;
+    std::memcpy(&packed, &value, sizeof(packed));
+    return packed;
+}
+
+template <>
+inline uint32_t toPacked<double>(double value)
+{
+    return toPacked<float>(static_cast<float>(value));
+}
+
+inline App::Color unpackColor(uint32_t packed)
+{
+    uint32_t a = (packed >> 24) & 0xff;
+    uint32_t r = (packed >> 16) & 0xff;
+    uint32_t g = (packed >> 8) & 0xff;
+    uint32_t b = packed & 0xff;
+    return App::Color(static_cast<float>(r)/255.0f,
+                      static_cast<float>(g)/255.0f,
+                      static_cast<float>(b)/255.0f,
+                      static_cast<float>(a)/255.0f);
+}
+
+/** Decodes the values of a single field of \a count records. \a data points
+ * to the field of the first record and \a stride is the distance between
+ * two records in bytes.
+ */
+template <typename T>
+void decodeValues(const char* data, std::size_t stride, std::size_t first, std::size_t count,
+                 bool swap, const FieldTarget& target)
+{
+    data += first * stride;
+    if (target.kind == FieldTarget::Value) {
+        float* out = target.values + first * target.stride;
+        float scale = target.scale;
+        for (std::size_t i=0; i<count; i++, data += stride, out += target.stride)
+            *out = static_cast<float>(readValue<T>(data, swap)) * scale;
+    }
+    else if (target.kind == FieldTarget::PackedColor) {
+        App::Color* out = target.colors + first;
+        for (std::size_t i=0; i<count; i++, data += stride, ++out)
+            *out = unpackColor(toPacked<T>(readValue<T>(data, swap)));
+    }
+}
+
+class FieldDecoder
+{
+public:
+    FieldDecoder(const std::vector<FieldType>& types, const std::vector<int>& sizes)
+        : types(types), targets(types.size()), recordSize(0)
+    {
+        for (int size : sizes) {
+            offsets.push_back(recordSize);
+            recordSize += static_cast<std::size_t>(size);
+        }
+    }
+
+    std::size_t getRecordSize() const
+    {
+        return recordSize;
+    }
+
+    void setTarget(std::size_t field, float* values, std::size_t stride, float scale = 1.0f)
+    {
+        FieldTarget& target = targets[field];
+        target.kind = FieldTarget::Value;
+        target.values = values;
+        target.stride = stride;
+        target.scale = scale;
+    }
+
+    void setColorTarget(std::size_t field, App::Color* colors)
+    {
+        FieldTarget& target = targets[field];
+        target.kind = FieldTarget::PackedColor;
+        target.colors = colors;
+    }
+
+    /// Decode \a numPoints records stored one after another
+    void decodeBinary(const char* data, std::size_t numPoints, bool swap) const
+    {
+        forEachRange(numPoints, [&](std::size_t first, std::size_t count) {
+            for (std::size_t j=0; j<types.size(); j++)
+                decodeField(types[j], data + offsets[j], recordSize, first, count, swap, targets[j]);
+        });
+    }
+
+    /// Decode \a numPoints records stored field by field
+    void decodeBinaryColumns(const char* data, std::size_t numPoints, bool swap) const
+    {
+        forEachRange(numPoints, [&](std::size_t first, std::size_t count) {
+            for (std::size_t j=0; j<types.size(); j++) {
+                std::size_t size = j+1 < offsets.size() ? offsets[j+1] - offsets[j]
+                                                        : recordSize - offsets[j];
+                decodeField(types[j], data + offsets[j] * numPoints, size, first, count, swap, targets[j]);
+            }
+        });
+    }
+
+    /** Decode up to \a numPoints lines of whitespace separated values. Empty
+     * lines are skipped. Returns the number of decoded records. Throws
+     * Base::BadFormatError if a value is not a valid number.
+     */
+    std::size_t decodeAscii(const char* begin, const char* end, std::size_t numPoints) const
+    {
+        struct Chunk {
+            const char* begin;
+            const char* end;
+            std::size_t lines;
+            std::size_t row;
+            std::size_t badRow;
+        };
+
+        // split the data at line ends
+        std::vector<Chunk> chunks;
+        std::size_t numChunks = std::max(1, QThread::idealThreadCount()) * 4;
+        std::size_t chunkSize = std::max<std::size_t>((end - begin) / numChunks, 1 << 20);
+        for (const char* it = begin; it < end;) {
+            const char* next = it + std::min<std::size_t>(chunkSize, end - it);
+            next = std::find(next, end, '\n');
+            if (next != end)
+                ++next;
+            chunks.push_back({it, next, 0, 0, std::numeric_limits<std::size_t>::max()});
+            it = next;
+        }
+
+        // count the lines of each chunk to know where its records go
+        QtConcurrent::blockingMap(chunks, [](Chunk& chunk) {
+            for (const char* it = chunk.begin; it < chunk.end;) {
+                const char* eol = std::find(it, chunk.end, '\n');
+                if (!isBlankLine(it, eol))
+                    ++chunk.lines;
+                it = eol == chunk.end ? eol : eol + 1;
+            }
+        });
+
+        std::size_t row = 0;
+        for (auto& chunk : chunks) {
+            chunk.row = row;
+            row += chunk.lines;
+        }
+
+        QtConcurrent::blockingMap(chunks, [this, numPoints](Chunk& chunk) {
+            std::size_t row = chunk.row;
+            for (const char* it = chunk.begin; it < chunk.end && row < numPoints;) {
+                const char* eol = std::find(it, chunk.end, '\n');
+                if (!isBlankLine(it, eol)) {
+                    // remember the error as exceptions must not leave the worker
+                    if (!decodeLine(it, eol, row)) {
+                        chunk.badRow = row;
+                        return;
+                    }
+                    ++row;
+                }
+                it = eol == chunk.end ? eol : eol + 1;
+            }
+        });
+
+        for (const auto& chunk : chunks) {
+            if (chunk.badRow != std::numeric_limits<std::size_t>::max())
+                throw Base::BadFormatError("Invalid number in point " + std::to_string(chunk.badRow + 1));
+        }
+
+        return std::min(row, numPoints);
+    }
+
+    /// Skip \a lines non-empty lines
+    static const char* skipLines(const char* begin, const char* end, std::size_t lines)
+    {
+        while (lines > 0 && begin < end) {
+            const char* eol = std::find(begin, end, '\n');
+            if (!isBlankLine(begin, eol))
+                --lines;
+            begin = eol == end ? end : eol + 1;
+        }
+        return begin;
+    }
+
+private:
+    template <typename Func>
+    static void forEachRange(std::size_t numPoints, Func func)
+    {
+        const std::size_t rangeSize = 1 << 16;
+        std::vector<std::pair<std::size_t, std::size_t> > ranges;
+        for (std::size_t i=0; i<numPoints; i+=rangeSize)
+            ranges.emplace_back(i, std::min(rangeSize, numPoints - i));
+        QtConcurrent::blockingMap(ranges, [&func](const std::pair<std::size_t, std::size_t>& range) {
+            func(range.first, range.second);
+        });
+    }
+
+    static void decodeField(FieldType type, const char* data, std::size_t stride,
+                            std::size_t first, std::size_t count, bool swap,
+                            const FieldTarget& target)
+    {
+        if (target.kind == FieldTarget::Ignore)
+            return;
+        switch (type) {
+        case FieldType::Int8:
+            decodeValues<int8_t>(data, stride, first, count, swap, target);
+            break;
+        case FieldType::UInt8:
+            decodeValues<uint8_t>(data, stride, first, count, swap, target);
+            break;
+        case FieldType::Int16:
+            decodeValues<int16_t>(data, stride, first, count, swap, target);
+            break;
+        case FieldType::UInt16:
+            decodeValues<uint16_t>(data, stride, first, count, swap, target);
+            break;
+        case FieldType::Int32:
+            decodeValues<int32_t>(data, stride, first, count, swap, target);
+            break;
+        case FieldType::UInt32:
+            decodeValues<uint32_t>(data, stride, first, count, swap, target);
+            break;
+        case FieldType::Float32:
+            decodeValues<float>(data, stride, first, count, swap, target);
+            break;
+        case FieldType::Float64:
+            decodeValues<double>(data, stride, first, count, swap, target);
+            break;
+        }
+    }
+
+    static bool isSpace(char c)
+    {
+        return c == ' ' || c == '\t' || c == '\r';
+    }
+
+    static bool isBlankLine(const char* it, const char* eol)
+    {
+        for (; it < eol; ++it) {
+            if (!isSpace(*it))
+                return false;
+        }
+        return true;
+    }
+
+    /// Returns false if a value is not a valid number
+    bool decodeLine(const char* it, const char* eol, std::size_t row) const
+    {
+        char token[64];
+        for (std::size_t j=0; j<types.size(); j++) {
+            while (it < eol && isSpace(*it))
+                ++it;
+            if (it == eol)
+                break;
+            // the mapped data is not null terminated
+            const char* start = it;
+            while (it < eol && !isSpace(*it))
+                ++it;
+            std::size_t len = it - start;
+            if (len >= sizeof(token))
+                return false;
+            std::copy(start, it, token);
+            token[len] = 0;
+
+            char* endptr;
+            double value = std::strtod(token, &endptr);
+            if (endptr != token + len)
+                return false;
+
+            const FieldTarget& target = targets[j];
+            if (target.kind == FieldTarget::Value) {
+                target.values[row * target.stride] = static_cast<float>(value) * target.scale;
+            }
+            else if (target.kind == FieldTarget::PackedColor) {
+                target.colors[row] = unpackColor(types[j] == FieldType::Float32 ? toPacked<double>(value)
+                                                                                : static_cast<uint32_t>(value));
+            }
+        }
+        return true;
+    }
+
+private:
+    std::vector<FieldType> types;
+    std::vector<FieldTarget> targets;
+    std::vector<std::size_t> offsets;
+    std::size_t recordSize;
+};
+
+/** Gives access to the content of a file. The file is memory mapped if
+ * possible, otherwise it's read into memory.
+ */
+class FileContent
+{
+public:
+    explicit FileContent(const std::string& filename)
+        : file(QString::fromUtf8(filename.c_str()))
+        , mapped(nullptr)
+    {
+        if (!file.open(QIODevice::ReadOnly))
+            throw Base::FileException("Failed to open file", filename);
+        if (file.size() > 0)
+            mapped = file.map(0, file.size());
+        if (!mapped) {
+            buffer.resize(static_cast<std::size_t>(file.size()));
+            if (!buffer.empty() && file.read(&buffer[0], file.size()) != file.size())
+                throw Base::FileException("Failed to read file", filename);
+        }
+    }
+
+    const char* data() const
+    {
+        if (mapped)
+            return reinterpret_cast<const char*>(mapped);
+        return buffer.empty() ? nullptr : &buffer[0];
+    }
+
+    std::size_t size() const
+    {
+        return static_cast<std::size_t>(file.size());
+    }
+
+private:
+    QFile file;
+    uchar* mapped;
+    std::vector<char> buffer;
+};
+
+/** Decodes the positions of \a numPoints binary records block by block into
+ * a tile file. The data is decoded twice, first to get the bounding box and
+ * then to fill the tiles, so the whole point cloud never has to be kept in
+ * memory.
+ */
+std::shared_ptr<PointTiles> decodeTiles(FieldDecoder& decoder, std::size_t x, std::size_t y, std::size_t z,
+                                        const char* data, std::size_t numPoints, bool swap)
+{
+    const std::size_t blockSize = 1 << 20;
+    std::vector<PointKernel::value_type> block(std::min(blockSize, numPoints));
+    decoder.setTarget(x, &block[0].x, 3);
+    decoder.setTarget(y, &block[0].y, 3);
+    decoder.setTarget(z, &block[0].z, 3);
+
+    std::size_t recordSize = decoder.getRecordSize();
+    Base::BoundBox3f box;
+    for (std::size_t i=0; i<numPoints; i+=blockSize) {
+        std::size_t count = std::min(blockSize, numPoints - i);
+        decoder.decodeBinary(data + i * recordSize, count, swap);
+        for (std::size_t j=0; j<count; j++)
+            box.Add(block[j]);
+    }
+
+    PointTilesBuilder builder(Base::FileInfo::getTempFileName("PointTiles"), box, numPoints);
+    for (std::size_t i=0; i<numPoints; i+=blockSize) {
+        std::size_t count = std::min(blockSize, numPoints - i);
+        decoder.decodeBinary(data + i * recordSize, count, swap);
+        builder.add(&block[0], count);
+    }
+
+    return builder.finish(true);
+}
+
+inline std::size_t findField(const std::vector<std::string>& fields, const char* name,
+                             const char* altName = nullptr)
+{
+    auto it = std::find(fields.begin(), fields.end(), name);
+    if (it == fields.end() && altName)
+        it = std::find(fields.begin(), fields.end(), altName);
+    if (it == fields.end())
+        return std::numeric_limits<std::size_t>::max();
+    return std::distance(fields.begin(), it);
+}
+
+inline FieldType getPlyFieldType(const std::string& t)
+{
+    if (t == "char" || t == "int8")
+        return FieldType::Int8;
+    else if (t == "uchar" || t == "uint8")
+        return FieldType::UInt8;
+    else if (t == "short" || t == "int16")
+        return FieldType::Int16;
+    else if (t == "ushort" || t == "uint16")
+        return FieldType::UInt16;
+    else if (t == "int" || t == "int32")
+        return FieldType::Int32;
+    else if (t == "uint" || t == "uint32")
+        return FieldType::UInt32;
+    else if (t == "float" || t == "float32")
+        return FieldType::Float32;
+    else if (t == "double" || t == "float64")
+        return FieldType::Float64;
+    throw Base::BadFormatError("Unexpected type");
+}
+
+inline FieldType getPcdFieldType(const std::string& type, int size)
+{
+    char t = type.empty() ? 0 : type[0];
+    switch (size) {
+    case 1:
+        if (t == 'I')
+            return FieldType::Int8;
+        else if (t == 'U')
+            return FieldType::UInt8;
+        break;
+    case 2:
+        if (t == 'I')
+            return FieldType::Int16;
+        else if (t == 'U')
+            return FieldType::UInt16;
+        break;
+    case 4:
+        if (t == 'I')
+            return FieldType::Int32;
+        else if (t == 'U')
+            return FieldType::UInt32;
+        else if (t == 'F')
+            return FieldType::Float32;
+        break;
+    case 8:
+        if (t == 'F')
+            return FieldType::Float64;
+        break;
+    default:
+        break;
+    }
+    throw Base::BadFormatError("Unexpected type");
+}
+
+static_assert(sizeof(PointKernel::value_type) == 3 * sizeof(float), "Unexpected point layout");
+static_assert(sizeof(Base::Vector3f) == 3 * sizeof(float), "Unexpected normal layout");
+static_assert(sizeof(App::Color) == 4 * sizeof(float), "Unexpected color layout");
+}
+
+// ----------------------------------------------------------------------------
+
 PlyReader::PlyReader()
 {
 }
@@ -516,141 +952,106 @@ void PlyReader::read(const std::string& filename)
     std::vector<int> sizes;
     std::size_t offset = 0;
     std::size_t numPoints = readHeader(inp, format, offset, fields, types, sizes);
+    std::streamoff headerSize = inp.tellg();
+    inp.close();
 
-    Eigen::MatrixXd data(numPoints, fields.size());
-    if (format == "ascii") {
-        readAscii(inp, offset, data);
-    }
-    else if (format == "binary_little_endian") {
-        readBinary(false, inp, offset, types, sizes, data);
-    }
-    else if (format == "binary_big_endian") {
-        readBinary(true, inp, offset, types, sizes, data);
-    }
-
-    std::vector<std::string>::iterator it;
     std::size_t max_size = std::numeric_limits<std::size_t>::max();
+    std::size_t x = findField(fields, "x");
+    std::size_t y = findField(fields, "y");
+    std::size_t z = findField(fields, "z");
+    std::size_t normal_x = findField(fields, "normal_x", "nx");
+    std::size_t normal_y = findField(fields, "normal_y", "ny");
+    std::size_t normal_z = findField(fields, "normal_z", "nz");
+    std::size_t greyvalue = findField(fields, "intensity");
+    std::size_t red = findField(fields, "red");
+    std::size_t green = findField(fields, "green");
+    std::size_t blue = findField(fields, "blue");
+    std::size_t alpha = findField(fields, "alpha");
 
-    // x field
-    std::size_t x = max_size;
-    it = std::find(fields.begin(), fields.end(), "x");
-    if (it != fields.end())
-        x = std::distance(fields.begin(), it);
-
-    // y field
-    std::size_t y = max_size;
-    it = std::find(fields.begin(), fields.end(), "y");
-    if (it != fields.end())
-        y = std::distance(fields.begin(), it);
-
-    // z field
-    std::size_t z = max_size;
-    it = std::find(fields.begin(), fields.end(), "z");
-    if (it != fields.end())
-        z = std::distance(fields.begin(), it);
-
-    // normal x field
-    std::size_t normal_x = max_size;
-    it = std::find(fields.begin(), fields.end(), "normal_x");
-    if (it == fields.end())
-        it = std::find(fields.begin(), fields.end(), "nx");
-    if (it != fields.end())
-        normal_x = std::distance(fields.begin(), it);
-
-    // normal y field
-    std::size_t normal_y = max_size;
-    it = std::find(fields.begin(), fields.end(), "normal_y");
-    if (it == fields.end())
-        it = std::find(fields.begin(), fields.end(), "ny");
-    if (it != fields.end())
-        normal_y = std::distance(fields.begin(), it);
-
-    // normal z field
-    std::size_t normal_z = max_size;
-    it = std::find(fields.begin(), fields.end(), "normal_z");
-    if (it == fields.end())
-        it = std::find(fields.begin(), fields.end(), "nz");
-    if (it != fields.end())
-        normal_z = std::distance(fields.begin(), it);
-
-    // intensity field
-    std::size_t greyvalue = max_size;
-    it = std::find(fields.begin(), fields.end(), "intensity");
-    if (it != fields.end())
-        greyvalue = std::distance(fields.begin(), it);
-
-    // rgb(a) field
-    std::size_t red = max_size, green = max_size, blue = max_size, alpha = max_size;
-    it = std::find(fields.begin(), fields.end(), "red");
-    if (it != fields.end())
-        red = std::distance(fields.begin(), it);
-
-    it = std::find(fields.begin(), fields.end(), "green");
-    if (it != fields.end())
-        green = std::distance(fields.begin(), it);
-
-    it = std::find(fields.begin(), fields.end(), "blue");
-    if (it != fields.end())
-        blue = std::distance(fields.begin(), it);
-
-    it = std::find(fields.begin(), fields.end(), "alpha");
-    if (it != fields.end())
-        alpha = std::distance(fields.begin(), it);
-
-    // transfer the data
     bool hasData = (x != max_size && y != max_size && z != max_size);
     bool hasNormal = (normal_x != max_size && normal_y != max_size && normal_z != max_size);
     bool hasIntensity = (greyvalue != max_size);
     bool hasColor = (red != max_size && green != max_size && blue != max_size);
+    if (!hasData || numPoints == 0 || headerSize < 0)
+        return;
 
-    if (hasData) {
-        points.reserve(numPoints);
-        for (std::size_t i=0; i<numPoints; i++) {
-            points.push_back(Base::Vector3d(data(i,x),data(i,y),data(i,z)));
-        }
+    std::vector<FieldType> fieldTypes;
+    for (const auto& t : types)
+        fieldTypes.push_back(getPlyFieldType(t));
+
+    // decode the values directly into the final arrays
+    FieldDecoder decoder(fieldTypes, sizes);
+
+    // huge binary files are kept out-of-core if they have no per-point properties
+    if (format != "ascii" && useTiles(filename, numPoints, hasNormal || hasIntensity || hasColor)) {
+        FileContent content(filename);
+        std::size_t neededSize = offset + decoder.getRecordSize() * numPoints;
+        if (static_cast<std::size_t>(headerSize) + neededSize > content.size())
+            throw Base::BadFormatError("File expects too many elements");
+        const char* begin = content.data() + headerSize + offset;
+        setTiles(filename, decodeTiles(decoder, x, y, z, begin, numPoints,
+                                       format == "binary_big_endian"));
+        return;
     }
 
-    if (hasData && hasNormal) {
-        normals.reserve(numPoints);
-        for (std::size_t i=0; i<numPoints; i++) {
-            normals.emplace_back(data(i,normal_x),data(i,normal_y),data(i,normal_z));
-        }
+    std::vector<PointKernel::value_type>& pts = points.getBasicPoints();
+    pts.resize(numPoints);
+    decoder.setTarget(x, &pts[0].x, 3);
+    decoder.setTarget(y, &pts[0].y, 3);
+    decoder.setTarget(z, &pts[0].z, 3);
+
+    if (hasNormal) {
+        normals.resize(numPoints);
+        decoder.setTarget(normal_x, &normals[0].x, 3);
+        decoder.setTarget(normal_y, &normals[0].y, 3);
+        decoder.setTarget(normal_z, &normals[0].z, 3);
     }
 
-    if (hasData && hasIntensity) {
-        intensity.reserve(numPoints);
-        for (std::size_t i=0; i<numPoints; i++) {
-            intensity.push_back(data(i,greyvalue));
+    if (hasIntensity) {
+        intensity.resize(numPoints);
+        decoder.setTarget(greyvalue, &intensity[0], 1);
+    }
+
+    if (hasColor) {
+        float scale = 1.0f;
+        if (types[red] == "uchar" || types[red] == "uint8")
+            scale = 1.0f/255.0f;
+        else if (types[red] != "float" && types[red] != "float32")
+            hasColor = false;
+
+        if (hasColor) {
+            colors.resize(numPoints, App::Color(0.0f, 0.0f, 0.0f, 1.0f));
+            decoder.setTarget(red, &colors[0].r, 4, scale);
+            decoder.setTarget(green, &colors[0].g, 4, scale);
+            decoder.setTarget(blue, &colors[0].b, 4, scale);
+            if (alpha != max_size)
+                decoder.setTarget(alpha, &colors[0].a, 4, scale);
         }
     }
 
-    if (hasData && hasColor) {
-        colors.reserve(numPoints);
-        float a = 1.0;
-        if (types[red] == "uchar") {
-            for (std::size_t i=0; i<numPoints; i++) {
-                float r = data(i, red);
-                float g = data(i, green);
-                float b = data(i, blue);
-                if (alpha != max_size)
-                    a = data(i, alpha);
-                colors.emplace_back(static_cast<float>(r)/255.0f,
-                                            static_cast<float>(g)/255.0f,
-                                            static_cast<float>(b)/255.0f,
-                                            static_cast<float>(a)/255.0f);
-            }
-        }
-        else if (types[red] == "float") {
-            for (std::size_t i=0; i<numPoints; i++) {
-                float r = data(i, red);
-                float g = data(i, green);
-                float b = data(i, blue);
-                if (alpha != max_size)
-                    a = data(i, alpha);
-                colors.emplace_back(r, g, b, a);
-            }
+    FileContent content(filename);
+    const char* begin = content.data() + headerSize;
+    const char* end = content.data() + content.size();
+    if (format == "ascii") {
+        begin = FieldDecoder::skipLines(begin, end, offset);
+        std::size_t count = decoder.decodeAscii(begin, end, numPoints);
+        if (count < numPoints) {
+            // the file has fewer lines than announced
+            pts.resize(count);
+            if (hasNormal)
+                normals.resize(count);
+            if (hasIntensity)
+                intensity.resize(count);
+            if (hasColor)
+                colors.resize(count);
         }
     }
+    else {
+        std::size_t neededSize = offset + decoder.getRecordSize() * numPoints;
+        if (static_cast<std::size_t>(headerSize) + neededSize > content.size())
+            throw Base::BadFormatError("File expects too many elements");
+        decoder.decodeBinary(begin + offset, numPoints, format == "binary_big_endian");
+    }
 }
 
 std::size_t PlyReader::readHeader(std::istream& in,
@@ -821,121 +1222,6 @@ std::size_t PlyReader::readHeader(std::istream& in,
     return numPoints;
 }
 
-void PlyReader::readAscii(std::istream& inp, std::size_t offset, Eigen::MatrixXd& data)
-{
-    std::string line;
-    std::size_t row = 0;
-    std::size_t numPoints = data.rows();
-    std::size_t numFields = data.cols();
-    std::vector<std::string> list;
-    while (std::getline(inp, line) && row < numPoints) {
-        if (line.empty())
-            continue;
-
-        if (offset > 0) {
-            offset--;
-            continue;
-        }
-
-        // since the file is loaded in binary mode we may get the CR at the end
-        boost::trim(line);
-        boost::split(list, line, boost::is_any_of ("\t\r "), boost::token_compress_on);
-
-        std::istringstream str(line);
-
-        for (std::size_t col = 0; col < list.size() && col < numFields; col++) {
-            double value = boost::lexical_cast<double>(list[col]);
-            data(row, col) = value;
-        }
-
-        ++row;
-    }
-}
-
-void PlyReader::readBinary(bool swapByteOrder,
-                           std::istream& inp,
-                           std::size_t offset,
-                           const std::vector<std::string>& types,
-                           const std::vector<int>& sizes,
-                           Eigen::MatrixXd& data)
-{
-    std::size_t numPoints = data.rows();
-    std::size_t numFields = data.cols();
-
-    int neededSize = 0;
-    ConverterPtr convert_float32(new ConverterT<float>);
-    ConverterPtr convert_float64(new ConverterT<double>);
-    ConverterPtr convert_int8(new ConverterT<int8_t>);
-    ConverterPtr convert_uint8(new ConverterT<uint8_t>);
-    ConverterPtr convert_int16(new ConverterT<int16_t>);
-    ConverterPtr convert_uint16(new ConverterT<uint16_t>);
-    ConverterPtr convert_int32(new ConverterT<int32_t>);
-    ConverterPtr convert_uint32(new ConverterT<uint32_t>);
-
-    std::vector<ConverterPtr> converters;
-    for (std::size_t j=0; j<numFields; j++) {
-        std::string t = types[j];
-        switch (sizes[j]) {
-        case 1:
-            if (t == "char" || t == "int8")
-                converters.push_back(convert_int8);
-            else if (t == "uchar" || t == "uint8")
-                converters.push_back(convert_uint8);
-            else
-                throw Base::BadFormatError("Unexpected type");
-            break;
-        case 2:
-            if (t == "short" || t == "int16")
-                converters.push_back(convert_int16);
-            else if (t == "ushort" || t == "uint16")
-                converters.push_back(convert_uint16);
-            else
-                throw Base::BadFormatError("Unexpected type");
-            break;
-        case 4:
-            if (t == "int" || t == "int32")
-                converters.push_back(convert_int32);
-            else if (t == "uint" || t == "uint32")
-                converters.push_back(convert_uint32);
-            else if (t == "float" || t == "float32")
-                converters.push_back(convert_float32);
-            else
-                throw Base::BadFormatError("Unexpected type");
-            break;
-        case 8:
-            if (t == "double" || t == "float64")
-                converters.push_back(convert_float64);
-            else
-                throw Base::BadFormatError("Unexpected type");
-            break;
-        default:
-            throw Base::BadFormatError("Unexpected type");
-        }
-
-        neededSize += converters.back()->getSizeOf();
-    }
-
-    std::streamoff ulSize = 0;
-    std::streamoff ulCurr = 0;
-    std::streambuf* buf = inp.rdbuf();
-    if (buf) {
-        ulCurr = buf->pubseekoff(static_cast<std::streamoff>(offset), std::ios::cur, std::ios::in);
-        ulSize = buf->pubseekoff(0, std::ios::end, std::ios::in);
-        buf->pubseekoff(ulCurr, std::ios::beg, std::ios::in);
-        if (ulCurr + neededSize*static_cast<std::streamoff>(numPoints) > ulSize)
-            throw Base::BadFormatError("File expects too many elements");
-    }
-
-    Base::InputStream str(inp);
-    str.setByteOrder(swapByteOrder ? Base::Stream::BigEndian : Base::Stream::LittleEndian);
-    for (std::size_t i=0; i<numPoints; i++) {
-        for (std::size_t j=0; j<numFields; j++) {
-            double value = converters[j]->toDouble(str);
-            data(i, j) = value;
-        }
-    }
-}
-
 // ----------------------------------------------------------------------------
 
 PcdReader::PcdReader()
@@ -960,154 +1246,108 @@ void PcdReader::read(const std::string& filename)
     std::vector<std::string> types;
     std::vector<int> sizes;
     std::size_t numPoints = readHeader(inp, format, fields, types, sizes);
+    std::streamoff headerSize = inp.tellg();
+    inp.close();
 
-    Eigen::MatrixXd data(numPoints, fields.size());
-    if (format == "ascii") {
-        readAscii(inp, data);
-    }
-    else if (format == "binary") {
-        readBinary(false, inp, types, sizes, data);
-    }
-    else if (format == "binary_compressed") {
-        unsigned int c, u;
-        Base::InputStream str(inp);
-        str >> c >> u;
-
-        std::vector<char> compressed(c);
-        inp.read(&compressed[0], c);
-        std::vector<char> uncompressed(u);
-        if (lzfDecompress(&compressed[0], c, &uncompressed[0], u) == u) {
-            DataStreambuf ibuf(uncompressed);
-            std::istream istr(0);
-            istr.rdbuf(&ibuf);
-            readBinary(true, istr, types, sizes, data);
-        }
-        else {
-            throw Base::BadFormatError("Failed to decompress binary data");
-        }
-    }
-
-    std::vector<std::string>::iterator it;
     std::size_t max_size = std::numeric_limits<std::size_t>::max();
+    std::size_t x = findField(fields, "x");
+    std::size_t y = findField(fields, "y");
+    std::size_t z = findField(fields, "z");
+    std::size_t normal_x = findField(fields, "normal_x", "nx");
+    std::size_t normal_y = findField(fields, "normal_y", "ny");
+    std::size_t normal_z = findField(fields, "normal_z", "nz");
+    std::size_t greyvalue = findField(fields, "intensity");
+    std::size_t rgba = findField(fields, "rgb", "rgba");
 
-    // x field
-    std::size_t x = max_size;
-    it = std::find(fields.begin(), fields.end(), "x");
-    if (it != fields.end())
-        x = std::distance(fields.begin(), it);
-
-    // y field
-    std::size_t y = max_size;
-    it = std::find(fields.begin(), fields.end(), "y");
-    if (it != fields.end())
-        y = std::distance(fields.begin(), it);
-
-    // z field
-    std::size_t z = max_size;
-    it = std::find(fields.begin(), fields.end(), "z");
-    if (it != fields.end())
-        z = std::distance(fields.begin(), it);
-
-    // normal x field
-    std::size_t normal_x = max_size;
-    it = std::find(fields.begin(), fields.end(), "normal_x");
-    if (it == fields.end())
-        it = std::find(fields.begin(), fields.end(), "nx");
-    if (it != fields.end())
-        normal_x = std::distance(fields.begin(), it);
-
-    // normal y field
-    std::size_t normal_y = max_size;
-    it = std::find(fields.begin(), fields.end(), "normal_y");
-    if (it == fields.end())
-        it = std::find(fields.begin(), fields.end(), "ny");
-    if (it != fields.end())
-        normal_y = std::distance(fields.begin(), it);
-
-    // normal z field
-    std::size_t normal_z = max_size;
-    it = std::find(fields.begin(), fields.end(), "normal_z");
-    if (it == fields.end())
-        it = std::find(fields.begin(), fields.end(), "nz");
-    if (it != fields.end())
-        normal_z = std::distance(fields.begin(), it);
-
-    // intensity field
-    std::size_t greyvalue = max_size;
-    it = std::find(fields.begin(), fields.end(), "intensity");
-    if (it != fields.end())
-        greyvalue = std::distance(fields.begin(), it);
-
-    // rgb(a) field
-    std::size_t rgba = max_size;
-    it = std::find(fields.begin(), fields.end(), "rgb");
-    if (it == fields.end())
-        it = std::find(fields.begin(), fields.end(), "rgba");
-    if (it != fields.end())
-        rgba = std::distance(fields.begin(), it);
-
-    // transfer the data
     bool hasData = (x != max_size && y != max_size && z != max_size);
     bool hasNormal = (normal_x != max_size && normal_y != max_size && normal_z != max_size);
     bool hasIntensity = (greyvalue != max_size);
-    bool hasColor = (rgba != max_size);
+    bool hasColor = (rgba != max_size && (types[rgba] == "U" || types[rgba] == "F"));
+    if (!hasData || numPoints == 0 || headerSize < 0)
+        return;
+
+    std::vector<FieldType> fieldTypes;
+    for (std::size_t i=0; i<types.size(); i++)
+        fieldTypes.push_back(getPcdFieldType(types[i], sizes[i]));
+
+    // decode the values directly into the final arrays
+    FieldDecoder decoder(fieldTypes, sizes);
+
+    // huge binary files are kept out-of-core if they have no per-point
+    // properties, the structure is dropped then
+    if (format == "binary" && useTiles(filename, numPoints, hasNormal || hasIntensity || hasColor)) {
+        FileContent content(filename);
+        const char* begin = content.data() + headerSize;
+        if (content.size() - static_cast<std::size_t>(headerSize) < decoder.getRecordSize() * numPoints)
+            throw Base::BadFormatError("File expects too many elements");
+        setTiles(filename, decodeTiles(decoder, x, y, z, begin, numPoints, false));
+        this->width = -1;
+        this->height = -1;
+        return;
+    }
 
-    if (hasData) {
-        points.reserve(numPoints);
-        for (std::size_t i=0; i<numPoints; i++) {
-            points.push_back(Base::Vector3d(data(i,x),data(i,y),data(i,z)));
-        }
+    std::vector<PointKernel::value_type>& pts = points.getBasicPoints();
+    pts.resize(numPoints);
+    decoder.setTarget(x, &pts[0].x, 3);
+    decoder.setTarget(y, &pts[0].y, 3);
+    decoder.setTarget(z, &pts[0].z, 3);
+
+    if (hasNormal) {
+        normals.resize(numPoints);
+        decoder.setTarget(normal_x, &normals[0].x, 3);
+        decoder.setTarget(normal_y, &normals[0].y, 3);
+        decoder.setTarget(normal_z, &normals[0].z, 3);
     }
 
-    if (hasData && hasNormal) {
-        normals.reserve(numPoints);
-        for (std::size_t i=0; i<numPoints; i++) {
-            normals.emplace_back(data(i,normal_x),data(i,normal_y),data(i,normal_z));
-        }
+    if (hasIntensity) {
+        intensity.resize(numPoints);
+        decoder.setTarget(greyvalue, &intensity[0], 1);
     }
 
-    if (hasData && hasIntensity) {
-        intensity.reserve(numPoints);
-        for (std::size_t i=0; i<numPoints; i++) {
-            intensity.push_back(data(i,greyvalue));
-        }
+    if (hasColor) {
+        colors.resize(numPoints);
+        decoder.setColorTarget(rgba, &colors[0]);
     }
 
-    if (hasData && hasColor) {
-        colors.reserve(numPoints);
-        if (types[rgba] == "U") {
-            for (std::size_t i=0; i<numPoints; i++) {
-                uint32_t packed = static_cast<uint32_t>(data(i,rgba));
-                uint32_t a = (packed >> 24) & 0xff;
-                uint32_t r = (packed >> 16) & 0xff;
-                uint32_t g = (packed >> 8) & 0xff;
-                uint32_t b = packed & 0xff;
-                colors.emplace_back(static_cast<float>(r)/255.0f,
-                                            static_cast<float>(g)/255.0f,
-                                            static_cast<float>(b)/255.0f,
-                                            static_cast<float>(a)/255.0f);
-            }
+    FileContent content(filename);
+    const char* begin = content.data() + headerSize;
+    const char* end = content.data() + content.size();
+    std::size_t neededSize = decoder.getRecordSize() * numPoints;
+    if (format == "ascii") {
+        std::size_t count = decoder.decodeAscii(begin, end, numPoints);
+        if (count < numPoints) {
+            // the file has fewer lines than announced, so the points are
+            // no longer organized
+            pts.resize(count);
+            if (hasNormal)
+                normals.resize(count);
+            if (hasIntensity)
+                intensity.resize(count);
+            if (hasColor)
+                colors.resize(count);
+            this->width = static_cast<int>(count);
+            this->height = 1;
         }
-        else if (types[rgba] == "F") {
-            union RGBA {
-                uint32_t u;
-                float f;
-            };
+    }
+    else if (format == "binary") {
+        if (static_cast<std::size_t>(end - begin) < neededSize)
+            throw Base::BadFormatError("File expects too many elements");
+        decoder.decodeBinary(begin, numPoints, false);
+    }
+    else if (format == "binary_compressed") {
+        if (end - begin < 8)
+            throw Base::BadFormatError("Failed to decompress binary data");
+        unsigned int c = readValue<uint32_t>(begin, false);
+        unsigned int u = readValue<uint32_t>(begin + 4, false);
+        begin += 8;
+        if (static_cast<std::size_t>(end - begin) < c || u < neededSize)
+            throw Base::BadFormatError("File expects too many elements");
 
-            union RGBA v;
-            for (std::size_t i=0; i<numPoints; i++) {
-                v.f = static_cast<float>(data(i,rgba));
-                uint32_t packed = v.u;
-                uint32_t a = (packed >> 24) & 0xff;
-                uint32_t r = (packed >> 16) & 0xff;
-                uint32_t g = (packed >> 8) & 0xff;
-                uint32_t b = packed & 0xff;
-                colors.emplace_back(static_cast<float>(r)/255.0f,
-                                            static_cast<float>(g)/255.0f,
-                                            static_cast<float>(b)/255.0f,
-                                            static_cast<float>(a)/255.0f);
-            }
-        }
+        // the compressed data is stored field by field
+        std::vector<char> uncompressed(u);
+        if (lzfDecompress(begin, c, &uncompressed[0], u) != u)
+            throw Base::BadFormatError("Failed to decompress binary data");
+        decoder.decodeBinaryColumns(&uncompressed[0], numPoints, false);
     }
 }
 
@@ -1183,124 +1423,6 @@ std::size_t PcdReader::readHeader(std::istream& in,
     return points;
 }
 
-void PcdReader::readAscii(std::istream& inp, Eigen::MatrixXd& data)
-{
-    std::string line;
-    std::size_t row = 0;
-    std::size_t numPoints = data.rows();
-    std::size_t numFields = data.cols();
-    std::vector<std::string> list;
-    while (std::getline(inp, line) && row < numPoints) {
-        if (line.empty())
-            continue;
-
-        // since the file is loaded in binary mode we may get the CR at the end
-        boost::trim(line);
-        boost::split(list, line, boost::is_any_of ("\t\r "), boost::token_compress_on);
-
-        std::istringstream str(line);
-
-        for (std::size_t col = 0; col < list.size() && col < numFields; col++) {
-            double value = boost::lexical_cast<double>(list[col]);
-            data(row, col) = value;
-        }
-
-        ++row;
-    }
-}
-
-void PcdReader::readBinary(bool transpose,
-                           std::istream& inp,
-                           const std::vector<std::string>& types,
-                           const std::vector<int>& sizes,
-                           Eigen::MatrixXd& data)
-{
-    std::size_t numPoints = data.rows();
-    std::size_t numFields = data.cols();
-
-    int neededSize = 0;
-    ConverterPtr convert_float32(new ConverterT<float>);
-    ConverterPtr convert_float64(new ConverterT<double>);
-    ConverterPtr convert_int8(new ConverterT<int8_t>);
-    ConverterPtr convert_uint8(new ConverterT<uint8_t>);
-    ConverterPtr convert_int16(new ConverterT<int16_t>);
-    ConverterPtr convert_uint16(new ConverterT<uint16_t>);
-    ConverterPtr convert_int32(new ConverterT<int32_t>);
-    ConverterPtr convert_uint32(new ConverterT<uint32_t>);
-
-    std::vector<ConverterPtr> converters;
-    for (std::size_t j=0; j<numFields; j++) {
-        char t = types[j][0];
-        switch (sizes[j]) {
-        case 1:
-            if (t == 'I')
-                converters.push_back(convert_int8);
-            else if (t == 'U')
-                converters.push_back(convert_uint8);
-            else
-                throw Base::BadFormatError("Unexpected type");
-            break;
-        case 2:
-            if (t == 'I')
-                converters.push_back(convert_int16);
-            else if (t == 'U')
-                converters.push_back(convert_uint16);
-            else
-                throw Base::BadFormatError("Unexpected type");
-            break;
-        case 4:
-            if (t == 'I')
-                converters.push_back(convert_int32);
-            else if (t == 'U')
-                converters.push_back(convert_uint32);
-            else if (t == 'F')
-                converters.push_back(convert_float32);
-            else
-                throw Base::BadFormatError("Unexpected type");
-            break;
-        case 8:
-            if (t == 'F')
-                converters.push_back(convert_float64);
-            else
-                throw Base::BadFormatError("Unexpected type");
-            break;
-        default:
-            throw Base::BadFormatError("Unexpected type");
-        }
-
-        neededSize += converters.back()->getSizeOf();
-    }
-
-    std::streamoff ulSize = 0;
-    std::streamoff ulCurr = 0;
-    std::streambuf* buf = inp.rdbuf();
-    if (buf) {
-        ulCurr = buf->pubseekoff(0, std::ios::cur, std::ios::in);
-        ulSize = buf->pubseekoff(0, std::ios::end, std::ios::in);
-        buf->pubseekoff(ulCurr, std::ios::beg, std::ios::in);
-        if (ulCurr + neededSize*static_cast<std::streamoff>(numPoints) > ulSize)
-            throw Base::BadFormatError("File expects too many elements");
-    }
-
-    Base::InputStream str(inp);
-    if (transpose) {
-        for (std::size_t j=0; j<numFields; j++) {
-            for (std::size_t i=0; i<numPoints; i++) {
-                double value = converters[j]->toDouble(str);
-                data(i, j) = value;
-            }
-        }
-    }
-    else {
-        for (std::size_t i=0; i<numPoints; i++) {
-            for (std::size_t j=0; j<numFields; j++) {
-                double value = converters[j]->toDouble(str);
-                data(i, j) = value;
-            }
-        }
-    }
-}
-
 // ----------------------------------------------------------------------------
 
 Writer::Writer(const PointKernel& p) : points(p)
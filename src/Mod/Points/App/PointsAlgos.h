@@ -26,7 +26,6 @@
 
 #include "Points.h"
 #include "Properties.h"
-#include <Eigen/Core>
 
 namespace Points
 {
@@ -52,6 +51,11 @@ public:
     virtual void read(const std::string& filename) = 0;
 
     void clear();
+    /** Binary files with more than \a threshold points are kept out-of-core
+     * in a tile file and only \a overviewSize points are loaded. Files with
+     * normals, colors or intensities are always loaded completely. 0 disables it.
+     */
+    void setOutOfCore(std::size_t threshold, std::size_t overviewSize);
     const PointKernel& getPoints() const;
     bool hasProperties() const;
     const std::vector<float>& getIntensities() const;
@@ -64,12 +68,20 @@ public:
     int getWidth() const;
     int getHeight() const;
 
+protected:
+    /// Checks whether to keep the points out-of-core, warns if the file is too big for it
+    bool useTiles(const std::string& filename, std::size_t numPoints, bool hasProperties) const;
+    /// Attach the tiles and report the size of the resident overview
+    void setTiles(const std::string& filename, const std::shared_ptr<PointTiles>& tiles);
+
 protected:
     PointKernel points;
     std::vector<float> intensity;
     std::vector<App::Color> colors;
     std::vector<Base::Vector3f> normals;
     int width, height;
+    std::size_t tileThreshold;
+    std::size_t overviewSize;
 };
 
 class AscReader : public Reader
@@ -91,11 +103,6 @@ private:
     std::size_t readHeader(std::istream&, std::string& format, std::size_t& offset,
         std::vector<std::string>& fields, std::vector<std::string>& types,
         std::vector<int>& sizes);
-    void readAscii(std::istream&, std::size_t offset, Eigen::MatrixXd& data);
-    void readBinary(bool swapByteOrder, std::istream&, std::size_t offset,
-        const std::vector<std::string>& types,
-        const std::vector<int>& sizes,
-        Eigen::MatrixXd& data);
 };
 
 class PcdReader : public Reader
@@ -108,11 +115,6 @@ public:
 private:
     std::size_t readHeader(std::istream&, std::string& format, std::vector<std::string>& fields,
         std::vector<std::string>& types, std::vector<int>& sizes);
-    void readAscii(std::istream&, Eigen::MatrixXd& data);
-    void readBinary(bool transpose, std::istream&,
-        const std::vector<std::string>& types,
-        const std::vector<int>& sizes,
-        Eigen::MatrixXd& data);
 };
 
 class Writer
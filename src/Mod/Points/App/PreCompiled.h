@@ -57,10 +57,12 @@
 #include <sstream>
 #include <stack>
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include <bitset>
 #include <float.h>
 #include <cmath>
+#include <cstring>
 #include <stdlib.h>
 
 #endif //_PreComp_
@@ -29,6 +29,7 @@
 # include <algorithm>
 #endif
 
+#include <Base/Console.h>
 #include <Base/Exception.h>
 #include <Base/Matrix.h>
 #include <Base/Stream.h>
@@ -158,6 +159,13 @@ void PropertyPointKernel::removeIndices( const std::vector<unsigned long>& uIndi
     if ( uSortedInds.size() > _cPoints->size() )
         return;
 
+    // the indices refer to the overview points
+    if (_cPoints->hasTiles()) {
+        Base::Console().Warning("Removing points from a point cloud of %lu points loaded in tiles, "
+                                "only its overview points are kept\n",
+                                static_cast<unsigned long>(_cPoints->countAll()));
+    }
+
     PointKernel kernel;
     kernel.setTransform(_cPoints->getTransform());
     kernel.reserve(_cPoints->size() - uSortedInds.size());
@@ -68,71 +68,54 @@ std::string LuxTools::getCamera(const CamDef& Cam)
 
 void LuxTools::writeShape(std::ostream &out, const char *PartName, const TopoDS_Shape& Shape, float fMeshDeviation)
 {
-    Base::Console().Log("Meshing with Deviation: %f\n",fMeshDeviation);
+    // the faces are meshed in parallel
+    std::vector<FaceMesh> meshes;
+    PovTools::meshShape(Shape, fMeshDeviation, meshes);
 
-    TopExp_Explorer ex;
-    BRepMesh_IncrementalMesh MESH(Shape,fMeshDeviation);
-
-    // counting faces and start sequencer
-    int l = 1;
-    for (ex.Init(Shape, TopAbs_FACE); ex.More(); ex.Next(),l++) {}
-    Base::SequencerLauncher seq("Writing file", l);
-    
     // write object
     out << "AttributeBegin #  \"" << PartName << "\"" << endl;
     out << "Transform [1 0 0 0 0 1 0 0 0 0 1 0 0 0 0 1]" << endl;
     out << "NamedMaterial \"FreeCADMaterial_" << PartName << "\"" << endl;
     out << "Shape \"mesh\"" << endl;
-    
-    // gather vertices, normals and face indices
-    std::stringstream triindices;
-    std::stringstream N;
-    std::stringstream P;
-    l = 1;
-    int vi = 0;
-    for (ex.Init(Shape, TopAbs_FACE); ex.More(); ex.Next(),l++) {
-
-        // get the shape and mesh it
-        const TopoDS_Face& aFace = TopoDS::Face(ex.Current());
-
-        // this block mesh the face and transfers it in a C array of vertices and face indexes
-        Standard_Integer nbNodesInFace,nbTriInFace;
-        gp_Vec* vertices=0;
-        gp_Vec* vertexnormals=0;
-        long* cons=0;
-
-        PovTools::transferToArray(aFace,&vertices,&vertexnormals,&cons,nbNodesInFace,nbTriInFace);
-
-        if (!vertices) break;
-        // writing vertices
-        for (int i=0; i < nbNodesInFace; i++) {
-            P << vertices[i].X() << " " << vertices[i].Y() << " " << vertices[i].Z() << " ";
-        }
 
-        // writing per vertex normals
-        for (int j=0; j < nbNodesInFace; j++) {
-            N << vertexnormals[j].X() << " "  << vertexnormals[j].Y() << " " << vertexnormals[j].Z() << " ";
+    // write mesh data, every list is written in chunks directly into the stream
+    const std::size_t chunkSize = 1 << 16;
+    TextBuffer buf;
+
+    // writing triangle indices
+    buf << "    \"integer triindices\" [";
+    long vi = 0;
+    for (std::vector<FaceMesh>::const_iterator it = meshes.begin(); it != meshes.end(); ++it) {
+        const std::vector<long>& cons = it->indices;
+        for (std::size_t k=0; k < cons.size(); k += 3) {
+            buf << cons[k]+vi << " " << cons[k+2]+vi << " " << cons[k+1]+vi << " ";
         }
-
-        // writing triangle indices
-        for (int k=0; k < nbTriInFace; k++) {
-            triindices << cons[3*k]+vi << " " << cons[3*k+2]+vi << " " << cons[3*k+1]+vi << " ";
+        vi += static_cast<long>(it->vertices.size());
+        buf.flush(out, chunkSize);
+    }
+    buf << "]\n";
+
+    // writing vertices
+    buf << "    \"point P\" [";
+    for (std::vector<FaceMesh>::const_iterator it = meshes.begin(); it != meshes.end(); ++it) {
+        for (std::vector<gp_Vec>::const_iterator jt = it->vertices.begin(); jt != it->vertices.end(); ++jt) {
+            buf << jt->X() << " " << jt->Y() << " " << jt->Z() << " ";
         }
-        
-        vi = vi + nbNodesInFace;
-        
-        delete [] vertexnormals;
-        delete [] vertices;
-        delete [] cons;
-
-        seq.next();
-
-    } // end of face loop
+        buf.flush(out, chunkSize);
+    }
+    buf << "]\n";
+
+    // writing per vertex normals
+    buf << "    \"normal N\" [";
+    for (std::vector<FaceMesh>::const_iterator it = meshes.begin(); it != meshes.end(); ++it) {
+        for (std::vector<gp_Vec>::const_iterator jt = it->normals.begin(); jt != it->normals.end(); ++jt) {
+            buf << jt->X() << " " << jt->Y() << " " << jt->Z() << " ";
+        }
+        buf.flush(out, chunkSize);
+    }
+    buf << "]\n";
+    buf.flush(out);
 
-    // write mesh data
-    out << "    \"integer triindices\" [" << triindices.str() << "]" << endl;
-    out << "    \"point P\" [" << P.str() << "]" << endl;
-    out << "    \"normal N\" [" << N.str() << "]" << endl;
     out << "    \"bool generatetangents\" [\"false\"]" << endl;
     out << "    \"string name\" [\"" << PartName << "\"]" << endl;
     out << "AttributeEnd # \"\"" << endl;
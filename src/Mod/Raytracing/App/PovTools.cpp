@@ -31,11 +31,16 @@
 # include <TopExp_Explorer.hxx>
 # include <TopoDS.hxx>
 # include <TopoDS_Face.hxx>
+# include <algorithm>
 # include <sstream>
 #endif
 
+#include <QThread>
+#include <QtConcurrentMap>
+
 #include <Base/Console.h>
 #include <Base/Exception.h>
+#include <Base/Matrix.h>
 #include <Base/Sequencer.h>
 #include <App/ComplexGeoData.h>
 
@@ -144,14 +149,128 @@ void PovTools::writeCameraVec(const char* FileName, const std::vector<CamDef>& C
     fout.close();
 }
 
+namespace {
+
+// A face and the result of its conversion in a worker thread
+template <typename Result>
+struct FaceTask
+{
+    TopoDS_Face face;
+    Result result;
+};
+
+template <typename Result>
+struct FaceTaskRunner
+{
+    typedef void result_type;
+    typedef void (*Function)(const TopoDS_Face&, Result&);
+
+    FaceTaskRunner(Function func) : func(func) {}
+    void operator() (FaceTask<Result>& task) const
+    {
+        func(task.face, task.result);
+    }
+
+    Function func;
+};
+
+void meshFace(const TopoDS_Face& face, FaceMesh& mesh)
+{
+    PovTools::transferToMesh(face, mesh);
+}
+
+// Transfers the triangulation of a face and formats it as body of a povray mesh2,
+// the text stays empty if the face has no triangulation
+void formatPovFace(const TopoDS_Face& face, std::string& text)
+{
+    FaceMesh mesh;
+    if (!PovTools::transferToMesh(face, mesh))
+        return;
+
+    const std::vector<gp_Vec>& vertices = mesh.vertices;
+    const std::vector<gp_Vec>& normals = mesh.normals;
+    const std::vector<long>& cons = mesh.indices;
+    int nbNodesInFace = static_cast<int>(vertices.size());
+    int nbTriInFace = static_cast<int>(cons.size() / 3);
+
+    TextBuffer out;
+    out.str().reserve(nbNodesInFace * 80 + nbTriInFace * 24 + 128);
+    out << "  vertex_vectors {\n"
+        << "    " << nbNodesInFace << ",\n";
+    // writing vertices
+    for (int i=0; i < nbNodesInFace; i++) {
+        out << "    <" << vertices[i].X() << ","
+            << vertices[i].Z() << ","
+            << vertices[i].Y() << ">,\n";
+    }
+    out << "  }\n"
+    // writing per vertex normals
+        << "  normal_vectors {\n"
+        << "    " << nbNodesInFace << ",\n";
+    for (int j=0; j < nbNodesInFace; j++) {
+        out << "    <" << normals[j].X() << ","
+            << normals[j].Z() << ","
+            << normals[j].Y() << ">,\n";
+    }
+
+    out << "  }\n"
+    // writing triangle indices
+        << "  face_indices {\n"
+        << "    " << nbTriInFace << ",\n";
+    for (int k=0; k < nbTriInFace; k++) {
+        out << "    <" << cons[3*k] << "," << cons[3*k+2] << "," << cons[3*k+1] << ">,\n";
+    }
+    out << "  }\n";
+
+    text.swap(out.str());
+}
+
+// Meshes the shape and converts its faces with \a func in parallel. To limit the
+// memory the faces are handled in blocks and the results of a block are passed
+// to \a sink in the order of the faces. Stops as soon as \a sink returns false.
+template <typename Result, typename Sink>
+void convertFaces(const TopoDS_Shape& Shape, float fMeshDeviation,
+                  void (*func)(const TopoDS_Face&, Result&), Sink sink)
+{
+    Base::Console().Log("Meshing with Deviation: %f\n",fMeshDeviation);
+
+    BRepMesh_IncrementalMesh MESH(Shape,fMeshDeviation,
+                                  /*isRelative*/ Standard_False,
+                                  /*theAngDeflection*/ 0.5,
+                                  /*isInParallel*/ Standard_True);
+
+    std::vector<TopoDS_Face> faces;
+    for (TopExp_Explorer ex(Shape, TopAbs_FACE); ex.More(); ex.Next())
+        faces.push_back(TopoDS::Face(ex.Current()));
+
+    Base::SequencerLauncher seq("Writing file", faces.size() + 1);
+
+    std::size_t blockSize = 4 * static_cast<std::size_t>(std::max(QThread::idealThreadCount(), 1));
+    for (std::size_t i = 0; i < faces.size(); i += blockSize) {
+        std::size_t end = std::min(i + blockSize, faces.size());
+        std::vector<FaceTask<Result> > tasks(end - i);
+        for (std::size_t j = i; j < end; j++)
+            tasks[j - i].face = faces[j];
+        QtConcurrent::blockingMap(tasks, FaceTaskRunner<Result>(func));
+        for (typename std::vector<FaceTask<Result> >::iterator it = tasks.begin(); it != tasks.end(); ++it) {
+            if (!sink(it->result))
+                return;
+            seq.next();
+        }
+    }
+}
+
+}
+
 void PovTools::writeData(const char *FileName, const char *PartName,
                          const Data::ComplexGeoData* data, float /*fMeshDeviation*/)
 {
     // open the file and write
     Base::ofstream fout(FileName);
     // write the file
-    fout <<  "// Written by FreeCAD http://www.freecadweb.org/" << endl;
+    fout <<  "// Written by FreeCAD http://www.freecadweb.org/\n";
 
+    TextBuffer out;
     unsigned long count = data->countSubElements("Face");
     for (unsigned long i=0; i<count; i++) {
         std::vector<Base::Vector3d> points;
@@ -161,45 +280,47 @@ void PovTools::writeData(const char *FileName, const char *PartName,
         data->getFacesFromSubelement(segm, points, normals, facets);
         delete segm;
 
+        long index = static_cast<long>(i);
         // writing per face header
-        fout << "// element number" << i << " +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++" << endl
-             << "#declare " << PartName << i << " = mesh2{" << endl
-             << "  vertex_vectors {" << endl
-             << "    " << points.size() << "," << endl;
+        out << "// element number" << index << " +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++\n"
+            << "#declare " << PartName << index << " = mesh2{\n"
+            << "  vertex_vectors {\n"
+            << "    " << static_cast<long>(points.size()) << ",\n";
 
         // writing vertices
         for (std::vector<Base::Vector3d>::iterator it = points.begin(); it != points.end(); ++it) {
-            fout << "    <"
-                 << it->x << ","
-                 << it->y << ","
-                 << it->z << ">,"
-                 << endl;
+            out << "    <"
+                << it->x << ","
+                << it->y << ","
+                << it->z << ">,\n";
         }
 
         // writing per vertex normals
-        fout << "  }" << endl
-             << "  normal_vectors {" << endl
-             << "    " << normals.size() << "," << endl;
+        out << "  }\n"
+            << "  normal_vectors {\n"
+            << "    " << static_cast<long>(normals.size()) << ",\n";
 
         for (std::vector<Base::Vector3d>::iterator it = normals.begin(); it != normals.end(); ++it) {
-            fout << "    <" 
-                 << it->x << ","
-                 << it->y << ","
-                 << it->z << ">,"
-                 << endl;
+            out << "    <"
+                << it->x << ","
+                << it->y << ","
+                << it->z << ">,\n";
         }
 
         // writing triangle indices
-        fout << "  }" << endl
-             << "  face_indices {" << endl
-             << "    " << facets.size() << "," << endl;
+        out << "  }\n"
+            << "  face_indices {\n"
+            << "    " << static_cast<long>(facets.size()) << ",\n";
         for (std::vector<Data::ComplexGeoData::Facet>::iterator it = facets.begin(); it != facets.end(); ++it) {
-            fout << "    <" << it->I1 << ","<< it->I3 << ","<< it->I2 << ">," << endl;
+            out << "    <" << static_cast<long>(it->I1) << ","
+                << static_cast<long>(it->I3) << ","
+                << static_cast<long>(it->I2) << ">,\n";
         }
 
         // end of face
-        fout << "  }" << endl
-             << "} // end of element" << i << endl << endl;
+        out << "  }\n"
+            << "} // end of element" << index << "\n\n";
+        out.flush(fout);
     }
 
     fout << endl << endl << "// Declare all together +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++" << endl
@@ -223,76 +344,27 @@ void PovTools::writeShape(const char *FileName, const char *PartName,
 void PovTools::writeShape(std::ostream &out, const char *PartName,
                           const TopoDS_Shape& Shape, float fMeshDeviation)
 {
-    Base::Console().Log("Meshing with Deviation: %f\n",fMeshDeviation);
-
-    TopExp_Explorer ex;
-    BRepMesh_IncrementalMesh MESH(Shape,fMeshDeviation);
-
-
-    // counting faces and start sequencer
-    int l = 1;
-    for (ex.Init(Shape, TopAbs_FACE); ex.More(); ex.Next(),l++) {}
-    Base::SequencerLauncher seq("Writing file", l);
-
     // write the file
     out <<  "// Written by FreeCAD http://www.freecadweb.org/" << endl;
-    l = 1;
-    for (ex.Init(Shape, TopAbs_FACE); ex.More(); ex.Next(),l++) {
-
-        // get the shape and mesh it
-        const TopoDS_Face& aFace = TopoDS::Face(ex.Current());
 
-        // this block mesh the face and transfers it in a C array of vertices and face indexes
-        Standard_Integer nbNodesInFace,nbTriInFace;
-        gp_Vec* vertices=0;
-        gp_Vec* vertexnormals=0;
-        long* cons=0;
-
-        transferToArray(aFace,&vertices,&vertexnormals,&cons,nbNodesInFace,nbTriInFace);
-
-        if (!vertices) break;
-        // writing per face header
-        out << "// face number" << l << " +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++" << endl
-        << "#declare " << PartName << l << " = mesh2{" << endl
-        << "  vertex_vectors {" << endl
-        << "    " << nbNodesInFace << "," << endl;
-        // writing vertices
-        for (int i=0; i < nbNodesInFace; i++) {
-            out << "    <" << vertices[i].X() << ","
-            << vertices[i].Z() << ","
-            << vertices[i].Y() << ">,"
-            << endl;
-        }
-        out << "  }" << endl
-        // writing per vertex normals
-        << "  normal_vectors {" << endl
-        << "    " << nbNodesInFace << "," << endl;
-        for (int j=0; j < nbNodesInFace; j++) {
-            out << "    <" << vertexnormals[j].X() << ","
-            << vertexnormals[j].Z() << ","
-            << vertexnormals[j].Y() << ">,"
-            << endl;
+    // the faces are meshed and formatted in parallel and written in their
+    // original order directly into the stream
+    int l = 1;
+    convertFaces(Shape, fMeshDeviation, formatPovFace, [&](const std::string& body) -> bool {
+        if (body.empty()) {
+            Base::Console().Log("Empty face triangulation\n");
+            return false;
         }
 
-        out << "  }" << endl
-        // writing triangle indices
-        << "  face_indices {" << endl
-        << "    " << nbTriInFace << "," << endl;
-        for (int k=0; k < nbTriInFace; k++) {
-            out << "    <" << cons[3*k] << ","<< cons[3*k+2] << ","<< cons[3*k+1] << ">," << endl;
-        }
+        // writing per face header
+        out << "// face number" << l << " +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++\n"
+            << "#declare " << PartName << l << " = mesh2{\n";
+        out.write(body.c_str(), body.size());
         // end of face
-        out << "  }" << endl
-        << "} // end of Face"<< l << endl << endl;
-
-        delete [] vertexnormals;
-        delete [] vertices;
-        delete [] cons;
-
-        seq.next();
-
-    } // end of face loop
-
+        out << "} // end of Face" << l << "\n\n";
+        l++;
+        return true;
+    });
 
     out << endl << endl << "// Declare all together +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++" << endl
     << "#declare " << PartName << " = union {" << endl;
@@ -309,74 +381,101 @@ void PovTools::writeShapeCSV(const char *FileName,
 {
     const char cSeperator = ',';
 
-    Base::Console().Log("Meshing with Deviation: %f\n",fMeshDeviation);
-
-    TopExp_Explorer ex;
-    BRepMesh_IncrementalMesh MESH(Shape,fMeshDeviation);
-
     // open the file and write
     std::ofstream fout(FileName);
 
-    // counting faces and start sequencer
-    int l = 1;
-    for (ex.Init(Shape, TopAbs_FACE); ex.More(); ex.Next(),l++) {}
-    Base::SequencerLauncher seq("Writing file", l);
-
-    // write the file
-    l = 1;
-    for (ex.Init(Shape, TopAbs_FACE); ex.More(); ex.Next(),l++) {
-
-        // get the shape and mesh it
-        const TopoDS_Face& aFace = TopoDS::Face(ex.Current());
-
-        // this block mesh the face and transfers it in a C array of vertices and face indexes
-        Standard_Integer nbNodesInFace,nbTriInFace;
-        gp_Vec* vertices=0;
-        gp_Vec* vertexnormals=0;
-        long* cons=0;
-
-        transferToArray(aFace,&vertices,&vertexnormals,&cons,nbNodesInFace,nbTriInFace);
+    TextBuffer out;
+    convertFaces(Shape, fMeshDeviation, meshFace, [&](const FaceMesh& mesh) -> bool {
+        if (mesh.vertices.empty()) {
+            Base::Console().Log("Empty face triangulation\n");
+            return false;
+        }
 
-        if (!vertices) break;
-        // writing per face header
         // writing vertices
-        for (int i=0; i < nbNodesInFace; i++) {
-            fout << vertices[i].X() << cSeperator
-            << vertices[i].Z() << cSeperator
-            << vertices[i].Y() << cSeperator
-            << vertexnormals[i].X() * fLength <<cSeperator
-            << vertexnormals[i].Z() * fLength <<cSeperator
-            << vertexnormals[i].Y() * fLength <<cSeperator
-            << endl;
+        const std::vector<gp_Vec>& vertices = mesh.vertices;
+        const std::vector<gp_Vec>& vertexnormals = mesh.normals;
+        for (std::size_t i=0; i < vertices.size(); i++) {
+            out << vertices[i].X() << cSeperator
+                << vertices[i].Z() << cSeperator
+                << vertices[i].Y() << cSeperator
+                << vertexnormals[i].X() * fLength << cSeperator
+                << vertexnormals[i].Z() * fLength << cSeperator
+                << vertexnormals[i].Y() * fLength << cSeperator
+                << '\n';
         }
+        out.flush(fout);
+        return true;
+    });
 
-        delete [] vertexnormals;
-        delete [] vertices;
-        delete [] cons;
+    fout.close();
+}
 
-        seq.next();
+void PovTools::writeMatrix(std::ostream &out, const Base::Matrix4D& mat)
+{
+    if (mat == Base::Matrix4D())
+        return;
 
-    } // end of face loop
+    // povray transforms row vectors and has the y and z axes swapped
+    static const int axis[3] = {0, 2, 1};
+    out << "  matrix <";
+    for (int i=0; i < 4; i++) {
+        for (int j=0; j < 3; j++) {
+            if (i > 0 || j > 0)
+                out << ",";
+            out << mat[axis[j]][i < 3 ? axis[i] : 3];
+        }
+    }
+    out << ">" << endl;
+}
 
-    fout.close();
+void PovTools::meshShape(const TopoDS_Shape& Shape, float fMeshDeviation,
+                         std::vector<FaceMesh>& meshes)
+{
+    convertFaces(Shape, fMeshDeviation, meshFace, [&](FaceMesh& mesh) -> bool {
+        if (mesh.vertices.empty()) {
+            Base::Console().Log("Empty face triangulation\n");
+            return false;
+        }
+        meshes.push_back(FaceMesh());
+        meshes.back().vertices.swap(mesh.vertices);
+        meshes.back().normals.swap(mesh.normals);
+        meshes.back().indices.swap(mesh.indices);
+        return true;
+    });
 }
 
 void PovTools::transferToArray(const TopoDS_Face& aFace,gp_Vec** vertices,gp_Vec** vertexnormals, long** cons,int &nbNodesInFace,int &nbTriInFace )
 {
-    TopLoc_Location aLoc;
-
-    // doing the meshing and checking the result
-    //BRepMesh_IncrementalMesh MESH(aFace,fDeflection);
-    Handle(Poly_Triangulation) aPoly = BRep_Tool::Triangulation(aFace,aLoc);
-    if (aPoly.IsNull()) {
+    FaceMesh mesh;
+    if (!transferToMesh(aFace, mesh)) {
         Base::Console().Log("Empty face triangulation\n");
         nbNodesInFace =0;
         nbTriInFace = 0;
-        vertices = 0l;
-        cons = 0l;
+        *vertices = 0;
+        *vertexnormals = 0;
+        *cons = 0;
         return;
     }
 
+    nbNodesInFace = static_cast<int>(mesh.vertices.size());
+    nbTriInFace = static_cast<int>(mesh.indices.size() / 3);
+    *vertices = new gp_Vec[nbNodesInFace];
+    *vertexnormals = new gp_Vec[nbNodesInFace];
+    *cons = new long[3*(nbTriInFace)+1];
+    std::copy(mesh.vertices.begin(), mesh.vertices.end(), *vertices);
+    std::copy(mesh.normals.begin(), mesh.normals.end(), *vertexnormals);
+    std::copy(mesh.indices.begin(), mesh.indices.end(), *cons);
+}
+
+bool PovTools::transferToMesh(const TopoDS_Face& aFace, FaceMesh& mesh)
+{
+    TopLoc_Location aLoc;
+
+    // doing the meshing and checking the result
+    Handle(Poly_Triangulation) aPoly = BRep_Tool::Triangulation(aFace,aLoc);
+    if (aPoly.IsNull())
+        return false;
+
     // getting the transformation of the shape/face
     gp_Trsf myTransf;
     Standard_Boolean identity = true;
@@ -387,15 +486,14 @@ void PovTools::transferToArray(const TopoDS_Face& aFace,gp_Vec** vertices,gp_Vec
 
     Standard_Integer i;
     // getting size and create the array
-    nbNodesInFace = aPoly->NbNodes();
-    nbTriInFace = aPoly->NbTriangles();
-    *vertices = new gp_Vec[nbNodesInFace];
-    *vertexnormals = new gp_Vec[nbNodesInFace];
-    for (i=0; i < nbNodesInFace; i++) {
-        (*vertexnormals)[i]= gp_Vec(0.0,0.0,0.0);
-    }
-
-    *cons = new long[3*(nbTriInFace)+1];
+    Standard_Integer nbNodesInFace = aPoly->NbNodes();
+    Standard_Integer nbTriInFace = aPoly->NbTriangles();
+    std::vector<gp_Vec>& vertices = mesh.vertices;
+    std::vector<gp_Vec>& vertexnormals = mesh.normals;
+    std::vector<long>& cons = mesh.indices;
+    vertices.resize(nbNodesInFace);
+    vertexnormals.assign(nbNodesInFace, gp_Vec(0.0,0.0,0.0));
+    cons.resize(3*nbTriInFace);
 
     // check orientation
     TopAbs_Orientation orient = aFace.Orientation();
@@ -431,59 +529,57 @@ void PovTools::transferToArray(const TopoDS_Face& aFace,gp_Vec** vertices,gp_Vec
         gp_Vec v1(V1.X(),V1.Y(),V1.Z()),v2(V2.X(),V2.Y(),V2.Z()),v3(V3.X(),V3.Y(),V3.Z());
         gp_Vec Normal = (v2-v1)^(v3-v1);
 
-        //Standard_Real Area = 0.5 * Normal.Magnitude();
-
         // add the triangle normal to the vertex normal for all points of this triangle
-        (*vertexnormals)[N1-1] += gp_Vec(Normal.X(),Normal.Y(),Normal.Z());
-        (*vertexnormals)[N2-1] += gp_Vec(Normal.X(),Normal.Y(),Normal.Z());
-        (*vertexnormals)[N3-1] += gp_Vec(Normal.X(),Normal.Y(),Normal.Z());
-
-        (*vertices)[N1-1].SetX((float)(V1.X()));
-        (*vertices)[N1-1].SetY((float)(V1.Y()));
-        (*vertices)[N1-1].SetZ((float)(V1.Z()));
-        (*vertices)[N2-1].SetX((float)(V2.X()));
-        (*vertices)[N2-1].SetY((float)(V2.Y()));
-        (*vertices)[N2-1].SetZ((float)(V2.Z()));
-        (*vertices)[N3-1].SetX((float)(V3.X()));
-        (*vertices)[N3-1].SetY((float)(V3.Y()));
-        (*vertices)[N3-1].SetZ((float)(V3.Z()));
+        vertexnormals[N1-1] += Normal;
+        vertexnormals[N2-1] += Normal;
+        vertexnormals[N3-1] += Normal;
+
+        vertices[N1-1].SetCoord((float)(V1.X()), (float)(V1.Y()), (float)(V1.Z()));
+        vertices[N2-1].SetCoord((float)(V2.X()), (float)(V2.Y()), (float)(V2.Z()));
+        vertices[N3-1].SetCoord((float)(V3.X()), (float)(V3.Y()), (float)(V3.Z()));
 
         int j = i - 1;
-        N1--;
-        N2--;
-        N3--;
-        (*cons)[3*j] = N1;
-        (*cons)[3*j+1] = N2;
-        (*cons)[3*j+2] = N3;
+        cons[3*j] = N1 - 1;
+        cons[3*j+1] = N2 - 1;
+        cons[3*j+2] = N3 - 1;
+    }
+
+    // the projection is initialized once per face and reused for all vertices
+    Handle(Geom_Surface) Surface;
+    GeomAPI_ProjectPointOnSurf ProPntSrf;
+    try {
+        Surface = BRep_Tool::Surface(aFace);
+        if (!Surface.IsNull()) {
+            Standard_Real u1, u2, v1, v2;
+            Surface->Bounds(u1, u2, v1, v2);
+            ProPntSrf.Init(Surface, u1, u2, v1, v2);
+        }
+    }
+    catch (...) {
+        Surface.Nullify();
     }
 
     // normalize all vertex normals
     for (i=0; i < nbNodesInFace; i++) {
-
-        gp_Dir clNormal;
-
-        try {
-            Handle(Geom_Surface) Surface = BRep_Tool::Surface(aFace);
-
-            gp_Pnt vertex((*vertices)[i].XYZ());
-//     gp_Pnt vertex((*vertices)[i][0], (*vertices)[i][1], (*vertices)[i][2]);
-            GeomAPI_ProjectPointOnSurf ProPntSrf(vertex, Surface);
-            Standard_Real fU, fV;
-            ProPntSrf.Parameters(1, fU, fV);
-
-            GeomLProp_SLProps clPropOfFace(Surface, fU, fV, 2, gp::Resolution());
-
-            clNormal = clPropOfFace.Normal();
-            gp_Vec temp = clNormal;
-            //Base::Console().Log("unterschied:%.2f",temp.dot((*vertexnormals)[i]));
-            if ( temp * (*vertexnormals)[i] < 0 )
-                temp = -temp;
-            (*vertexnormals)[i] = temp;
-
-        }
-        catch (...) {
+        if (!Surface.IsNull()) {
+            try {
+                ProPntSrf.Perform(gp_Pnt(vertices[i].XYZ()));
+                Standard_Real fU, fV;
+                ProPntSrf.Parameters(1, fU, fV);
+
+                GeomLProp_SLProps clPropOfFace(Surface, fU, fV, 2, gp::Resolution());
+
+                gp_Vec temp = clPropOfFace.Normal();
+                if ( temp * vertexnormals[i] < 0 )
+                    temp = -temp;
+                vertexnormals[i] = temp;
+            }
+            catch (...) {
+            }
         }
 
-        (*vertexnormals)[i].Normalize();
+        vertexnormals[i].Normalize();
     }
+
+    return true;
 }
@@ -25,11 +25,15 @@
 #define _PovTools_h_
 
 #include <gp_Vec.hxx>
+#include <cstdio>
+#include <ostream>
+#include <string>
 #include <vector>
 
 class TopoDS_Shape;
 class TopoDS_Face;
 
+namespace Base { class Matrix4D; }
 namespace Data { class ComplexGeoData; }
 
 namespace Raytracing
@@ -70,6 +74,75 @@ public:
     gp_Vec Up;
 };
 
+/// triangulation of a face with normalized per vertex normals
+class FaceMesh
+{
+public:
+    std::vector<gp_Vec> vertices;
+    std::vector<gp_Vec> normals;
+    /// zero based vertex indices, three per triangle
+    std::vector<long> indices;
+};
+
+/** Text buffer for writing large meshes
+ * Numbers are formatted with the same result as std::ostream with its
+ * default settings but without the overhead of the stream.
+ */
+class TextBuffer
+{
+public:
+    TextBuffer& operator << (const char* s) {
+        buffer += s;
+        return *this;
+    }
+    TextBuffer& operator << (const std::string& s) {
+        buffer += s;
+        return *this;
+    }
+    TextBuffer& operator << (char c) {
+        buffer += c;
+        return *this;
+    }
+    TextBuffer& operator << (double v) {
+        char buf[32];
+        int len = snprintf(buf, sizeof(buf), "%g", v);
+        buffer.append(buf, len);
+        return *this;
+    }
+    TextBuffer& operator << (long v) {
+        char buf[24];
+        char* end = buf + sizeof(buf);
+        char* pos = end;
+        unsigned long u = v < 0 ? 0UL - static_cast<unsigned long>(v) : static_cast<unsigned long>(v);
+        do {
+            *--pos = static_cast<char>('0' + u % 10);
+            u /= 10;
+        }
+        while (u);
+        if (v < 0)
+            *--pos = '-';
+        buffer.append(pos, end - pos);
+        return *this;
+    }
+    TextBuffer& operator << (int v) {
+        return *this << static_cast<long>(v);
+    }
+
+    std::string& str() {
+        return buffer;
+    }
+    /// writes the buffer into the stream once it holds at least \a minSize bytes
+    void flush(std::ostream& out, std::size_t minSize=0) {
+        if (buffer.size() >= minSize) {
+            out.write(buffer.c_str(), buffer.size());
+            buffer.clear();
+        }
+    }
+
+private:
+    std::string buffer;
+};
+
 
 class AppRaytracingExport PovTools
 {
@@ -111,6 +184,17 @@ public:
                               float fMeshDeviation,
                               float fLength);
 
+    /// write a placement as povray matrix modifier, nothing is written for the identity
+    static void writeMatrix(std::ostream &out,
+                            const Base::Matrix4D& mat);
+
+    /// mesh a shape and transfer the triangulation of its faces, the faces are handled in parallel
+    static void meshShape(const TopoDS_Shape& Shape,
+                          float fMeshDeviation,
+                          std::vector<FaceMesh>& meshes);
+
+    /// transfer the triangulation of a meshed face, returns false if the face has no triangulation
+    static bool transferToMesh(const TopoDS_Face& aFace, FaceMesh& mesh);
 
     static void transferToArray(const TopoDS_Face& aFace,gp_Vec** vertices,gp_Vec** vertexnormals, long** cons,int &nbNodesInFace,int &nbTriInFace );
 };
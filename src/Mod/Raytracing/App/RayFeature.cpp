@@ -25,10 +25,14 @@
 
 #ifndef _PreComp_
 # include <Standard.hxx>
+# include <TopLoc_Location.hxx>
+# include <set>
 #endif
 
 #include <Base/Exception.h>
 #include <Base/FileInfo.h>
+#include <App/Document.h>
+#include <App/Link.h>
 #include <Mod/Part/App/PartFeature.h>
 
 #include "RayFeature.h"
@@ -40,6 +44,66 @@ using namespace std;
 
 PROPERTY_SOURCE(Raytracing::RayFeature, Raytracing::RaySegment)
 
+namespace {
+
+// An object to render and its placement, which is either its own one or
+// the one of the link that instantiates it
+struct RayInstance
+{
+    App::DocumentObject* object;
+    Base::Matrix4D matrix;
+    bool linked;
+};
+
+// Resolves App::Link and link arrays to the objects they instantiate
+void getInstances(App::DocumentObject* obj, std::vector<RayInstance>& instances)
+{
+    Base::Matrix4D mat;
+    App::DocumentObject* linked = obj->getLinkedObject(true, &mat, true);
+    if (!linked)
+        return;
+
+    App::LinkBaseExtension* ext = linked->getExtensionByType<App::LinkBaseExtension>(true);
+    int count = ext ? ext->_getElementCountValue() : 0;
+    if (count > 0) {
+        const std::vector<App::DocumentObject*>& elements = ext->_getElementListValue();
+        std::vector<Base::Placement> placements = ext->getPlacementListValue();
+        std::vector<Base::Vector3d> scales = ext->getScaleListValue();
+        for (int i = 0; i < count; i++) {
+            RayInstance instance;
+            instance.matrix = mat;
+            instance.linked = true;
+            if (i < static_cast<int>(elements.size())) {
+                if (!elements[i])
+                    continue;
+                instance.object = elements[i]->getLinkedObject(true, &instance.matrix, true);
+            }
+            else {
+                // the array elements are not exposed as objects
+                if (i < static_cast<int>(placements.size()))
+                    instance.matrix *= placements[i].toMatrix();
+                if (i < static_cast<int>(scales.size())) {
+                    Base::Matrix4D s;
+                    s.scale(scales[i]);
+                    instance.matrix *= s;
+                }
+                instance.object = ext->getTrueLinkedObject(true, &instance.matrix);
+            }
+            if (instance.object)
+                instances.push_back(instance);
+        }
+        return;
+    }
+
+    RayInstance instance;
+    instance.object = linked;
+    instance.matrix = mat;
+    instance.linked = (linked != obj);
+    instances.push_back(instance);
+}
+
+}
+
 //===========================================================================
 // Feature
 //===========================================================================
@@ -70,31 +134,59 @@ App::DocumentObjectExecReturn *RayFeature::execute(void)
     App::DocumentObject* link = Source.getValue();
     if (!link)
         return new App::DocumentObjectExecReturn("No object linked");
-    if (!link->getTypeId().isDerivedFrom(Part::Feature::getClassTypeId()))
-        return new App::DocumentObjectExecReturn("Linked object is not a Part object");
-    TopoDS_Shape shape = static_cast<Part::Feature*>(link)->Shape.getShape().getShape();
-    std::string Name(std::string("Pov_")+static_cast<Part::Feature*>(link)->getNameInDocument());
-    if (shape.IsNull())
-        return new App::DocumentObjectExecReturn("Linked shape object is empty");
 
-    PovTools::writeShape(result,Name.c_str(),shape);
+    std::vector<RayInstance> instances;
+    getInstances(link, instances);
+    if (instances.empty())
+        return new App::DocumentObjectExecReturn("No object linked");
 
     // This must not be done in PovTools::writeShape!
+    std::stringstream texture;
     long t = Transparency.getValue();
     const App::Color& c = Color.getValue();
-    result << "// instance to render" << endl
-           << "object {" << Name << endl
-           << " texture {" << endl;
+    texture << " texture {" << endl;
     if (t == 0) {
-        result << "      pigment {color rgb <"<<c.r<<","<<c.g<<","<<c.b<<">}" << endl;
+        texture << "      pigment {color rgb <"<<c.r<<","<<c.g<<","<<c.b<<">}" << endl;
     }
     else {
         float trans = t/100.0f;
-        result << "      pigment {color rgb <"<<c.r<<","<<c.g<<","<<c.b<<"> transmit "<<trans<<"}" << endl;
+        texture << "      pigment {color rgb <"<<c.r<<","<<c.g<<","<<c.b<<"> transmit "<<trans<<"}" << endl;
+    }
+    texture << "      finish {StdFinish } //definition on top of the project" << endl
+            << "  }" << endl;
+
+    std::set<App::DocumentObject*> declared;
+    for (std::vector<RayInstance>::iterator it = instances.begin(); it != instances.end(); ++it) {
+        if (!it->object->getTypeId().isDerivedFrom(Part::Feature::getClassTypeId()))
+            return new App::DocumentObjectExecReturn("Linked object is not a Part object");
+        const Part::TopoShape& tshape = static_cast<Part::Feature*>(it->object)->Shape.getShape();
+        if (tshape.isNull())
+            return new App::DocumentObjectExecReturn("Linked shape object is empty");
+
+        std::string Name(std::string("Pov_"));
+        if (it->object->getDocument() != getDocument())
+            Name += std::string(it->object->getDocument()->getName()) + "_";
+        Name += it->object->getNameInDocument();
+
+        // The mesh is written once in the local coordinates of the object and
+        // is shared by all its instances. The guard also skips it if another
+        // feature of the project has declared it already.
+        if (declared.insert(it->object).second) {
+            TopoDS_Shape shape = tshape.getShape().Located(TopLoc_Location());
+            result << "#ifndef (" << Name << ")" << endl;
+            PovTools::writeShape(result,Name.c_str(),shape);
+            result << "#end" << endl;
+        }
+
+        if (!it->linked)
+            it->matrix = tshape.getTransform();
+
+        result << "// instance to render" << endl
+               << "object {" << Name << endl;
+        PovTools::writeMatrix(result, it->matrix);
+        result << texture.str()
+               << "}" << endl;
     }
-    result << "      finish {StdFinish } //definition on top of the project" << endl
-           << "  }" << endl
-           << "}" << endl   ;
 
     // Apply the resulting fragment
     Result.setValue(result.str().c_str());
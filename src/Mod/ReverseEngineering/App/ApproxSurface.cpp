@@ -22,13 +22,12 @@
 
 
 #include "PreCompiled.h"
-#include <math_Gauss.hxx>
-#include <math_Householder.hxx>
 #include <Geom_BSplineSurface.hxx>
 #include <Precision.hxx>
 
 #include <QFuture>
 #include <QFutureWatcher>
+#include <QThread>
 #include <QtConcurrentMap>
 #include <boost_bind_bind.hpp>
 
@@ -768,14 +767,10 @@ BSplineParameterCorrection::BSplineParameterCorrection(unsigned usUOrder, unsign
   : ParameterCorrection(usUOrder, usVOrder, usUCtrlpoints, usVCtrlpoints)
   , _clUSpline(usUCtrlpoints+usUOrder)
   , _clVSpline(usVCtrlpoints+usVOrder)
-  , _clSmoothMatrix(0,usUCtrlpoints*usVCtrlpoints-1,
-                    0,usUCtrlpoints*usVCtrlpoints-1)
-  , _clFirstMatrix (0,usUCtrlpoints*usVCtrlpoints-1,
-                    0,usUCtrlpoints*usVCtrlpoints-1)
-  , _clSecondMatrix(0,usUCtrlpoints*usVCtrlpoints-1,
-                    0,usUCtrlpoints*usVCtrlpoints-1)
-  , _clThirdMatrix (0,usUCtrlpoints*usVCtrlpoints-1,
-                    0,usUCtrlpoints*usVCtrlpoints-1)
+  , _clSmoothMatrix(usUCtrlpoints*usVCtrlpoints, usUCtrlpoints*usVCtrlpoints)
+  , _clFirstMatrix (usUCtrlpoints*usVCtrlpoints, usUCtrlpoints*usVCtrlpoints)
+  , _clSecondMatrix(usUCtrlpoints*usVCtrlpoints, usUCtrlpoints*usVCtrlpoints)
+  , _clThirdMatrix (usUCtrlpoints*usVCtrlpoints, usUCtrlpoints*usVCtrlpoints)
 {
     Init();
 }
@@ -785,10 +780,10 @@ void BSplineParameterCorrection::Init()
     // Initialisierungen
     _pvcUVParam       = NULL;
     _pvcPoints        = NULL;
-    _clFirstMatrix.Init(0.0);
-    _clSecondMatrix.Init(0.0);
-    _clThirdMatrix.Init(0.0);
-    _clSmoothMatrix.Init(0.0);
+    _clFirstMatrix.setZero();
+    _clSecondMatrix.setZero();
+    _clThirdMatrix.setZero();
+    _clSmoothMatrix.setZero();
 
     /* Berechne die Knotenvektoren */
     unsigned usUMax = _usUCtrlpoints-_usUOrder+1;
@@ -929,74 +924,182 @@ void BSplineParameterCorrection::DoParameterCorrection(int iIter)
     while(i<iIter && fMaxDiff > Precision::Confusion() && fMaxScalar < 0.99);
 }
 
-bool BSplineParameterCorrection::SolveWithoutSmoothing()
+namespace Reen {
+/**
+ * Accumulates the normal equations M^T*M*X = M^T*b of the least-squares fit over
+ * a range of points. A B-spline basis function has local support, so a point only
+ * contributes to the uOrder*vOrder control points whose basis functions are non-zero
+ * at its parameters. Thus M itself is never built and M^T*M is stored as a band of
+ * (2*uOrder-1)*(2*vOrder-1) entries per row.
+ */
+class NormalEquations
 {
-    unsigned ulSize = _pvcPoints->Length();
-    unsigned ulDim  = _usUCtrlpoints*_usVCtrlpoints;
-    math_Matrix M  (0, ulSize-1, 0, ulDim-1);
-    math_Matrix Xx (0, ulDim-1, 0, 0);
-    math_Matrix Xy (0, ulDim-1, 0, 0);
-    math_Matrix Xz (0, ulDim-1, 0, 0);
-    math_Vector bx (0, ulSize-1);
-    math_Vector by (0, ulSize-1);
-    math_Vector bz (0, ulSize-1);
-
-    //Bestimmung der Koeffizientenmatrix des ueberbestimmten LGS
-    for (unsigned i=0; i<ulSize; i++) {
-        const gp_Pnt2d& uvValue = (*_pvcUVParam)(i);
-        double fU = uvValue.X();
-        double fV = uvValue.Y();
-        unsigned ulIdx=0;
-
-        // Vorberechnung der Werte der Basis-Funktionen
-        std::vector<double> basisU(_usUCtrlpoints);
-        for (unsigned j=0; j<_usUCtrlpoints; j++) {
-            basisU[j] = _clUSpline.BasisFunction(j,fU);
-        }
-        std::vector<double> basisV(_usVCtrlpoints);
-        for (unsigned k=0; k<_usVCtrlpoints; k++) {
-            basisV[k] = _clVSpline.BasisFunction(k,fV);
-        }
-
-        for (unsigned j=0; j<_usUCtrlpoints; j++) {
-            double valueU = basisU[j];
-            if (valueU == 0.0) {
-                for (unsigned k=0; k<_usVCtrlpoints; k++) {
-                    M(i,ulIdx) = 0.0;
-                    ulIdx++;
-                }
-            }
-            else {
-                for (unsigned k=0; k<_usVCtrlpoints; k++) {
-                    M(i,ulIdx) = valueU * basisV[k];
-                    ulIdx++;
+public:
+    struct Result
+    {
+        std::vector<double> band;
+        std::vector<gp_XYZ> rhs;
+    };
+
+    NormalEquations(BSplineBasis& uSpline, BSplineBasis& vSpline,
+                    unsigned uOrder, unsigned vOrder, unsigned uCtrl, unsigned vCtrl,
+                    const TColgp_Array1OfPnt& points, const TColgp_Array1OfPnt2d& uvParams)
+      : uSpline(uSpline), vSpline(vSpline)
+      , uOrder(uOrder), vOrder(vOrder), uCtrl(uCtrl), vCtrl(vCtrl)
+      , points(points), uvParams(uvParams)
+    {
+    }
+    int bandWidth() const
+    {
+        return (2*uOrder-1)*(2*vOrder-1);
+    }
+    /// offset of the entry (j+du,k+dv) in the band of row (j,k)
+    int bandOffset(int du, int dv) const
+    {
+        return (du+uOrder-1)*(2*vOrder-1) + (dv+vOrder-1);
+    }
+    Result accumulate(const std::pair<int,int>& range) const
+    {
+        Result res;
+        res.band.resize(uCtrl*vCtrl*bandWidth(), 0.0);
+        res.rhs.resize(uCtrl*vCtrl, gp_XYZ(0.0,0.0,0.0));
+
+        std::vector<double> basisU(uOrder), basisV(vOrder);
+        for (int i=range.first; i<range.second; i++) {
+            const gp_Pnt2d& uvValue = uvParams(i);
+            double fU = uvValue.X();
+            double fV = uvValue.Y();
+            // all basis functions are zero outside of the knot range [0,1]
+            if (fU < 0.0 || fU > 1.0 || fV < 0.0 || fV > 1.0)
+                continue;
+
+            // only the basis functions of the knot span are non-zero
+            int firstU = uSpline.FindSpan(fU) - (uOrder-1);
+            int firstV = vSpline.FindSpan(fV) - (vOrder-1);
+            for (int j=0; j<uOrder; j++)
+                basisU[j] = uSpline.BasisFunction(firstU+j, fU);
+            for (int k=0; k<vOrder; k++)
+                basisV[k] = vSpline.BasisFunction(firstV+k, fV);
+
+            const gp_XYZ& pnt = points(i).XYZ();
+            for (int j=0; j<uOrder; j++) {
+                for (int k=0; k<vOrder; k++) {
+                    double value = basisU[j] * basisV[k];
+                    if (value == 0.0)
+                        continue;
+                    int row = (firstU+j)*vCtrl + (firstV+k);
+                    res.rhs[row] += value * pnt;
+                    double* band = &res.band[row*bandWidth()];
+                    for (int l=0; l<uOrder; l++) {
+                        for (int m=0; m<vOrder; m++) {
+                            band[bandOffset(l-j, m-k)] += value * basisU[l] * basisV[m];
+                        }
+                    }
                 }
             }
         }
+
+        return res;
     }
 
-    //Bestimmen der rechten Seite
-    for (int ii=_pvcPoints->Lower(); ii<=_pvcPoints->Upper(); ii++) {
-        const gp_Pnt& pnt = (*_pvcPoints)(ii);
-        bx(ii) = pnt.X(); by(ii) = pnt.Y(); bz(ii) = pnt.Z();
+private:
+    BSplineBasis& uSpline;
+    BSplineBasis& vSpline;
+    int uOrder, vOrder, uCtrl, vCtrl;
+    const TColgp_Array1OfPnt& points;
+    const TColgp_Array1OfPnt2d& uvParams;
+};
+}
+
+bool BSplineParameterCorrection::SolveWithoutSmoothing()
+{
+    return SolveNormalEquations(0.0);
+}
+
+bool BSplineParameterCorrection::SolveWithSmoothing(double fWeight)
+{
+    return SolveNormalEquations(fWeight);
+}
+
+bool BSplineParameterCorrection::SolveNormalEquations(double fWeight)
+{
+    int iVCtrl = static_cast<int>(_usVCtrlpoints);
+    int iUCtrl = static_cast<int>(_usUCtrlpoints);
+    int ulDim  = iUCtrl*iVCtrl;
+
+    // Die Punkte werden in Bloecken parallel aufsummiert
+    int numThreads = std::max(1, QThread::idealThreadCount());
+    int lower = _pvcPoints->Lower();
+    int upper = _pvcPoints->Upper()+1;
+    int step = std::max(1, (upper-lower+numThreads-1)/numThreads);
+    std::vector< std::pair<int,int> > ranges;
+    for (int i=lower; i<upper; i+=step)
+        ranges.push_back(std::make_pair(i, std::min(i+step, upper)));
+
+    NormalEquations equations(_clUSpline, _clVSpline, _usUOrder, _usVOrder,
+                              _usUCtrlpoints, _usVCtrlpoints, *_pvcPoints, *_pvcUVParam);
+    QFuture<NormalEquations::Result> future = QtConcurrent::mapped
+        (ranges, boost::bind(&NormalEquations::accumulate, &equations, bp::_1));
+    QFutureWatcher<NormalEquations::Result> watcher;
+    watcher.setFuture(future);
+    watcher.waitForFinished();
+
+    int bandWidth = equations.bandWidth();
+    std::vector<double> band(ulDim*bandWidth, 0.0);
+    Eigen::MatrixXd b = Eigen::MatrixXd::Zero(ulDim, 3);
+    for (QFuture<NormalEquations::Result>::const_iterator it = future.begin(); it != future.end(); ++it) {
+        for (std::size_t i=0; i<band.size(); i++)
+            band[i] += it->band[i];
+        for (int i=0; i<ulDim; i++) {
+            b(i,0) += it->rhs[i].X();
+            b(i,1) += it->rhs[i].Y();
+            b(i,2) += it->rhs[i].Z();
+        }
     }
 
-    // Loese das ueberbest. LGS mit der Householder-Transformation
-    math_Householder hhX(M,bx);
-    math_Householder hhY(M,by);
-    math_Householder hhZ(M,bz);
+    // Die quadratische Systemmatrix ist duenn besetzt
+    std::vector< Eigen::Triplet<double> > triplets;
+    triplets.reserve(ulDim*bandWidth);
+    int iUOrder = static_cast<int>(_usUOrder);
+    int iVOrder = static_cast<int>(_usVOrder);
+    for (int row=0; row<ulDim; row++) {
+        int j = row / iVCtrl;
+        int k = row % iVCtrl;
+        for (int du=1-iUOrder; du<iUOrder; du++) {
+            if (j+du < 0 || j+du >= iUCtrl)
+                continue;
+            for (int dv=1-iVOrder; dv<iVOrder; dv++) {
+                if (k+dv < 0 || k+dv >= iVCtrl)
+                    continue;
+                double value = band[row*bandWidth + equations.bandOffset(du, dv)];
+                if (value != 0.0)
+                    triplets.push_back(Eigen::Triplet<double>(row, (j+du)*iVCtrl+k+dv, value));
+            }
+        }
+    }
 
-    if (!(hhX.IsDone() && hhY.IsDone() && hhZ.IsDone()))
-        //LGS konnte nicht geloest werden
-        return false;
-    Xx = hhX.AllValues();
-    Xy = hhY.AllValues();
-    Xz = hhZ.AllValues();
+    SparseMatrix A(ulDim, ulDim);
+    A.setFromTriplets(triplets.begin(), triplets.end());
+    if (fWeight != 0.0)
+        A += fWeight * _clSmoothMatrix;
+
+    // Loese das LGS mit der Cholesky-Zerlegung und falls die Systemmatrix
+    // singulaer ist mit dem CG-Verfahren
+    Eigen::MatrixXd X;
+    Eigen::SimplicialLDLT<SparseMatrix> ldlt(A);
+    if (ldlt.info() == Eigen::Success)
+        X = ldlt.solve(b);
+    if (ldlt.info() != Eigen::Success) {
+        Eigen::ConjugateGradient<SparseMatrix, Eigen::Lower|Eigen::Upper> cg(A);
+        X = cg.solve(b);
+        if (cg.info() != Eigen::Success)
+            return false;
+    }
 
-    unsigned ulIdx=0;
-    for (unsigned j=0;j<_usUCtrlpoints;j++) {
-        for (unsigned k=0;k<_usVCtrlpoints;k++) {
-            _vCtrlPntsOfSurf(j,k) = gp_Pnt(Xx(ulIdx,0),Xy(ulIdx,0),Xz(ulIdx,0));
+    int ulIdx=0;
+    for (int j=0;j<iUCtrl;j++) {
+        for (int k=0;k<iVCtrl;k++) {
+            _vCtrlPntsOfSurf(j,k) = gp_Pnt(X(ulIdx,0),X(ulIdx,1),X(ulIdx,2));
             ulIdx++;
         }
     }
@@ -1005,151 +1108,83 @@ bool BSplineParameterCorrection::SolveWithoutSmoothing()
 }
 
 namespace Reen {
-class ScalarProduct
+/// A term Iu(i,k)*Iv(j,l) of a smoothing functional where Iu and Iv are the
+/// integrals of products of the derivatives of the basis functions
+struct SmoothingTerm
+{
+    double factor;
+    int uOrd1, uOrd2;
+    int vOrd1, vOrd2;
+};
+
+/**
+ * Table of the integrals of the product of the derivatives of two basis functions.
+ * The integral is zero if the supports of the basis functions don't overlap, i.e.
+ * if the indices differ by order or more.
+ */
+class IntegralTable
 {
 public:
-    ScalarProduct(const math_Matrix& mat) : mat(mat)
+    IntegralTable(BSplineBasis& spline, int count, int order, int ord1, int ord2)
+      : count(count), order(order), values(count*(2*order-1))
     {
+        for (int i=0; i<count; i++) {
+            for (int k=std::max(0,i-order+1); k<std::min(count,i+order); k++)
+                values[i*(2*order-1) + k-i+order-1] = spline.GetIntegralOfProductOfBSplines(i,k,ord1,ord2);
+        }
     }
-    std::vector<double> multiply(int col) const
+    double operator()(int i, int k) const
     {
-        math_Vector vec = mat.Col(col);
-        std::vector<double> out(mat.ColNumber());
-        for (int n=mat.LowerCol(); n<=mat.UpperCol(); n++) {
-            out[n] = vec * mat.Col(n);
-        }
-        return out;
+        return values[i*(2*order-1) + k-i+order-1];
     }
 
 private:
-    const math_Matrix& mat;
+    int count, order;
+    std::vector<double> values;
 };
 }
 
-bool BSplineParameterCorrection::SolveWithSmoothing(double fWeight)
+void BSplineParameterCorrection::CalcSmoothMatrix(SparseMatrix& rclMat, const std::vector<SmoothingTerm>& terms,
+                                                  Base::SequencerLauncher& seq)
 {
-    unsigned ulSize = _pvcPoints->Length();
-    unsigned ulDim  = _usUCtrlpoints*_usVCtrlpoints;
-    math_Matrix M  (0, ulSize-1, 0, ulDim-1);
-    math_Vector Xx (0, ulDim-1);
-    math_Vector Xy (0, ulDim-1);
-    math_Vector Xz (0, ulDim-1);
-    math_Vector bx (0, ulSize-1);
-    math_Vector by (0, ulSize-1);
-    math_Vector bz (0, ulSize-1);
-    math_Vector Mbx(0, ulDim-1);
-    math_Vector Mby(0, ulDim-1);
-    math_Vector Mbz(0, ulDim-1);
-
-    //Bestimmung der Koeffizientenmatrix des ueberbestimmten LGS
-    for (unsigned i=0; i<ulSize; i++) {
-        const gp_Pnt2d& uvValue = (*_pvcUVParam)(i);
-        double fU = uvValue.X();
-        double fV = uvValue.Y();
-        int ulIdx=0;
-
-        // Vorberechnung der Werte der Basis-Funktionen
-        std::vector<double> basisU(_usUCtrlpoints);
-        for (unsigned j=0; j<_usUCtrlpoints; j++) {
-            basisU[j] = _clUSpline.BasisFunction(j,fU);
-        }
-        std::vector<double> basisV(_usVCtrlpoints);
-        for (unsigned k=0; k<_usVCtrlpoints; k++) {
-            basisV[k] = _clVSpline.BasisFunction(k,fV);
-        }
-
-        for (unsigned j=0; j<_usUCtrlpoints; j++) {
-            double valueU = basisU[j];
-            if (valueU == 0.0) {
-                for (unsigned k=0; k<_usVCtrlpoints; k++) {
-                    M(i,ulIdx) = 0.0;
-                    ulIdx++;
+    int iUCtrl = static_cast<int>(_usUCtrlpoints);
+    int iVCtrl = static_cast<int>(_usVCtrlpoints);
+    int iUOrder = static_cast<int>(_usUOrder);
+    int iVOrder = static_cast<int>(_usVOrder);
+
+    std::vector<IntegralTable> uTables, vTables;
+    for (std::vector<SmoothingTerm>::const_iterator it = terms.begin(); it != terms.end(); ++it) {
+        uTables.push_back(IntegralTable(_clUSpline, iUCtrl, iUOrder, it->uOrd1, it->uOrd2));
+        vTables.push_back(IntegralTable(_clVSpline, iVCtrl, iVOrder, it->vOrd1, it->vOrd2));
+    }
+
+    // Nur Kontrollpunkte mit sich ueberlappenden Basisfunktionen ergeben Eintraege
+    std::vector< Eigen::Triplet<double> > triplets;
+    triplets.reserve(iUCtrl*iVCtrl*(2*iUOrder-1)*(2*iVOrder-1));
+    for (int k=0; k<iUCtrl; k++) {
+        for (int l=0; l<iVCtrl; l++) {
+            int m = k*iVCtrl+l;
+            for (int i=std::max(0,k-iUOrder+1); i<std::min(iUCtrl,k+iUOrder); i++) {
+                for (int j=std::max(0,l-iVOrder+1); j<std::min(iVCtrl,l+iVOrder); j++) {
+                    double value = 0.0;
+                    for (std::size_t t=0; t<terms.size(); t++)
+                        value += terms[t].factor * uTables[t](i,k) * vTables[t](j,l);
+                    if (value != 0.0)
+                        triplets.push_back(Eigen::Triplet<double>(m, i*iVCtrl+j, value));
                 }
             }
-            else {
-                for (unsigned k=0; k<_usVCtrlpoints; k++) {
-                    M(i,ulIdx) = valueU * basisV[k];
-                    ulIdx++;
-                }
-            }
-        }
-    }
-
-    //Das Produkt aus ihrer Transformierten und ihr selbst ergibt die quadratische Systemmatrix (langsam)
-#if 0
-    math_Matrix MTM = M.TMultiply(M);
-#elif 0
-    math_Matrix MTM(0, ulDim-1, 0, ulDim-1);
-    for (unsigned m=0; m<ulDim; m++) {
-        math_Vector Mm = M.Col(m);
-        for (unsigned n=m; n<ulDim; n++) {
-            MTM(m,n) = MTM(n,m) = Mm * M.Col(n);
-        }
-    }
-#else // multi-threaded
-    std::vector<int> columns(ulDim);
-    std::generate(columns.begin(), columns.end(), Base::iotaGen<int>(0));
-    ScalarProduct scalar(M);
-    QFuture< std::vector<double> > future = QtConcurrent::mapped
-        (columns, boost::bind(&ScalarProduct::multiply, &scalar, bp::_1));
-    QFutureWatcher< std::vector<double> > watcher;
-    watcher.setFuture(future);
-    watcher.waitForFinished();
-
-    math_Matrix MTM(0, ulDim-1, 0, ulDim-1);
-    int rowIndex=0;
-    for (QFuture< std::vector<double> >::const_iterator it = future.begin(); it != future.end(); ++it) {
-        int colIndex=0;
-        for (std::vector<double>::const_iterator jt = it->begin(); jt != it->end(); ++jt, colIndex++)
-            MTM(rowIndex, colIndex) = *jt;
-        rowIndex++;
-    }
-#endif
-
-    //Bestimmen der rechten Seite
-    for (int ii=_pvcPoints->Lower(); ii<=_pvcPoints->Upper(); ii++) {
-        const gp_Pnt& pnt = (*_pvcPoints)(ii);
-        bx(ii) = pnt.X(); by(ii) = pnt.Y(); bz(ii) = pnt.Z();
-    }
-    for (unsigned i=0; i<ulDim; i++) {
-        math_Vector Mi = M.Col(i);
-        Mbx(i) = Mi * bx;
-        Mby(i) = Mi * by;
-        Mbz(i) = Mi * bz;
-    }
-
-    // Loese das LGS mit der LU-Zerlegung
-    math_Gauss mgGaussX(MTM+fWeight*_clSmoothMatrix);
-    math_Gauss mgGaussY(MTM+fWeight*_clSmoothMatrix);
-    math_Gauss mgGaussZ(MTM+fWeight*_clSmoothMatrix);
-
-    mgGaussX.Solve(Mbx,Xx);
-    if (!mgGaussX.IsDone())
-        return false;
-
-    mgGaussY.Solve(Mby,Xy);
-    if (!mgGaussY.IsDone())
-        return false;
-
-    mgGaussZ.Solve(Mbz,Xz);
-    if (!mgGaussZ.IsDone())
-        return false;
-
-    unsigned ulIdx=0;
-    for (unsigned j=0;j<_usUCtrlpoints;j++) {
-        for (unsigned k=0;k<_usVCtrlpoints;k++) {
-            _vCtrlPntsOfSurf(j,k) = gp_Pnt(Xx(ulIdx),Xy(ulIdx),Xz(ulIdx));
-            ulIdx++;
+            seq.next();
         }
     }
 
-    return true;
+    rclMat.resize(iUCtrl*iVCtrl, iUCtrl*iVCtrl);
+    rclMat.setFromTriplets(triplets.begin(), triplets.end());
 }
 
 void BSplineParameterCorrection::CalcSmoothingTerms(bool bRecalc, double fFirst, double fSecond, double fThird)
 {
     if (bRecalc) {
-        Base::SequencerLauncher seq("Initializing...", 3 * _usUCtrlpoints * _usUCtrlpoints * _usVCtrlpoints * _usVCtrlpoints);
+        Base::SequencerLauncher seq("Initializing...", 3 * _usUCtrlpoints * _usVCtrlpoints);
         CalcFirstSmoothMatrix(seq);
         CalcSecondSmoothMatrix(seq);
         CalcThirdSmoothMatrix(seq);
@@ -1162,82 +1197,33 @@ void BSplineParameterCorrection::CalcSmoothingTerms(bool bRecalc, double fFirst,
 
 void BSplineParameterCorrection::CalcFirstSmoothMatrix(Base::SequencerLauncher& seq)
 {
-    unsigned m=0;
-    for (unsigned k=0; k<_usUCtrlpoints; k++) {
-        for (unsigned l=0; l<_usVCtrlpoints; l++) {
-            unsigned n=0;
-
-            for (unsigned i=0; i<_usUCtrlpoints; i++) {
-                for (unsigned j=0; j<_usVCtrlpoints; j++) {
-                    _clFirstMatrix(m,n) =   _clUSpline.GetIntegralOfProductOfBSplines(i,k,1,1) *
-                                            _clVSpline.GetIntegralOfProductOfBSplines(j,l,0,0) +
-                                            _clUSpline.GetIntegralOfProductOfBSplines(i,k,0,0) *
-                                            _clVSpline.GetIntegralOfProductOfBSplines(j,l,1,1);
-                    seq.next();
-                    n++;
-                }
-            }
-            m++;
-        }
-    }
+    std::vector<SmoothingTerm> terms;
+    SmoothingTerm t1 = {1.0, 1,1, 0,0}; terms.push_back(t1);
+    SmoothingTerm t2 = {1.0, 0,0, 1,1}; terms.push_back(t2);
+    CalcSmoothMatrix(_clFirstMatrix, terms, seq);
 }
 
 void BSplineParameterCorrection::CalcSecondSmoothMatrix(Base::SequencerLauncher& seq)
 {
-    unsigned m=0;
-    for (unsigned k=0; k<_usUCtrlpoints; k++) {
-        for (unsigned l=0; l<_usVCtrlpoints; l++) {
-            unsigned n=0;
-
-            for (unsigned i=0; i<_usUCtrlpoints; i++) {
-                for (unsigned j=0; j<_usVCtrlpoints; j++) {
-                    _clSecondMatrix(m,n) =  _clUSpline.GetIntegralOfProductOfBSplines(i,k,2,2) *
-                                            _clVSpline.GetIntegralOfProductOfBSplines(j,l,0,0) +
-                                          2*_clUSpline.GetIntegralOfProductOfBSplines(i,k,1,1) *
-                                            _clVSpline.GetIntegralOfProductOfBSplines(j,l,1,1) +
-                                            _clUSpline.GetIntegralOfProductOfBSplines(i,k,0,0) *
-                                            _clVSpline.GetIntegralOfProductOfBSplines(j,l,2,2);
-                    seq.next();
-                    n++;
-                }
-            }
-            m++;
-        }
-    }
+    std::vector<SmoothingTerm> terms;
+    SmoothingTerm t1 = {1.0, 2,2, 0,0}; terms.push_back(t1);
+    SmoothingTerm t2 = {2.0, 1,1, 1,1}; terms.push_back(t2);
+    SmoothingTerm t3 = {1.0, 0,0, 2,2}; terms.push_back(t3);
+    CalcSmoothMatrix(_clSecondMatrix, terms, seq);
 }
 
 void BSplineParameterCorrection::CalcThirdSmoothMatrix(Base::SequencerLauncher& seq)
 {
-    unsigned m=0;
-    for (unsigned k=0; k<_usUCtrlpoints; k++) {
-        for (unsigned l=0; l<_usVCtrlpoints; l++) {
-            unsigned n=0;
-
-            for (unsigned i=0; i<_usUCtrlpoints; i++) {
-                for (unsigned j=0; j<_usVCtrlpoints; j++) {
-                    _clThirdMatrix(m,n) = _clUSpline.GetIntegralOfProductOfBSplines(i,k,3,3) *
-                                          _clVSpline.GetIntegralOfProductOfBSplines(j,l,0,0) +
-                                          _clUSpline.GetIntegralOfProductOfBSplines(i,k,3,1) *
-                                          _clVSpline.GetIntegralOfProductOfBSplines(j,l,0,2) +
-                                          _clUSpline.GetIntegralOfProductOfBSplines(i,k,1,3) *
-                                          _clVSpline.GetIntegralOfProductOfBSplines(j,l,2,0) +
-                                          _clUSpline.GetIntegralOfProductOfBSplines(i,k,1,1) *
-                                          _clVSpline.GetIntegralOfProductOfBSplines(j,l,2,2) +
-                                          _clUSpline.GetIntegralOfProductOfBSplines(i,k,2,2) *
-                                          _clVSpline.GetIntegralOfProductOfBSplines(j,l,1,1) +
-                                          _clUSpline.GetIntegralOfProductOfBSplines(i,k,0,2) *
-                                          _clVSpline.GetIntegralOfProductOfBSplines(j,l,3,1) +
-                                          _clUSpline.GetIntegralOfProductOfBSplines(i,k,2,0) *
-                                          _clVSpline.GetIntegralOfProductOfBSplines(j,l,1,3) +
-                                          _clUSpline.GetIntegralOfProductOfBSplines(i,k,0,0) *
-                                          _clVSpline.GetIntegralOfProductOfBSplines(j,l,3,3) ;
-                    seq.next();
-                    n++;
-                }
-            }
-            m++;
-        }
-    }
+    std::vector<SmoothingTerm> terms;
+    SmoothingTerm t1 = {1.0, 3,3, 0,0}; terms.push_back(t1);
+    SmoothingTerm t2 = {1.0, 3,1, 0,2}; terms.push_back(t2);
+    SmoothingTerm t3 = {1.0, 1,3, 2,0}; terms.push_back(t3);
+    SmoothingTerm t4 = {1.0, 1,1, 2,2}; terms.push_back(t4);
+    SmoothingTerm t5 = {1.0, 2,2, 1,1}; terms.push_back(t5);
+    SmoothingTerm t6 = {1.0, 0,2, 3,1}; terms.push_back(t6);
+    SmoothingTerm t7 = {1.0, 2,0, 1,3}; terms.push_back(t7);
+    SmoothingTerm t8 = {1.0, 0,0, 3,3}; terms.push_back(t8);
+    CalcSmoothMatrix(_clThirdMatrix, terms, seq);
 }
 
 void BSplineParameterCorrection::EnableSmoothing(bool bSmooth, double fSmoothInfl)
@@ -1256,32 +1242,32 @@ void BSplineParameterCorrection::EnableSmoothing(bool bSmooth, double fSmoothInf
     ParameterCorrection::EnableSmoothing(bSmooth, fSmoothInfl);
 }
 
-const math_Matrix& BSplineParameterCorrection::GetFirstSmoothMatrix() const
+const BSplineParameterCorrection::SparseMatrix& BSplineParameterCorrection::GetFirstSmoothMatrix() const
 {
     return _clFirstMatrix;
 }
 
-const math_Matrix& BSplineParameterCorrection::GetSecondSmoothMatrix() const
+const BSplineParameterCorrection::SparseMatrix& BSplineParameterCorrection::GetSecondSmoothMatrix() const
 {
     return _clSecondMatrix;
 }
 
-const math_Matrix& BSplineParameterCorrection::GetThirdSmoothMatrix() const
+const BSplineParameterCorrection::SparseMatrix& BSplineParameterCorrection::GetThirdSmoothMatrix() const
 {
     return _clThirdMatrix;
 }
 
-void BSplineParameterCorrection::SetFirstSmoothMatrix(const math_Matrix& rclMat)
+void BSplineParameterCorrection::SetFirstSmoothMatrix(const SparseMatrix& rclMat)
 {
     _clFirstMatrix = rclMat;
 }
 
-void BSplineParameterCorrection::SetSecondSmoothMatrix(const math_Matrix& rclMat)
+void BSplineParameterCorrection::SetSecondSmoothMatrix(const SparseMatrix& rclMat)
 {
     _clSecondMatrix = rclMat;
 }
 
-void BSplineParameterCorrection::SetThirdSmoothMatrix(const math_Matrix& rclMat)
+void BSplineParameterCorrection::SetThirdSmoothMatrix(const SparseMatrix& rclMat)
 {
     _clThirdMatrix = rclMat;
 }
@@ -31,6 +31,7 @@
 #include <TColgp_Array1OfPnt2d.hxx>
 #include <Geom_BSplineSurface.hxx>
 #include <math_Matrix.hxx>
+#include <Eigen/Sparse>
 
 #include <Base/Vector3D.h>
 
@@ -367,9 +368,14 @@ protected:
  * koennen.
  */
 
+struct SmoothingTerm;
+
 class ReenExport BSplineParameterCorrection : public ParameterCorrection
 {
 public:
+    typedef Eigen::SparseMatrix<double> SparseMatrix;
+
+
     // Konstruktor
     BSplineParameterCorrection(unsigned usUOrder=4,               //Ordnung in u-Richtung (Ordnung=Grad+1)
                                unsigned usVOrder=4,               //Ordnung in v-Richtung
@@ -400,6 +406,12 @@ protected:
      */
     virtual bool SolveWithSmoothing(double fWeight);
 
+    /**
+     * Solves the sparse normal equations of the least-squares fit with the
+     * smoothing terms weighted by fWeight
+     */
+    bool SolveNormalEquations(double fWeight);
+
 public:
     /**
      * Setzen des Knotenvektors
@@ -414,32 +426,32 @@ public:
     /**
      * Gibt die erste Matrix der Glaettungsterme zurueck, falls berechnet
      */
-    virtual const math_Matrix& GetFirstSmoothMatrix() const;
+    virtual const SparseMatrix& GetFirstSmoothMatrix() const;
 
     /**
      * Gibt die zweite Matrix der Glaettungsterme zurueck, falls berechnet
      */
-    virtual const math_Matrix& GetSecondSmoothMatrix() const;
+    virtual const SparseMatrix& GetSecondSmoothMatrix() const;
 
     /**
      * Gibt die dritte Matrix der Glaettungsterme zurueck, falls berechnet
      */
-    virtual const math_Matrix& GetThirdSmoothMatrix() const;
+    virtual const SparseMatrix& GetThirdSmoothMatrix() const;
 
     /**
      * Setzt die erste Matrix der Glaettungsterme
      */
-    virtual void SetFirstSmoothMatrix(const math_Matrix& rclMat);
+    virtual void SetFirstSmoothMatrix(const SparseMatrix& rclMat);
 
     /**
      * Setzt die zweite Matrix der Glaettungsterme
      */
-    virtual void SetSecondSmoothMatrix(const math_Matrix& rclMat);
+    virtual void SetSecondSmoothMatrix(const SparseMatrix& rclMat);
 
     /**
      * Setzt die dritte Matrix der Glaettungsterme
      */
-    virtual void SetThirdSmoothMatrix(const math_Matrix& rclMat);
+    virtual void SetThirdSmoothMatrix(const SparseMatrix& rclMat);
 
     /**
      * Verwende Glaettungsterme
@@ -476,13 +488,18 @@ protected:
      */
     virtual void CalcThirdSmoothMatrix(Base::SequencerLauncher&);
 
+    /**
+     * Computes the sparse matrix of a smoothing functional given as sum of terms
+     */
+    void CalcSmoothMatrix(SparseMatrix&, const std::vector<SmoothingTerm>&, Base::SequencerLauncher&);
+
 protected:
     BSplineBasis           _clUSpline;        //! B-Spline-Basisfunktion in u-Richtung
     BSplineBasis           _clVSpline;        //! B-Spline-Basisfunktion in v-Richtung
-    math_Matrix            _clSmoothMatrix;   //! Matrix der Glaettungsfunktionale
-    math_Matrix            _clFirstMatrix;    //! Matrix der 1. Glaettungsfunktionale
-    math_Matrix            _clSecondMatrix;   //! Matrix der 2. Glaettungsfunktionale
-    math_Matrix            _clThirdMatrix;    //! Matrix der 3. Glaettungsfunktionale
+    SparseMatrix           _clSmoothMatrix;   //! Matrix der Glaettungsfunktionale
+    SparseMatrix           _clFirstMatrix;    //! Matrix der 1. Glaettungsfunktionale
+    SparseMatrix           _clSecondMatrix;   //! Matrix der 2. Glaettungsfunktionale
+    SparseMatrix           _clThirdMatrix;    //! Matrix der 3. Glaettungsfunktionale
 };
 
 } // namespace Reen
@@ -260,6 +260,7 @@ private:
 
 FillingPanel::FillingPanel(ViewProviderFilling* vp, Surface::Filling* obj)
 {
+    setPerElementNotification();
     ui = new Ui_TaskFilling();
     ui->setupUi(this);
     ui->statusLabel->clear();
@@ -117,6 +117,7 @@ private:
 
 FillingEdgePanel::FillingEdgePanel(ViewProviderFilling* vp, Surface::Filling* obj)
 {
+    setPerElementNotification();
     ui = new Ui_TaskFillingEdge();
     ui->setupUi(this);
 
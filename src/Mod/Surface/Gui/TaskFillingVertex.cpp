@@ -116,6 +116,7 @@ private:
 
 FillingVertexPanel::FillingVertexPanel(ViewProviderFilling* vp, Surface::Filling* obj)
 {
+    setPerElementNotification();
     ui = new Ui_TaskFillingVertex();
     ui->setupUi(this);
 
@@ -186,6 +186,7 @@ bool GeomFillSurface::EdgeSelection::allow(App::Document* , App::DocumentObject*
 
 GeomFillSurface::GeomFillSurface(ViewProviderGeomFillSurface* vp, Surface::GeomFillSurface* obj)
 {
+    setPerElementNotification();
     ui = new Ui_GeomFillSurface();
     ui->setupUi(this);
     selectionMode = None;
@@ -249,6 +249,7 @@ private:
 
 SectionsPanel::SectionsPanel(ViewProviderSections* vp, Surface::Sections* obj) : ui(new Ui_Sections())
 {
+    setPerElementNotification();
     ui->setupUi(this);
     ui->statusLabel->clear();
 
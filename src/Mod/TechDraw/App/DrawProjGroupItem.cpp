@@ -145,10 +145,19 @@ App::DocumentObjectExecReturn *DrawProjGroupItem::execute(void)
     }
 
     App::DocumentObjectExecReturn* ret = DrawViewPart::execute();
-    autoPosition();
+    if (m_tempGeometryObject == nullptr) {
+        autoPosition();
+    }
     return ret;
 }
 
+//position needs the size of the projection
+void DrawProjGroupItem::updateAfterHlr(void)
+{
+    DrawViewPart::updateAfterHlr();
+    autoPosition();
+}
+
 void DrawProjGroupItem::autoPosition()
 {
 //    Base::Console().Message("DPGI::autoPosition(%s)\n",Label.getValue());
@@ -91,6 +91,7 @@ public:
 
 protected:
     void onChanged(const App::Property* prop) override;
+    virtual void updateAfterHlr(void) override;
     virtual bool isLocked(void) const override;
     virtual bool showLock(void) const override;
 
@@ -64,9 +64,13 @@
 
 #include <limits>
 #include <algorithm>
+#include <array>
 #include <cmath>
+#include <unordered_map>
 #include <GeomLib_Tool.hxx>
 
+#include <QtConcurrentMap>
+
 #include <App/Application.h>
 #include <Base/BoundBox.h>
 #include <Base/Console.h>
@@ -166,72 +170,10 @@ std::vector<TopoDS_Edge> DrawProjectSplit::getEdges(TechDraw::GeometryObject* ge
         }
     }
     faceEdges = nonZero;
-    origEdges = nonZero;
 
     //HLR algo does not provide all edge intersections for edge endpoints.
     //need to split long edges touched by Vertex of another edge
-    std::vector<splitPoint> splits;
-    std::vector<TopoDS_Edge>::iterator itOuter = origEdges.begin();
-    int iOuter = 0;
-    for (; itOuter != origEdges.end(); ++itOuter, iOuter++) {
-        TopoDS_Vertex v1 = TopExp::FirstVertex((*itOuter));
-        TopoDS_Vertex v2 = TopExp::LastVertex((*itOuter));
-        Bnd_Box sOuter;
-        BRepBndLib::Add(*itOuter, sOuter);
-        sOuter.SetGap(0.1);
-        if (sOuter.IsVoid()) {
-            Base::Console().Message("DPS::Extract Faces - outer Bnd_Box is void\n");
-            continue;
-        }
-        if (DrawUtil::isZeroEdge(*itOuter)) {
-            Base::Console().Message("DPS::extractFaces - outerEdge: %d is ZeroEdge\n",iOuter);   //this is not finding ZeroEdges
-            continue;  //skip zero length edges. shouldn't happen ;)
-        }
-        int iInner = 0;
-        std::vector<TopoDS_Edge>::iterator itInner = faceEdges.begin();
-        for (; itInner != faceEdges.end(); ++itInner,iInner++) {
-            if (iInner == iOuter) {
-                continue;
-            }
-            if (DrawUtil::isZeroEdge((*itInner))) {
-                continue;  //skip zero length edges. shouldn't happen ;)
-            }
-
-            Bnd_Box sInner;
-            BRepBndLib::Add(*itInner, sInner);
-            sInner.SetGap(0.1);
-            if (sInner.IsVoid()) {
-                Base::Console().Log("INFO - DPS::Extract Faces - inner Bnd_Box is void\n");
-                continue;
-            }
-            if (sOuter.IsOut(sInner)) {      //bboxes of edges don't intersect, don't bother
-                continue;
-            }
-
-            double param = -1;
-            if (isOnEdge((*itInner),v1,param,false)) {
-                gp_Pnt pnt1 = BRep_Tool::Pnt(v1);
-                splitPoint s1;
-                s1.i = iInner;
-                s1.v = Base::Vector3d(pnt1.X(),pnt1.Y(),pnt1.Z());
-                s1.param = param;
-                splits.push_back(s1);
-            }
-            if (isOnEdge((*itInner),v2,param,false)) {
-                gp_Pnt pnt2 = BRep_Tool::Pnt(v2);
-                splitPoint s2;
-                s2.i = iInner;
-                s2.v = Base::Vector3d(pnt2.X(),pnt2.Y(),pnt2.Z());
-                s2.param = param;
-                splits.push_back(s2);
-            }
-        } //inner loop
-    }   //outer loop
-
-    std::vector<splitPoint> sorted = sortSplits(splits,true);
-    auto last = std::unique(sorted.begin(), sorted.end(), DrawProjectSplit::splitEqual);  //duplicates to back
-    sorted.erase(last, sorted.end());                         //remove dupls
-    std::vector<TopoDS_Edge> newEdges = splitEdges(faceEdges,sorted);
+    std::vector<TopoDS_Edge> newEdges = splitTouchingEdges(faceEdges);
 
     if (newEdges.empty()) {
         Base::Console().Log("LOG - DPS::extractFaces - no newEdges\n");
@@ -245,26 +187,39 @@ std::vector<TopoDS_Edge> DrawProjectSplit::getEdges(TechDraw::GeometryObject* ge
 //note param gets modified here
 bool DrawProjectSplit::isOnEdge(TopoDS_Edge e, TopoDS_Vertex v, double& param, bool allowEnds)
 {
-    bool result = false;
-    bool outOfBox = false;
-    param = -2;
-
     //eliminate obvious cases
     Bnd_Box sBox;
     BRepBndLib::Add(e, sBox);
     sBox.SetGap(0.1);
     if (sBox.IsVoid()) {
         Base::Console().Message("DPS::isOnEdge - Bnd_Box is void\n");
-    } else {
+    }
+    double dist = 0.0;
+    bool result = isOnEdge(e, sBox, v, param, dist, allowEnds);
+    if (dist < 0.0) {
+        Base::Console().Error("DPS::isOnEdge - simpleMinDist failed: %.3f\n",dist);
+    }
+    return result;
+}
+
+bool DrawProjectSplit::isOnEdge(const TopoDS_Edge& e, const Bnd_Box& box, const TopoDS_Vertex& v,
+                                double& param, double& dist, bool allowEnds)
+{
+    bool result = false;
+    bool outOfBox = false;
+    param = -2;
+    dist = Precision::Infinite();
+
+    if (!box.IsVoid()) {
         gp_Pnt pt = BRep_Tool::Pnt(v);
-        if (sBox.IsOut(pt)) {
+        if (box.IsOut(pt)) {
             outOfBox = true;
         }
     }
     if (!outOfBox) {
-            double dist = DrawUtil::simpleMinDist(v,e);
+            BRepExtrema_DistShapeShape extss(v, e);          //not simpleMinDist, it reports failures
+            dist = (extss.IsDone() && extss.NbSolution() > 0) ? extss.Value() : -1.0;
             if (dist < 0.0) {
-                Base::Console().Error("DPS::isOnEdge - simpleMinDist failed: %.3f\n",dist);
                 result = false;
             } else if (dist < Precision::Confusion()) {
                 const gp_Pnt pt = BRep_Tool::Pnt(v);                         //have to duplicate method 3 to get param
@@ -289,6 +244,161 @@ bool DrawProjectSplit::isOnEdge(TopoDS_Edge e, TopoDS_Vertex v, double& param, b
 }
 
 
+namespace {
+//! regular grid over the XY extent of edge bounding boxes. Each cell lists the
+//! edges whose box overlaps it, so the edges near a point are found without
+//! looking at all of them.
+class EdgeBoxGrid
+{
+public:
+    explicit EdgeBoxGrid(const std::vector<Bnd_Box>& boxes) :
+        m_boxes(boxes),
+        m_xMin(0.0),
+        m_yMin(0.0),
+        m_cellSize(1.0),
+        m_nx(0),
+        m_ny(0)
+    {
+        Bnd_Box all;
+        int count = 0;
+        for (auto& b: boxes) {
+            if (!b.IsVoid()) {
+                all.Add(b);
+                count++;
+            }
+        }
+        if (all.IsVoid()) {
+            return;
+        }
+        double xMin, yMin, zMin, xMax, yMax, zMax;
+        all.Get(xMin, yMin, zMin, xMax, yMax, zMax);
+        double width = std::max(xMax - xMin, Precision::Confusion());
+        double height = std::max(yMax - yMin, Precision::Confusion());
+        //about one edge per cell
+        m_cellSize = std::sqrt(width * height / count);
+        m_cellSize = std::max(m_cellSize, std::max(width, height) / 1024.0);
+        m_xMin = xMin;
+        m_yMin = yMin;
+        m_nx = std::min(int(width / m_cellSize) + 1, 1024);
+        m_ny = std::min(int(height / m_cellSize) + 1, 1024);
+        m_cells.resize(m_nx * m_ny);
+
+        for (int i = 0; i < int(boxes.size()); i++) {
+            if (boxes[i].IsVoid()) {
+                continue;
+            }
+            boxes[i].Get(xMin, yMin, zMin, xMax, yMax, zMax);
+            int ix1 = column(xMin), ix2 = column(xMax);
+            int iy1 = row(yMin), iy2 = row(yMax);
+            for (int iy = iy1; iy <= iy2; iy++) {
+                for (int ix = ix1; ix <= ix2; ix++) {
+                    m_cells[iy * m_nx + ix].push_back(i);
+                }
+            }
+        }
+    }
+
+    //! the edges whose bounding box contains the point
+    void candidates(const gp_Pnt& pnt, std::vector<int>& result) const
+    {
+        result.clear();
+        if (m_cells.empty()) {
+            return;
+        }
+        //points outside of the grid end up in a border cell and fail the box test
+        for (int i: m_cells[row(pnt.Y()) * m_nx + column(pnt.X())]) {
+            if (!m_boxes[i].IsOut(pnt)) {
+                result.push_back(i);
+            }
+        }
+    }
+
+private:
+    int column(double x) const {
+        return std::max(0, std::min(int((x - m_xMin) / m_cellSize), m_nx - 1));
+    }
+    int row(double y) const {
+        return std::max(0, std::min(int((y - m_yMin) / m_cellSize), m_ny - 1));
+    }
+
+    const std::vector<Bnd_Box>& m_boxes;
+    double m_xMin;
+    double m_yMin;
+    double m_cellSize;
+    int m_nx;
+    int m_ny;
+    std::vector<std::vector<int> > m_cells;
+};
+
+struct SplitJob {
+    int edge;
+    std::vector<splitPoint> splits;
+};
+}
+
+//! find the points where the end vertices of an edge touch another edge. Only the
+//! edges whose bounding box contains the vertex are tested and the edges are
+//! processed in parallel.
+std::vector<splitPoint> DrawProjectSplit::findSplitPoints(const std::vector<TopoDS_Edge>& edges)
+{
+    std::vector<splitPoint> result;
+    std::vector<Bnd_Box> boxes(edges.size());
+    std::vector<SplitJob> jobs;
+    for (int i = 0; i < int(edges.size()); i++) {
+        if (DrawUtil::isZeroEdge(edges[i])) {
+            continue;  //skip zero length edges. shouldn't happen ;)
+        }
+        BRepBndLib::Add(edges[i], boxes[i]);
+        if (boxes[i].IsVoid()) {
+            Base::Console().Log("DPS::findSplitPoints - Bnd_Box is void for edge %d\n",i);
+            continue;
+        }
+        boxes[i].SetGap(0.1);
+        SplitJob job;
+        job.edge = i;
+        jobs.push_back(job);
+    }
+
+    EdgeBoxGrid grid(boxes);
+    QtConcurrent::blockingMap(jobs, [&](SplitJob& job) {
+        std::vector<int> nearEdges;
+        TopoDS_Vertex ends[2] = { TopExp::FirstVertex(edges[job.edge]),
+                                  TopExp::LastVertex(edges[job.edge]) };
+        for (auto& v: ends) {
+            gp_Pnt pnt = BRep_Tool::Pnt(v);
+            grid.candidates(pnt, nearEdges);
+            for (int iInner: nearEdges) {
+                if (iInner == job.edge) {
+                    continue;
+                }
+                double param = -1;
+                double dist = 0.0;
+                if (isOnEdge(edges[iInner], boxes[iInner], v, param, dist, false)) {
+                    splitPoint s;
+                    s.i = iInner;
+                    s.v = Base::Vector3d(pnt.X(),pnt.Y(),pnt.Z());
+                    s.param = param;
+                    job.splits.push_back(s);
+                }
+            }
+        }
+    });
+
+    for (auto& job: jobs) {
+        result.insert(result.end(), job.splits.begin(), job.splits.end());
+    }
+    return result;
+}
+
+std::vector<TopoDS_Edge> DrawProjectSplit::splitTouchingEdges(const std::vector<TopoDS_Edge>& edges)
+{
+    std::vector<splitPoint> splits = findSplitPoints(edges);
+    std::vector<splitPoint> sorted = sortSplits(splits,true);
+    auto last = std::unique(sorted.begin(), sorted.end(), DrawProjectSplit::splitEqual);  //duplicates to back
+    sorted.erase(last, sorted.end());                         //remove dupls
+    return splitEdges(edges,sorted);
+}
+
 std::vector<TopoDS_Edge> DrawProjectSplit::splitEdges(std::vector<TopoDS_Edge> edges, std::vector<splitPoint> splits)
 {
     std::vector<TopoDS_Edge> result;
@@ -413,10 +523,24 @@ std::vector<splitPoint> DrawProjectSplit::sortSplits(std::vector<splitPoint>& s,
     return result;
 }
 
+//! remove edges with the same ends and end angles. The edges are hashed on the grid cell of
+//! their start point. As the cells are larger than the tolerance a duplicate is found in the
+//! same or a neighbouring cell. The first edge of a set of duplicates is kept. The result
+//! is in descending edgeLess order, the order the faces are numbered in.
 std::vector<TopoDS_Edge> DrawProjectSplit::removeDuplicateEdges(std::vector<TopoDS_Edge>& inEdges)
 {
     std::vector<TopoDS_Edge> result;
-    std::vector<edgeSortItem> temp;
+    std::vector<edgeSortItem> kept;
+    const double cellSize = 10.0 * Precision::Confusion();
+
+    struct CellHash {
+        std::size_t operator()(const std::array<long long, 3>& c) const {
+            std::size_t h = std::hash<long long>()(c[0]);
+            h = h * 31 + std::hash<long long>()(c[1]);
+            return h * 31 + std::hash<long long>()(c[2]);
+        }
+    };
+    std::unordered_map<std::array<long long, 3>, std::vector<edgeSortItem>, CellHash> cells;
 
     unsigned int idx = 0;
     for (auto& e: inEdges) {
@@ -437,22 +561,40 @@ std::vector<TopoDS_Edge> DrawProjectSplit::removeDuplicateEdges(std::vector<Topo
              item.endAngle = aTemp;
         }
         item.idx = idx;
-        temp.push_back(item);
         idx++;
-    }
-
-    std::vector<edgeSortItem> sorted = sortEdges(temp,true);
-    auto last = std::unique(sorted.begin(), sorted.end(), edgeSortItem::edgeEqual);  //duplicates to back
-    sorted.erase(last, sorted.end());                         //remove dupls
 
-    //TODO: "sorted" turns to garbage if pagescale set to "0.1"!!!!???? ***
-    for (auto e: sorted) {
-        if (e.idx < inEdges.size()) {
-            result.push_back(inEdges.at(e.idx));                  //<<< ***here
-        } else {
-            Base::Console().Message("ERROR - DPS::removeDuplicateEdges - access: %d inEdges: %d\n",e.idx,inEdges.size());
+        std::array<long long, 3> cell = {{ (long long)std::floor(item.start.x / cellSize),
+                                           (long long)std::floor(item.start.y / cellSize),
+                                           (long long)std::floor(item.start.z / cellSize) }};
+        bool duplicate = false;
+        for (int dx = -1; dx <= 1 && !duplicate; dx++) {
+            for (int dy = -1; dy <= 1 && !duplicate; dy++) {
+                for (int dz = -1; dz <= 1 && !duplicate; dz++) {
+                    std::array<long long, 3> nearCell = {{ cell[0] + dx, cell[1] + dy, cell[2] + dz }};
+                    auto it = cells.find(nearCell);
+                    if (it == cells.end()) {
+                        continue;
+                    }
+                    for (auto& other: it->second) {
+                        if (edgeSortItem::edgeEqual(item, other)) {
+                            duplicate = true;
+                            break;
+                        }
+                    }
+                }
+            }
+        }
+        if (!duplicate) {
+            cells[cell].push_back(item);
+            kept.push_back(item);
         }
     }
+
+    std::vector<edgeSortItem> sorted = sortEdges(kept,true);
+    result.reserve(sorted.size());
+    for (auto& item: sorted) {
+        result.push_back(inEdges.at(item.idx));
+    }
     return result;
 }
 
@@ -36,6 +36,7 @@
 
 class gp_Pnt;
 class gp_Ax2;
+class Bnd_Box;
 
 namespace TechDraw
 {
@@ -82,6 +83,14 @@ public:
     static TechDraw::GeometryObject*  buildGeometryObject(TopoDS_Shape shape, const gp_Ax2& viewAxis);
 
     static bool isOnEdge(TopoDS_Edge e, TopoDS_Vertex v, double& param, bool allowEnds = false);
+    /// same as above with a precomputed bounding box of \a e. Does not write to the console, so
+    /// it can be called from worker threads. \a dist is negative if the distance calculation failed.
+    static bool isOnEdge(const TopoDS_Edge& e, const Bnd_Box& box, const TopoDS_Vertex& v,
+                         double& param, double& dist, bool allowEnds);
+    /// points where an end vertex of an edge touches the interior of another edge
+    static std::vector<splitPoint> findSplitPoints(const std::vector<TopoDS_Edge>& edges);
+    /// split the edges at all their touching points
+    static std::vector<TopoDS_Edge> splitTouchingEdges(const std::vector<TopoDS_Edge>& edges);
     static std::vector<TopoDS_Edge> splitEdges(std::vector<TopoDS_Edge> orig, std::vector<splitPoint> splits);
     static std::vector<TopoDS_Edge> split1Edge(TopoDS_Edge e, std::vector<splitPoint> splitPoints);
 
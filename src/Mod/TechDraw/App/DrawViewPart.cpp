@@ -77,8 +77,12 @@
 
 #include <limits>
 #include <algorithm>
+#include <chrono>
 #include <cmath>
 
+#include <QtConcurrentRun>
+#include <QTimer>
+
 #include <App/Application.h>
 #include <App/Document.h>
 #include <App/GroupExtension.h>
@@ -127,7 +131,8 @@ PROPERTY_SOURCE_WITH_EXTENSIONS(TechDraw::DrawViewPart,
                                 TechDraw::DrawView)
 
 DrawViewPart::DrawViewPart(void) :
-    geometryObject(0)
+    geometryObject(0),
+    m_tempGeometryObject(nullptr)
 {
     static const char *group = "Projection";
     static const char *sgroup = "HLR Parameters";
@@ -172,10 +177,14 @@ DrawViewPart::DrawViewPart(void) :
     geometryObject = nullptr;
     //initialize bbox to non-garbage
     bbox = Base::BoundBox3d(Base::Vector3d(0.0, 0.0, 0.0), 0.0);
+
+    QObject::connect(&m_hlrWatcher, &QFutureWatcherBase::finished,
+                     &m_hlrWatcher, [this]() { onHlrFinished(); });
 }
 
 DrawViewPart::~DrawViewPart()
 {
+    cancelHlr();
     removeAllReferencesFromGeom();
     delete geometryObject;
 }
@@ -290,6 +299,10 @@ App::DocumentObjectExecReturn *DrawViewPart::execute(void)
 
     m_saveShape = shape;
     partExec(shape);
+    if (m_tempGeometryObject != nullptr) {
+        //projection is running in the background, onHlrFinished() does the rest
+        return DrawView::execute();
+    }
     addShapes2d();
 
     //second pass if required
@@ -348,11 +361,23 @@ void DrawViewPart::onChanged(const App::Property* prop)
 void DrawViewPart::partExec(TopoDS_Shape shape)
 {
 //    Base::Console().Message("DVP::partExec()\n");
+    //a projection still running is outdated now
+    cancelHlr();
+    if (useParallelHlr()) {
+        startHlr(shape);
+        return;
+    }
+
     geometryObject = makeGeometryForShape(shape);
     if (geometryObject == nullptr) {
         return;
     }
+    postHlrTasks();
+}
 
+//! the steps of partExec that need the projected geometry
+void DrawViewPart::postHlrTasks(void)
+{
 #if MOD_TECHDRAW_HANDLE_FACES
     if (handleFaces() && !geometryObject->usePolygonHLR()) {
         try {
@@ -402,11 +427,21 @@ void DrawViewPart::addShapes2d(void)
 }
 
 GeometryObject* DrawViewPart::makeGeometryForShape(TopoDS_Shape shape)
+{
+    gp_Ax2 viewAxis;
+    TopoDS_Shape scaledShape = prepareShapeForHlr(shape, viewAxis);
+//    BRepTools::Write(scaledShape, "DVPScaled.brep");            //debug
+    GeometryObject* go =  buildGeometryObject(scaledShape,viewAxis);
+    return go;
+}
+
+//! center, scale and rotate the shape for projection
+TopoDS_Shape DrawViewPart::prepareShapeForHlr(TopoDS_Shape shape, gp_Ax2& viewAxis)
 {
     gp_Pnt inputCenter;
     Base::Vector3d stdOrg(0.0,0.0,0.0);
 
-    gp_Ax2 viewAxis = getProjectionCS(stdOrg);
+    viewAxis = getProjectionCS(stdOrg);
 
     inputCenter = TechDraw::findCentroid(shape,
                                          viewAxis);
@@ -427,20 +462,21 @@ GeometryObject* DrawViewPart::makeGeometryForShape(TopoDS_Shape shape)
                                             viewAxis,
                                             Rotation.getValue());  //conventional rotation
      }
-//    BRepTools::Write(scaledShape, "DVPScaled.brep");            //debug
-    GeometryObject* go =  buildGeometryObject(scaledShape,viewAxis);
-    return go;
+    return scaledShape;
 }
 
-//note: slightly different than routine with same name in DrawProjectSplit
-TechDraw::GeometryObject* DrawViewPart::buildGeometryObject(TopoDS_Shape shape, gp_Ax2 viewAxis)
+TechDraw::GeometryObject* DrawViewPart::createGeometryObject(void)
 {
     TechDraw::GeometryObject* go = new TechDraw::GeometryObject(getNameInDocument(), this);
     go->setIsoCount(IsoCount.getValue());
     go->isPerspective(Perspective.getValue());
     go->setFocus(Focus.getValue());
     go->usePolygonHLR(CoarseView.getValue());
+    return go;
+}
 
+static void projectGeometry(TechDraw::GeometryObject* go, const TopoDS_Shape& shape, const gp_Ax2& viewAxis)
+{
     if (go->usePolygonHLR()){
         go->projectShapeWithPolygonAlgo(shape,
             viewAxis);
@@ -449,7 +485,20 @@ TechDraw::GeometryObject* DrawViewPart::buildGeometryObject(TopoDS_Shape shape,
         go->projectShape(shape,
             viewAxis);
     }
+}
+
+//note: slightly different than routine with same name in DrawProjectSplit
+TechDraw::GeometryObject* DrawViewPart::buildGeometryObject(TopoDS_Shape shape, gp_Ax2 viewAxis)
+{
+    TechDraw::GeometryObject* go = createGeometryObject();
+    projectGeometry(go, shape, viewAxis);
+    extractHlrGeometry(go);
+    return go;
+}
 
+//! convert the HLR result of the GeometryObject into TechDraw geometry
+void DrawViewPart::extractHlrGeometry(TechDraw::GeometryObject* go)
+{
     go->extractGeometry(TechDraw::ecHARD,                   //always show the hard&outline visible lines
                         true);
     go->extractGeometry(TechDraw::ecOUTLINE,
@@ -490,7 +539,102 @@ TechDraw::GeometryObject* DrawViewPart::buildGeometryObject(TopoDS_Shape shape,
         Base::Console().Log("DVP::buildGO - NO extracted edges!\n");
     }
     bbox = go->calcBoundingBox();
-    return go;
+}
+
+//! automatic scaling needs the projected size right away
+bool DrawViewPart::useParallelHlr(void) const
+{
+    return Preferences::parallelHlr() &&
+           !ScaleType.isValue("Automatic");
+}
+
+//! run the hidden line removal in a worker thread. The previous geometry stays
+//! in place until onHlrFinished() merges the result.
+void DrawViewPart::startHlr(TopoDS_Shape shape)
+{
+    gp_Ax2 viewAxis;
+    TopoDS_Shape preparedShape = prepareShapeForHlr(shape, viewAxis);
+    //the prepared shape may share its TShapes with the document's shapes, and
+    //the worker meshes it for the polygon algorithm, so give it its own copy
+    TopoDS_Shape scaledShape = BRepBuilderAPI_Copy(preparedShape).Shape();
+    TechDraw::GeometryObject* go = createGeometryObject();
+    go->deferMessages(true);
+    m_tempGeometryObject = go;
+    m_hlrFuture = QtConcurrent::run([go, scaledShape, viewAxis]() {
+        projectGeometry(go, scaledShape, viewAxis);
+    });
+    m_hlrWatcher.setFuture(m_hlrFuture);
+}
+
+//! called by m_hlrWatcher once the worker thread is done
+void DrawViewPart::onHlrFinished(void)
+{
+    if (mergeHlr()) {
+        updateAfterHlr();
+    }
+}
+
+//! move the projected geometry into place. Returns false if there is nothing
+//! to merge, i.e. no projection or already merged by waitForHlr().
+bool DrawViewPart::mergeHlr(void)
+{
+    if (m_tempGeometryObject == nullptr) {
+        return false;
+    }
+    m_hlrFuture.waitForFinished();
+    TechDraw::GeometryObject* go = m_tempGeometryObject;
+    m_tempGeometryObject = nullptr;
+    go->deferMessages(false);
+    go->reportMessages();
+
+    extractHlrGeometry(go);
+    geometryObject = go;
+    postHlrTasks();
+    addShapes2d();
+    return true;
+}
+
+//! tell the Gui about the new geometry
+void DrawViewPart::updateAfterHlr(void)
+{
+    requestPaint();
+    for (auto& dim: getDimensions()) {
+        dim->requestPaint();
+    }
+    for (auto& balloon: getBalloons()) {
+        balloon->requestPaint();
+    }
+}
+
+//! discard a pending projection
+void DrawViewPart::cancelHlr(void)
+{
+    if (m_tempGeometryObject == nullptr) {
+        return;
+    }
+    m_hlrFuture.waitForFinished();
+    delete m_tempGeometryObject;
+    m_tempGeometryObject = nullptr;
+}
+
+bool DrawViewPart::waitingForHlr(void) const
+{
+    return m_tempGeometryObject != nullptr &&
+           !m_hlrFuture.isFinished();
+}
+
+//! callers may be drawing or executing another object, so only the geometry
+//! is merged here and the updates are left to the event loop
+void DrawViewPart::waitForHlr(void) const
+{
+    DrawViewPart* self = const_cast<DrawViewPart*>(this);
+    if (self->mergeHlr()) {
+        QTimer::singleShot(0, &self->m_hlrWatcher, [self]() {
+            if (self->getNameInDocument() != nullptr) {
+                self->updateAfterHlr();
+            }
+        });
+    }
 }
 
 //! make faces from the existing edge geometry
@@ -520,75 +664,26 @@ void DrawViewPart::extractFaces()
 
     //HLR algo does not provide all edge intersections for edge endpoints.
     //need to split long edges touched by Vertex of another edge
-    std::vector<splitPoint> splits;
-    std::vector<TopoDS_Edge>::iterator itOuter = nonZero.begin();
-    int iOuter = 0;
-    for (; itOuter != nonZero.end(); ++itOuter, iOuter++) {    //*** itOuter != nonZero.end() - 1
-        TopoDS_Vertex v1 = TopExp::FirstVertex((*itOuter));
-        TopoDS_Vertex v2 = TopExp::LastVertex((*itOuter));
-        Bnd_Box sOuter;
-        BRepBndLib::Add(*itOuter, sOuter);
-        sOuter.SetGap(0.1);
-        if (sOuter.IsVoid()) {
-            Base::Console().Log("DVP::Extract Faces - outer Bnd_Box is void for %s\n",getNameInDocument());
-            continue;
-        }
-        if (DrawUtil::isZeroEdge(*itOuter)) {
-            Base::Console().Log("DVP::extractFaces - outerEdge: %d is ZeroEdge\n",iOuter);   //this is not finding ZeroEdges
-            continue;  //skip zero length edges. shouldn't happen ;)
-        }
-        int iInner = 0;
-        std::vector<TopoDS_Edge>::iterator itInner = nonZero.begin();   //***sb itOuter + 1;
-        for (; itInner != nonZero.end(); ++itInner,iInner++) {
-            if (iInner == iOuter) {
-                continue;
-            }
-            if (DrawUtil::isZeroEdge((*itInner))) {
-                continue;  //skip zero length edges. shouldn't happen ;)
-            }
-
-            Bnd_Box sInner;
-            BRepBndLib::Add(*itInner, sInner);
-            sInner.SetGap(0.1);
-            if (sInner.IsVoid()) {
-                Base::Console().Log("INFO - DVP::Extract Faces - inner Bnd_Box is void for %s\n",getNameInDocument());
-                continue;
-            }
-            if (sOuter.IsOut(sInner)) {      //bboxes of edges don't intersect, don't bother
-                continue;
-            }
-
-            double param = -1;
-            if (DrawProjectSplit::isOnEdge((*itInner),v1,param,false)) {
-                gp_Pnt pnt1 = BRep_Tool::Pnt(v1);
-                splitPoint s1;
-                s1.i = iInner;
-                s1.v = Base::Vector3d(pnt1.X(),pnt1.Y(),pnt1.Z());
-                s1.param = param;
-                splits.push_back(s1);
-            }
-            if (DrawProjectSplit::isOnEdge((*itInner),v2,param,false)) {
-                gp_Pnt pnt2 = BRep_Tool::Pnt(v2);
-                splitPoint s2;
-                s2.i = iInner;
-                s2.v = Base::Vector3d(pnt2.X(),pnt2.Y(),pnt2.Z());
-                s2.param = param;
-                splits.push_back(s2);
-            }
-        } //inner loop
-    }   //outer loop
-
-    std::vector<splitPoint> sorted = DrawProjectSplit::sortSplits(splits,true);
-    auto last = std::unique(sorted.begin(), sorted.end(), DrawProjectSplit::splitEqual);  //duplicates to back
-    sorted.erase(last, sorted.end());                         //remove dupl splits
-    std::vector<TopoDS_Edge> newEdges = DrawProjectSplit::splitEdges(nonZero,sorted);
+    auto start = std::chrono::high_resolution_clock::now();
+    std::vector<TopoDS_Edge> newEdges = DrawProjectSplit::splitTouchingEdges(nonZero);
+    auto end   = std::chrono::high_resolution_clock::now();
+    auto diff  = end - start;
+    double diffOut = std::chrono::duration <double, std::milli> (diff).count();
+    Base::Console().Log("TIMING - %s DVP spent: %.3f millisecs splitting %d edges\n",
+                        getNameInDocument(), diffOut, int(nonZero.size()));
 
     if (newEdges.empty()) {
         Base::Console().Log("DVP::extractFaces - no newEdges\n");
         return;
     }
 
-    newEdges = DrawProjectSplit::removeDuplicateEdges(newEdges);        //<<< here
+    start = std::chrono::high_resolution_clock::now();
+    newEdges = DrawProjectSplit::removeDuplicateEdges(newEdges);
+    end   = std::chrono::high_resolution_clock::now();
+    diff  = end - start;
+    diffOut = std::chrono::duration <double, std::milli> (diff).count();
+    Base::Console().Log("TIMING - %s DVP spent: %.3f millisecs removing duplicate edges\n",
+                        getNameInDocument(), diffOut);
 
 //find all the wires in the pile of faceEdges
     EdgeWalker ew;
@@ -681,6 +776,7 @@ std::vector<TechDraw::DrawViewBalloon*> DrawViewPart::getBalloons() const
 
 const std::vector<TechDraw::Vertex *> DrawViewPart::getVertexGeometry() const
 {
+    waitForHlr();
     std::vector<TechDraw::Vertex *> result;
     if (geometryObject != nullptr) {
         result = geometryObject->getVertexGeometry();
@@ -690,6 +786,7 @@ const std::vector<TechDraw::Vertex *> DrawViewPart::getVertexGeometry() const
 
 const std::vector<TechDraw::Face *> DrawViewPart::getFaceGeometry() const
 {
+    waitForHlr();
     std::vector<TechDraw::Face*> result;
     if (geometryObject != nullptr) {
         result = geometryObject->getFaceGeometry();
@@ -699,6 +796,7 @@ const std::vector<TechDraw::Face *> DrawViewPart::getFaceGeometry() const
 
 const std::vector<TechDraw::BaseGeom*> DrawViewPart::getEdgeGeometry() const
 {
+    waitForHlr();
     std::vector<TechDraw::BaseGeom  *> result;
     if (geometryObject != nullptr) {
         result = geometryObject->getEdgeGeometry();
@@ -798,6 +896,7 @@ std::vector<TopoDS_Wire> DrawViewPart::getWireForFace(int idx) const
 
 Base::BoundBox3d DrawViewPart::getBoundingBox() const
 {
+    waitForHlr();
     return bbox;
 }
 
@@ -861,6 +960,7 @@ BaseGeom* DrawViewPart::projectEdge(const TopoDS_Edge& e) const
 
 bool DrawViewPart::hasGeometry(void) const
 {
+    waitForHlr();
     bool result = false;
     if (geometryObject == nullptr) {
         return result;
@@ -948,6 +1048,7 @@ std::vector<DrawViewDetail*> DrawViewPart::getDetailRefs(void) const
 
 const std::vector<TechDraw::BaseGeom  *> DrawViewPart::getVisibleFaceEdges() const
 {
+    waitForHlr();
     return geometryObject->getVisibleFaceEdges(SmoothVisible.getValue(),SeamVisible.getValue());
 }
 
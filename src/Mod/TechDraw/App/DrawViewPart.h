@@ -37,6 +37,9 @@
 
 #include <Base/BoundBox.h>
 
+#include <QFuture>
+#include <QFutureWatcher>
+
 #include "PropertyGeomFormatList.h"
 #include "PropertyCenterLineList.h"
 #include "PropertyCosmeticEdgeList.h"
@@ -131,7 +134,12 @@ public:
     const std::vector<TechDraw::Face*> getFaceGeometry() const;
 
     bool hasGeometry(void) const;
-    TechDraw::GeometryObject* getGeometryObject(void) const { return geometryObject; }
+    TechDraw::GeometryObject* getGeometryObject(void) const { waitForHlr(); return geometryObject; }
+
+    //! true while the projection of this view runs in a worker thread
+    bool waitingForHlr(void) const;
+    //! block until a pending projection is finished and its geometry is available
+    void waitForHlr(void) const;
 
     TechDraw::BaseGeom* getGeomByIndex(int idx) const;               //get existing geom for edge idx in projection
     TechDraw::Vertex* getProjVertexByIndex(int idx) const;           //get existing geom for vertex idx in projection
@@ -212,6 +220,11 @@ protected:
     TechDraw::GeometryObject *geometryObject;
     Base::BoundBox3d bbox;
 
+    //projection running in a worker thread, merged by onHlrFinished()
+    TechDraw::GeometryObject *m_tempGeometryObject;
+    QFuture<void> m_hlrFuture;
+    QFutureWatcher<void> m_hlrWatcher;
+
     virtual void onChanged(const App::Property* prop) override;
     virtual void unsetupObject() override;
 
@@ -220,6 +233,17 @@ protected:
     void partExec(TopoDS_Shape shape);
     virtual void addShapes2d(void);
 
+    TopoDS_Shape prepareShapeForHlr(TopoDS_Shape shape, gp_Ax2& viewAxis);
+    TechDraw::GeometryObject* createGeometryObject(void);
+    void extractHlrGeometry(TechDraw::GeometryObject* go);
+    void postHlrTasks(void);
+    bool useParallelHlr(void) const;
+    void startHlr(TopoDS_Shape shape);
+    void onHlrFinished(void);
+    bool mergeHlr(void);
+    virtual void updateAfterHlr(void);
+    void cancelHlr(void);
+
     void extractFaces();
 
     Base::Vector3d shapeCentroid;
@@ -68,6 +68,7 @@
 
 #include <algorithm>
 #include <chrono>
+#include <cstdarg>
 
 #include <Base/Console.h>
 #include <Base/Exception.h>
@@ -95,7 +96,8 @@ GeometryObject::GeometryObject(const string& parent, TechDraw::DrawView* parentO
     m_isoCount(0),
     m_isPersp(false),
     m_focus(100.0),
-    m_usePolygonHLR(false)
+    m_usePolygonHLR(false),
+    m_deferMessages(false)
 
 {
 }
@@ -198,18 +200,18 @@ void GeometryObject::projectShape(const TopoDS_Shape& input,
 
     }
     catch (const Standard_Failure& e) {
-        Base::Console().Error("GO::projectShape - OCC error - %s - while projecting shape\n",
+        consoleMessage(true, "GO::projectShape - OCC error - %s - while projecting shape\n",
                               e.GetMessageString());
         }
     catch (...) {
-        Base::Console().Error("GeometryObject::projectShape - unknown error occurred while projecting shape\n");
+        consoleMessage(true, "GeometryObject::projectShape - unknown error occurred while projecting shape\n");
 //        throw Base::RuntimeError("GeometryObject::projectShape - unknown error occurred while projecting shape");
     }
 
     auto end   = chrono::high_resolution_clock::now();
     auto diff  = end - start;
     double diffOut = chrono::duration <double, milli> (diff).count();
-    Base::Console().Log("TIMING - %s GO spent: %.3f millisecs in HLRBRep_Algo & co\n",m_parentName.c_str(),diffOut);
+    consoleMessage(false, "TIMING - %s GO spent: %.3f millisecs in HLRBRep_Algo & co\n",m_parentName.c_str(),diffOut);
 
     start = chrono::high_resolution_clock::now();
 
@@ -260,20 +262,50 @@ void GeometryObject::projectShape(const TopoDS_Shape& input,
 
     }
     catch (const Standard_Failure& e) {
-        Base::Console().Error("GO::projectShape - OCC error - %s - while extracting edges\n",
+        consoleMessage(true, "GO::projectShape - OCC error - %s - while extracting edges\n",
                               e.GetMessageString());
     }
     catch (...) {
-        Base::Console().Error("GO::projectShape - unknown error while extracting edges\n");
+        consoleMessage(true, "GO::projectShape - unknown error while extracting edges\n");
 //        throw Base::RuntimeError("GeometryObject::projectShape - error occurred while extracting edges");
     }
     end   = chrono::high_resolution_clock::now();
     diff  = end - start;
     diffOut = chrono::duration <double, milli> (diff).count();
-    Base::Console().Log("TIMING - %s GO spent: %.3f millisecs in hlrToShape and BuildCurves\n",m_parentName.c_str(),diffOut);
+    consoleMessage(false, "TIMING - %s GO spent: %.3f millisecs in hlrToShape and BuildCurves\n",m_parentName.c_str(),diffOut);
 }
 
 //mirror a shape thru XZ plane for Qt's inverted Y coordinate
+//Console output is not safe from a worker thread, so it is buffered
+//until reportMessages() is called from the main thread
+void GeometryObject::consoleMessage(bool error, const char* format, ...)
+{
+    char buffer[1024];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+    if (m_deferMessages) {
+        m_messages.emplace_back(error, buffer);
+    } else if (error) {
+        Base::Console().Error("%s", buffer);
+    } else {
+        Base::Console().Log("%s", buffer);
+    }
+}
+
+void GeometryObject::reportMessages()
+{
+    for (auto& m: m_messages) {
+        if (m.first) {
+            Base::Console().Error("%s", m.second.c_str());
+        } else {
+            Base::Console().Log("%s", m.second.c_str());
+        }
+    }
+    m_messages.clear();
+}
+
 TopoDS_Shape GeometryObject::invertGeometry(const TopoDS_Shape s)
 {
     TopoDS_Shape result;
@@ -341,11 +373,11 @@ void GeometryObject::projectShapeWithPolygonAlgo(const TopoDS_Shape& input,
         brep_hlrPoly->Update();
     }
     catch (const Standard_Failure& e) {
-        Base::Console().Error("GO::projectShapeWithPolygonAlgo - OCC error - %s - while projecting shape\n",
+        consoleMessage(true, "GO::projectShapeWithPolygonAlgo - OCC error - %s - while projecting shape\n",
                               e.GetMessageString());
     }
     catch (...) {
-        Base::Console().Error("GO::projectShapeWithPolygonAlgo - unknown error while projecting shape\n");
+        consoleMessage(true, "GO::projectShapeWithPolygonAlgo - unknown error while projecting shape\n");
 //        throw Base::RuntimeError("GeometryObject::projectShapeWithPolygonAlgo  - error occurred while projecting shape");
 //        Standard_Failure::Raise("GeometryObject::projectShapeWithPolygonAlgo  - error occurred while projecting shape");
     }
@@ -389,18 +421,18 @@ void GeometryObject::projectShapeWithPolygonAlgo(const TopoDS_Shape& input,
         hidOutline = invertGeometry(hidOutline);
     }
     catch (const Standard_Failure& e) {
-        Base::Console().Error("GO::projectShapeWithPolygonAlgo - OCC error - %s - while extracting edges\n",
+        consoleMessage(true, "GO::projectShapeWithPolygonAlgo - OCC error - %s - while extracting edges\n",
                               e.GetMessageString());
     }
     catch (...) {
-        Base::Console().Error("GO::projectShapeWithPolygonAlgo - - error occurred while extracting edges\n");
+        consoleMessage(true, "GO::projectShapeWithPolygonAlgo - - error occurred while extracting edges\n");
 //        throw Base::RuntimeError("GeometryObject::projectShapeWithPolygonAlgo  - error occurred while extracting edges");
 //        Standard_Failure::Raise("GeometryObject::projectShapeWithPolygonAlgo - error occurred while extracting edges");
     }
     auto end = chrono::high_resolution_clock::now();
     auto diff = end - start;
     double diffOut = chrono::duration <double, milli>(diff).count();
-    Base::Console().Log("TIMING - %s GO spent: %.3f millisecs in HLRBRep_PolyAlgo & co\n", m_parentName.c_str(), diffOut);
+    consoleMessage(false, "TIMING - %s GO spent: %.3f millisecs in HLRBRep_PolyAlgo & co\n", m_parentName.c_str(), diffOut);
 }
 
 TopoDS_Shape GeometryObject::projectFace(const TopoDS_Shape &face,
@@ -131,6 +131,9 @@ public:
     void setFocus(double f) { m_focus = f; }
     double getFocus(void) { return m_focus; }
     void pruneVertexGeom(Base::Vector3d center, double radius);
+    //! buffer console output of the projection, for projecting in a worker thread
+    void deferMessages(bool b) { m_deferMessages = b; }
+    void reportMessages();
 
     //dupl mirrorShape???
     static TopoDS_Shape invertGeometry(const TopoDS_Shape s);
@@ -197,6 +200,7 @@ protected:
     std::vector<Face *> faceGeom;
 
     bool findVertex(Base::Vector3d v);
+    void consoleMessage(bool error, const char* format, ...);
 
     std::string m_parentName;
     TechDraw::DrawView* m_parent;
@@ -204,6 +208,8 @@ protected:
     bool m_isPersp;
     double m_focus;
     bool m_usePolygonHLR;
+    bool m_deferMessages;
+    std::vector<std::pair<bool, std::string> > m_messages;
 };
 
 } //namespace TechDraw
@@ -148,6 +148,16 @@ bool Preferences::keepPagesUpToDate()
     return autoUpdate;
 }
 
+//run hidden line removal of views in worker threads
+bool Preferences::parallelHlr()
+{
+    Base::Reference<ParameterGrp> hGrp = App::GetApplication().GetUserParameter().
+                                         GetGroup("BaseApp")->GetGroup("Preferences")->
+                                         GetGroup("Mod/TechDraw/General");
+    bool parallel = hGrp->GetBool("ParallelHLR", false);
+    return parallel;
+}
+
 bool Preferences::useGlobalDecimals()
 {
     bool result = false;
@@ -57,6 +57,7 @@ static double      vertexScale();
 
 static bool        useGlobalDecimals();
 static bool        keepPagesUpToDate();
+static bool        parallelHlr();
 
 static int         projectionAngle();
 static int         lineGroup();
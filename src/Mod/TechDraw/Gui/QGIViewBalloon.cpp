@@ -585,6 +585,9 @@ void QGIViewBalloon::draw()
     if (refObj == nullptr) {
         return;
     }
+    if (refObj->waitingForHlr()) {                                     //redrawn when the projection is ready
+        return;
+    }
     if(!refObj->hasGeometry()) {                                       //nothing to draw yet (restoring)
         balloonLabel->hide();
         hide();
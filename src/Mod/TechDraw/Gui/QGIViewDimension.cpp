@@ -706,6 +706,9 @@ void QGIViewDimension::draw()
     if (refObj == nullptr) {
         return;
     }
+    if (refObj->waitingForHlr()) {                                     //redrawn when the projection is ready
+        return;
+    }
     if(!refObj->hasGeometry()) {                                       //nothing to draw yet (restoring)
         datumLabel->hide();
         hide();
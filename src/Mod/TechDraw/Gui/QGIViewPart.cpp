@@ -444,6 +444,9 @@ void QGIViewPart::drawViewPart()
         return;
     }
 //    Base::Console().Message("QGIVP::DVP() - %s / %s\n", viewPart->getNameInDocument(), viewPart->Label.getValue());
+    if (viewPart->waitingForHlr()) {
+        return;                                  //keep the current drawing until the projection is ready
+    }
     if (!viewPart->hasGeometry()) {
         removePrimitives();                      //clean the slate
         removeDecorations();
@@ -665,6 +665,109 @@ class DocumentRecomputeCases(unittest.TestCase):
     #closing doc
     FreeCAD.closeDocument("RecomputeTests")
 
+class DocumentDependencyCases(unittest.TestCase):
+  def setUp(self):
+    self.Doc = FreeCAD.newDocument("DependencyTests")
+    self.L1 = self.Doc.addObject("App::FeatureTest","Label_1")
+    self.L2 = self.Doc.addObject("App::FeatureTest","Label_2")
+    self.L3 = self.Doc.addObject("App::FeatureTest","Label_3")
+
+  def testAddRemoveLink(self):
+    self.failUnless(list(FreeCAD.getDependentObjects(self.L1,1)) == [self.L1])
+    self.L1.Link = self.L2
+    self.L2.LinkList = [self.L3]
+    self.failUnless(list(FreeCAD.getDependentObjects(self.L1,1)) == [self.L3,self.L2,self.L1])
+    self.failUnless(set(FreeCAD.getDependentObjects(self.L1)) == set([self.L1,self.L2,self.L3]))
+    # link against the current order
+    self.L3.Link = self.L1
+    self.L1.Link = None
+    self.failUnless(list(FreeCAD.getDependentObjects(self.L3,1)) == [self.L1,self.L3])
+    self.failUnless(list(FreeCAD.getDependentObjects(self.L2,1)) == [self.L1,self.L3,self.L2])
+    self.L2.LinkList = []
+    self.failUnless(list(FreeCAD.getDependentObjects(self.L2,1)) == [self.L2])
+    self.failUnless(self.Doc.recompute() == 3)
+
+  def testRemoveObject(self):
+    self.L1.Link = self.L2
+    self.L2.Link = self.L3
+    self.failUnless(list(FreeCAD.getDependentObjects(self.L1,1)) == [self.L3,self.L2,self.L1])
+    self.Doc.removeObject(self.L2.Name)
+    self.failUnless(self.L1.Link is None)
+    self.failUnless(list(FreeCAD.getDependentObjects(self.L1,1)) == [self.L1])
+    self.failUnless(list(FreeCAD.getDependentObjects(self.L3,1)) == [self.L3])
+
+  def testUndoRemoveObject(self):
+    self.Doc.UndoMode = 1
+    self.Doc.openTransaction("Link")
+    self.L1.Link = self.L2
+    self.L2.Link = self.L3
+    self.Doc.commitTransaction()
+
+    self.Doc.openTransaction("Remove")
+    self.Doc.removeObject("Label_2")
+    self.Doc.commitTransaction()
+    self.failUnless(self.L1.Link is None)
+    self.failUnless(list(FreeCAD.getDependentObjects(self.L1,1)) == [self.L1])
+
+    # undo re-adds the object together with the links to and from it
+    self.Doc.undo()
+    L2 = self.Doc.getObject("Label_2")
+    self.failUnless(self.L1.Link == L2)
+    self.failUnless(list(FreeCAD.getDependentObjects(self.L1,1)) == [self.L3,L2,self.L1])
+
+    self.Doc.redo()
+    self.failUnless(list(FreeCAD.getDependentObjects(self.L1,1)) == [self.L1])
+
+    self.Doc.undo()
+    self.Doc.undo()
+    self.failUnless(list(FreeCAD.getDependentObjects(self.L1,1)) == [self.L1])
+    self.failUnless(self.Doc.recompute() == 3)
+
+  def testCycle(self):
+    self.L1.Link = self.L2
+    self.L2.Link = self.L3
+    self.failUnless(list(FreeCAD.getDependentObjects(self.L1,1)) == [self.L3,self.L2,self.L1])
+
+    self.L3.Link = self.L1
+    self.failUnless(set(FreeCAD.getDependentObjects(self.L1)) == set([self.L1,self.L2,self.L3]))
+    self.assertRaises(Exception, FreeCAD.getDependentObjects, self.L1, 4)
+
+    # removing any link of the cycle brings back the sorted order
+    self.L2.Link = None
+    self.failUnless(list(FreeCAD.getDependentObjects(self.L1,4)) == [self.L2,self.L1])
+    self.failUnless(list(FreeCAD.getDependentObjects(self.L3,1)) == [self.L2,self.L1,self.L3])
+    self.failUnless(self.Doc.recompute() == 3)
+
+  def testCrossDocument(self):
+    # only links to a saved document are allowed
+    Doc2 = FreeCAD.newDocument("DependencyTests2")
+    Doc2.saveAs(tempfile.gettempdir() + os.sep + "DependencyTests2.FCStd")
+    Ext1 = Doc2.addObject("App::FeatureTest","Ext_1")
+    Ext2 = Doc2.addObject("App::FeatureTest","Ext_2")
+    Ext1.Link = Ext2
+    try:
+      link = self.Doc.addObject("App::Link","link")
+      link.LinkedObject = Ext1
+      self.L1.Link = link
+      self.failUnless(list(FreeCAD.getDependentObjects(self.L1,1)) == [Ext2,Ext1,link,self.L1])
+      self.failUnless(list(FreeCAD.getDependentObjects(self.L1,3)) == [link,self.L1])
+      # mixed documents
+      self.failUnless(list(FreeCAD.getDependentObjects([self.L1,Ext2],1)) == [Ext2,Ext1,link,self.L1])
+
+      # a change in the other document is seen as well
+      Ext1.Link = None
+      self.failUnless(list(FreeCAD.getDependentObjects(self.L1,1)) == [Ext1,link,self.L1])
+      link.LinkedObject = None
+      self.failUnless(list(FreeCAD.getDependentObjects(self.L1,1)) == [link,self.L1])
+    finally:
+      self.L1.Link = None
+      self.Doc.removeObject("link")
+      FreeCAD.closeDocument("DependencyTests2")
+
+  def tearDown(self):
+    #closing doc
+    FreeCAD.closeDocument("DependencyTests")
+
 class UndoRedoCases(unittest.TestCase):
   def setUp(self):
     self.Doc = FreeCAD.newDocument("UndoTest")